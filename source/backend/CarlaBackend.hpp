@@ -407,8 +407,29 @@ enum OptionsType {
      * Set path to the VST X11 UI bridge executable.\n
      * Default unset.
      */
-    OPTION_PATH_BRIDGE_VST_X11 = 29
+    OPTION_PATH_BRIDGE_VST_X11 = 29,
 #endif
+
+    /*!
+     * Interval in ms between output parameter and peak updates sent by the engine thread.\n
+     * Post-poned events are handled as soon as they arrive regardless of this value.\n
+     * Default is 30.
+     */
+    OPTION_METER_LATENCY = 30,
+
+    /*!
+     * Run plugin bridges one block behind the host, so they process in parallel with it.\n
+     * This adds one buffer of latency to each bridged plugin, reported to the engine.\n
+     * Default is no.
+     */
+    OPTION_ASYNC_PLUGIN_BRIDGES = 31,
+
+    /*!
+     * Load bridged plugins of the same binary type into a single bridge process, up to 16 per process.\n
+     * A crash of that process takes all of its plugins with it.\n
+     * Default is no.
+     */
+    OPTION_SHARE_PLUGIN_BRIDGES = 32
 };
 
 /*!
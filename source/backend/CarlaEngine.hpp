@@ -235,6 +235,8 @@ struct EngineOptions {
 
     bool forceStereo;
     bool preferPluginBridges;
+    bool asyncPluginBridges;
+    bool sharePluginBridges;
     bool preferUiBridges;
     bool uisAlwaysOnTop;
 #ifdef WANT_DSSI
@@ -243,6 +245,7 @@ struct EngineOptions {
 
     unsigned int maxParameters;
     unsigned int oscUiTimeout;
+    unsigned int meterLatency;
 
     bool jackAutoConnect;
     bool jackTimeMaster;
@@ -288,6 +291,8 @@ struct EngineOptions {
 # endif
           forceStereo(false),
           preferPluginBridges(false),
+          asyncPluginBridges(false),
+          sharePluginBridges(false),
           preferUiBridges(true),
           uisAlwaysOnTop(true),
 # ifdef WANT_DSSI
@@ -295,6 +300,7 @@ struct EngineOptions {
 # endif
           maxParameters(MAX_DEFAULT_PARAMETERS),
           oscUiTimeout(4000),
+          meterLatency(30),
           jackAutoConnect(false),
           jackTimeMaster(false),
 # ifdef WANT_RTAUDIO
@@ -627,6 +633,10 @@ public:
 #ifndef DOXYGEN
 private:
     EngineEvent* pBuffer;
+    uint32_t*    pCount;   // number of events in pBuffer, owned by the engine in rack and bridge modes
+    uint32_t     fCount;   // pCount storage for patchbay mode
+
+    friend class CarlaEngineGraph;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineEventPort)
 #endif
@@ -886,6 +896,19 @@ public:
      */
     const char* getUniquePluginName(const char* const name);
 
+#ifdef BUILD_BRIDGE
+    /*!
+     * Let the bridge audio thread process plugin with id \a id as slot \a slot, using the audio pool \a audioBaseName.
+     */
+    virtual bool attachBridgePlugin(const unsigned int slot, const char* const audioBaseName, const unsigned int id);
+
+    /*!
+     * Take the plugin the host has removed from slot \a slot, if any.\n
+     * The audio thread no longer uses it, the caller must remove it from the engine.
+     */
+    virtual CarlaPlugin* takeDetachedBridgePlugin(const unsigned int slot);
+#endif
+
     // -------------------------------------------------------------------
     // Project management
 
@@ -1046,6 +1069,12 @@ public:
      */
     void setAboutToClose();
 
+    /*!
+     * Wake up the engine thread so it handles post-poned plugin events.\n
+     * This function is real-time safe.
+     */
+    void signalPostRtEvents();
+
     // -------------------------------------------------------------------
     // Options
 
@@ -1069,11 +1098,6 @@ public:
     bool isOscControlRegistered() const;
 #endif
 
-    /*!
-     * Idle OSC.
-     */
-    void idleOsc();
-
     /*!
      * Get OSC TCP server path.
      */
@@ -1086,9 +1110,10 @@ public:
 
 #ifdef BUILD_BRIDGE
     /*!
-     * Set OSC bridge data.
+     * Set OSC bridge data of plugin with id \a pluginId.\n
+     * Each plugin of a bridge reports to its own host-side plugin.
      */
-    void setOscBridgeData(const CarlaOscData* const oscData);
+    void setOscBridgeData(const unsigned int pluginId, const CarlaOscData* const oscData);
 #endif
 
     // -------------------------------------
@@ -1135,6 +1160,7 @@ protected:
 
     // Internal data, used in Rack and Bridge modes
     EngineEvent* getInternalEventBuffer(const bool isInput) const;
+    uint32_t*    getInternalEventCount(const bool isInput) const;
 
 # ifndef BUILD_BRIDGE
     /*!
@@ -1173,25 +1199,25 @@ public:
 # ifdef BUILD_BRIDGE
     static CarlaEngine* newBridge(const char* const audioBaseName, const char* const controlBaseName);
 
-    void osc_send_bridge_audio_count(const int32_t ins, const int32_t outs, const int32_t total);
-    void osc_send_bridge_midi_count(const int32_t ins, const int32_t outs, const int32_t total);
-    void osc_send_bridge_parameter_count(const int32_t ins, const int32_t outs, const int32_t total);
-    void osc_send_bridge_program_count(const int32_t count);
-    void osc_send_bridge_midi_program_count(const int32_t count);
-    void osc_send_bridge_plugin_info(const int32_t category, const int32_t hints, const char* const name, const char* const label, const char* const maker, const char* const copyright, const int64_t uniqueId);
-    void osc_send_bridge_parameter_info(const int32_t index, const char* const name, const char* const unit);
-    void osc_send_bridge_parameter_data(const int32_t index, const int32_t type, const int32_t rindex, const int32_t hints, const int32_t midiChannel, const int32_t midiCC);
-    void osc_send_bridge_parameter_ranges(const int32_t index, const float def, const float min, const float max, const float step, const float stepSmall, const float stepLarge);
-    void osc_send_bridge_program_info(const int32_t index, const char* const name);
-    void osc_send_bridge_midi_program_info(const int32_t index, const int32_t bank, const int32_t program, const char* const label);
-    void osc_send_bridge_configure(const char* const key, const char* const value);
-    void osc_send_bridge_set_parameter_value(const int32_t index, const float value);
-    void osc_send_bridge_set_default_value(const int32_t index, const float value);
-    void osc_send_bridge_set_program(const int32_t index);
-    void osc_send_bridge_set_midi_program(const int32_t index);
-    void osc_send_bridge_set_custom_data(const char* const type, const char* const key, const char* const value);
-    void osc_send_bridge_set_chunk_data(const char* const chunkFile);
-    void osc_send_bridge_set_peaks();
+    void osc_send_bridge_audio_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total);
+    void osc_send_bridge_midi_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total);
+    void osc_send_bridge_parameter_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total);
+    void osc_send_bridge_program_count(const unsigned int pluginId, const int32_t count);
+    void osc_send_bridge_midi_program_count(const unsigned int pluginId, const int32_t count);
+    void osc_send_bridge_plugin_info(const unsigned int pluginId, const int32_t category, const int32_t hints, const char* const name, const char* const label, const char* const maker, const char* const copyright, const int64_t uniqueId);
+    void osc_send_bridge_parameter_info(const unsigned int pluginId, const int32_t index, const char* const name, const char* const unit);
+    void osc_send_bridge_parameter_data(const unsigned int pluginId, const int32_t index, const int32_t type, const int32_t rindex, const int32_t hints, const int32_t midiChannel, const int32_t midiCC);
+    void osc_send_bridge_parameter_ranges(const unsigned int pluginId, const int32_t index, const float def, const float min, const float max, const float step, const float stepSmall, const float stepLarge);
+    void osc_send_bridge_program_info(const unsigned int pluginId, const int32_t index, const char* const name);
+    void osc_send_bridge_midi_program_info(const unsigned int pluginId, const int32_t index, const int32_t bank, const int32_t program, const char* const label);
+    void osc_send_bridge_configure(const unsigned int pluginId, const char* const key, const char* const value);
+    void osc_send_bridge_set_parameter_value(const unsigned int pluginId, const int32_t index, const float value);
+    void osc_send_bridge_set_default_value(const unsigned int pluginId, const int32_t index, const float value);
+    void osc_send_bridge_set_program(const unsigned int pluginId, const int32_t index);
+    void osc_send_bridge_set_midi_program(const unsigned int pluginId, const int32_t index);
+    void osc_send_bridge_set_custom_data(const unsigned int pluginId, const char* const type, const char* const key, const char* const value);
+    void osc_send_bridge_set_chunk_data(const unsigned int pluginId, const char* const chunkFile);
+    void osc_send_bridge_set_peaks(const unsigned int pluginId);
 # else
     static void registerNativePlugin();
 
@@ -1216,10 +1242,16 @@ public:
     void osc_send_control_note_off(const int32_t pluginId, const int32_t channel, const int32_t note);
     void osc_send_control_set_peaks(const int32_t pluginId);
     void osc_send_control_exit();
+
+    // parameter values and peaks sent by the calling thread in between these go out as OSC bundles
+    void osc_send_control_begin_bundle();
+    void osc_send_control_end_bundle();
 # endif
 
 private:
     friend class CarlaEngineEventPort;
+    friend class CarlaEngineGraph;
+    friend class CarlaEngineOsc;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngine)
 #endif
@@ -774,6 +774,13 @@ public:
      */
     void postRtEventsRun();
 
+    /*!
+     * Send output parameter values that changed since the last call to the UI and/or OSC clients.\n
+     * If \a sendAll is true all values are sent.
+     * This function is called from the engine thread.
+     */
+    void outputParametersRun(const bool sendToUi, const bool sendToOsc, bool sendAll);
+
     // -------------------------------------------------------------------
     // Post-poned UI Stuff
 
@@ -854,6 +861,18 @@ protected:
     friend struct CarlaPluginProtectedData;
     CarlaPluginProtectedData* const kData; //!< Internal data, for CarlaPlugin subclasses only.
 
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Post-processing
+
+    /*!
+     * Apply dry/wet, balance and volume to the plugin output in a single pass, ramping from the values used in the previous call.\n
+     * \a dryBuffer and \a wetBuffer are read at \a inOffset, \a outBuffer is written at \a outOffset and may be the same as \a wetBuffer.\n
+     * The dry signal is delayed to match the plugin latency.
+     */
+    void processPostProc(float** const dryBuffer, float** const wetBuffer, float** const outBuffer, const uint32_t frames, const uint32_t inOffset, const uint32_t outOffset);
+#endif
+
     // -------------------------------------------------------------------
     // Helper classes
 
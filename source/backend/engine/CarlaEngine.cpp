@@ -17,6 +17,7 @@
 
 #include "CarlaEngineInternal.hpp"
 #include "CarlaBackendUtils.hpp"
+#include "CarlaBridgeUtils.hpp"
 #include "CarlaStateUtils.hpp"
 #include "CarlaMIDI.h"
 
@@ -178,12 +179,17 @@ void CarlaEngineCVPort::setBufferSize(const uint32_t bufferSize)
 
 CarlaEngineEventPort::CarlaEngineEventPort(const bool isInput, const ProcessMode processMode)
     : CarlaEnginePort(isInput, processMode),
-      pBuffer(nullptr)
+      pBuffer(nullptr),
+      pCount(nullptr),
+      fCount(0)
 {
     carla_debug("CarlaEngineEventPort::CarlaEngineEventPort(%s, %s)", bool2str(isInput), ProcessMode2Str(processMode));
 
     if (kProcessMode == PROCESS_MODE_PATCHBAY)
+    {
         pBuffer = new EngineEvent[INTERNAL_EVENT_COUNT];
+        pCount  = &fCount;
+    }
 }
 
 CarlaEngineEventPort::~CarlaEngineEventPort()
@@ -210,10 +216,17 @@ void CarlaEngineEventPort::initBuffer(CarlaEngine* const engine)
         return;
 
     if (kProcessMode == PROCESS_MODE_CONTINUOUS_RACK || kProcessMode == PROCESS_MODE_BRIDGE)
+    {
         pBuffer = engine->getInternalEventBuffer(kIsInput);
+        pCount  = engine->getInternalEventCount(kIsInput);
+    }
 
-    else if (kProcessMode == PROCESS_MODE_PATCHBAY && ! kIsInput)
-        carla_zeroStruct<EngineEvent>(pBuffer, INTERNAL_EVENT_COUNT);
+    if (kIsInput || pBuffer == nullptr || pCount == nullptr)
+        return;
+
+    // start writing from the beginning, the rest of the buffer is not touched
+    *pCount = 0;
+    pBuffer[0].clear();
 }
 
 uint32_t CarlaEngineEventPort::getEventCount() const
@@ -226,17 +239,12 @@ uint32_t CarlaEngineEventPort::getEventCount() const
         return 0;
     if (pBuffer == nullptr)
         return 0;
+    if (pCount == nullptr)
+        return 0;
     if (kProcessMode == PROCESS_MODE_SINGLE_CLIENT || kProcessMode == PROCESS_MODE_MULTIPLE_CLIENTS)
         return 0;
 
-    for (uint32_t i=0; i < INTERNAL_EVENT_COUNT; ++i)
-    {
-        if (pBuffer[i].type == kEngineEventTypeNull)
-            return i;
-    }
-
-    // buffer full
-    return INTERNAL_EVENT_COUNT;
+    return *pCount;
 }
 
 const EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index)
@@ -254,6 +262,8 @@ const EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index)
         return kFallbackEngineEvent;
     if (index >= INTERNAL_EVENT_COUNT)
         return kFallbackEngineEvent;
+    if (pCount != nullptr && index >= *pCount)
+        return kFallbackEngineEvent;
 
     return pBuffer[index];
 }
@@ -269,7 +279,7 @@ void CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t
 
     if (kIsInput)
         return;
-    if (pBuffer == nullptr)
+    if (pBuffer == nullptr || pCount == nullptr)
         return;
     if (kProcessMode == PROCESS_MODE_SINGLE_CLIENT || kProcessMode == PROCESS_MODE_MULTIPLE_CLIENTS)
         return;
@@ -282,22 +292,27 @@ void CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t
         CARLA_ASSERT(! MIDI_IS_CONTROL_BANK_SELECT(param));
     }
 
-    for (uint32_t i=0; i < INTERNAL_EVENT_COUNT; ++i)
-    {
-        if (pBuffer[i].type != kEngineEventTypeNull)
-            continue;
-
-        pBuffer[i].type    = kEngineEventTypeControl;
-        pBuffer[i].time    = time;
-        pBuffer[i].channel = channel;
+    const uint32_t i(*pCount);
 
-        pBuffer[i].ctrl.type  = type;
-        pBuffer[i].ctrl.param = param;
-        pBuffer[i].ctrl.value = carla_fixValue<float>(0.0f, 1.0f, value);
+    if (i >= INTERNAL_EVENT_COUNT)
+    {
+        carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
         return;
     }
 
-    carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
+    pBuffer[i].type    = kEngineEventTypeControl;
+    pBuffer[i].time    = time;
+    pBuffer[i].channel = channel;
+
+    pBuffer[i].ctrl.type  = type;
+    pBuffer[i].ctrl.param = param;
+    pBuffer[i].ctrl.value = carla_fixValue<float>(0.0f, 1.0f, value);
+
+    // keep buffer null-terminated
+    if (i+1 < INTERNAL_EVENT_COUNT)
+        pBuffer[i+1].clear();
+
+    *pCount = i+1;
 }
 
 void CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t channel, const uint8_t port, const uint8_t* const data, const uint8_t size)
@@ -311,7 +326,7 @@ void CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t cha
 
     if (kIsInput)
         return;
-    if (pBuffer == nullptr)
+    if (pBuffer == nullptr || pCount == nullptr)
         return;
     if (kProcessMode == PROCESS_MODE_SINGLE_CLIENT || kProcessMode == PROCESS_MODE_MULTIPLE_CLIENTS)
         return;
@@ -322,26 +337,31 @@ void CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t cha
     if (size == 0 || size > 4)
         return;
 
-    for (uint32_t i=0; i < INTERNAL_EVENT_COUNT; ++i)
+    const uint32_t i(*pCount);
+
+    if (i >= INTERNAL_EVENT_COUNT)
     {
-        if (pBuffer[i].type != kEngineEventTypeNull)
-            continue;
+        carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
+        return;
+    }
 
-        pBuffer[i].type    = kEngineEventTypeMidi;
-        pBuffer[i].time    = time;
-        pBuffer[i].channel = channel;
+    pBuffer[i].type    = kEngineEventTypeMidi;
+    pBuffer[i].time    = time;
+    pBuffer[i].channel = channel;
 
-        pBuffer[i].midi.port = port;
-        pBuffer[i].midi.size = size;
+    pBuffer[i].midi.port = port;
+    pBuffer[i].midi.size = size;
 
-        carla_copy<uint8_t>(pBuffer[i].midi.data, data, size);
+    carla_copy<uint8_t>(pBuffer[i].midi.data, data, size);
 
-        // strip MIDI channel from 1st byte
-        pBuffer[i].midi.data[0] = MIDI_GET_STATUS_FROM_DATA(pBuffer[i].midi.data);
-        return;
-    }
+    // strip MIDI channel from 1st byte
+    pBuffer[i].midi.data[0] = MIDI_GET_STATUS_FROM_DATA(pBuffer[i].midi.data);
 
-    carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
+    // keep buffer null-terminated
+    if (i+1 < INTERNAL_EVENT_COUNT)
+        pBuffer[i+1].clear();
+
+    *pCount = i+1;
 }
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -620,14 +640,17 @@ bool CarlaEngine::init(const char* const clientName)
         kData->maxPluginNumber = MAX_RACK_PLUGINS;
         kData->bufEvents.in  = new EngineEvent[INTERNAL_EVENT_COUNT];
         kData->bufEvents.out = new EngineEvent[INTERNAL_EVENT_COUNT];
+        kData->bufAudio.resize(fBufferSize);
         break;
 
     case PROCESS_MODE_PATCHBAY:
         kData->maxPluginNumber = MAX_PATCHBAY_PLUGINS;
+        kData->bufEvents.in  = new EngineEvent[INTERNAL_EVENT_COUNT];
+        kData->bufEvents.out = new EngineEvent[INTERNAL_EVENT_COUNT];
         break;
 
     case PROCESS_MODE_BRIDGE:
-        kData->maxPluginNumber = 1;
+        kData->maxPluginNumber = BRIDGE_SHM_PLUGIN_COUNT;
         kData->bufEvents.in  = new EngineEvent[INTERNAL_EVENT_COUNT];
         kData->bufEvents.out = new EngineEvent[INTERNAL_EVENT_COUNT];
         break;
@@ -645,6 +668,11 @@ bool CarlaEngine::init(const char* const clientName)
 
     kData->plugins = new EnginePluginData[kData->maxPluginNumber];
 
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.init();
+#endif
+
     kData->osc.init(clientName);
 #ifndef BUILD_BRIDGE
     kData->oscData = kData->osc.getControlData();
@@ -655,6 +683,7 @@ bool CarlaEngine::init(const char* const clientName)
 
     kData->nextAction.ready();
     kData->thread.startNow();
+    kData->osc.startThread();
 
     return true;
 }
@@ -667,10 +696,14 @@ bool CarlaEngine::close()
     CARLA_ASSERT(kData->nextPluginId == kData->maxPluginNumber);
     carla_debug("CarlaEngine::close()");
 
+    kData->osc.stopThread();
     kData->thread.stopNow();
     kData->nextAction.ready();
 
 #ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.close();
+
     osc_send_control_exit();
 #endif
     kData->osc.close();
@@ -699,6 +732,11 @@ bool CarlaEngine::close()
         kData->bufEvents.out = nullptr;
     }
 
+    kData->bufEvents.inCount  = 0;
+    kData->bufEvents.outCount = 0;
+
+    kData->bufAudio.clear();
+
     fName.clear();
 
     return true;
@@ -710,13 +748,21 @@ void CarlaEngine::idle()
     CARLA_ASSERT(kData->nextAction.opcode == kEnginePostActionNull); // TESTING, remove later
     CARLA_ASSERT(kData->nextPluginId == kData->maxPluginNumber);     // TESTING, remove later
 
-    for (unsigned int i=0; i < kData->curPluginCount; ++i)
     {
-        CarlaPlugin* const plugin(kData->plugins[i].plugin);
+        // OSC handlers run under this lock too, keep them away from the plugins' GUI data
+        const CarlaMutex::ScopedLocker sl(kData->thread.getMutex());
 
-        if (plugin != nullptr && plugin->enabled())
-            plugin->idleGui();
+        for (unsigned int i=0; i < kData->curPluginCount; ++i)
+        {
+            CarlaPlugin* const plugin(kData->plugins[i].plugin);
+
+            if (plugin != nullptr && plugin->enabled())
+                plugin->idleGui();
+        }
     }
+
+    // rack buffers left over from a buffer size change
+    kData->bufAudio.freeRetired();
 }
 
 CarlaEngineClient* CarlaEngine::addClient(CarlaPlugin* const)
@@ -882,7 +928,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype, cons
 
     plugin->registerToOscClient();
 
-    kData->plugins[id].plugin      = plugin;
+    kData->plugins[id].setPlugin(plugin);
     kData->plugins[id].insPeak[0]  = 0.0f;
     kData->plugins[id].insPeak[1]  = 0.0f;
     kData->plugins[id].outsPeak[0] = 0.0f;
@@ -890,6 +936,11 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype, cons
 
     ++kData->curPluginCount;
 
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.pluginAdded(id);
+#endif
+
     callback(CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->name());
     return true;
 }
@@ -918,9 +969,11 @@ bool CarlaEngine::removePlugin(const unsigned int id)
 
     CARLA_ASSERT(plugin->id() == id);
 
+    kData->osc.stopThread();
     kData->thread.stopNow();
 
-    const bool lockWait(isRunning() && fOptions.processMode != PROCESS_MODE_MULTIPLE_CLIENTS);
+    // a bridge never runs pending actions, its audio thread reaches plugins through slots the host empties first
+    const bool lockWait(isRunning() && fOptions.processMode != PROCESS_MODE_MULTIPLE_CLIENTS && fOptions.processMode != PROCESS_MODE_BRIDGE);
     const CarlaEngineProtectedData::ScopedPluginAction spa(kData, kEnginePostActionRemovePlugin, id, 0, lockWait);
 
 #ifndef BUILD_BRIDGE
@@ -930,8 +983,16 @@ bool CarlaEngine::removePlugin(const unsigned int id)
 
     delete plugin;
 
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.pluginRemoved(id);
+#endif
+
     if (isRunning() && ! kData->aboutToClose)
+    {
         kData->thread.startNow();
+        kData->osc.startThread();
+    }
 
     callback(CALLBACK_PLUGIN_REMOVED, id, 0, 0, 0.0f, nullptr);
     return true;
@@ -946,8 +1007,13 @@ void CarlaEngine::removeAllPlugins()
     if (kData->plugins == nullptr || kData->curPluginCount == 0)
         return;
 
+    kData->osc.stopThread();
     kData->thread.stopNow();
 
+#ifndef BUILD_BRIDGE
+    const unsigned int oldCount(kData->curPluginCount);
+#endif
+
     const bool lockWait(isRunning());
     const CarlaEngineProtectedData::ScopedPluginAction spa(kData, kEnginePostActionZeroCount, 0, 0, lockWait);
 
@@ -955,7 +1021,7 @@ void CarlaEngine::removeAllPlugins()
     {
         CarlaPlugin* const plugin(kData->plugins[i].plugin);
 
-        kData->plugins[i].plugin = nullptr;
+        kData->plugins[i].setPlugin(nullptr);
 
         if (plugin != nullptr)
             delete plugin;
@@ -967,8 +1033,16 @@ void CarlaEngine::removeAllPlugins()
         kData->plugins[i].outsPeak[1] = 0.0f;
     }
 
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.pluginsCleared(oldCount);
+#endif
+
     if (isRunning() && ! kData->aboutToClose)
+    {
         kData->thread.startNow();
+        kData->osc.startThread();
+    }
 
     carla_debug("CarlaEngine::removeAllPlugins() - END");
 }
@@ -1084,6 +1158,7 @@ bool CarlaEngine::switchPlugins(const unsigned int idA, const unsigned int idB)
         return false;
     }
 
+    kData->osc.stopThread();
     kData->thread.stopNow();
 
     const bool lockWait(isRunning() && fOptions.processMode != PROCESS_MODE_MULTIPLE_CLIENTS);
@@ -1092,10 +1167,16 @@ bool CarlaEngine::switchPlugins(const unsigned int idA, const unsigned int idB)
 #ifndef BUILD_BRIDGE // TODO
     //if (isOscControlRegistered())
     //    osc_send_control_switch_plugins(idA, idB);
+
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.pluginsSwitched(idA, idB);
 #endif
 
     if (isRunning() && ! kData->aboutToClose)
+    {
         kData->thread.startNow();
+        kData->osc.startThread();
+    }
 
     return true;
 }
@@ -1206,6 +1287,19 @@ const char* CarlaEngine::getUniquePluginName(const char* const name)
     return (const char*)sname;
 }
 
+#ifdef BUILD_BRIDGE
+bool CarlaEngine::attachBridgePlugin(const unsigned int, const char* const, const unsigned int)
+{
+    setLastError("This engine type cannot host bridged plugins");
+    return false;
+}
+
+CarlaPlugin* CarlaEngine::takeDetachedBridgePlugin(const unsigned int)
+{
+    return nullptr;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // Project management
 
@@ -1513,21 +1607,45 @@ void CarlaEngine::setCallback(const CallbackFunc func, void* const ptr)
 // -----------------------------------------------------------------------
 // Patchbay
 
-bool CarlaEngine::patchbayConnect(int, int)
+bool CarlaEngine::patchbayConnect(int portA, int portB)
 {
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        return kData->graph.connect(portA, portB);
+#endif
+
+#ifdef BUILD_BRIDGE
+    // unused
+    (void)portA;
+    (void)portB;
+#endif
+
     setLastError("Unsupported operation");
     return false;
 }
 
-bool CarlaEngine::patchbayDisconnect(int)
+bool CarlaEngine::patchbayDisconnect(int connectionId)
 {
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        return kData->graph.disconnect(connectionId);
+#endif
+
+#ifdef BUILD_BRIDGE
+    // unused
+    (void)connectionId;
+#endif
+
     setLastError("Unsupported operation");
     return false;
 }
 
 void CarlaEngine::patchbayRefresh()
 {
-    // nothing
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.refresh();
+#endif
 }
 
 // -----------------------------------------------------------------------
@@ -1567,6 +1685,11 @@ void CarlaEngine::setAboutToClose()
     kData->aboutToClose = true;
 }
 
+void CarlaEngine::signalPostRtEvents()
+{
+    kData->thread.wakeUp();
+}
+
 // -----------------------------------------------------------------------
 // Global options
 
@@ -1629,6 +1752,16 @@ void CarlaEngine::setOption(const OptionsType option, const int value, const cha
         fOptions.preferPluginBridges = (value != 0);
         break;
 
+    case OPTION_ASYNC_PLUGIN_BRIDGES:
+        CARLA_ENGINE_SET_OPTION_RUNNING_CHECK
+        fOptions.asyncPluginBridges = (value != 0);
+        break;
+
+    case OPTION_SHARE_PLUGIN_BRIDGES:
+        CARLA_ENGINE_SET_OPTION_RUNNING_CHECK
+        fOptions.sharePluginBridges = (value != 0);
+        break;
+
     case OPTION_PREFER_UI_BRIDGES:
         CARLA_ENGINE_SET_OPTION_RUNNING_CHECK
         fOptions.preferUiBridges = (value != 0);
@@ -1639,6 +1772,13 @@ void CarlaEngine::setOption(const OptionsType option, const int value, const cha
         fOptions.oscUiTimeout = static_cast<uint>(value);
         break;
 
+    case OPTION_METER_LATENCY:
+        if (value <= 0)
+            return carla_stderr("CarlaEngine::setOption(%s, %i, \"%s\") - invalid value", OptionsType2Str(option), value, valueStr);
+
+        fOptions.meterLatency = static_cast<uint>(value);
+        break;
+
     case OPTION_JACK_AUTOCONNECT:
         CARLA_ENGINE_SET_OPTION_RUNNING_CHECK
         fOptions.jackAutoConnect = (value != 0);
@@ -1732,7 +1872,17 @@ void CarlaEngine::setOption(const OptionsType option, const int value, const cha
 #ifdef BUILD_BRIDGE
 bool CarlaEngine::isOscBridgeRegistered() const
 {
-    return (kData->oscData != nullptr);
+    if (kData->plugins == nullptr)
+        return false;
+
+    // a plugin being added registers its data before it is counted
+    for (unsigned int i=0; i < kData->maxPluginNumber; ++i)
+    {
+        if (kData->plugins[i].oscData != nullptr)
+            return true;
+    }
+
+    return false;
 }
 #else
 bool CarlaEngine::isOscControlRegistered() const
@@ -1741,11 +1891,6 @@ bool CarlaEngine::isOscControlRegistered() const
 }
 #endif
 
-void CarlaEngine::idleOsc()
-{
-    kData->osc.idle();
-}
-
 const char* CarlaEngine::getOscServerPathTCP() const
 {
     return kData->osc.getServerPathTCP();
@@ -1757,9 +1902,12 @@ const char* CarlaEngine::getOscServerPathUDP() const
 }
 
 #ifdef BUILD_BRIDGE
-void CarlaEngine::setOscBridgeData(const CarlaOscData* const oscData)
+void CarlaEngine::setOscBridgeData(const unsigned int pluginId, const CarlaOscData* const oscData)
 {
-    kData->oscData = oscData;
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+
+    if (kData->plugins != nullptr && pluginId < kData->maxPluginNumber)
+        kData->plugins[pluginId].oscData = oscData;
 }
 #endif
 
@@ -1778,6 +1926,13 @@ void CarlaEngine::bufferSizeChanged(const uint32_t newBufferSize)
             plugin->bufferSizeChanged(newBufferSize);
     }
 
+#ifndef BUILD_BRIDGE
+    if (fOptions.processMode == PROCESS_MODE_CONTINUOUS_RACK)
+        kData->bufAudio.resize(newBufferSize);
+    else if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
+        kData->graph.bufferSizeChanged();
+#endif
+
     callback(CALLBACK_BUFFER_SIZE_CHANGED, 0, newBufferSize, 0, 0.0f, nullptr);
 }
 
@@ -1843,22 +1998,29 @@ EngineEvent* CarlaEngine::getInternalEventBuffer(const bool isInput) const
     return isInput ? kData->bufEvents.in : kData->bufEvents.out;
 }
 
-#ifndef BUILD_BRIDGE
-void setValueIfHigher(float& value, const float& compare)
+uint32_t* CarlaEngine::getInternalEventCount(const bool isInput) const
 {
-    if (value < compare)
-        value = compare;
+    return isInput ? &kData->bufEvents.inCount : &kData->bufEvents.outCount;
 }
 
+#ifndef BUILD_BRIDGE
 void CarlaEngine::processRack(float* inBuf[2], float* outBuf[2], const uint32_t frames)
 {
     CARLA_ASSERT(kData->bufEvents.in != nullptr);
     CARLA_ASSERT(kData->bufEvents.out != nullptr);
 
+    // each plugin processes 'in' into 'out', buffers are swapped between plugins.
+    // 'out' alternates between the engine output and the internal rack buffers.
+    float* in[2]  = { inBuf[0], inBuf[1] };
+    float* out[2] = { outBuf[0], outBuf[1] };
+
+    const CarlaEngineProtectedData::InternalAudioBuffer::Buffers* const buffers(kData->bufAudio.take());
+    const bool canSwap(buffers != nullptr && buffers->size >= frames);
+
     // initialize outputs (zero)
     carla_zeroFloat(outBuf[0], frames);
     carla_zeroFloat(outBuf[1], frames);
-    carla_zeroMem(kData->bufEvents.out, sizeof(EngineEvent)*INTERNAL_EVENT_COUNT);
+    kData->bufEvents.clearOut();
 
     bool processed = false;
 
@@ -1873,19 +2035,29 @@ void CarlaEngine::processRack(float* inBuf[2], float* outBuf[2], const uint32_t
         if (processed)
         {
             // initialize inputs (from previous outputs)
-            carla_copyFloat(inBuf[0], outBuf[0], frames);
-            carla_copyFloat(inBuf[1], outBuf[1], frames);
-            std::memcpy(kData->bufEvents.in, kData->bufEvents.out, sizeof(EngineEvent)*INTERNAL_EVENT_COUNT);
+            if (canSwap)
+            {
+                in[0]  = out[0];
+                in[1]  = out[1];
+                out[0] = (in[0] == outBuf[0]) ? buffers->rack[0] : outBuf[0];
+                out[1] = (in[1] == outBuf[1]) ? buffers->rack[1] : outBuf[1];
+            }
+            else
+            {
+                carla_copyFloat(inBuf[0], outBuf[0], frames);
+                carla_copyFloat(inBuf[1], outBuf[1], frames);
+            }
+
+            kData->bufEvents.swap();
 
             // initialize outputs (zero)
-            carla_zeroFloat(outBuf[0], frames);
-            carla_zeroFloat(outBuf[1], frames);
-            carla_zeroMem(kData->bufEvents.out, sizeof(EngineEvent)*INTERNAL_EVENT_COUNT);
+            carla_zeroFloat(out[0], frames);
+            carla_zeroFloat(out[1], frames);
         }
 
         // process
         plugin->initBuffers();
-        plugin->process(inBuf, outBuf, frames);
+        plugin->process(in, out, frames);
         plugin->unlock();
 
 #if 0
@@ -1910,40 +2082,28 @@ void CarlaEngine::processRack(float* inBuf[2], float* outBuf[2], const uint32_t
 #endif
 
         // set peaks
-        {
-            float inPeak1  = 0.0f;
-            float inPeak2  = 0.0f;
-            float outPeak1 = 0.0f;
-            float outPeak2 = 0.0f;
-
-            for (uint32_t k=0; k < frames; ++k)
-            {
-                setValueIfHigher(inPeak1,  std::fabs(inBuf[0][k]));
-                setValueIfHigher(inPeak2,  std::fabs(inBuf[1][k]));
-                setValueIfHigher(outPeak1, std::fabs(outBuf[0][k]));
-                setValueIfHigher(outPeak2, std::fabs(outBuf[1][k]));
-            }
-
-            kData->plugins[i].insPeak[0]  = inPeak1;
-            kData->plugins[i].insPeak[1]  = inPeak2;
-            kData->plugins[i].outsPeak[0] = outPeak1;
-            kData->plugins[i].outsPeak[1] = outPeak2;
-        }
+        kData->plugins[i].insPeak[0]  = carla_findAbsMaxFloat(in[0], frames);
+        kData->plugins[i].insPeak[1]  = carla_findAbsMaxFloat(in[1], frames);
+        kData->plugins[i].outsPeak[0] = carla_findAbsMaxFloat(out[0], frames);
+        kData->plugins[i].outsPeak[1] = carla_findAbsMaxFloat(out[1], frames);
 
         processed = true;
     }
+
+    // last plugin wrote into the rack buffers, move result to the engine output
+    if (out[0] != outBuf[0])
+    {
+        carla_copyFloat(outBuf[0], out[0], frames);
+        carla_copyFloat(outBuf[1], out[1], frames);
+    }
 }
 
 void CarlaEngine::processPatchbay(float** inBuf, float** outBuf, const uint32_t bufCount[2], const uint32_t frames)
 {
-    // TODO
-    return;
+    CARLA_ASSERT(kData->bufEvents.in != nullptr);
+    CARLA_ASSERT(kData->bufEvents.out != nullptr);
 
-    // unused, for now
-    (void)inBuf;
-    (void)outBuf;
-    (void)bufCount;
-    (void)frames;
+    kData->graph.process(inBuf, outBuf, bufCount, frames);
 }
 #endif
 
@@ -2114,10 +2274,11 @@ void CarlaEngine::osc_send_control_set_parameter_value(const int32_t pluginId, c
 
     if (kData->oscData != nullptr && kData->oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+21];
-        std::strcpy(targetPath, kData->oscData->path);
-        std::strcat(targetPath, "/set_parameter_value");
-        lo_send(kData->oscData->target, targetPath, "iif", pluginId, index, value);
+        const lo_message msg(lo_message_new());
+        lo_message_add_int32(msg, pluginId);
+        lo_message_add_int32(msg, index);
+        lo_message_add_float(msg, value);
+        kData->osc.sendControlMessage("/set_parameter_value", msg);
     }
 }
 
@@ -2279,13 +2440,26 @@ void CarlaEngine::osc_send_control_set_peaks(const int32_t pluginId)
 
     if (kData->oscData != nullptr && kData->oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+22];
-        std::strcpy(targetPath, kData->oscData->path);
-        std::strcat(targetPath, "/set_peaks");
-        lo_send(kData->oscData->target, targetPath, "iffff", pluginId, pData.insPeak[0], pData.insPeak[1], pData.outsPeak[0], pData.outsPeak[1]);
+        const lo_message msg(lo_message_new());
+        lo_message_add_int32(msg, pluginId);
+        lo_message_add_float(msg, pData.insPeak[0]);
+        lo_message_add_float(msg, pData.insPeak[1]);
+        lo_message_add_float(msg, pData.outsPeak[0]);
+        lo_message_add_float(msg, pData.outsPeak[1]);
+        kData->osc.sendControlMessage("/set_peaks", msg);
     }
 }
 
+void CarlaEngine::osc_send_control_begin_bundle()
+{
+    kData->osc.beginControlBundle();
+}
+
+void CarlaEngine::osc_send_control_end_bundle()
+{
+    kData->osc.endControlBundle();
+}
+
 void CarlaEngine::osc_send_control_exit()
 {
     CARLA_ASSERT(kData->oscData != nullptr);
@@ -2300,268 +2474,304 @@ void CarlaEngine::osc_send_control_exit()
     }
 }
 #else
-void CarlaEngine::osc_send_bridge_audio_count(const int32_t ins, const int32_t outs, const int32_t total)
+void CarlaEngine::osc_send_bridge_audio_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(total >= 0 && total >= ins + outs);
-    carla_debug("CarlaEngine::osc_send_bridge_audio_count(%i, %i, %i)", ins, outs, total);
+    carla_debug("CarlaEngine::osc_send_bridge_audio_count(%i, %i, %i, %i)", pluginId, ins, outs, total);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+20];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+20];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_audio_count");
-        lo_send(kData->oscData->target, targetPath, "iii", ins, outs, total);
+        lo_send(oscData->target, targetPath, "iii", ins, outs, total);
     }
 }
 
-void CarlaEngine::osc_send_bridge_midi_count(const int32_t ins, const int32_t outs, const int32_t total)
+void CarlaEngine::osc_send_bridge_midi_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(total >= 0 && total >= ins + outs);
-    carla_debug("CarlaEngine::osc_send_bridge_midi_count(%i, %i, %i)", ins, outs, total);
+    carla_debug("CarlaEngine::osc_send_bridge_midi_count(%i, %i, %i, %i)", pluginId, ins, outs, total);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+19];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+19];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_midi_count");
-        lo_send(kData->oscData->target, targetPath, "iii", ins, outs, total);
+        lo_send(oscData->target, targetPath, "iii", ins, outs, total);
     }
 }
 
-void CarlaEngine::osc_send_bridge_parameter_count(const int32_t ins, const int32_t outs, const int32_t total)
+void CarlaEngine::osc_send_bridge_parameter_count(const unsigned int pluginId, const int32_t ins, const int32_t outs, const int32_t total)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(total >= 0 && total >= ins + outs);
-    carla_debug("CarlaEngine::osc_send_bridge_parameter_count(%i, %i, %i)", ins, outs, total);
+    carla_debug("CarlaEngine::osc_send_bridge_parameter_count(%i, %i, %i, %i)", pluginId, ins, outs, total);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+24];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+24];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_parameter_count");
-        lo_send(kData->oscData->target, targetPath, "iii", ins, outs, total);
+        lo_send(oscData->target, targetPath, "iii", ins, outs, total);
     }
 }
 
-void CarlaEngine::osc_send_bridge_program_count(const int32_t count)
+void CarlaEngine::osc_send_bridge_program_count(const unsigned int pluginId, const int32_t count)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(count >= 0);
-    carla_debug("CarlaEngine::osc_send_bridge_program_count(%i)", count);
+    carla_debug("CarlaEngine::osc_send_bridge_program_count(%i, %i)", pluginId, count);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+22];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+22];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_program_count");
-        lo_send(kData->oscData->target, targetPath, "i", count);
+        lo_send(oscData->target, targetPath, "i", count);
     }
 }
 
-void CarlaEngine::osc_send_bridge_midi_program_count(const int32_t count)
+void CarlaEngine::osc_send_bridge_midi_program_count(const unsigned int pluginId, const int32_t count)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(count >= 0);
-    carla_debug("CarlaEngine::osc_send_bridge_midi_program_count(%i)", count);
+    carla_debug("CarlaEngine::osc_send_bridge_midi_program_count(%i, %i)", pluginId, count);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+27];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+27];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_midi_program_count");
-        lo_send(kData->oscData->target, targetPath, "i", count);
+        lo_send(oscData->target, targetPath, "i", count);
     }
 }
 
-void CarlaEngine::osc_send_bridge_plugin_info(const int32_t category, const int32_t hints, const char* const name, const char* const label, const char* const maker, const char* const copyright, const int64_t uniqueId)
+void CarlaEngine::osc_send_bridge_plugin_info(const unsigned int pluginId, const int32_t category, const int32_t hints, const char* const name, const char* const label, const char* const maker, const char* const copyright, const int64_t uniqueId)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(name != nullptr);
     CARLA_ASSERT(label != nullptr);
     CARLA_ASSERT(maker != nullptr);
     CARLA_ASSERT(copyright != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_plugin_info(%i, %i, \"%s\", \"%s\", \"%s\", \"%s\", " P_INT64 ")", category, hints, name, label, maker, copyright, uniqueId);
+    carla_debug("CarlaEngine::osc_send_bridge_plugin_info(%i, %i, %i, \"%s\", \"%s\", \"%s\", \"%s\", " P_INT64 ")", pluginId, category, hints, name, label, maker, copyright, uniqueId);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+20];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+20];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_plugin_info");
-        lo_send(kData->oscData->target, targetPath, "iissssh", category, hints, name, label, maker, copyright, uniqueId);
+        lo_send(oscData->target, targetPath, "iissssh", category, hints, name, label, maker, copyright, uniqueId);
     }
 }
 
-void CarlaEngine::osc_send_bridge_parameter_info(const int32_t index, const char* const name, const char* const unit)
+void CarlaEngine::osc_send_bridge_parameter_info(const unsigned int pluginId, const int32_t index, const char* const name, const char* const unit)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(name != nullptr);
     CARLA_ASSERT(unit != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_parameter_info(%i, \"%s\", \"%s\")", index, name, unit);
+    carla_debug("CarlaEngine::osc_send_bridge_parameter_info(%i, %i, \"%s\", \"%s\")", pluginId, index, name, unit);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+23];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+23];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_parameter_info");
-        lo_send(kData->oscData->target, targetPath, "iss", index, name, unit);
+        lo_send(oscData->target, targetPath, "iss", index, name, unit);
     }
 }
 
-void CarlaEngine::osc_send_bridge_parameter_data(const int32_t index, const int32_t type, const int32_t rindex, const int32_t hints, const int32_t midiChannel, const int32_t midiCC)
+void CarlaEngine::osc_send_bridge_parameter_data(const unsigned int pluginId, const int32_t index, const int32_t type, const int32_t rindex, const int32_t hints, const int32_t midiChannel, const int32_t midiCC)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_parameter_data(%i, %i, %i, %i, %i, %i)", index, type, rindex, hints, midiChannel, midiCC);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_parameter_data(%i, %i, %i, %i, %i, %i, %i)", pluginId, index, type, rindex, hints, midiChannel, midiCC);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+23];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+23];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_parameter_data");
-        lo_send(kData->oscData->target, targetPath, "iiiiii", index, type, rindex, hints, midiChannel, midiCC);
+        lo_send(oscData->target, targetPath, "iiiiii", index, type, rindex, hints, midiChannel, midiCC);
     }
 }
 
-void CarlaEngine::osc_send_bridge_parameter_ranges(const int32_t index, const float def, const float min, const float max, const float step, const float stepSmall, const float stepLarge)
+void CarlaEngine::osc_send_bridge_parameter_ranges(const unsigned int pluginId, const int32_t index, const float def, const float min, const float max, const float step, const float stepSmall, const float stepLarge)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_parameter_ranges(%i, %f, %f, %f, %f, %f, %f)", index, def, min, max, step, stepSmall, stepLarge);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_parameter_ranges(%i, %i, %f, %f, %f, %f, %f, %f)", pluginId, index, def, min, max, step, stepSmall, stepLarge);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+25];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+25];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_parameter_ranges");
-        lo_send(kData->oscData->target, targetPath, "iffffff", index, def, min, max, step, stepSmall, stepLarge);
+        lo_send(oscData->target, targetPath, "iffffff", index, def, min, max, step, stepSmall, stepLarge);
     }
 }
 
-void CarlaEngine::osc_send_bridge_program_info(const int32_t index, const char* const name)
+void CarlaEngine::osc_send_bridge_program_info(const unsigned int pluginId, const int32_t index, const char* const name)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_program_info(%i, \"%s\")", index, name);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_program_info(%i, %i, \"%s\")", pluginId, index, name);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+21];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+21];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_program_info");
-        lo_send(kData->oscData->target, targetPath, "is", index, name);
+        lo_send(oscData->target, targetPath, "is", index, name);
     }
 }
 
-void CarlaEngine::osc_send_bridge_midi_program_info(const int32_t index, const int32_t bank, const int32_t program, const char* const label)
+void CarlaEngine::osc_send_bridge_midi_program_info(const unsigned int pluginId, const int32_t index, const int32_t bank, const int32_t program, const char* const label)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_midi_program_info(%i, %i, %i, \"%s\")", index, bank, program, label);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_midi_program_info(%i, %i, %i, %i, \"%s\")", pluginId, index, bank, program, label);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+26];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+26];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_midi_program_info");
-        lo_send(kData->oscData->target, targetPath, "iiis", index, bank, program, label);
+        lo_send(oscData->target, targetPath, "iiis", index, bank, program, label);
     }
 }
 
-void CarlaEngine::osc_send_bridge_configure(const char* const key, const char* const value)
+void CarlaEngine::osc_send_bridge_configure(const unsigned int pluginId, const char* const key, const char* const value)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
     CARLA_ASSERT(key != nullptr);
     CARLA_ASSERT(value != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_configure(\"%s\", \"%s\")", key, value);
+    carla_debug("CarlaEngine::osc_send_bridge_configure(%i, \"%s\", \"%s\")", pluginId, key, value);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+18];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+18];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_configure");
-        lo_send(kData->oscData->target, targetPath, "ss", key, value);
+        lo_send(oscData->target, targetPath, "ss", key, value);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_parameter_value(const int32_t index, const float value)
+void CarlaEngine::osc_send_bridge_set_parameter_value(const unsigned int pluginId, const int32_t index, const float value)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_parameter_value(%i, %f)", index, value);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_parameter_value(%i, %i, %f)", pluginId, index, value);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+28];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+28];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_parameter_value");
-        lo_send(kData->oscData->target, targetPath, "if", index, value);
+        lo_send(oscData->target, targetPath, "if", index, value);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_default_value(const int32_t index, const float value)
+void CarlaEngine::osc_send_bridge_set_default_value(const unsigned int pluginId, const int32_t index, const float value)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_default_value(%i, %f)", index, value);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_default_value(%i, %i, %f)", pluginId, index, value);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+26];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+26];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_default_value");
-        lo_send(kData->oscData->target, targetPath, "if", index, value);
+        lo_send(oscData->target, targetPath, "if", index, value);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_program(const int32_t index)
+void CarlaEngine::osc_send_bridge_set_program(const unsigned int pluginId, const int32_t index)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_program(%i)", index);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_program(%i, %i)", pluginId, index);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+20];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+20];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_program");
-        lo_send(kData->oscData->target, targetPath, "i", index);
+        lo_send(oscData->target, targetPath, "i", index);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_midi_program(const int32_t index)
+void CarlaEngine::osc_send_bridge_set_midi_program(const unsigned int pluginId, const int32_t index)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_midi_program(%i)", index);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_midi_program(%i, %i)", pluginId, index);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+25];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+25];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_midi_program");
-        lo_send(kData->oscData->target, targetPath, "i", index);
+        lo_send(oscData->target, targetPath, "i", index);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_custom_data(const char* const type, const char* const key, const char* const value)
+void CarlaEngine::osc_send_bridge_set_custom_data(const unsigned int pluginId, const char* const type, const char* const key, const char* const value)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_custom_data(\"%s\", \"%s\", \"%s\")", type, key, value);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_custom_data(%i, \"%s\", \"%s\", \"%s\")", pluginId, type, key, value);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+24];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+24];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_custom_data");
-        lo_send(kData->oscData->target, targetPath, "sss", type, key, value);
+        lo_send(oscData->target, targetPath, "sss", type, key, value);
     }
 }
 
-void CarlaEngine::osc_send_bridge_set_chunk_data(const char* const chunkFile)
+void CarlaEngine::osc_send_bridge_set_chunk_data(const unsigned int pluginId, const char* const chunkFile)
 {
-    CARLA_ASSERT(kData->oscData != nullptr);
-    carla_debug("CarlaEngine::osc_send_bridge_set_chunk_data(\"%s\")", chunkFile);
+    CARLA_ASSERT(pluginId < kData->maxPluginNumber);
+    carla_debug("CarlaEngine::osc_send_bridge_set_chunk_data(%i, \"%s\")", pluginId, chunkFile);
 
-    if (kData->oscData != nullptr && kData->oscData->target != nullptr)
+    const CarlaOscData* const oscData(kData->plugins[pluginId].oscData);
+
+    if (oscData != nullptr && oscData->target != nullptr)
     {
-        char targetPath[std::strlen(kData->oscData->path)+23];
-        std::strcpy(targetPath, kData->oscData->path);
+        char targetPath[std::strlen(oscData->path)+23];
+        std::strcpy(targetPath, oscData->path);
         std::strcat(targetPath, "/bridge_set_chunk_data");
-        lo_send(kData->oscData->target, targetPath, "s", chunkFile);
+        lo_send(oscData->target, targetPath, "s", chunkFile);
     }
 }
 #endif
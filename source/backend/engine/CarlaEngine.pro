@@ -56,6 +56,7 @@ DEFINES   += DISTRHO_PLUGIN_TARGET_VST
 
 SOURCES  = \
     CarlaEngine.cpp \
+    CarlaEngineGraph.cpp \
     CarlaEngineOsc.cpp \
     CarlaEngineThread.cpp \
     CarlaEngineBridge.cpp \
@@ -66,6 +67,7 @@ SOURCES  = \
 
 HEADERS  = \
     CarlaEngineInternal.hpp \
+    CarlaEngineGraph.hpp \
     CarlaEngineOsc.hpp \
     CarlaEngineThread.hpp
 
@@ -84,6 +86,7 @@ HEADERS += \
     ../../utils/CarlaBackendUtils.hpp \
     ../../utils/CarlaBridgeUtils.hpp \
     ../../utils/CarlaJuceUtils.hpp \
+    ../../utils/CarlaMathUtils.hpp \
     ../../utils/CarlaOscUtils.hpp \
     ../../utils/CarlaStateUtils.hpp
 
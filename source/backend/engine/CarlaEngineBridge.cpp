@@ -48,8 +48,9 @@ public:
     {
         carla_debug("CarlaEngineBridge::CarlaEngineBridge()");
 
-        fShmAudioPool.filename  = "/carla-bridge_shm_";
-        fShmAudioPool.filename += audioBaseName;
+        // the first plugin's audio pool, the host tells about the others when adding them
+        fSlots[0].filename  = "/carla-bridge_shm_";
+        fSlots[0].filename += audioBaseName;
 
         fShmControl.filename    = "/carla-bridge_shc_";
         fShmControl.filename   += controlBaseName;
@@ -69,14 +70,7 @@ public:
 
         // SHM Audio Pool
         {
-#ifdef CARLA_OS_WIN
-            // TESTING!
-            fShmAudioPool.shm = carla_shm_attach_linux((const char*)fShmAudioPool.filename);
-#else
-            fShmAudioPool.shm = carla_shm_attach((const char*)fShmAudioPool.filename);
-#endif
-
-            if (! carla_is_shm_valid(fShmAudioPool.shm))
+            if (! attachAudioPool(fSlots[0]))
             {
                 _cleanup();
                 carla_stdout("Failed to open or create shared memory file #1");
@@ -106,19 +100,30 @@ public:
                 carla_stdout("Failed to mmap shared memory file");
                 return false;
             }
+
+            // let the host know what we speak, so it can report a mismatch
+            fShmControl.data->bridgeVersion = BRIDGE_SHM_PROTOCOL_VERSION;
+
+            if (fShmControl.data->version != BRIDGE_SHM_PROTOCOL_VERSION)
+            {
+                carla_stderr("Shared memory protocol mismatch, host uses version %i, bridge uses %i", fShmControl.data->version, BRIDGE_SHM_PROTOCOL_VERSION);
+                _cleanup();
+                return false;
+            }
         }
 
         // Read values from memory
+        BridgeRingBuffer* const ringBuffer(&fShmControl.data->plugins[0].ringBuffer);
         PluginBridgeOpcode opcode;
 
-        opcode = rdwr_readOpcode(&fShmControl.data->ringBuffer);
+        opcode = rdwr_readOpcode(ringBuffer);
         CARLA_ASSERT(opcode == kPluginBridgeOpcodeSetBufferSize);
-        fBufferSize = rdwr_readInt(&fShmControl.data->ringBuffer);
+        fBufferSize = rdwr_readInt(ringBuffer);
         carla_stderr("BufferSize: %i", fBufferSize);
 
-        opcode = rdwr_readOpcode(&fShmControl.data->ringBuffer);
+        opcode = rdwr_readOpcode(ringBuffer);
         CARLA_ASSERT(opcode == kPluginBridgeOpcodeSetSampleRate);
-        fSampleRate = rdwr_readFloat(&fShmControl.data->ringBuffer);
+        fSampleRate = rdwr_readFloat(ringBuffer);
         carla_stderr("SampleRate: %f", fSampleRate);
 
         fQuitNow = false;
@@ -157,6 +162,73 @@ public:
         return kEngineTypeBridge;
     }
 
+    // -------------------------------------
+    // Plugin management
+
+    bool attachBridgePlugin(const unsigned int slotId, const char* const audioBaseName, const unsigned int id)
+    {
+        carla_debug("CarlaEngineBridge::attachBridgePlugin(%i, \"%s\", %i)", slotId, audioBaseName, id);
+        CARLA_ASSERT(slotId < BRIDGE_SHM_PLUGIN_COUNT);
+        CARLA_ASSERT(audioBaseName != nullptr);
+
+        if (slotId >= BRIDGE_SHM_PLUGIN_COUNT || audioBaseName == nullptr)
+        {
+            setLastError("Invalid bridge slot");
+            return false;
+        }
+
+        CarlaPlugin* const plugin(getPlugin(id));
+        BridgeSlot& slot(fSlots[slotId]);
+
+        if (plugin == nullptr)
+        {
+            setLastError("Could not find plugin to attach");
+            return false;
+        }
+
+        if (slot.plugin != nullptr || slot.detached != nullptr)
+        {
+            setLastError("Bridge slot is already in use");
+            return false;
+        }
+
+        if (! carla_is_shm_valid(slot.shm))
+        {
+            slot.filename  = "/carla-bridge_shm_";
+            slot.filename += audioBaseName;
+
+            if (! attachAudioPool(slot))
+            {
+                slot.filename.clear();
+                setLastError("Failed to open the plugin's shared memory file");
+                return false;
+            }
+        }
+
+        __sync_synchronize();
+        slot.plugin = plugin;
+        return true;
+    }
+
+    CarlaPlugin* takeDetachedBridgePlugin(const unsigned int slotId)
+    {
+        CARLA_ASSERT(slotId < BRIDGE_SHM_PLUGIN_COUNT);
+
+        if (slotId >= BRIDGE_SHM_PLUGIN_COUNT)
+            return nullptr;
+
+        BridgeSlot& slot(fSlots[slotId]);
+        CarlaPlugin* const plugin(slot.detached);
+
+        if (plugin == nullptr)
+            return nullptr;
+
+        slot.detached = nullptr;
+        closeAudioPool(slot);
+
+        return plugin;
+    }
+
     // -------------------------------------
     // CarlaThread virtual calls
 
@@ -175,184 +247,269 @@ public:
                 return;
             }
 
-            while (rdwr_dataAvailable(&fShmControl.data->ringBuffer))
+            // one wake may serve several plugins, each one gets as many replies as it has requests
+            for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
             {
-                const PluginBridgeOpcode opcode(rdwr_readOpcode(&fShmControl.data->ringBuffer));
+                BridgeShmSlot& shmSlot(fShmControl.data->plugins[i]);
 
-                switch (opcode)
-                {
-                case kPluginBridgeOpcodeNull:
-                    break;
+                // anything counted here is already committed to the ring
+                const int requests(rdwr_takeRequests(&shmSlot));
 
-                case kPluginBridgeOpcodeSetAudioPool:
-                {
-                    const int poolSize(rdwr_readInt(&fShmControl.data->ringBuffer));
-                    fShmAudioPool.data = (float*)carla_shm_map(fShmAudioPool.shm, poolSize);
-                    break;
-                }
+                handleSlot(fSlots[i], shmSlot);
 
-                case kPluginBridgeOpcodeSetBufferSize:
+                for (int j=0; j < requests; ++j)
                 {
-                    const int bufferSize(rdwr_readInt(&fShmControl.data->ringBuffer));
-                    bufferSizeChanged(bufferSize);
-                    break;
+                    if (jackbridge_sem_post(&shmSlot.runClient) != 0)
+                        pass(); //carla_stderr2("Could not post to semaphore");
                 }
+            }
+        }
 
-                case kPluginBridgeOpcodeSetSampleRate:
-                {
-                    const float sampleRate(rdwr_readFloat(&fShmControl.data->ringBuffer));
-                    sampleRateChanged(sampleRate);
-                    break;
-                }
+        fIsRunning = false;
+    }
 
-                case kPluginBridgeOpcodeSetParameter:
-                {
-                    const int   index(rdwr_readInt(&fShmControl.data->ringBuffer));
-                    const float value(rdwr_readFloat(&fShmControl.data->ringBuffer));
+private:
+    struct BridgeSlot {
+        // audio pool
+        CarlaString filename;
+        float* data;
+        size_t size;
+        shm_t shm;
 
-                    CarlaPlugin* const plugin(getPluginUnchecked(0));
+        // set by the main thread once loaded, cleared by the audio thread when the host removes it
+        CarlaPlugin* volatile plugin;
 
-                    if (plugin != nullptr && plugin->enabled())
-                    {
-                        plugin->setParameterValueByRealIndex(index, value, false, false, false);
-                        plugin->postponeRtEvent(kPluginPostRtEventParameterChange, index, 0, value);
-                    }
+        // removed by the host, waiting for the main thread to delete it
+        CarlaPlugin* volatile detached;
 
-                    break;
-                }
+        BridgeSlot()
+            : data(nullptr),
+              size(0),
+              plugin(nullptr),
+              detached(nullptr)
+        {
+            carla_shm_init(shm);
+        }
+    } fSlots[BRIDGE_SHM_PLUGIN_COUNT];
 
-                case kPluginBridgeOpcodeSetProgram:
-                {
-                    const int index(rdwr_readInt(&fShmControl.data->ringBuffer));
+    struct BridgeControl {
+        CarlaString filename;
+        BridgeShmControl* data;
+        shm_t shm;
 
-                    CarlaPlugin* const plugin(getPluginUnchecked(0));
+        BridgeControl()
+            : data(nullptr)
+        {
+            carla_shm_init(shm);
+        }
 
-                    if (plugin != nullptr && plugin->enabled())
-                    {
-                        plugin->setProgram(index, false, false, false);
-                        plugin->postponeRtEvent(kPluginPostRtEventProgramChange, index, 0, 0.0f);
-                    }
+    } fShmControl;
 
-                    break;
-                }
+    bool fIsRunning;
+    bool fQuitNow;
+
+    void handleSlot(BridgeSlot& slot, BridgeShmSlot& shmSlot)
+    {
+        BridgeRingBuffer* const ringBuffer(&shmSlot.ringBuffer);
 
-                case kPluginBridgeOpcodeSetMidiProgram:
+        while (rdwr_dataAvailable(ringBuffer))
+        {
+            const PluginBridgeOpcode opcode(rdwr_readOpcode(ringBuffer));
+            CarlaPlugin* const plugin(slot.plugin);
+
+            switch (opcode)
+            {
+            case kPluginBridgeOpcodeNull:
+                break;
+
+            case kPluginBridgeOpcodeSetAudioPool:
+            {
+                const int poolSize(rdwr_readInt(ringBuffer));
+
+                if (slot.data != nullptr)
+                    carla_shm_unmap(slot.shm, slot.data, slot.size);
+
+                slot.data = (float*)carla_shm_map(slot.shm, poolSize);
+                slot.size = poolSize;
+                break;
+            }
+
+            case kPluginBridgeOpcodeSetBufferSize:
+            {
+                const int bufferSize(rdwr_readInt(ringBuffer));
+                fBufferSize = bufferSize;
+
+                // only this slot's plugin, the others get their own opcode
+                if (plugin != nullptr && plugin->enabled())
+                    plugin->bufferSizeChanged(bufferSize);
+                break;
+            }
+
+            case kPluginBridgeOpcodeSetSampleRate:
+            {
+                const float sampleRate(rdwr_readFloat(ringBuffer));
+                fSampleRate = sampleRate;
+
+                if (plugin != nullptr && plugin->enabled())
+                    plugin->sampleRateChanged(sampleRate);
+                break;
+            }
+
+            case kPluginBridgeOpcodeSetParameter:
+            {
+                const int   index(rdwr_readInt(ringBuffer));
+                const float value(rdwr_readFloat(ringBuffer));
+
+                if (plugin != nullptr && plugin->enabled())
                 {
-                    const int index(rdwr_readInt(&fShmControl.data->ringBuffer));
+                    plugin->setParameterValueByRealIndex(index, value, false, false, false);
+                    plugin->postponeRtEvent(kPluginPostRtEventParameterChange, index, 0, value);
+                }
 
-                    CarlaPlugin* const plugin(getPluginUnchecked(0));
+                break;
+            }
 
-                    if (plugin != nullptr && plugin->enabled())
-                    {
-                        plugin->setMidiProgram(index, false, false, false);
-                        plugin->postponeRtEvent(kPluginPostRtEventMidiProgramChange, index, 0, 0.0f);
-                    }
+            case kPluginBridgeOpcodeSetProgram:
+            {
+                const int index(rdwr_readInt(ringBuffer));
 
-                    break;
+                if (plugin != nullptr && plugin->enabled())
+                {
+                    plugin->setProgram(index, false, false, false);
+                    plugin->postponeRtEvent(kPluginPostRtEventProgramChange, index, 0, 0.0f);
                 }
 
-                case kPluginBridgeOpcodeMidiEvent:
+                break;
+            }
+
+            case kPluginBridgeOpcodeSetMidiProgram:
+            {
+                const int index(rdwr_readInt(ringBuffer));
+
+                if (plugin != nullptr && plugin->enabled())
                 {
-                    uint8_t data[4] = { 0 };
-                    const long time(rdwr_readLong(&fShmControl.data->ringBuffer));
-                    const int  dataSize(rdwr_readInt(&fShmControl.data->ringBuffer));
+                    plugin->setMidiProgram(index, false, false, false);
+                    plugin->postponeRtEvent(kPluginPostRtEventMidiProgramChange, index, 0, 0.0f);
+                }
 
-                    CARLA_ASSERT_INT(dataSize >= 1 && dataSize <= 4, dataSize);
+                break;
+            }
 
-                    for (int i=0; i < dataSize && i < 4; ++i)
-                        data[i] = rdwr_readChar(&fShmControl.data->ringBuffer);
+            case kPluginBridgeOpcodeProcess:
+            {
+                const int eventCount(rdwr_readInt(ringBuffer));
+                readEvents(&shmSlot.eventRing, eventCount);
+
+                CARLA_ASSERT(slot.data != nullptr);
 
-                    CARLA_ASSERT(kData->bufEvents.in != nullptr);
+                if (plugin != nullptr && plugin->enabled() && slot.data != nullptr && plugin->tryLock())
+                {
+                    const uint32_t inCount(plugin->audioInCount());
+                    const uint32_t outCount(plugin->audioOutCount());
 
-                    if (kData->bufEvents.in != nullptr)
-                    {
-                        // TODO
-                    }
+                    float* inBuffer[inCount];
+                    float* outBuffer[outCount];
 
-                    break;
+                    for (uint32_t i=0; i < inCount; ++i)
+                        inBuffer[i] = slot.data + i*fBufferSize;
+                    for (uint32_t i=0; i < outCount; ++i)
+                        outBuffer[i] = slot.data + (i+inCount)*fBufferSize;
+
+                    plugin->initBuffers();
+                    plugin->process(inBuffer, outBuffer, fBufferSize);
+                    plugin->unlock();
                 }
+                break;
+            }
 
-                case kPluginBridgeOpcodeProcess:
+            case kPluginBridgeOpcodeQuit:
+                fQuitNow = true;
+                break;
+
+            case kPluginBridgeOpcodeRemovePlugin:
+                // stop using it here, the main thread deletes it later
+                if (plugin != nullptr)
                 {
-                    CARLA_ASSERT(fShmAudioPool.data != nullptr);
-                    CarlaPlugin* const plugin(getPluginUnchecked(0));
-
-                    if (plugin != nullptr && plugin->enabled() && plugin->tryLock())
-                    {
-                        const uint32_t inCount(plugin->audioInCount());
-                        const uint32_t outCount(plugin->audioOutCount());
-
-                        float* inBuffer[inCount];
-                        float* outBuffer[outCount];
-
-                        for (uint32_t i=0; i < inCount; ++i)
-                            inBuffer[i] = fShmAudioPool.data + i*fBufferSize;
-                        for (uint32_t i=0; i < outCount; ++i)
-                            outBuffer[i] = fShmAudioPool.data + (i+inCount)*fBufferSize;
-
-                        plugin->initBuffers();
-                        plugin->process(inBuffer, outBuffer, fBufferSize);
-                        plugin->unlock();
-                    }
-                    break;
+                    slot.plugin = nullptr;
+                    __sync_synchronize();
+                    slot.detached = plugin;
                 }
+                break;
+            }
+        }
+    }
 
-                case kPluginBridgeOpcodeQuit:
-                    fQuitNow = true;
-                    break;
-                }
+    // move this cycle's events from the shared ring into the engine buffer
+    void readEvents(BridgeEventRing* const eventRing, const int count)
+    {
+        CARLA_ASSERT(kData->bufEvents.in != nullptr);
+
+        if (kData->bufEvents.in == nullptr)
+            return;
+
+        uint32_t i = 0, dropped = 0;
+
+        for (int j=0; j < count; ++j)
+        {
+            if (i < INTERNAL_EVENT_COUNT)
+            {
+                if (rdwr_readEvent(eventRing, kData->bufEvents.in[i]))
+                    ++i;
             }
+            else
+            {
+                EngineEvent event;
 
-            if (jackbridge_sem_post(&fShmControl.data->runClient) != 0)
-                pass(); //carla_stderr2("Could not post to semaphore");
+                if (rdwr_readEvent(eventRing, event))
+                    ++dropped;
+            }
         }
 
-        fIsRunning = false;
+        kData->bufEvents.setInCount(i);
+
+        if (dropped > 0)
+            rdwr_addOverflows(eventRing, dropped);
     }
 
-private:
-    struct BridgeAudioPool {
-        CarlaString filename;
-        float* data;
-        shm_t shm;
+    static bool attachAudioPool(BridgeSlot& slot)
+    {
+#ifdef CARLA_OS_WIN
+        // TESTING!
+        slot.shm = carla_shm_attach_linux((const char*)slot.filename);
+#else
+        slot.shm = carla_shm_attach((const char*)slot.filename);
+#endif
 
-        BridgeAudioPool()
-            : data(nullptr)
-        {
-            carla_shm_init(shm);
-        }
-    } fShmAudioPool;
+        return carla_is_shm_valid(slot.shm);
+    }
 
-    struct BridgeControl {
-        CarlaString filename;
-        BridgeShmControl* data;
-        shm_t shm;
+    static void closeAudioPool(BridgeSlot& slot)
+    {
+        if (slot.filename.isNotEmpty())
+            slot.filename.clear();
 
-        BridgeControl()
-            : data(nullptr)
+        if (slot.data != nullptr)
         {
-            carla_shm_init(shm);
+            carla_shm_unmap(slot.shm, slot.data, slot.size);
+            slot.data = nullptr;
         }
 
-    } fShmControl;
+        slot.size = 0;
 
-    bool fIsRunning;
-    bool fQuitNow;
+        if (carla_is_shm_valid(slot.shm))
+            carla_shm_close(slot.shm);
+    }
 
     void _cleanup()
     {
-        if (fShmAudioPool.filename.isNotEmpty())
-            fShmAudioPool.filename.clear();
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+            closeAudioPool(fSlots[i]);
 
         if (fShmControl.filename.isNotEmpty())
             fShmControl.filename.clear();
 
-        fShmAudioPool.data = nullptr;
         fShmControl.data = nullptr;
 
-        if (carla_is_shm_valid(fShmAudioPool.shm))
-            carla_shm_close(fShmAudioPool.shm);
-
         if (carla_is_shm_valid(fShmControl.shm))
             carla_shm_close(fShmControl.shm);
     }
@@ -0,0 +1,1261 @@
+/*
+ * Carla Engine Graph
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#include "CarlaEngineGraph.hpp"
+#include "CarlaEngineInternal.hpp"
+
+#include <cerrno>
+
+#ifndef CARLA_OS_WIN
+# include <sched.h>
+# include <unistd.h>
+#endif
+
+CARLA_BACKEND_START_NAMESPACE
+
+#if 0
+} // Fix editor indentation
+#endif
+
+// -----------------------------------------------------------------------
+// Plugin Helpers, defined in CarlaPlugin.cpp
+
+extern CarlaEngineEventPort* CarlaPluginGetEventInPort(CarlaPlugin* const plugin);
+extern CarlaEngineEventPort* CarlaPluginGetEventOutPort(CarlaPlugin* const plugin);
+
+// -----------------------------------------------------------------------
+// Spin-wait helper, tells the cpu we're busy-waiting and eventually gives up our time slice
+
+static inline
+void spinWait(const unsigned int spins)
+{
+    if (spins < 1000)
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        __asm__ __volatile__("pause");
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH_7A__))
+        __asm__ __volatile__("yield");
+#endif
+    }
+    else
+    {
+#ifndef CARLA_OS_WIN
+        sched_yield();
+#endif
+    }
+}
+
+// -----------------------------------------------------------------------
+// Port id helpers
+
+static inline
+bool isPluginPort(const int port)
+{
+    return (port >= PATCHBAY_GRAPH_PLUGIN_PORT);
+}
+
+static inline
+int getPluginIdFromPort(const int port)
+{
+    return (port - PATCHBAY_GRAPH_PLUGIN_PORT) / 1000;
+}
+
+static inline
+int getPluginPortIndex(const int port)
+{
+    return (port - PATCHBAY_GRAPH_PLUGIN_PORT) % 1000;
+}
+
+static inline
+int getPluginPort(const int pluginId, const int index)
+{
+    return PATCHBAY_GRAPH_PLUGIN_PORT + pluginId*1000 + index;
+}
+
+static inline
+bool isEventPort(const int port)
+{
+    if (isPluginPort(port))
+    {
+        const int index(getPluginPortIndex(port));
+        return (index == PATCHBAY_GRAPH_PLUGIN_EVENTS_IN || index == PATCHBAY_GRAPH_PLUGIN_EVENTS_OUT);
+    }
+
+    return (port == PATCHBAY_GRAPH_ENGINE_EVENTS_IN || port == PATCHBAY_GRAPH_ENGINE_EVENTS_OUT);
+}
+
+// -----------------------------------------------------------------------
+// Schedule
+
+CarlaEngineGraph::Schedule::Schedule()
+    : bufferSize(0),
+      nodeCount(0),
+      nodes(nullptr),
+      order(nullptr),
+      levelCount(0),
+      levelOffset(nullptr),
+      maxLevelWidth(0),
+      sources(nullptr),
+      merges(nullptr),
+      sinkCount(0),
+      sinkOffset(nullptr),
+      eventSinkOffset(0),
+      eventSinkCount(0) {}
+
+CarlaEngineGraph::Schedule::~Schedule()
+{
+    clear();
+}
+
+void CarlaEngineGraph::Schedule::clear()
+{
+    if (nodes != nullptr)
+    {
+        for (uint32_t i=0; i < nodeCount; ++i)
+        {
+            Node& node(nodes[i]);
+
+            for (uint32_t j=0; j < node.audioInCount; ++j)
+                delete[] node.audioIn[j];
+
+            for (uint32_t j=0; j < node.audioOutCount; ++j)
+                delete[] node.audioOut[j];
+
+            delete[] node.audioIn;
+            delete[] node.audioOut;
+            delete[] node.audioSrcOffset;
+        }
+
+        delete[] nodes;
+        nodes = nullptr;
+    }
+
+    if (order != nullptr)
+    {
+        delete[] order;
+        order = nullptr;
+    }
+
+    if (levelOffset != nullptr)
+    {
+        delete[] levelOffset;
+        levelOffset = nullptr;
+    }
+
+    if (sources != nullptr)
+    {
+        delete[] sources;
+        sources = nullptr;
+    }
+
+    if (merges != nullptr)
+    {
+        delete[] merges;
+        merges = nullptr;
+    }
+
+    if (sinkOffset != nullptr)
+    {
+        delete[] sinkOffset;
+        sinkOffset = nullptr;
+    }
+
+    bufferSize      = 0;
+    nodeCount       = 0;
+    levelCount      = 0;
+    maxLevelWidth   = 0;
+    sinkCount       = 0;
+    eventSinkOffset = 0;
+    eventSinkCount  = 0;
+}
+
+// -----------------------------------------------------------------------
+// Engine Graph
+
+CarlaEngineGraph::CarlaEngineGraph(CarlaEngine* const engine)
+    : kEngine(engine),
+      fLastConnectionId(0),
+      fCurrent(nullptr),
+      fActive(0),
+      fPending(false),
+      fCycle(0),
+      fProcInBuf(nullptr),
+      fProcInCount(0),
+      fProcFrames(0),
+      fWorkerCount(0),
+      fWorkersPromoted(false),
+      fWorkersQuit(false),
+      fJobState(0),
+      fJobPending(0)
+{
+    carla_debug("CarlaEngineGraph::CarlaEngineGraph(%p)", engine);
+    CARLA_ASSERT(engine != nullptr);
+}
+
+CarlaEngineGraph::~CarlaEngineGraph()
+{
+    carla_debug("CarlaEngineGraph::~CarlaEngineGraph()");
+    CARLA_ASSERT(fWorkerCount == 0);
+
+    fConnections.clear();
+}
+
+void CarlaEngineGraph::init()
+{
+    carla_debug("CarlaEngineGraph::init()");
+
+    fLastConnectionId = 0;
+    fConnections.clear();
+
+    startWorkers();
+    rebuild();
+}
+
+void CarlaEngineGraph::close()
+{
+    carla_debug("CarlaEngineGraph::close()");
+
+    stopWorkers();
+
+    const CarlaMutex::ScopedLocker sl(fMutex);
+
+    fConnections.clear();
+    fSchedules[0].clear();
+    fSchedules[1].clear();
+
+    fActive  = 0;
+    fPending = false;
+}
+
+// -----------------------------------------------------------------------
+// non-realtime calls
+
+bool CarlaEngineGraph::connect(const int portA, const int portB)
+{
+    carla_debug("CarlaEngineGraph::connect(%i, %i)", portA, portB);
+
+    if (! isPortValid(portA, true))
+    {
+        kEngine->setLastError("Invalid output port");
+        return false;
+    }
+    if (! isPortValid(portB, false))
+    {
+        kEngine->setLastError("Invalid input port");
+        return false;
+    }
+    if (isEventPort(portA) != isEventPort(portB))
+    {
+        kEngine->setLastError("Cannot connect audio and event ports");
+        return false;
+    }
+    if (! (isPluginPort(portA) || isPluginPort(portB)))
+    {
+        kEngine->setLastError("Invalid connection (engine to engine)");
+        return false;
+    }
+
+    if (isPluginPort(portA) && isPluginPort(portB))
+    {
+        const int pluginA(getPluginIdFromPort(portA));
+        const int pluginB(getPluginIdFromPort(portB));
+
+        if (pluginA == pluginB || hasPath(pluginB, pluginA))
+        {
+            kEngine->setLastError("Invalid connection (feedback loop)");
+            return false;
+        }
+    }
+
+    Connection connection;
+    connection.id      = PATCHBAY_GRAPH_CONNECTION_OFFSET + fLastConnectionId;
+    connection.portOut = portA;
+    connection.portIn  = portB;
+
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+        {
+            const Connection& other(*it);
+
+            if (other.portOut == portA && other.portIn == portB)
+            {
+                kEngine->setLastError("Ports are already connected");
+                return false;
+            }
+        }
+
+        fConnections.append(connection);
+    }
+
+    fLastConnectionId++;
+    rebuild();
+
+    kEngine->callback(CALLBACK_PATCHBAY_CONNECTION_ADDED, 0, connection.id, portA, portB, nullptr);
+    return true;
+}
+
+bool CarlaEngineGraph::disconnect(const int connectionId)
+{
+    carla_debug("CarlaEngineGraph::disconnect(%i)", connectionId);
+
+    bool found = false;
+
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+        {
+            const Connection& connection(*it);
+
+            if (connection.id == connectionId)
+            {
+                fConnections.remove(it);
+                found = true;
+                break;
+            }
+        }
+    }
+
+    if (! found)
+    {
+        kEngine->setLastError("Failed to find the requested connection");
+        return false;
+    }
+
+    rebuild();
+
+    kEngine->callback(CALLBACK_PATCHBAY_CONNECTION_REMOVED, 0, connectionId, 0, 0.0f, nullptr);
+    return true;
+}
+
+void CarlaEngineGraph::refresh()
+{
+    carla_debug("CarlaEngineGraph::refresh()");
+
+    kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GRAPH_ENGINE_GROUP, PATCHBAY_GRAPH_ENGINE_EVENTS_IN,  PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_OUTPUT, "events-in");
+    kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GRAPH_ENGINE_GROUP, PATCHBAY_GRAPH_ENGINE_EVENTS_OUT, PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_INPUT,  "events-out");
+
+    for (unsigned int i=0; i < kEngine->currentPluginCount(); ++i)
+        announcePlugin(i, true);
+
+    announceConnections(true, 0, kEngine->maxPluginNumber());
+
+    // plugins might have changed their ports
+    rebuild();
+}
+
+void CarlaEngineGraph::pluginAdded(const unsigned int id)
+{
+    carla_debug("CarlaEngineGraph::pluginAdded(%i)", id);
+
+    announcePlugin(id, true);
+    rebuild();
+}
+
+void CarlaEngineGraph::pluginRemoved(const unsigned int id)
+{
+    carla_debug("CarlaEngineGraph::pluginRemoved(%i)", id);
+
+    const unsigned int newCount(kEngine->currentPluginCount());
+
+    // all plugins after the removed one change id, announce them again
+    announceConnections(false, id, newCount);
+
+    for (unsigned int i=id; i <= newCount; ++i)
+        announcePlugin(i, false);
+
+    removeConnections(static_cast<int>(id));
+
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+        {
+            Connection& connection(*it);
+
+            if (isPluginPort(connection.portOut) && getPluginIdFromPort(connection.portOut) > static_cast<int>(id))
+                connection.portOut -= 1000;
+
+            if (isPluginPort(connection.portIn) && getPluginIdFromPort(connection.portIn) > static_cast<int>(id))
+                connection.portIn -= 1000;
+        }
+    }
+
+    for (unsigned int i=id; i < newCount; ++i)
+        announcePlugin(i, true);
+
+    if (id < newCount)
+        announceConnections(true, id, newCount-1);
+
+    rebuild();
+}
+
+void CarlaEngineGraph::pluginsSwitched(const unsigned int idA, const unsigned int idB)
+{
+    carla_debug("CarlaEngineGraph::pluginsSwitched(%i, %i)", idA, idB);
+
+    const unsigned int first((idA < idB) ? idA : idB);
+    const unsigned int last((idA < idB) ? idB : idA);
+
+    announceConnections(false, first, last);
+    announcePlugin(idA, false);
+    announcePlugin(idB, false);
+
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        const int diff((static_cast<int>(idB) - static_cast<int>(idA)) * 1000);
+
+        for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+        {
+            Connection& connection(*it);
+
+            if (isPluginPort(connection.portOut))
+            {
+                const int pluginId(getPluginIdFromPort(connection.portOut));
+
+                if (pluginId == static_cast<int>(idA))
+                    connection.portOut += diff;
+                else if (pluginId == static_cast<int>(idB))
+                    connection.portOut -= diff;
+            }
+
+            if (isPluginPort(connection.portIn))
+            {
+                const int pluginId(getPluginIdFromPort(connection.portIn));
+
+                if (pluginId == static_cast<int>(idA))
+                    connection.portIn += diff;
+                else if (pluginId == static_cast<int>(idB))
+                    connection.portIn -= diff;
+            }
+        }
+    }
+
+    announcePlugin(idA, true);
+    announcePlugin(idB, true);
+    announceConnections(true, first, last);
+
+    rebuild();
+}
+
+void CarlaEngineGraph::pluginsCleared(const unsigned int oldCount)
+{
+    carla_debug("CarlaEngineGraph::pluginsCleared(%i)", oldCount);
+
+    announceConnections(false, 0, oldCount);
+
+    for (unsigned int i=0; i < oldCount; ++i)
+        announcePlugin(i, false);
+
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+        fConnections.clear();
+    }
+
+    rebuild();
+}
+
+void CarlaEngineGraph::bufferSizeChanged()
+{
+    carla_debug("CarlaEngineGraph::bufferSizeChanged()");
+
+    rebuild();
+}
+
+// -----------------------------------------------------------------------
+// non-realtime helpers
+
+void CarlaEngineGraph::rebuild()
+{
+    CarlaEngineProtectedData* const data(kEngine->kData);
+
+    const CarlaMutex::ScopedLocker sl(fMutex);
+
+    // the realtime thread only uses the active schedule, and swaps under this same lock
+    Schedule& s(fSchedules[fActive == 0 ? 1 : 0]);
+    s.clear();
+
+    const uint32_t nodeCount((data->plugins != nullptr) ? data->curPluginCount : 0);
+
+    s.bufferSize = kEngine->getBufferSize();
+
+    if (nodeCount == 0 || s.bufferSize == 0)
+    {
+        fPending = true;
+        return;
+    }
+
+    // nodes and their buffers
+    s.nodeCount = nodeCount;
+    s.nodes     = new Node[nodeCount];
+
+    for (uint32_t i=0; i < nodeCount; ++i)
+    {
+        Node& node(s.nodes[i]);
+        CarlaPlugin* const plugin(data->plugins[i].plugin);
+
+        node.pluginId       = i;
+        node.generation     = data->plugins[i].generation;
+        node.audioInCount   = (plugin != nullptr) ? plugin->audioInCount()  : 0;
+        node.audioOutCount  = (plugin != nullptr) ? plugin->audioOutCount() : 0;
+        node.audioIn        = new float*[node.audioInCount > 0 ? node.audioInCount : 1];
+        node.audioOut       = new float*[node.audioOutCount > 0 ? node.audioOutCount : 1];
+        node.audioSrcOffset = new uint32_t[node.audioInCount+1];
+        node.eventSrcOffset = 0;
+        node.eventSrcCount  = 0;
+        node.cycle          = 0;
+
+        node.audioIn[0] = node.audioOut[0] = nullptr;
+
+        for (uint32_t j=0; j < node.audioInCount; ++j)
+            node.audioIn[j] = new float[s.bufferSize];
+
+        for (uint32_t j=0; j < node.audioOutCount; ++j)
+            node.audioOut[j] = new float[s.bufferSize];
+    }
+
+    // sources, flattened per node input and engine output
+    s.sources = new Source[fConnections.count() > 0 ? fConnections.count() : 1];
+    s.merges  = new MergeSource[fConnections.count() > 0 ? fConnections.count() : 1];
+
+    uint32_t srcCount = 0;
+
+    for (uint32_t i=0; i < nodeCount; ++i)
+    {
+        Node& node(s.nodes[i]);
+
+        for (uint32_t j=0; j < node.audioInCount; ++j)
+        {
+            node.audioSrcOffset[j] = srcCount;
+            srcCount = appendSources(s, srcCount, getPluginPort(i, PATCHBAY_GRAPH_PLUGIN_AUDIO_IN+j));
+        }
+        node.audioSrcOffset[node.audioInCount] = srcCount;
+
+        node.eventSrcOffset = srcCount;
+        srcCount = appendSources(s, srcCount, getPluginPort(i, PATCHBAY_GRAPH_PLUGIN_EVENTS_IN));
+        node.eventSrcCount = srcCount - node.eventSrcOffset;
+    }
+
+    // engine outputs
+    for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+    {
+        const Connection& connection(*it);
+
+        if (connection.portIn >= PATCHBAY_GRAPH_ENGINE_AUDIO_OUT && connection.portIn < PATCHBAY_GRAPH_ENGINE_AUDIO_OUT+1000)
+        {
+            const uint32_t channel(connection.portIn - PATCHBAY_GRAPH_ENGINE_AUDIO_OUT);
+
+            if (channel >= s.sinkCount)
+                s.sinkCount = channel+1;
+        }
+    }
+
+    s.sinkOffset = new uint32_t[s.sinkCount+1];
+
+    for (uint32_t i=0; i < s.sinkCount; ++i)
+    {
+        s.sinkOffset[i] = srcCount;
+        srcCount = appendSources(s, srcCount, PATCHBAY_GRAPH_ENGINE_AUDIO_OUT+i);
+    }
+    s.sinkOffset[s.sinkCount] = srcCount;
+
+    s.eventSinkOffset = srcCount;
+    srcCount = appendSources(s, srcCount, PATCHBAY_GRAPH_ENGINE_EVENTS_OUT);
+    s.eventSinkCount = srcCount - s.eventSinkOffset;
+
+    // dependency levels, longest path from a node without plugin inputs
+    uint32_t level[nodeCount];
+    carla_fill<uint32_t>(level, nodeCount, 0);
+
+    for (uint32_t pass=0; pass < nodeCount; ++pass)
+    {
+        bool changed = false;
+
+        for (uint32_t i=0; i < nodeCount; ++i)
+        {
+            const Node& node(s.nodes[i]);
+
+            for (uint32_t j=node.audioSrcOffset[0]; j < node.eventSrcOffset+node.eventSrcCount; ++j)
+            {
+                const Source& source(s.sources[j]);
+
+                if (source.node >= 0 && level[i] < level[source.node]+1)
+                {
+                    level[i] = level[source.node]+1;
+                    changed  = true;
+                }
+            }
+        }
+
+        if (! changed)
+            break;
+    }
+
+    for (uint32_t i=0; i < nodeCount; ++i)
+    {
+        if (level[i]+1 > s.levelCount)
+            s.levelCount = level[i]+1;
+    }
+
+    // sort nodes by level
+    s.order       = new uint32_t[nodeCount];
+    s.levelOffset = new uint32_t[s.levelCount+1];
+
+    for (uint32_t l=0, k=0; l < s.levelCount; ++l)
+    {
+        s.levelOffset[l] = k;
+
+        for (uint32_t i=0; i < nodeCount; ++i)
+        {
+            if (level[i] == l)
+                s.order[k++] = i;
+        }
+
+        if (k - s.levelOffset[l] > s.maxLevelWidth)
+            s.maxLevelWidth = k - s.levelOffset[l];
+    }
+    s.levelOffset[s.levelCount] = nodeCount;
+
+    fPending = true;
+
+    carla_debug("CarlaEngineGraph::rebuild() - %i nodes, %i levels, max width %i", nodeCount, s.levelCount, s.maxLevelWidth);
+}
+
+uint32_t CarlaEngineGraph::appendSources(Schedule& s, uint32_t srcCount, const int portIn)
+{
+    for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+    {
+        const Connection& connection(*it);
+
+        if (connection.portIn != portIn)
+            continue;
+
+        Source& source(s.sources[srcCount]);
+
+        if (isPluginPort(connection.portOut))
+        {
+            const int pluginId(getPluginIdFromPort(connection.portOut));
+
+            if (pluginId >= static_cast<int>(s.nodeCount))
+                continue;
+
+            source.node  = pluginId;
+            source.index = isEventPort(connection.portOut) ? 0 : getPluginPortIndex(connection.portOut) - PATCHBAY_GRAPH_PLUGIN_AUDIO_OUT;
+        }
+        else
+        {
+            source.node  = -1;
+            source.index = isEventPort(connection.portOut) ? 0 : connection.portOut - PATCHBAY_GRAPH_ENGINE_AUDIO_IN;
+        }
+
+        ++srcCount;
+    }
+
+    return srcCount;
+}
+
+void CarlaEngineGraph::announcePlugin(const unsigned int id, const bool added)
+{
+    const int groupId(PATCHBAY_GRAPH_PLUGIN_GROUP + static_cast<int>(id));
+
+    if (! added)
+    {
+        kEngine->callback(CALLBACK_PATCHBAY_CLIENT_REMOVED, 0, groupId, 0, 0.0f, nullptr);
+        return;
+    }
+
+    CarlaPlugin* const plugin(kEngine->getPlugin(id));
+
+    if (plugin == nullptr)
+        return;
+
+    char strBuf[STR_MAX+1];
+
+    kEngine->callback(CALLBACK_PATCHBAY_CLIENT_ADDED, 0, groupId, 0, 0.0f, plugin->name());
+
+    for (uint32_t i=0; i < plugin->audioInCount(); ++i)
+    {
+        std::snprintf(strBuf, STR_MAX, "audio-in%i", i+1);
+        kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, groupId, getPluginPort(id, PATCHBAY_GRAPH_PLUGIN_AUDIO_IN+i), PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_INPUT, strBuf);
+    }
+
+    for (uint32_t i=0; i < plugin->audioOutCount(); ++i)
+    {
+        std::snprintf(strBuf, STR_MAX, "audio-out%i", i+1);
+        kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, groupId, getPluginPort(id, PATCHBAY_GRAPH_PLUGIN_AUDIO_OUT+i), PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_OUTPUT, strBuf);
+    }
+
+    if (CarlaPluginGetEventInPort(plugin) != nullptr)
+        kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, groupId, getPluginPort(id, PATCHBAY_GRAPH_PLUGIN_EVENTS_IN), PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_INPUT, "events-in");
+
+    if (CarlaPluginGetEventOutPort(plugin) != nullptr)
+        kEngine->callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, groupId, getPluginPort(id, PATCHBAY_GRAPH_PLUGIN_EVENTS_OUT), PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_OUTPUT, "events-out");
+}
+
+void CarlaEngineGraph::announceConnections(const bool added, const unsigned int firstPluginId, const unsigned int lastPluginId)
+{
+    const CarlaMutex::ScopedLocker sl(fMutex);
+
+    for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+    {
+        const Connection& connection(*it);
+
+        const int idOut(isPluginPort(connection.portOut) ? getPluginIdFromPort(connection.portOut) : -1);
+        const int idIn(isPluginPort(connection.portIn) ? getPluginIdFromPort(connection.portIn) : -1);
+
+        const bool outMatches(idOut >= static_cast<int>(firstPluginId) && idOut <= static_cast<int>(lastPluginId));
+        const bool inMatches(idIn >= static_cast<int>(firstPluginId) && idIn <= static_cast<int>(lastPluginId));
+
+        if (! (outMatches || inMatches))
+            continue;
+
+        if (added)
+            kEngine->callback(CALLBACK_PATCHBAY_CONNECTION_ADDED, 0, connection.id, connection.portOut, connection.portIn, nullptr);
+        else
+            kEngine->callback(CALLBACK_PATCHBAY_CONNECTION_REMOVED, 0, connection.id, 0, 0.0f, nullptr);
+    }
+}
+
+void CarlaEngineGraph::removeConnections(const int pluginId)
+{
+    const CarlaMutex::ScopedLocker sl(fMutex);
+
+    for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+    {
+        const Connection& connection(*it);
+
+        if ((isPluginPort(connection.portOut) && getPluginIdFromPort(connection.portOut) == pluginId) ||
+            (isPluginPort(connection.portIn)  && getPluginIdFromPort(connection.portIn)  == pluginId))
+        {
+            fConnections.remove(it);
+        }
+    }
+}
+
+bool CarlaEngineGraph::isPortValid(const int port, const bool isOutput) const
+{
+    if (! isPluginPort(port))
+    {
+        if (isOutput)
+            return (port == PATCHBAY_GRAPH_ENGINE_EVENTS_IN || (port >= PATCHBAY_GRAPH_ENGINE_AUDIO_IN && port < PATCHBAY_GRAPH_ENGINE_AUDIO_IN+1000));
+        else
+            return (port == PATCHBAY_GRAPH_ENGINE_EVENTS_OUT || (port >= PATCHBAY_GRAPH_ENGINE_AUDIO_OUT && port < PATCHBAY_GRAPH_ENGINE_AUDIO_OUT+1000));
+    }
+
+    const int pluginId(getPluginIdFromPort(port));
+    const int index(getPluginPortIndex(port));
+
+    if (pluginId >= static_cast<int>(kEngine->currentPluginCount()))
+        return false;
+
+    CarlaPlugin* const plugin(kEngine->getPlugin(pluginId));
+
+    if (plugin == nullptr)
+        return false;
+
+    if (isOutput)
+    {
+        if (index == PATCHBAY_GRAPH_PLUGIN_EVENTS_OUT)
+            return (CarlaPluginGetEventOutPort(plugin) != nullptr);
+
+        return (index >= PATCHBAY_GRAPH_PLUGIN_AUDIO_OUT && index < PATCHBAY_GRAPH_PLUGIN_AUDIO_OUT + static_cast<int>(plugin->audioOutCount()));
+    }
+    else
+    {
+        if (index == PATCHBAY_GRAPH_PLUGIN_EVENTS_IN)
+            return (CarlaPluginGetEventInPort(plugin) != nullptr);
+
+        return (index >= PATCHBAY_GRAPH_PLUGIN_AUDIO_IN && index < PATCHBAY_GRAPH_PLUGIN_AUDIO_IN + static_cast<int>(plugin->audioInCount()));
+    }
+}
+
+bool CarlaEngineGraph::hasPath(const int fromPlugin, const int toPlugin) const
+{
+    const unsigned int count(kEngine->currentPluginCount());
+
+    if (count == 0)
+        return false;
+
+    bool visited[count];
+    int  stack[count];
+    int  stackSize = 0;
+
+    carla_fill<bool>(visited, count, false);
+
+    stack[stackSize++] = fromPlugin;
+    visited[fromPlugin] = true;
+
+    while (stackSize > 0)
+    {
+        const int pluginId(stack[--stackSize]);
+
+        if (pluginId == toPlugin)
+            return true;
+
+        for (NonRtList<Connection>::Itenerator it = fConnections.begin(); it.valid(); it.next())
+        {
+            const Connection& connection(*it);
+
+            if (! (isPluginPort(connection.portOut) && isPluginPort(connection.portIn)))
+                continue;
+            if (getPluginIdFromPort(connection.portOut) != pluginId)
+                continue;
+
+            const int next(getPluginIdFromPort(connection.portIn));
+
+            if (next < static_cast<int>(count) && ! visited[next])
+            {
+                visited[next] = true;
+                stack[stackSize++] = next;
+            }
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------
+// realtime calls
+
+void CarlaEngineGraph::process(float** inBuf, float** outBuf, const uint32_t bufCount[2], const uint32_t frames)
+{
+    CarlaEngineProtectedData* const data(kEngine->kData);
+
+    // pick up a new schedule if there's one, never block here
+    if (fPending && fMutex.tryLock())
+    {
+        fActive  = (fActive == 0) ? 1 : 0;
+        fPending = false;
+        fMutex.unlock();
+    }
+
+    Schedule& s(fSchedules[fActive]);
+
+    // initialize outputs (zero)
+    for (uint32_t i=0; i < bufCount[1]; ++i)
+        carla_zeroFloat(outBuf[i], frames);
+
+    if (data->bufEvents.out != nullptr)
+        data->bufEvents.clearOut();
+
+    if (s.nodeCount == 0 || frames > s.bufferSize)
+        return;
+
+    if (! fWorkersPromoted)
+        promoteWorkers();
+
+    fCurrent      = &s;
+    fProcInBuf    = inBuf;
+    fProcInCount  = bufCount[0];
+    fProcFrames   = frames;
+    ++fCycle;
+
+    // process plugins
+    if (fWorkerCount == 0 || s.maxLevelWidth <= 1)
+    {
+        for (uint32_t i=0; i < s.nodeCount; ++i)
+            processNode(s.order[i]);
+    }
+    else
+    {
+        for (uint32_t l=0; l < s.levelCount; ++l)
+        {
+            const uint32_t begin(s.levelOffset[l]);
+            const uint32_t end(s.levelOffset[l+1]);
+
+            if (end - begin == 1)
+                processNode(s.order[begin]);
+            else
+                runLevel(begin, end);
+        }
+    }
+
+    // mix engine outputs
+    for (uint32_t i=0; i < s.sinkCount && i < bufCount[1]; ++i)
+    {
+        for (uint32_t j=s.sinkOffset[i]; j < s.sinkOffset[i+1]; ++j)
+        {
+            const Source& source(s.sources[j]);
+
+            if (source.node < 0)
+                continue;
+
+            const Node& node(s.nodes[source.node]);
+
+            if (node.cycle == fCycle && source.index < node.audioOutCount)
+                carla_addFloat(outBuf[i], node.audioOut[source.index], frames);
+        }
+    }
+
+    if (data->bufEvents.out != nullptr && s.eventSinkCount > 0)
+        data->bufEvents.outCount = mergeEvents(data->bufEvents.out, s.eventSinkOffset, s.eventSinkCount);
+
+    fCurrent = nullptr;
+}
+
+void CarlaEngineGraph::processNode(const uint32_t index)
+{
+    CarlaEngineProtectedData* const data(kEngine->kData);
+
+    const Schedule& s(*fCurrent);
+    Node& node(s.nodes[index]);
+
+    // plugin might have been removed or moved since the schedule was built
+    if (node.pluginId >= data->curPluginCount || data->plugins[node.pluginId].generation != node.generation)
+        return;
+
+    CarlaPlugin* const plugin(data->plugins[node.pluginId].plugin);
+
+    if (plugin == nullptr)
+        return;
+    if (! plugin->enabled())
+        return;
+    if (plugin->audioInCount() != node.audioInCount || plugin->audioOutCount() != node.audioOutCount)
+        return;
+    if (! plugin->tryLock())
+        return;
+
+    const uint32_t frames(fProcFrames);
+
+    // initialize inputs
+    for (uint32_t i=0; i < node.audioInCount; ++i)
+    {
+        float* const buffer(node.audioIn[i]);
+        bool first = true;
+
+        for (uint32_t j=node.audioSrcOffset[i]; j < node.audioSrcOffset[i+1]; ++j)
+        {
+            const Source& source(s.sources[j]);
+            float* srcBuffer = nullptr;
+
+            if (source.node < 0)
+            {
+                if (source.index < fProcInCount)
+                    srcBuffer = fProcInBuf[source.index];
+            }
+            else
+            {
+                const Node& srcNode(s.nodes[source.node]);
+
+                if (srcNode.cycle == fCycle && source.index < srcNode.audioOutCount)
+                    srcBuffer = srcNode.audioOut[source.index];
+            }
+
+            if (srcBuffer == nullptr)
+                continue;
+
+            if (first)
+            {
+                carla_copyFloat(buffer, srcBuffer, frames);
+                first = false;
+            }
+            else
+                carla_addFloat(buffer, srcBuffer, frames);
+        }
+
+        if (first)
+            carla_zeroFloat(buffer, frames);
+    }
+
+    // initialize outputs (zero)
+    for (uint32_t i=0; i < node.audioOutCount; ++i)
+        carla_zeroFloat(node.audioOut[i], frames);
+
+    plugin->initBuffers();
+
+    if (CarlaEngineEventPort* const port = CarlaPluginGetEventInPort(plugin))
+    {
+        if (port->pBuffer != nullptr && port->pCount != nullptr)
+            *port->pCount = mergeEvents(port->pBuffer, node.eventSrcOffset, node.eventSrcCount);
+    }
+
+    // process
+    plugin->process(node.audioIn, node.audioOut, frames);
+    plugin->unlock();
+
+    // set peaks
+    {
+        float inPeak[2]  = { 0.0f, 0.0f };
+        float outPeak[2] = { 0.0f, 0.0f };
+
+        for (uint32_t i=0; i < node.audioInCount && i < 2; ++i)
+            inPeak[i] = carla_findAbsMaxFloat(node.audioIn[i], frames);
+
+        for (uint32_t i=0; i < node.audioOutCount && i < 2; ++i)
+            outPeak[i] = carla_findAbsMaxFloat(node.audioOut[i], frames);
+
+        data->plugins[node.pluginId].insPeak[0]  = inPeak[0];
+        data->plugins[node.pluginId].insPeak[1]  = inPeak[1];
+        data->plugins[node.pluginId].outsPeak[0] = outPeak[0];
+        data->plugins[node.pluginId].outsPeak[1] = outPeak[1];
+    }
+
+    node.cycle = fCycle;
+}
+
+void CarlaEngineGraph::runLevel(const uint32_t begin, const uint32_t end)
+{
+    fJobPending = static_cast<int>(end - begin);
+    __sync_synchronize();
+    __sync_lock_test_and_set(&fJobState, (static_cast<uint64_t>(end) << 32) | begin);
+
+    // this thread takes jobs too
+    const uint32_t wakeCount(end - begin - 1 < fWorkerCount ? end - begin - 1 : fWorkerCount);
+
+    for (uint32_t i=0; i < wakeCount; ++i)
+        sem_post(&fWorkerSem);
+
+    runJobs();
+
+    // wait for the level to finish, the last jobs are usually about done by now
+    for (unsigned int spins=0; fJobPending != 0; ++spins)
+        spinWait(spins);
+
+    __sync_synchronize();
+}
+
+void CarlaEngineGraph::runJobs()
+{
+    for (;;)
+    {
+        const uint64_t state(fJobState);
+        const uint32_t next(static_cast<uint32_t>(state & 0xffffffff));
+        const uint32_t end(static_cast<uint32_t>(state >> 32));
+
+        if (next >= end)
+            return;
+
+        if (! __sync_bool_compare_and_swap(&fJobState, state, state+1))
+            continue;
+
+        processNode(fCurrent->order[next]);
+
+        __sync_sub_and_fetch(&fJobPending, 1);
+    }
+}
+
+uint32_t CarlaEngineGraph::mergeEvents(EngineEvent* const dst, const uint32_t srcOffset, const uint32_t count)
+{
+    CarlaEngineProtectedData* const data(kEngine->kData);
+
+    if (count == 0)
+    {
+        dst[0].clear();
+        return 0;
+    }
+
+    const Source* const sources(&fCurrent->sources[srcOffset]);
+    MergeSource*  const merges(&fCurrent->merges[srcOffset]);
+    uint32_t srcCount = 0;
+
+    for (uint32_t i=0; i < count; ++i)
+    {
+        const Source& source(sources[i]);
+        const EngineEvent* srcBuffer = nullptr;
+        uint32_t srcEvents = 0;
+
+        if (source.node < 0)
+        {
+            srcBuffer = data->bufEvents.in;
+            srcEvents = data->bufEvents.inCount;
+        }
+        else
+        {
+            const Node& srcNode(fCurrent->nodes[source.node]);
+
+            if (srcNode.cycle == fCycle)
+            {
+                // processed this cycle, so the plugin is still valid
+                CarlaEngineEventPort* const port(CarlaPluginGetEventOutPort(data->plugins[srcNode.pluginId].plugin));
+
+                if (port != nullptr && port->pCount != nullptr)
+                {
+                    srcBuffer = port->pBuffer;
+                    srcEvents = *port->pCount;
+                }
+            }
+        }
+
+        if (srcBuffer == nullptr || srcEvents == 0)
+            continue;
+
+        merges[srcCount].buffer = srcBuffer;
+        merges[srcCount].pos    = 0;
+        merges[srcCount].end    = srcEvents;
+        ++srcCount;
+    }
+
+    uint32_t written = 0;
+
+    if (srcCount == 1)
+    {
+        // single source, plain copy
+        written = merges[0].end;
+        std::memcpy(dst, merges[0].buffer, sizeof(EngineEvent)*written);
+    }
+    else
+    {
+        // each source is already sorted by time, merge them
+        while (written < INTERNAL_EVENT_COUNT)
+        {
+            int best = -1;
+
+            for (uint32_t i=0; i < srcCount; ++i)
+            {
+                if (merges[i].pos >= merges[i].end)
+                    continue;
+
+                if (best < 0 || merges[i].buffer[merges[i].pos].time < merges[best].buffer[merges[best].pos].time)
+                    best = static_cast<int>(i);
+            }
+
+            if (best < 0)
+                break;
+
+            MergeSource& merge(merges[best]);
+            std::memcpy(&dst[written++], &merge.buffer[merge.pos++], sizeof(EngineEvent));
+        }
+    }
+
+    if (written < INTERNAL_EVENT_COUNT)
+        dst[written].clear();
+
+    return written;
+}
+
+// -----------------------------------------------------------------------
+// workers
+
+void CarlaEngineGraph::startWorkers()
+{
+    CARLA_ASSERT(fWorkerCount == 0);
+
+    fWorkersPromoted = false;
+    fWorkersQuit     = false;
+    fJobState        = 0;
+    fJobPending      = 0;
+
+#ifndef CARLA_OS_WIN
+    const long cpuCount(sysconf(_SC_NPROCESSORS_ONLN));
+
+    if (cpuCount <= 1)
+        return;
+
+    if (sem_init(&fWorkerSem, 0, 0) != 0)
+    {
+        carla_stderr("CarlaEngineGraph::startWorkers() - failed to create semaphore, processing will be serial");
+        return;
+    }
+
+    const unsigned int count((cpuCount-1 < static_cast<long>(PATCHBAY_GRAPH_MAX_WORKERS)) ? cpuCount-1 : PATCHBAY_GRAPH_MAX_WORKERS);
+
+    for (unsigned int i=0; i < count; ++i)
+    {
+        if (pthread_create(&fWorkers[fWorkerCount], nullptr, carla_engine_graph_worker, this) != 0)
+        {
+            carla_stderr("CarlaEngineGraph::startWorkers() - failed to create worker thread %i", i);
+            break;
+        }
+
+        ++fWorkerCount;
+    }
+
+    if (fWorkerCount == 0)
+        sem_destroy(&fWorkerSem);
+
+    carla_debug("CarlaEngineGraph::startWorkers() - started %i workers", fWorkerCount);
+#endif
+}
+
+void CarlaEngineGraph::stopWorkers()
+{
+    if (fWorkerCount == 0)
+        return;
+
+    fWorkersQuit = true;
+    __sync_synchronize();
+
+    for (unsigned int i=0; i < fWorkerCount; ++i)
+        sem_post(&fWorkerSem);
+
+    for (unsigned int i=0; i < fWorkerCount; ++i)
+        pthread_join(fWorkers[i], nullptr);
+
+    sem_destroy(&fWorkerSem);
+    fWorkerCount = 0;
+}
+
+void CarlaEngineGraph::promoteWorkers()
+{
+    fWorkersPromoted = true;
+
+#ifndef CARLA_OS_WIN
+# ifdef CARLA_OS_LINUX
+    // run on the cpus the audio thread may use, in case the audio server was given only some of them
+    cpu_set_t cpuSet;
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0)
+    {
+        for (unsigned int i=0; i < fWorkerCount; ++i)
+            pthread_setaffinity_np(fWorkers[i], sizeof(cpu_set_t), &cpuSet);
+    }
+# endif
+
+    // use the same scheduling as the audio thread
+    int policy;
+    sched_param param;
+
+    if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+        return;
+    if (policy != SCHED_FIFO && policy != SCHED_RR)
+        return;
+
+    for (unsigned int i=0; i < fWorkerCount; ++i)
+        pthread_setschedparam(fWorkers[i], policy, &param);
+#endif
+}
+
+void CarlaEngineGraph::workerRun()
+{
+    for (;;)
+    {
+        if (sem_wait(&fWorkerSem) != 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fWorkersQuit)
+            break;
+
+        runJobs();
+    }
+}
+
+void* CarlaEngineGraph::carla_engine_graph_worker(void* arg)
+{
+    ((CarlaEngineGraph*)arg)->workerRun();
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
@@ -0,0 +1,209 @@
+/*
+ * Carla Engine Graph
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __CARLA_ENGINE_GRAPH_HPP__
+#define __CARLA_ENGINE_GRAPH_HPP__
+
+#include "CarlaEngine.hpp"
+#include "CarlaMutex.hpp"
+#include "RtList.hpp"
+
+#include <pthread.h>
+#include <semaphore.h>
+
+CARLA_BACKEND_START_NAMESPACE
+
+#if 0
+} // Fix editor indentation
+#endif
+
+// -----------------------------------------------------------------------
+// Patchbay graph port ids
+//
+// Engine audio ports use the same ids as the hardware ports of the internal engines (group*1000 + channel).
+// Engine events ports live in the main Carla group.
+// Each plugin gets its own group and a range of 1000 port ids.
+
+const int PATCHBAY_GRAPH_ENGINE_GROUP       = -1;
+const int PATCHBAY_GRAPH_ENGINE_AUDIO_IN    = 0;    // + channel, graph source
+const int PATCHBAY_GRAPH_ENGINE_AUDIO_OUT   = 1000; // + channel, graph sink
+const int PATCHBAY_GRAPH_ENGINE_EVENTS_IN   = 9998; // graph source
+const int PATCHBAY_GRAPH_ENGINE_EVENTS_OUT  = 9999; // graph sink
+
+const int PATCHBAY_GRAPH_PLUGIN_GROUP       = 10;    // + plugin id
+const int PATCHBAY_GRAPH_PLUGIN_PORT        = 10000; // + plugin id * 1000
+const int PATCHBAY_GRAPH_PLUGIN_AUDIO_IN    = 0;     // + channel
+const int PATCHBAY_GRAPH_PLUGIN_AUDIO_OUT   = 400;   // + channel
+const int PATCHBAY_GRAPH_PLUGIN_EVENTS_IN   = 998;
+const int PATCHBAY_GRAPH_PLUGIN_EVENTS_OUT  = 999;
+
+const int PATCHBAY_GRAPH_CONNECTION_OFFSET  = 100000;
+
+const unsigned int PATCHBAY_GRAPH_MAX_WORKERS = 16;
+
+// -----------------------------------------------------------------------
+
+/*!
+ * Connection graph used in patchbay mode.\n
+ * Connections are kept on the non-realtime side, every change rebuilds a processing schedule
+ * where plugins are sorted in dependency levels.\n
+ * Plugins in the same level do not depend on each other, and get processed in parallel by a pool of worker threads.
+ */
+class CarlaEngineGraph
+{
+public:
+    CarlaEngineGraph(CarlaEngine* const engine);
+    ~CarlaEngineGraph();
+
+    void init();
+    void close();
+
+    // -------------------------------------------------------------------
+    // non-realtime calls
+
+    bool connect(const int portA, const int portB);
+    bool disconnect(const int connectionId);
+    void refresh();
+
+    void pluginAdded(const unsigned int id);
+    void pluginRemoved(const unsigned int id);
+    void pluginsSwitched(const unsigned int idA, const unsigned int idB);
+    void pluginsCleared(const unsigned int oldCount);
+
+    void bufferSizeChanged();
+
+    // -------------------------------------------------------------------
+    // realtime call
+
+    void process(float** inBuf, float** outBuf, const uint32_t bufCount[2], const uint32_t frames);
+
+    // -------------------------------------------------------------------
+
+private:
+    CarlaEngine* const kEngine;
+
+    struct Connection {
+        int id;
+        int portOut;
+        int portIn;
+    };
+
+    // where a node input comes from; node < 0 means the engine
+    struct Source {
+        int node;
+        uint32_t index;
+    };
+
+    // merge state of an event source, only used while merging
+    struct MergeSource {
+        const EngineEvent* buffer;
+        uint32_t pos;
+        uint32_t end;
+    };
+
+    struct Node {
+        unsigned int pluginId;
+        uint32_t     generation; // of the plugin slot when built, the plugin is only used while it still matches
+
+        uint32_t audioInCount;
+        uint32_t audioOutCount;
+        float**  audioIn;
+        float**  audioOut;
+
+        uint32_t* audioSrcOffset; // [audioInCount+1], ranges in Schedule::sources
+        uint32_t  eventSrcOffset;
+        uint32_t  eventSrcCount;
+
+        volatile uint32_t cycle;  // last processed cycle
+    };
+
+    struct Schedule {
+        uint32_t bufferSize;
+
+        uint32_t nodeCount;
+        Node*    nodes;          // indexed by plugin id
+
+        uint32_t* order;         // node indexes, sorted by level
+        uint32_t  levelCount;
+        uint32_t* levelOffset;   // [levelCount+1], ranges in order
+        uint32_t  maxLevelWidth;
+
+        Source*   sources;
+        MergeSource* merges;     // same size as sources, each range is only merged by one thread per cycle
+
+        uint32_t  sinkCount;     // engine audio outputs
+        uint32_t* sinkOffset;    // [sinkCount+1], ranges in sources
+        uint32_t  eventSinkOffset;
+        uint32_t  eventSinkCount;
+
+        Schedule();
+        ~Schedule();
+
+        void clear();
+    };
+
+    CarlaMutex fMutex;
+    NonRtList<Connection> fConnections;
+    int fLastConnectionId;
+
+    Schedule fSchedules[2];
+    Schedule* fCurrent;
+    unsigned int fActive;
+    volatile bool fPending;
+    uint32_t fCycle;
+
+    // current process data, for workers
+    float**  fProcInBuf;
+    uint32_t fProcInCount;
+    uint32_t fProcFrames;
+
+    // workers
+    pthread_t fWorkers[PATCHBAY_GRAPH_MAX_WORKERS];
+    unsigned int fWorkerCount;
+    bool fWorkersPromoted;
+    volatile bool fWorkersQuit;
+    sem_t fWorkerSem;
+
+    volatile uint64_t fJobState;   // (end << 32) | next
+    volatile int      fJobPending;
+
+    void rebuild();
+    uint32_t appendSources(Schedule& s, uint32_t srcCount, const int portIn);
+    void announcePlugin(const unsigned int id, const bool added);
+    void announceConnections(const bool added, const unsigned int firstPluginId, const unsigned int lastPluginId);
+    void removeConnections(const int pluginId);
+    bool isPortValid(const int port, const bool isOutput) const;
+    bool hasPath(const int fromPlugin, const int toPlugin) const;
+
+    void processNode(const uint32_t index);
+    void runLevel(const uint32_t begin, const uint32_t end);
+    void runJobs();
+    uint32_t mergeEvents(EngineEvent* const dst, const uint32_t srcOffset, const uint32_t count);
+
+    void startWorkers();
+    void stopWorkers();
+    void promoteWorkers();
+    void workerRun();
+
+    static void* carla_engine_graph_worker(void* arg);
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineGraph)
+};
+
+CARLA_BACKEND_END_NAMESPACE
+
+#endif // __CARLA_ENGINE_GRAPH_HPP__
@@ -22,6 +22,10 @@
 #include "CarlaEngineOsc.hpp"
 #include "CarlaEngineThread.hpp"
 
+#ifndef BUILD_BRIDGE
+# include "CarlaEngineGraph.hpp"
+#endif
+
 #include "CarlaPlugin.hpp"
 #include "RtList.hpp"
 
@@ -125,22 +129,41 @@ enum EnginePostAction {
 
 struct EnginePluginData {
     CarlaPlugin* plugin;
+    uint32_t generation; // changed together with 'plugin', so the graph can tell if its copy is still valid
     float insPeak[2];
     float outsPeak[2];
+#ifdef BUILD_BRIDGE
+    const CarlaOscData* oscData; // the host-side plugin this one reports to
+#endif
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
     EnginePluginData()
         : plugin(nullptr),
+          generation(0),
           insPeak{0.0f},
-          outsPeak{0.0f} {}
+          outsPeak{0.0f}
+# ifdef BUILD_BRIDGE
+        , oscData(nullptr)
+# endif
+          {}
 #else
     EnginePluginData()
-        : plugin(nullptr)
+        : plugin(nullptr),
+          generation(0)
+# ifdef BUILD_BRIDGE
+        , oscData(nullptr)
+# endif
     {
         insPeak[0] = insPeak[1] = nullptr;
         outsPeak[0] = outsPeak[1] = nullptr;
     }
 #endif
+
+    void setPlugin(CarlaPlugin* const newPlugin)
+    {
+        plugin = newPlugin;
+        ++generation;
+    }
 };
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -148,6 +171,9 @@ struct EnginePluginData {
 struct CarlaEngineProtectedData {
     CarlaEngineOsc    osc;
     CarlaEngineThread thread;
+#ifndef BUILD_BRIDGE
+    CarlaEngineGraph  graph;
+#endif
 
     const CarlaOscData* oscData;
 
@@ -165,12 +191,130 @@ struct CarlaEngineProtectedData {
     struct InternalEventBuffer {
         EngineEvent* in;
         EngineEvent* out;
+        uint32_t inCount;
+        uint32_t outCount;
 
         InternalEventBuffer()
             : in(nullptr),
-              out(nullptr) {}
+              out(nullptr),
+              inCount(0),
+              outCount(0) {}
+
+        // set number of input events, null-terminating the buffer for old readers
+        void setInCount(const uint32_t count)
+        {
+            inCount = count;
+
+            if (count < INTERNAL_EVENT_COUNT)
+                in[count].clear();
+        }
+
+        void clearOut()
+        {
+            outCount = 0;
+            out[0].clear();
+        }
+
+        // previous output becomes the new input, output gets cleared
+        void swap()
+        {
+            EngineEvent* const tmp(in);
+            in  = out;
+            out = tmp;
+
+            inCount = outCount;
+            clearOut();
+        }
     } bufEvents;
 
+    struct InternalAudioBuffer {
+        // 2nd set of buffers for rack processing, the other is the engine output
+        struct Buffers {
+            float*   rack[2];
+            uint32_t size;
+
+            Buffers(const uint32_t bufferSize)
+                : size(bufferSize)
+            {
+                rack[0] = new float[bufferSize];
+                rack[1] = new float[bufferSize];
+            }
+
+            ~Buffers()
+            {
+                delete[] rack[0];
+                delete[] rack[1];
+            }
+        };
+
+        // new buffers are handed to the audio thread, which retires the old ones when it picks them up.
+        // retired buffers are freed outside the audio thread, in resize(), freeRetired() and clear().
+        Buffers* current;          // only used by the audio thread while running
+        Buffers* volatile pending;
+        Buffers* volatile retired;
+
+        InternalAudioBuffer()
+            : current(nullptr),
+              pending(nullptr),
+              retired(nullptr) {}
+
+        ~InternalAudioBuffer()
+        {
+            CARLA_ASSERT(current == nullptr && pending == nullptr && retired == nullptr);
+        }
+
+        // non real-time, never waits for the audio thread
+        void resize(const uint32_t bufferSize)
+        {
+            freeRetired();
+
+            Buffers* const newBuffers((bufferSize > 0) ? new Buffers(bufferSize) : nullptr);
+
+            // replaces buffers the audio thread has not taken yet
+            if (Buffers* const oldPending = __sync_lock_test_and_set(&pending, newBuffers))
+                delete oldPending;
+        }
+
+        void freeRetired()
+        {
+            if (Buffers* const oldRetired = __sync_lock_test_and_set(&retired, (Buffers*)nullptr))
+                delete oldRetired;
+        }
+
+        // audio thread, returns the buffers to use this cycle
+        const Buffers* take()
+        {
+            Buffers* const newBuffers(pending);
+
+            // keep the current ones until the previous retired buffers are freed
+            if (newBuffers != nullptr && retired == nullptr && __sync_bool_compare_and_swap(&pending, newBuffers, (Buffers*)nullptr))
+            {
+                retired = current;
+                current = newBuffers;
+            }
+
+            return current;
+        }
+
+        // only when not processing
+        void clear()
+        {
+            freeRetired();
+
+            if (pending != nullptr)
+            {
+                delete pending;
+                pending = nullptr;
+            }
+
+            if (current != nullptr)
+            {
+                delete current;
+                current = nullptr;
+            }
+        }
+    } bufAudio;
+
     struct NextAction {
         EnginePostAction opcode;
         unsigned int     pluginId;
@@ -206,6 +350,9 @@ struct CarlaEngineProtectedData {
     CarlaEngineProtectedData(CarlaEngine* const engine)
         : osc(engine),
           thread(engine),
+#ifndef BUILD_BRIDGE
+          graph(engine),
+#endif
           oscData(nullptr),
           callback(nullptr),
           callbackPtr(nullptr),
@@ -227,7 +374,7 @@ struct CarlaEngineProtectedData {
         CARLA_ASSERT(id == engine->kData->curPluginCount);
 
         if (id == engine->kData->curPluginCount)
-            engine->kData->plugins[id].plugin = plugin;
+            engine->kData->plugins[id].setPlugin(plugin);
     }
 #endif
 
@@ -249,21 +396,27 @@ struct CarlaEngineProtectedData {
 
             plugin->setId(i);
 
-            plugins[i].plugin      = plugin;
+            plugins[i].setPlugin(plugin);
             plugins[i].insPeak[0]  = 0.0f;
             plugins[i].insPeak[1]  = 0.0f;
             plugins[i].outsPeak[0] = 0.0f;
             plugins[i].outsPeak[1] = 0.0f;
+#ifdef BUILD_BRIDGE
+            plugins[i].oscData     = plugins[i+1].oscData;
+#endif
         }
 
         const unsigned int id(curPluginCount);
 
         // reset now last plugin
-        plugins[id].plugin      = nullptr;
+        plugins[id].setPlugin(nullptr);
         plugins[id].insPeak[0]  = 0.0f;
         plugins[id].insPeak[1]  = 0.0f;
         plugins[id].outsPeak[0] = 0.0f;
         plugins[id].outsPeak[1] = 0.0f;
+#ifdef BUILD_BRIDGE
+        plugins[id].oscData     = nullptr;
+#endif
     }
 
     void doPluginsSwitch()
@@ -284,8 +437,8 @@ struct CarlaEngineProtectedData {
 #else
         CarlaPlugin* const tmp(plugins[idA].plugin);
 
-        plugins[idA].plugin = plugins[idB].plugin;
-        plugins[idB].plugin = tmp;
+        plugins[idA].setPlugin(plugins[idB].plugin);
+        plugins[idB].setPlugin(tmp);
 #endif
     }
 
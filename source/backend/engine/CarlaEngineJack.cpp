@@ -1252,7 +1252,6 @@ protected:
             float* outBuf[2] = { audioOut1, audioOut2 };
 
             // initialize input events
-            carla_zeroStruct<EngineEvent>(kData->bufEvents.in, INTERNAL_EVENT_COUNT);
             {
                 uint32_t engineEventIndex = 0;
 
@@ -1336,6 +1335,8 @@ protected:
                     if (engineEventIndex >= INTERNAL_EVENT_COUNT)
                         break;
                 }
+
+                kData->bufEvents.setInCount(engineEventIndex);
             }
 
             // process rack
@@ -1345,7 +1346,7 @@ protected:
             {
                 jackbridge_midi_clear_buffer(eventOut);
 
-                for (unsigned short i=0; i < INTERNAL_EVENT_COUNT; ++i)
+                for (uint32_t i=0; i < kData->bufEvents.outCount; ++i)
                 {
                     EngineEvent* const engineEvent = &kData->bufEvents.out[i];
 
@@ -2048,28 +2049,12 @@ private:
         }
 
         for (uint32_t i=0; i < inCount && i < 2; ++i)
-        {
-            for (uint32_t j=0; j < nframes; ++j)
-            {
-                const float absV(std::abs(inBuffer[i][j]));
-
-                if (absV > inPeaks[i])
-                    inPeaks[i] = absV;
-            }
-        }
+            inPeaks[i] = carla_findAbsMaxFloat(inBuffer[i], nframes);
 
         plugin->process(inBuffer, outBuffer, nframes);
 
         for (uint32_t i=0; i < outCount && i < 2; ++i)
-        {
-            for (uint32_t j=0; j < nframes; ++j)
-            {
-                const float absV(std::abs(outBuffer[i][j]));
-
-                if (absV > outPeaks[i])
-                    outPeaks[i] = absV;
-            }
-        }
+            outPeaks[i] = carla_findAbsMaxFloat(outBuffer[i], nframes);
 
         setPeaks(plugin->id(), inPeaks, outPeaks);
     }
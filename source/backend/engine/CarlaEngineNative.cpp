@@ -483,7 +483,6 @@ protected:
         // ---------------------------------------------------------------
         // initialize input events
 
-        carla_zeroStruct<EngineEvent>(kData->bufEvents.in, INTERNAL_EVENT_COUNT);
         {
             uint32_t engineEventIndex = 0;
 
@@ -539,6 +538,8 @@ protected:
                 engineEvent.midi.data[3] = midiEvent.data[3];
                 engineEvent.midi.size    = midiEvent.size;
             }
+
+            kData->bufEvents.setInCount(engineEventIndex);
         }
 
         // ---------------------------------------------------------------
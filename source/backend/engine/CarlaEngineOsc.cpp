@@ -16,6 +16,7 @@
  */
 
 #include "CarlaEngineOsc.hpp"
+#include "CarlaEngineInternal.hpp"
 
 #include "CarlaEngine.hpp"
 #include "CarlaPlugin.hpp"
@@ -25,6 +26,10 @@
 # include "CarlaBridgeUtils.hpp"
 #endif
 
+#ifndef CARLA_OS_WIN
+# include <poll.h>
+#endif
+
 CARLA_BACKEND_START_NAMESPACE
 
 #ifndef BUILD_BRIDGE
@@ -36,11 +41,169 @@ extern int CarlaPluginSetOscBridgeInfo(CarlaPlugin* const plugin, const PluginBr
 #endif
 
 // -----------------------------------------------------------------------
+// OSC methods, looked up by name in a hash table
+
+enum OscMethod {
+    kOscMethodNull = 0,
+    // Common OSC methods (DSSI and bridge UIs)
+    kOscMethodUpdate,
+    kOscMethodConfigure,
+    kOscMethodControl,
+    kOscMethodProgram,
+    kOscMethodMidi,
+    kOscMethodExiting,
+#ifndef BUILD_BRIDGE
+    // Internal methods
+    kOscMethodSetActive,
+    kOscMethodSetDryWet,
+    kOscMethodSetVolume,
+    kOscMethodSetBalanceLeft,
+    kOscMethodSetBalanceRight,
+    kOscMethodSetPanning,
+    kOscMethodSetParameterValue,
+    kOscMethodSetParameterValues,
+    kOscMethodSetParameterMidiCC,
+    kOscMethodSetParameterMidiChannel,
+    kOscMethodSetProgram,
+    kOscMethodSetMidiProgram,
+    kOscMethodNoteOn,
+    kOscMethodNoteOff,
+    // Plugin Bridges, 'bridgeType' tells which
+    kOscMethodBridge,
+#endif
+#ifdef WANT_LV2
+    // Plugin-specific methods
+    kOscMethodLv2AtomTransfer,
+    kOscMethodLv2UridMap,
+#endif
+};
+
+struct OscMethodName {
+    const char* name;
+    OscMethod   method;
+    int         bridgeType;
+};
+
+static const OscMethodName kOscMethodNames[] = {
+    { "update",                     kOscMethodUpdate,                  0 },
+    { "configure",                  kOscMethodConfigure,               0 },
+    { "control",                    kOscMethodControl,                 0 },
+    { "program",                    kOscMethodProgram,                 0 },
+    { "midi",                       kOscMethodMidi,                    0 },
+    { "exiting",                    kOscMethodExiting,                 0 },
+#ifndef BUILD_BRIDGE
+    { "set_active",                 kOscMethodSetActive,               0 },
+    { "set_drywet",                 kOscMethodSetDryWet,               0 },
+    { "set_volume",                 kOscMethodSetVolume,               0 },
+    { "set_balance_left",           kOscMethodSetBalanceLeft,          0 },
+    { "set_balance_right",          kOscMethodSetBalanceRight,         0 },
+    { "set_panning",                kOscMethodSetPanning,              0 },
+    { "set_parameter_value",        kOscMethodSetParameterValue,       0 },
+    { "set_parameter_values",       kOscMethodSetParameterValues,      0 },
+    { "set_parameter_midi_cc",      kOscMethodSetParameterMidiCC,      0 },
+    { "set_parameter_midi_channel", kOscMethodSetParameterMidiChannel, 0 },
+    { "set_program",                kOscMethodSetProgram,              0 },
+    { "set_midi_program",           kOscMethodSetMidiProgram,          0 },
+    { "note_on",                    kOscMethodNoteOn,                  0 },
+    { "note_off",                   kOscMethodNoteOff,                 0 },
+    { "bridge_audio_count",         kOscMethodBridge, kPluginBridgeAudioCount },
+    { "bridge_midi_count",          kOscMethodBridge, kPluginBridgeMidiCount },
+    { "bridge_parameter_count",     kOscMethodBridge, kPluginBridgeParameterCount },
+    { "bridge_program_count",       kOscMethodBridge, kPluginBridgeProgramCount },
+    { "bridge_midi_program_count",  kOscMethodBridge, kPluginBridgeMidiProgramCount },
+    { "bridge_plugin_info",         kOscMethodBridge, kPluginBridgePluginInfo },
+    { "bridge_parameter_info",      kOscMethodBridge, kPluginBridgeParameterInfo },
+    { "bridge_parameter_data",      kOscMethodBridge, kPluginBridgeParameterData },
+    { "bridge_parameter_ranges",    kOscMethodBridge, kPluginBridgeParameterRanges },
+    { "bridge_program_info",        kOscMethodBridge, kPluginBridgeProgramInfo },
+    { "bridge_midi_program_info",   kOscMethodBridge, kPluginBridgeMidiProgramInfo },
+    { "bridge_configure",           kOscMethodBridge, kPluginBridgeConfigure },
+    { "bridge_set_parameter_value", kOscMethodBridge, kPluginBridgeSetParameterValue },
+    { "bridge_set_default_value",   kOscMethodBridge, kPluginBridgeSetDefaultValue },
+    { "bridge_set_program",         kOscMethodBridge, kPluginBridgeSetProgram },
+    { "bridge_set_midi_program",    kOscMethodBridge, kPluginBridgeSetMidiProgram },
+    { "bridge_set_custom_data",     kOscMethodBridge, kPluginBridgeSetCustomData },
+    { "bridge_set_chunk_data",      kOscMethodBridge, kPluginBridgeSetChunkData },
+    { "bridge_update",              kOscMethodBridge, kPluginBridgeUpdateNow },
+    { "bridge_error",               kOscMethodBridge, kPluginBridgeError },
+#endif
+#ifdef WANT_LV2
+    { "lv2_atom_transfer",          kOscMethodLv2AtomTransfer,         0 },
+    { "lv2_urid_map",               kOscMethodLv2UridMap,              0 },
+#endif
+    { nullptr,                      kOscMethodNull,                    0 }
+};
+
+class OscMethodTable
+{
+public:
+    OscMethodTable()
+    {
+        carla_zeroMem(fSlots, sizeof(fSlots));
+
+        for (const OscMethodName* name = kOscMethodNames; name->name != nullptr; ++name)
+        {
+            uint32_t i = hash(name->name) & kMask;
+
+            while (fSlots[i] != nullptr)
+                i = (i+1) & kMask;
+
+            fSlots[i] = name;
+        }
+    }
+
+    const OscMethodName* get(const char* const name) const
+    {
+        for (uint32_t i = hash(name) & kMask;; i = (i+1) & kMask)
+        {
+            const OscMethodName* const slot(fSlots[i]);
+
+            if (slot == nullptr)
+                return nullptr;
+            if (std::strcmp(slot->name, name) == 0)
+                return slot;
+        }
+    }
+
+private:
+    // at least twice the number of methods, must be a power of 2
+    static const uint32_t kSize = 128;
+    static const uint32_t kMask = kSize-1;
+
+    const OscMethodName* fSlots[kSize];
+
+    // FNV-1a
+    static uint32_t hash(const char* str)
+    {
+        uint32_t h = 2166136261U;
+
+        for (; *str != '\0'; ++str)
+        {
+            h ^= static_cast<uint8_t>(*str);
+            h *= 16777619U;
+        }
+
+        return h;
+    }
+};
+
+static const OscMethodTable kOscMethodTable;
+
+// -----------------------------------------------------------------------
+
+// how long the server thread waits for new messages, in ms
+static const int kServerThreadTimeout = 10;
 
 CarlaEngineOsc::CarlaEngineOsc(CarlaEngine* const engine)
     : kEngine(engine),
       fServerTCP(nullptr),
-      fServerUDP(nullptr)
+      fServerUDP(nullptr),
+#ifndef BUILD_BRIDGE
+      fControlBundle(nullptr),
+      fControlBundleSize(0),
+      fControlBundleThread(),
+#endif
+      fThread(this)
 {
     carla_debug("CarlaEngineOsc::CarlaEngineOsc(%p)", engine);
     CARLA_ASSERT(engine != nullptr);
@@ -54,6 +217,7 @@ CarlaEngineOsc::~CarlaEngineOsc()
     CARLA_ASSERT(fServerPathUDP.isEmpty());
     CARLA_ASSERT(fServerTCP == nullptr);
     CARLA_ASSERT(fServerUDP == nullptr);
+    CARLA_ASSERT(! fThread.isRunning());
 }
 
 // -----------------------------------------------------------------------
@@ -108,6 +272,8 @@ void CarlaEngineOsc::init(const char* const name)
 
 void CarlaEngineOsc::idle()
 {
+    const CarlaMutex::ScopedLocker sl(fMutex);
+
     if (fServerTCP != nullptr)
     {
         while (lo_server_recv_noblock(fServerTCP, 0) != 0) {}
@@ -127,6 +293,7 @@ void CarlaEngineOsc::close()
     CARLA_ASSERT(fServerPathUDP.isNotEmpty());
     CARLA_ASSERT(fServerTCP != nullptr);
     CARLA_ASSERT(fServerUDP != nullptr);
+    CARLA_ASSERT(! fThread.isRunning());
 
     fName.clear();
 
@@ -148,7 +315,10 @@ void CarlaEngineOsc::close()
     fServerPathUDP.clear();
 
 #ifndef BUILD_BRIDGE
-    fControlData.free();
+    {
+        const CarlaMutex::ScopedLocker sl(fControlMutex);
+        fControlData.free();
+    }
 #endif
 
     CARLA_ASSERT(fName.isEmpty());
@@ -160,6 +330,160 @@ void CarlaEngineOsc::close()
 
 // -----------------------------------------------------------------------
 
+void CarlaEngineOsc::startThread()
+{
+    carla_debug("CarlaEngineOsc::startThread()");
+    CARLA_ASSERT(fServerTCP != nullptr || fServerUDP != nullptr);
+
+    if (fThread.isRunning())
+        return;
+
+    fThread.startNow();
+}
+
+void CarlaEngineOsc::stopThread()
+{
+    carla_debug("CarlaEngineOsc::stopThread()");
+
+    fThread.stopNow();
+}
+
+void CarlaEngineOsc::waitForMessages()
+{
+#ifdef CARLA_OS_WIN
+    if (fServerUDP != nullptr)
+        lo_server_wait(fServerUDP, kServerThreadTimeout);
+    else
+        carla_msleep(kServerThreadTimeout);
+#else
+    // liblo has no way to wait on several servers, so poll their sockets ourselves.
+    // data on already accepted TCP connections is only noticed on timeout.
+    pollfd fds[2];
+    nfds_t count = 0;
+
+    if (fServerUDP != nullptr)
+    {
+        fds[count].fd     = lo_server_get_socket_fd(fServerUDP);
+        fds[count].events = POLLIN;
+        fds[count].revents = 0;
+
+        if (fds[count].fd >= 0)
+            ++count;
+    }
+
+    if (fServerTCP != nullptr)
+    {
+        fds[count].fd     = lo_server_get_socket_fd(fServerTCP);
+        fds[count].events = POLLIN;
+        fds[count].revents = 0;
+
+        if (fds[count].fd >= 0)
+            ++count;
+    }
+
+    if (count > 0)
+        poll(fds, count, kServerThreadTimeout);
+    else
+        carla_msleep(kServerThreadTimeout);
+#endif
+}
+
+// -----------------------------------------------------------------------
+
+#ifndef BUILD_BRIDGE
+void CarlaEngineOsc::beginControlBundle()
+{
+    CARLA_ASSERT(fControlBundle == nullptr);
+
+    if (fControlBundle != nullptr)
+        return;
+
+    fControlBundleSize   = 0;
+    fControlBundleThread = pthread_self();
+    fControlBundle       = lo_bundle_new(LO_TT_IMMEDIATE);
+}
+
+void CarlaEngineOsc::endControlBundle()
+{
+    CARLA_ASSERT(fControlBundle != nullptr);
+
+    if (fControlBundle == nullptr)
+        return;
+
+    flushControlBundle();
+
+    lo_bundle_free_messages(fControlBundle);
+    fControlBundle = nullptr;
+}
+
+void CarlaEngineOsc::flushControlBundle()
+{
+    if (fControlBundleSize == 0)
+        return;
+
+    {
+        const CarlaMutex::ScopedLocker sl(fControlMutex);
+
+        if (fControlData.target != nullptr)
+            lo_send_bundle(fControlData.target, fControlBundle);
+    }
+
+    // start a new one, the old messages are gone with it
+    lo_bundle_free_messages(fControlBundle);
+    fControlBundle     = lo_bundle_new(LO_TT_IMMEDIATE);
+    fControlBundleSize = 0;
+}
+
+void CarlaEngineOsc::sendControlMessage(const char* const method, const lo_message msg)
+{
+    CARLA_ASSERT(method != nullptr && method[0] == '/');
+    CARLA_ASSERT(msg != nullptr);
+
+    // only the thread that began the bundle adds to it, all others send right away
+    if (fControlBundle != nullptr && pthread_equal(fControlBundleThread, pthread_self()))
+    {
+        CarlaString& path(fControlBundlePaths[fControlBundleSize]);
+
+        {
+            const CarlaMutex::ScopedLocker sl(fControlMutex);
+
+            if (fControlData.path == nullptr)
+            {
+                lo_message_free(msg);
+                return;
+            }
+
+            path  = fControlData.path;
+            path += method;
+        }
+
+        ++fControlBundleSize;
+        lo_bundle_add_message(fControlBundle, (const char*)path, msg);
+
+        if (fControlBundleSize == kMaxControlBundleSize)
+            flushControlBundle();
+
+        return;
+    }
+
+    {
+        const CarlaMutex::ScopedLocker sl(fControlMutex);
+
+        if (fControlData.target != nullptr)
+        {
+            char targetPath[std::strlen(fControlData.path)+std::strlen(method)+1];
+            std::strcpy(targetPath, fControlData.path);
+            std::strcat(targetPath, method);
+            lo_send_message(fControlData.target, targetPath, msg);
+        }
+    }
+
+    lo_message_free(msg);
+}
+#endif
+
+// -----------------------------------------------------------------------
+
 bool isDigit(const char c)
 {
     return (c >= '0' && c <= '9');
@@ -187,6 +511,9 @@ int CarlaEngineOsc::handleMessage(const bool isTCP, const char* const path, cons
         return 1;
     }
 
+    // handlers change plugin data the engine thread reads, never run both at once
+    const CarlaMutex::ScopedLocker sl(kEngine->kData->thread.getMutex());
+
 #ifndef BUILD_BRIDGE
     // Initial path check
     if (std::strcmp(path, "/register") == 0)
@@ -201,9 +528,10 @@ int CarlaEngineOsc::handleMessage(const bool isTCP, const char* const path, cons
 #endif
 
     const size_t nameSize = fName.length();
+    const size_t pathSize = std::strlen(path);
 
     // Check if message is for this client
-    if (std::strlen(path) <= nameSize || std::strncmp(path+1, (const char*)fName, nameSize) != 0)
+    if (pathSize <= nameSize || std::strncmp(path+1, (const char*)fName, nameSize) != 0)
     {
         carla_stderr("CarlaEngineOsc::handleMessage() - message not for this client -> '%s' != '/%s/'", path, (const char*)fName);
         return 1;
@@ -269,8 +597,7 @@ int CarlaEngineOsc::handleMessage(const bool isTCP, const char* const path, cons
     }
 
     // Get method from path, "/Carla/i/method" -> "method"
-    char method[32] = { 0 };
-    std::strncpy(method, path + (nameSize + offset), 31);
+    const char* const method = (pathSize > nameSize + offset) ? path + (nameSize + offset) : "";
 
     if (method[0] == '\0')
     {
@@ -278,105 +605,76 @@ int CarlaEngineOsc::handleMessage(const bool isTCP, const char* const path, cons
         return 1;
     }
 
+    const OscMethodName* const oscMethod(kOscMethodTable.get(method));
+
+    switch (oscMethod != nullptr ? oscMethod->method : kOscMethodNull)
+    {
+    case kOscMethodNull:
+        break;
+
     // Common OSC methods (DSSI and bridge UIs)
-    if (std::strcmp(method, "update") == 0)
+    case kOscMethodUpdate:
     {
         const lo_address source = lo_message_get_source(msg);
         return handleMsgUpdate(plugin, argc, argv, types, source);
     }
-    if (std::strcmp(method, "configure") == 0)
+    case kOscMethodConfigure:
         return handleMsgConfigure(plugin, argc, argv, types);
-    if (std::strcmp(method, "control") == 0)
+    case kOscMethodControl:
         return handleMsgControl(plugin, argc, argv, types);
-    if (std::strcmp(method, "program") == 0)
+    case kOscMethodProgram:
         return handleMsgProgram(plugin, argc, argv, types);
-    if (std::strcmp(method, "midi") == 0)
+    case kOscMethodMidi:
         return handleMsgMidi(plugin, argc, argv, types);
-    if (std::strcmp(method, "exiting") == 0)
+    case kOscMethodExiting:
         return handleMsgExiting(plugin);
 
 #ifndef BUILD_BRIDGE
     // Internal methods
-    if (std::strcmp(method, "set_active") == 0)
+    case kOscMethodSetActive:
         return handleMsgSetActive(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_drywet") == 0)
+    case kOscMethodSetDryWet:
         return handleMsgSetDryWet(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_volume") == 0)
+    case kOscMethodSetVolume:
         return handleMsgSetVolume(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_balance_left") == 0)
+    case kOscMethodSetBalanceLeft:
         return handleMsgSetBalanceLeft(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_balance_right") == 0)
+    case kOscMethodSetBalanceRight:
         return handleMsgSetBalanceRight(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_panning") == 0)
+    case kOscMethodSetPanning:
         return handleMsgSetPanning(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_parameter_value") == 0)
+    case kOscMethodSetParameterValue:
         return handleMsgSetParameterValue(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_parameter_midi_cc") == 0)
+    case kOscMethodSetParameterValues:
+        return handleMsgSetParameterValues(plugin, argc, argv, types);
+    case kOscMethodSetParameterMidiCC:
         return handleMsgSetParameterMidiCC(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_parameter_midi_channel") == 0)
+    case kOscMethodSetParameterMidiChannel:
         return handleMsgSetParameterMidiChannel(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_program") == 0)
+    case kOscMethodSetProgram:
         return handleMsgSetProgram(plugin, argc, argv, types);
-    if (std::strcmp(method, "set_midi_program") == 0)
+    case kOscMethodSetMidiProgram:
         return handleMsgSetMidiProgram(plugin, argc, argv, types);
-    if (std::strcmp(method, "note_on") == 0)
+    case kOscMethodNoteOn:
         return handleMsgNoteOn(plugin, argc, argv, types);
-    if (std::strcmp(method, "note_off") == 0)
+    case kOscMethodNoteOff:
         return handleMsgNoteOff(plugin, argc, argv, types);
 
     // Plugin Bridges
-    if ((plugin->hints() & PLUGIN_IS_BRIDGE) > 0 && std::strlen(method) > 11 && std::strncmp(method, "bridge_", 7) == 0)
-    {
-        if (std::strcmp(method+7, "audio_count") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeAudioCount, argc, argv, types);
-        if (std::strcmp(method+7, "midi_count") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeMidiCount, argc, argv, types);
-        if (std::strcmp(method+7, "parameter_count") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeParameterCount, argc, argv, types);
-        if (std::strcmp(method+7, "program_count") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeProgramCount, argc, argv, types);
-        if (std::strcmp(method+7, "midi_program_count") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeMidiProgramCount, argc, argv, types);
-        if (std::strcmp(method+7, "plugin_info") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgePluginInfo, argc, argv, types);
-        if (std::strcmp(method+7, "parameter_info") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeParameterInfo, argc, argv, types);
-        if (std::strcmp(method+7, "parameter_data") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeParameterData, argc, argv, types);
-        if (std::strcmp(method+7, "parameter_ranges") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeParameterRanges, argc, argv, types);
-        if (std::strcmp(method+7, "program_info") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeProgramInfo, argc, argv, types);
-        if (std::strcmp(method+7, "midi_program_info") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeMidiProgramInfo, argc, argv, types);
-        if (std::strcmp(method+7, "configure") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeConfigure, argc, argv, types);
-        if (std::strcmp(method+7, "set_parameter_value") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetParameterValue, argc, argv, types);
-        if (std::strcmp(method+7, "set_default_value") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetDefaultValue, argc, argv, types);
-        if (std::strcmp(method+7, "set_program") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetProgram, argc, argv, types);
-        if (std::strcmp(method+7, "set_midi_program") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetMidiProgram, argc, argv, types);
-        if (std::strcmp(method+7, "set_custom_data") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetCustomData, argc, argv, types);
-        if (std::strcmp(method+7, "set_chunk_data") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeSetChunkData, argc, argv, types);
-        if (std::strcmp(method+7, "update") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeUpdateNow, argc, argv, types);
-        if (std::strcmp(method+7, "error") == 0)
-            return CarlaPluginSetOscBridgeInfo(plugin, kPluginBridgeError, argc, argv, types);
-    }
+    case kOscMethodBridge:
+        if ((plugin->hints() & PLUGIN_IS_BRIDGE) > 0)
+            return CarlaPluginSetOscBridgeInfo(plugin, static_cast<PluginBridgeInfoType>(oscMethod->bridgeType), argc, argv, types);
+        break;
 #endif
 
     // Plugin-specific methods
 #ifdef WANT_LV2
-    if (std::strcmp(method, "lv2_atom_transfer") == 0)
+    case kOscMethodLv2AtomTransfer:
         return handleMsgLv2AtomTransfer(plugin, argc, argv, types);
-    if (std::strcmp(method, "lv2_urid_map") == 0)
+    case kOscMethodLv2UridMap:
         return handleMsgLv2UridMap(plugin, argc, argv, types);
 #endif
+    }
 
     carla_stderr("CarlaEngineOsc::handleMessage() - unsupported OSC method '%s'", method);
     return 1;
@@ -401,19 +699,23 @@ int CarlaEngineOsc::handleMsgRegister(const bool isTCP, const int argc, const lo
     carla_debug("CarlaEngineOsc::handleMsgRegister() - OSC backend registered to %s", url);
 
     {
-        const char* host = lo_address_get_hostname(source);
-        const char* port = lo_address_get_port(source);
-        fControlData.source = lo_address_new_with_proto(isTCP ? LO_TCP : LO_UDP, host, port);
-    }
+        const CarlaMutex::ScopedLocker sl(fControlMutex);
 
-    {
-        char* host = lo_url_get_hostname(url);
-        char* port = lo_url_get_port(url);
-        fControlData.path   = carla_strdup_free(lo_url_get_path(url));
-        fControlData.target = lo_address_new_with_proto(isTCP ? LO_TCP : LO_UDP, host, port);
+        {
+            const char* host = lo_address_get_hostname(source);
+            const char* port = lo_address_get_port(source);
+            fControlData.source = lo_address_new_with_proto(isTCP ? LO_TCP : LO_UDP, host, port);
+        }
+
+        {
+            char* host = lo_url_get_hostname(url);
+            char* port = lo_url_get_port(url);
+            fControlData.path   = carla_strdup_free(lo_url_get_path(url));
+            fControlData.target = lo_address_new_with_proto(isTCP ? LO_TCP : LO_UDP, host, port);
 
-        std::free(host);
-        std::free(port);
+            std::free(host);
+            std::free(port);
+        }
     }
 
     for (unsigned short i=0; i < kEngine->currentPluginCount(); ++i)
@@ -437,6 +739,8 @@ int CarlaEngineOsc::handleMsgUnregister()
         return 1;
     }
 
+    const CarlaMutex::ScopedLocker sl(fControlMutex);
+
     fControlData.free();
     return 0;
 }
@@ -690,6 +994,43 @@ int CarlaEngineOsc::handleMsgSetParameterValue(CARLA_ENGINE_OSC_HANDLE_ARGS2)
     return 0;
 }
 
+int CarlaEngineOsc::handleMsgSetParameterValues(CARLA_ENGINE_OSC_HANDLE_ARGS2)
+{
+    carla_debug("CarlaEngineOsc::handleMsgSetParameterValues()");
+
+    // any number of index and value pairs, "ifif..."
+    if (argc < 2 || argc % 2 != 0)
+    {
+        carla_stderr("CarlaEngineOsc::handleMsgSetParameterValues() - argument count mismatch: %i is not an even number", argc);
+        return 1;
+    }
+    if (types == nullptr)
+    {
+        carla_stderr("CarlaEngineOsc::handleMsgSetParameterValues() - argument types are null");
+        return 1;
+    }
+
+    // check everything first, so a bad message is not applied halfway
+    for (int i=0; i < argc; i += 2)
+    {
+        if (types[i] != 'i' || types[i+1] != 'f')
+        {
+            carla_stderr("CarlaEngineOsc::handleMsgSetParameterValues() - argument types mismatch: '%s' is not a list of 'if'", types);
+            return 1;
+        }
+
+        CARLA_SAFE_ASSERT_INT(argv[i]->i >= 0, argv[i]->i);
+
+        if (argv[i]->i < 0)
+            return 1;
+    }
+
+    for (int i=0; i < argc; i += 2)
+        plugin->setParameterValue(static_cast<uint32_t>(argv[i]->i), argv[i+1]->f, true, false, true);
+
+    return 0;
+}
+
 int CarlaEngineOsc::handleMsgSetParameterMidiCC(CARLA_ENGINE_OSC_HANDLE_ARGS2)
 {
     carla_debug("CarlaEngineOsc::handleMsgSetParameterMidiCC()");
@@ -19,9 +19,14 @@
 #define __CARLA_ENGINE_OSC_HPP__
 
 #include "CarlaBackend.hpp"
+#include "CarlaMutex.hpp"
 #include "CarlaOscUtils.hpp"
 #include "CarlaString.hpp"
 
+#include <QtCore/QThread>
+
+#include <pthread.h>
+
 #define CARLA_ENGINE_OSC_HANDLE_ARGS1 CarlaPlugin* const plugin
 #define CARLA_ENGINE_OSC_HANDLE_ARGS2 CarlaPlugin* const plugin, const int argc, const lo_arg* const* const argv, const char* const types
 
@@ -61,9 +66,12 @@ public:
     ~CarlaEngineOsc();
 
     void init(const char* const name);
-    void idle();
     void close();
 
+    // handle incoming messages on a dedicated thread, as soon as they arrive
+    void startThread();
+    void stopThread();
+
     // -------------------------------------------------------------------
 
     const char* getServerPathTCP() const
@@ -88,6 +96,13 @@ public:
     {
         return &fControlData;
     }
+
+    // messages sent to the control client by the calling thread in between these are grouped in bundles
+    void beginControlBundle();
+    void endControlBundle();
+
+    // send or bundle a message to the control client, takes ownership of 'msg'
+    void sendControlMessage(const char* const method, const lo_message msg);
 #endif
 
     // -------------------------------------------------------------------
@@ -102,12 +117,70 @@ private:
     lo_server   fServerTCP;
     lo_server   fServerUDP;
 
+    CarlaMutex fMutex; // held while handling messages
+
 #ifndef BUILD_BRIDGE
     CarlaOscData fControlData; // for carla-control
+    CarlaMutex   fControlMutex;
+
+    static const unsigned int kMaxControlBundleSize = 32;
+
+    lo_bundle    fControlBundle;
+    unsigned int fControlBundleSize;
+    pthread_t    fControlBundleThread;
+    CarlaString  fControlBundlePaths[kMaxControlBundleSize]; // lo_bundle only keeps the pointers
+
+    void flushControlBundle();
 #endif
 
     // -------------------------------------------------------------------
 
+    class ServerThread : public QThread
+    {
+    public:
+        ServerThread(CarlaEngineOsc* const osc)
+            : kOsc(osc),
+              fStopNow(true) {}
+
+        void startNow()
+        {
+            fStopNow = false;
+            start();
+        }
+
+        void stopNow()
+        {
+            fStopNow = true;
+
+            if (isRunning() && ! wait(500))
+                terminate();
+        }
+
+    protected:
+        void run()
+        {
+            while (! fStopNow)
+            {
+                kOsc->waitForMessages();
+
+                if (! fStopNow)
+                    kOsc->idle();
+            }
+        }
+
+    private:
+        CarlaEngineOsc* const kOsc;
+        volatile bool fStopNow;
+    };
+
+    ServerThread fThread;
+
+    // only called from fThread, which owns the servers while running
+    void idle();
+    void waitForMessages();
+
+    // -------------------------------------------------------------------
+
     int handleMessage(const bool isTCP, const char* const path, const int argc, const lo_arg* const* const argv, const char* const types, const lo_message msg);
 
 #ifndef BUILD_BRIDGE
@@ -130,6 +203,7 @@ private:
     int handleMsgSetBalanceRight(CARLA_ENGINE_OSC_HANDLE_ARGS2);
     int handleMsgSetPanning(CARLA_ENGINE_OSC_HANDLE_ARGS2);
     int handleMsgSetParameterValue(CARLA_ENGINE_OSC_HANDLE_ARGS2);
+    int handleMsgSetParameterValues(CARLA_ENGINE_OSC_HANDLE_ARGS2);
     int handleMsgSetParameterMidiCC(CARLA_ENGINE_OSC_HANDLE_ARGS2);
     int handleMsgSetParameterMidiChannel(CARLA_ENGINE_OSC_HANDLE_ARGS2);
     int handleMsgSetProgram(CARLA_ENGINE_OSC_HANDLE_ARGS2);
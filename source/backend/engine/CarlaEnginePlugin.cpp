@@ -451,7 +451,6 @@ protected:
         // ---------------------------------------------------------------
         // initialize input events
 
-        carla_zeroStruct<EngineEvent>(kData->bufEvents.in, INTERNAL_EVENT_COUNT);
         {
             uint32_t engineEventIndex = 0;
 
@@ -526,6 +525,8 @@ protected:
                 engineEvent.midi.data[3] = midiEvent.buf[3];
                 engineEvent.midi.size    = midiEvent.size;
             }
+
+            kData->bufEvents.setInCount(engineEventIndex);
         }
 
         // ---------------------------------------------------------------
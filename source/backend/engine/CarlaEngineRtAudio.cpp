@@ -25,6 +25,12 @@
 #include "RtAudio.h"
 #include "RtMidi.h"
 
+#if defined(CARLA_OS_WIN) || defined(CARLA_OS_MAC)
+# include <sys/time.h>
+#else
+# include <time.h>
+#endif
+
 CARLA_BACKEND_START_NAMESPACE
 
 #if 0
@@ -79,6 +85,129 @@ RtMidi::Api getMatchedAudioMidiAPi(const RtAudio::Api rtApi)
     return RtMidi::UNSPECIFIED;
 }
 
+// -------------------------------------------------------------------------------------------------------------------
+// RtAudio MIDI input, lock-free
+
+class CarlaEngineRtAudio;
+
+const unsigned int MAX_MIDI_IN_RINGS = 16;
+
+struct RtMidiEvent {
+    uint64_t frame; // stream clock
+    unsigned char data[4];
+    unsigned char size;
+};
+
+// wait-free single-producer (RtMidi thread), single-consumer (audio thread) event ring
+struct RtMidiInRing {
+    static const uint32_t kSize = 512; // must be power of 2
+
+    RtMidiEvent events[kSize];
+    volatile uint32_t readPos;
+    volatile uint32_t writePos;
+
+    // producer side only
+    uint64_t lastFrame;
+    double   lastStreamTime; // last clock read, in case the next read fails
+    double   lastWallTime;
+
+    // non-rt side only
+    CarlaEngineRtAudio* engine;
+    bool used;
+
+    RtMidiInRing()
+        : readPos(0),
+          writePos(0),
+          lastFrame(0),
+          lastStreamTime(0.0),
+          lastWallTime(0.0),
+          engine(nullptr),
+          used(false) {}
+
+    void reset()
+    {
+        readPos = writePos = 0;
+        lastFrame = 0;
+        lastStreamTime = lastWallTime = 0.0;
+        used = false;
+    }
+
+    bool push(const RtMidiEvent& event)
+    {
+        const uint32_t pos(writePos);
+
+        if (pos - readPos >= kSize)
+            return false;
+
+        events[pos % kSize] = event;
+        __sync_synchronize();
+        writePos = pos + 1;
+        return true;
+    }
+
+    const RtMidiEvent* peek() const
+    {
+        const uint32_t pos(readPos);
+
+        if (pos == writePos)
+            return nullptr;
+
+        __sync_synchronize();
+        return &events[pos % kSize];
+    }
+
+    void pop()
+    {
+        __sync_synchronize();
+        readPos = readPos + 1;
+    }
+
+    void skipUntil(const uint64_t frame)
+    {
+        for (const RtMidiEvent* event; (event = peek()) != nullptr && event->frame < frame;)
+            pop();
+    }
+};
+
+// last audio cycle stream time and when it started, written by the audio thread only
+struct RtMidiInClock {
+    volatile uint32_t seq;
+    volatile double streamTime;
+    volatile double wallTime;
+
+    RtMidiInClock()
+        : seq(0),
+          streamTime(0.0),
+          wallTime(0.0) {}
+
+    void publish(const double stream, const double wall)
+    {
+        seq = seq + 1;
+        __sync_synchronize();
+        streamTime = stream;
+        wallTime   = wall;
+        __sync_synchronize();
+        seq = seq + 1;
+    }
+
+    bool read(double& stream, double& wall) const
+    {
+        for (int i=0; i < 100; ++i)
+        {
+            const uint32_t seq1(seq);
+            __sync_synchronize();
+            stream = streamTime;
+            wall   = wallTime;
+            __sync_synchronize();
+
+            if ((seq1 & 1) == 0 && seq1 == seq)
+                return (seq1 != 0);
+        }
+
+        return false;
+    }
+};
+
 // -------------------------------------------------------------------------------------------------------------------
 // RtAudio Engine
 
@@ -100,7 +229,8 @@ public:
           fAudioIsReady(false),
           fDummyMidiIn(getMatchedAudioMidiAPi(api), "Carla"),
           fDummyMidiOut(getMatchedAudioMidiAPi(api), "Carla"),
-          fLastConnectionId(0)
+          fLastConnectionId(0),
+          fMidiInLate(0)
     {
         carla_debug("CarlaEngineRtAudio::CarlaEngineRtAudio(%i)", api);
 
@@ -342,6 +472,9 @@ public:
 
             midiInPort->cancelCallback();
             delete midiInPort;
+
+            if (port.ring != nullptr)
+                port.ring->used = false;
         }
 
         for (NonRtList<MidiPort>::Itenerator it = fMidiOuts.begin(); it.valid(); it.next())
@@ -355,8 +488,14 @@ public:
         fMidiIns.clear();
         fMidiOuts.clear();
 
-        fMidiInEvents.clear();
-        //fMidiOutEvents.clear();
+        for (unsigned int i=0; i < MAX_MIDI_IN_RINGS; ++i)
+            fMidiInRings[i].reset();
+
+        if (fMidiInLate > 0)
+        {
+            carla_stderr("CarlaEngineRtAudio::close() - %u MIDI events were dropped or late", fMidiInLate);
+            fMidiInLate = 0;
+        }
 
         return (! hasError);
     }
@@ -402,6 +541,10 @@ public:
             return false;
         }
 
+        // plugin and audio device connections are handled by the patchbay graph
+        if (fOptions.processMode == PROCESS_MODE_PATCHBAY && portA >= 0 && portB >= 0)
+            return CarlaEngine::patchbayConnect(portA, portB);
+
         // only allow connections between Carla and other ports
         if (portA < 0 && portB < 0)
         {
@@ -491,7 +634,6 @@ public:
     bool patchbayDisconnect(int connectionId) override
     {
         CARLA_ASSERT(fAudioIsReady);
-        CARLA_ASSERT(fUsedConnections.count() > 0);
         carla_debug("CarlaEngineRtAudio::patchbayDisconnect(%i)", connectionId);
 
         if (! fAudioIsReady)
@@ -499,6 +641,12 @@ public:
             setLastError("Engine not ready");
             return false;
         }
+
+        if (fOptions.processMode == PROCESS_MODE_PATCHBAY && connectionId >= PATCHBAY_GRAPH_CONNECTION_OFFSET)
+            return CarlaEngine::patchbayDisconnect(connectionId);
+
+        CARLA_ASSERT(fUsedConnections.count() > 0);
+
         if (fUsedConnections.count() == 0)
         {
             setLastError("No connections available");
@@ -548,6 +696,10 @@ public:
                             midiInPort->cancelCallback();
                             delete midiInPort;
 
+                            // the audio thread keeps draining the ring, it's only reused on a new connection
+                            if (midiPort.ring != nullptr)
+                                midiPort.ring->used = false;
+
                             fMidiIns.remove(it);
                             break;
                         }
@@ -616,10 +768,15 @@ public:
         {
             callback(CALLBACK_PATCHBAY_CLIENT_ADDED, 0, PATCHBAY_GROUP_CARLA, 0, 0.0f, getName());
 
-            callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_IN1,  PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_INPUT,  "audio-in1");
-            callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_IN2,  PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_INPUT,  "audio-in2");
-            callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_OUT1, PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_OUTPUT, "audio-out1");
-            callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_OUT2, PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_OUTPUT, "audio-out2");
+            // in patchbay mode plugins connect to the audio device directly
+            if (fOptions.processMode != PROCESS_MODE_PATCHBAY)
+            {
+                callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_IN1,  PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_INPUT,  "audio-in1");
+                callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_IN2,  PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_INPUT,  "audio-in2");
+                callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_OUT1, PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_OUTPUT, "audio-out1");
+                callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_AUDIO_OUT2, PATCHBAY_PORT_IS_AUDIO|PATCHBAY_PORT_IS_OUTPUT, "audio-out2");
+            }
+
             callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_MIDI_IN,    PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_INPUT,   "midi-in");
             callback(CALLBACK_PATCHBAY_PORT_ADDED, 0, PATCHBAY_GROUP_CARLA, PATCHBAY_PORT_MIDI_OUT,   PATCHBAY_PORT_IS_MIDI|PATCHBAY_PORT_IS_OUTPUT,  "midi-out");
         }
@@ -786,6 +943,9 @@ public:
             fUsedConnections.append(connectionToId);
             fLastConnectionId++;
         }
+
+        // Plugins
+        CarlaEngine::patchbayRefresh();
     }
 
     // -------------------------------------------------------------------
@@ -802,24 +962,26 @@ protected:
         CARLA_ASSERT_INT2(nframes == fBufferSize, nframes, fBufferSize);
         CARLA_ASSERT(outsPtr != nullptr);
 
+        // publish the stream clock for the MIDI input threads
+        const uint64_t cycleFrame(static_cast<uint64_t>(streamTime*fSampleRate + 0.5));
+        fMidiInClock.publish(streamTime, getMonotonicTime());
+
         if (kData->curPluginCount == 0 || fAudioCountOut == 0 || ! fAudioIsReady)
         {
             if (fAudioCountOut > 0 && fAudioIsReady)
                 carla_zeroFloat(outsPtr, nframes*fAudioCountOut);
 
+            // nothing to send MIDI to
+            for (unsigned int i=0; i < MAX_MIDI_IN_RINGS; ++i)
+                fMidiInRings[i].skipUntil(cycleFrame + nframes);
+
             return proccessPendingEvents();
         }
 
         // initialize audio input
         if (fAudioIsInterleaved)
         {
-            for (unsigned int i=0, j=0; i < nframes*fAudioCountIn; ++i)
-            {
-                fAudioBufIn[i/fAudioCountIn][j] = insPtr[i];
-
-                if ((i+1) % fAudioCountIn == 0)
-                    j += 1;
-            }
+            carla_deinterleaveFloat(fAudioBufIn, insPtr, fAudioCountIn, nframes);
         }
         else
         {
@@ -834,17 +996,41 @@ protected:
         carla_zeroFloat(fAudioBufRackOut[0], nframes);
         carla_zeroFloat(fAudioBufRackOut[1], nframes);
 
-        // initialize input events
-        carla_zeroMem(kData->bufEvents.in, sizeof(EngineEvent)*INTERNAL_EVENT_COUNT);
-
-        if (fMidiInEvents.mutex.tryLock())
+        // initialize input events, merging all MIDI input rings by time
         {
             uint32_t engineEventIndex = 0;
-            fMidiInEvents.splice();
 
-            while (! fMidiInEvents.data.isEmpty())
+            while (engineEventIndex < INTERNAL_EVENT_COUNT)
             {
-                const RtMidiEvent& midiEvent(fMidiInEvents.data.getFirst(true));
+                RtMidiInRing* ring = nullptr;
+                uint64_t      frame = 0;
+
+                for (unsigned int i=0; i < MAX_MIDI_IN_RINGS; ++i)
+                {
+                    const RtMidiEvent* const event(fMidiInRings[i].peek());
+
+                    // empty, or belongs to a future cycle
+                    if (event == nullptr || event->frame >= cycleFrame + nframes)
+                        continue;
+
+                    if (ring == nullptr || event->frame < frame)
+                    {
+                        ring  = &fMidiInRings[i];
+                        frame = event->frame;
+                    }
+                }
+
+                if (ring == nullptr)
+                    break;
+
+                // too late, play it now
+                if (frame < cycleFrame)
+                {
+                    frame = cycleFrame;
+                    __sync_add_and_fetch(&fMidiInLate, 1);
+                }
+
+                const RtMidiEvent& midiEvent(*ring->peek());
 
                 EngineEvent& engineEvent(kData->bufEvents.in[engineEventIndex++]);
                 engineEvent.clear();
@@ -853,18 +1039,7 @@ protected:
                 const uint8_t midiChannel = MIDI_GET_CHANNEL_FROM_DATA(midiEvent.data);
 
                 engineEvent.channel = midiChannel;
-
-                if (midiEvent.time < fTimeInfo.frame)
-                {
-                    engineEvent.time = 0;
-                }
-                else if (midiEvent.time >= fTimeInfo.frame + nframes)
-                {
-                    engineEvent.time = fTimeInfo.frame + nframes-1;
-                    carla_stderr("MIDI Event in the future!, %i vs %i", engineEvent.time, fTimeInfo.frame);
-                }
-                else
-                    engineEvent.time = midiEvent.time - fTimeInfo.frame;
+                engineEvent.time    = static_cast<uint32_t>(frame - cycleFrame);
 
                 if (MIDI_IS_STATUS_CONTROL_CHANGE(midiStatus))
                 {
@@ -920,106 +1095,108 @@ protected:
                     engineEvent.midi.size    = midiEvent.size;
                 }
 
-                if (engineEventIndex >= INTERNAL_EVENT_COUNT)
-                    break;
+                ring->pop();
             }
 
-            fMidiInEvents.mutex.unlock();
+            kData->bufEvents.setInCount(engineEventIndex);
         }
 
-        fConnectAudioLock.lock();
-
-        // connect input buffers
-        if (fConnectedAudioIns[0].count() == 0)
+        if (fOptions.processMode == PROCESS_MODE_PATCHBAY)
         {
-            carla_zeroFloat(fAudioBufRackIn[0], nframes);
+            const uint32_t bufCount[2] = { fAudioCountIn, fAudioCountOut };
+
+            processPatchbay(fAudioBufIn, fAudioBufOut, bufCount, nframes);
         }
         else
         {
-            bool first = true;
+            fConnectAudioLock.lock();
 
-            for (NonRtList<uint>::Itenerator it = fConnectedAudioIns[0].begin(); it.valid(); it.next())
+            // connect input buffers
+            if (fConnectedAudioIns[0].count() == 0)
+            {
+                carla_zeroFloat(fAudioBufRackIn[0], nframes);
+            }
+            else
             {
-                const uint& port(*it);
-                CARLA_ASSERT(port < fAudioCountIn);
+                bool first = true;
 
-                if (first)
+                for (NonRtList<uint>::Itenerator it = fConnectedAudioIns[0].begin(); it.valid(); it.next())
                 {
-                    carla_copyFloat(fAudioBufRackIn[0], fAudioBufIn[port], nframes);
-                    first = false;
-                }
-                else
-                    carla_addFloat(fAudioBufRackIn[0], fAudioBufIn[port], nframes);
-            }
+                    const uint& port(*it);
+                    CARLA_ASSERT(port < fAudioCountIn);
 
-            if (first)
-                carla_zeroFloat(fAudioBufRackIn[0], nframes);
-        }
+                    if (first)
+                    {
+                        carla_copyFloat(fAudioBufRackIn[0], fAudioBufIn[port], nframes);
+                        first = false;
+                    }
+                    else
+                        carla_addFloat(fAudioBufRackIn[0], fAudioBufIn[port], nframes);
+                }
 
-        if (fConnectedAudioIns[1].count() == 0)
-        {
-            carla_zeroFloat(fAudioBufRackIn[1], nframes);
-        }
-        else
-        {
-            bool first = true;
+                if (first)
+                    carla_zeroFloat(fAudioBufRackIn[0], nframes);
+            }
 
-            for (NonRtList<uint>::Itenerator it = fConnectedAudioIns[1].begin(); it.valid(); it.next())
+            if (fConnectedAudioIns[1].count() == 0)
+            {
+                carla_zeroFloat(fAudioBufRackIn[1], nframes);
+            }
+            else
             {
-                const uint& port(*it);
-                CARLA_ASSERT(port < fAudioCountIn);
+                bool first = true;
 
-                if (first)
+                for (NonRtList<uint>::Itenerator it = fConnectedAudioIns[1].begin(); it.valid(); it.next())
                 {
-                    carla_copyFloat(fAudioBufRackIn[1], fAudioBufIn[port], nframes);
-                    first = false;
+                    const uint& port(*it);
+                    CARLA_ASSERT(port < fAudioCountIn);
+
+                    if (first)
+                    {
+                        carla_copyFloat(fAudioBufRackIn[1], fAudioBufIn[port], nframes);
+                        first = false;
+                    }
+                    else
+                        carla_addFloat(fAudioBufRackIn[1], fAudioBufIn[port], nframes);
                 }
-                else
-                    carla_addFloat(fAudioBufRackIn[1], fAudioBufIn[port], nframes);
-            }
 
-            if (first)
-                carla_zeroFloat(fAudioBufRackIn[1], nframes);
-        }
+                if (first)
+                    carla_zeroFloat(fAudioBufRackIn[1], nframes);
+            }
 
-        // process
-        processRack(fAudioBufRackIn, fAudioBufRackOut, nframes);
+            // process
+            processRack(fAudioBufRackIn, fAudioBufRackOut, nframes);
 
-        // connect output buffers
-        if (fConnectedAudioOuts[0].count() != 0)
-        {
-            for (NonRtList<uint>::Itenerator it = fConnectedAudioOuts[0].begin(); it.valid(); it.next())
+            // connect output buffers
+            if (fConnectedAudioOuts[0].count() != 0)
             {
-                const uint& port(*it);
-                CARLA_ASSERT(port < fAudioCountOut);
+                for (NonRtList<uint>::Itenerator it = fConnectedAudioOuts[0].begin(); it.valid(); it.next())
+                {
+                    const uint& port(*it);
+                    CARLA_ASSERT(port < fAudioCountOut);
 
-                carla_addFloat(fAudioBufOut[port], fAudioBufRackOut[0], nframes);
+                    carla_addFloat(fAudioBufOut[port], fAudioBufRackOut[0], nframes);
+                }
             }
-        }
 
-        if (fConnectedAudioOuts[1].count() != 0)
-        {
-            for (NonRtList<uint>::Itenerator it = fConnectedAudioOuts[1].begin(); it.valid(); it.next())
+            if (fConnectedAudioOuts[1].count() != 0)
             {
-                const uint& port(*it);
-                CARLA_ASSERT(port < fAudioCountOut);
+                for (NonRtList<uint>::Itenerator it = fConnectedAudioOuts[1].begin(); it.valid(); it.next())
+                {
+                    const uint& port(*it);
+                    CARLA_ASSERT(port < fAudioCountOut);
 
-                carla_addFloat(fAudioBufOut[port], fAudioBufRackOut[1], nframes);
+                    carla_addFloat(fAudioBufOut[port], fAudioBufRackOut[1], nframes);
+                }
             }
-        }
 
-        fConnectAudioLock.unlock();
+            fConnectAudioLock.unlock();
+        }
 
         // output audio
         if (fAudioIsInterleaved)
         {
-            for (unsigned int i=0, j=0; i < nframes*fAudioCountOut; ++i)
-            {
-                outsPtr[i] = fAudioBufOut[i/fAudioCountOut][j];
-
-                if ((i+1) % fAudioCountOut == 0)
-                    j += 1;
-            }
+            carla_interleaveFloat(outsPtr, fAudioBufOut, fAudioCountOut, nframes);
         }
         else
         {
@@ -1041,66 +1218,56 @@ protected:
         (void)status;
     }
 
-    void handleMidiCallback(double timeStamp, std::vector<unsigned char>* const message)
+    void handleMidiCallback(RtMidiInRing* const ring, std::vector<unsigned char>* const message)
     {
         if (! fAudioIsReady)
             return;
 
         const size_t messageSize = message->size();
-        static uint32_t lastTime = 0;
 
         if (messageSize == 0 || messageSize > 4)
             return;
 
-        timeStamp /= 2;
-
-        if (timeStamp > 0.95)
-            timeStamp = 0.95;
-        else if (timeStamp < 0.0)
-            timeStamp = 0.0;
+        // map arrival time into the stream clock.
+        // events are delayed by 1 buffer, so they keep their relative position inside the next cycle
+        double streamTime, wallTime;
 
-        RtMidiEvent midiEvent;
-        midiEvent.time = fTimeInfo.frame + (timeStamp*(double)fBufferSize);
-
-        if (midiEvent.time < lastTime)
-            midiEvent.time = lastTime;
-        else
-            lastTime = midiEvent.time;
-
-        if (messageSize == 1)
-        {
-            midiEvent.data[0] = message->at(0);
-            midiEvent.data[1] = 0;
-            midiEvent.data[2] = 0;
-            midiEvent.data[3] = 0;
-            midiEvent.size    = 1;
-        }
-        else if (messageSize == 2)
+        if (fMidiInClock.read(streamTime, wallTime))
         {
-            midiEvent.data[0] = message->at(0);
-            midiEvent.data[1] = message->at(1);
-            midiEvent.data[2] = 0;
-            midiEvent.data[3] = 0;
-            midiEvent.size    = 2;
+            ring->lastStreamTime = streamTime;
+            ring->lastWallTime   = wallTime;
         }
-        else if (messageSize == 3)
+        else if (ring->lastWallTime != 0.0)
         {
-            midiEvent.data[0] = message->at(0);
-            midiEvent.data[1] = message->at(1);
-            midiEvent.data[2] = message->at(2);
-            midiEvent.data[3] = 0;
-            midiEvent.size    = 3;
+            // audio thread kept the clock busy, use the previous one
+            streamTime = ring->lastStreamTime;
+            wallTime   = ring->lastWallTime;
         }
         else
         {
-            midiEvent.data[0] = message->at(0);
-            midiEvent.data[1] = message->at(1);
-            midiEvent.data[2] = message->at(2);
-            midiEvent.data[3] = message->at(3);
-            midiEvent.size    = 4;
+            // no clock yet
+            __sync_add_and_fetch(&fMidiInLate, 1);
+            return;
         }
 
-        fMidiInEvents.append(midiEvent);
+        const double elapsed(getMonotonicTime() - wallTime);
+
+        RtMidiEvent midiEvent;
+        midiEvent.frame = static_cast<uint64_t>((streamTime + (elapsed > 0.0 ? elapsed : 0.0))*fSampleRate + 0.5) + fBufferSize;
+
+        // keep events in order
+        if (midiEvent.frame < ring->lastFrame)
+            midiEvent.frame = ring->lastFrame;
+        else
+            ring->lastFrame = midiEvent.frame;
+
+        midiEvent.size = static_cast<unsigned char>(messageSize);
+
+        for (size_t i=0; i < 4; ++i)
+            midiEvent.data[i] = (i < messageSize) ? message->at(i) : 0;
+
+        if (! ring->push(midiEvent))
+            __sync_add_and_fetch(&fMidiInLate, 1);
     }
 
     bool connectMidiInPort(const int portId)
@@ -1120,9 +1287,30 @@ protected:
 
         int rtMidiPortIndex = -1;
 
+        RtMidiInRing* ring = nullptr;
+
+        for (unsigned int i=0; i < MAX_MIDI_IN_RINGS; ++i)
+        {
+            if (! fMidiInRings[i].used)
+            {
+                ring = &fMidiInRings[i];
+                break;
+            }
+        }
+
+        if (ring == nullptr)
+        {
+            setLastError("Too many MIDI inputs");
+            return false;
+        }
+
+        ring->engine    = this;
+        ring->lastFrame = 0;
+        ring->lastStreamTime = ring->lastWallTime = 0.0;
+
         RtMidiIn* const rtMidiIn(new RtMidiIn(getMatchedAudioMidiAPi(fAudio.getCurrentApi()), newPortName, 512));
         rtMidiIn->ignoreTypes();
-        rtMidiIn->setCallback(carla_rtmidi_callback, this);
+        rtMidiIn->setCallback(carla_rtmidi_callback, ring);
 
         for (unsigned int i=0, count=rtMidiIn->getPortCount(); i < count; ++i)
         {
@@ -1144,7 +1332,9 @@ protected:
         MidiPort midiPort;
         midiPort.portId = portId;
         midiPort.rtmidi = rtMidiIn;
+        midiPort.ring   = ring;
 
+        ring->used = true;
         fMidiIns.append(midiPort);
 
         return true;
@@ -1189,6 +1379,7 @@ protected:
         MidiPort midiPort;
         midiPort.portId = portId;
         midiPort.rtmidi = rtMidiOut;
+        midiPort.ring   = nullptr;
 
         fMidiOuts.append(midiPort);
 
@@ -1254,57 +1445,30 @@ private:
 
     struct MidiPort {
         RtMidi* rtmidi;
+        RtMidiInRing* ring; // inputs only
         int portId;
     };
 
     NonRtList<MidiPort> fMidiIns;
     NonRtList<MidiPort> fMidiOuts;
 
-    struct RtMidiEvent {
-        uint32_t time;
-        unsigned char data[4];
-        unsigned char size;
-    };
-
-    struct RtMidiEvents {
-        CarlaMutex mutex;
-        RtList<RtMidiEvent>::Pool dataPool;
-        RtList<RtMidiEvent> data;
-        RtList<RtMidiEvent> dataPending;
-
-        RtMidiEvents()
-            : dataPool(512, 512),
-              data(dataPool),
-              dataPending(dataPool) {}
-
-        ~RtMidiEvents()
-        {
-            clear();
-        }
-
-        void append(const RtMidiEvent& event)
-        {
-            mutex.lock();
-            dataPending.append(event);
-            mutex.unlock();
-        }
+    RtMidiInRing  fMidiInRings[MAX_MIDI_IN_RINGS];
+    RtMidiInClock fMidiInClock;
+    volatile uint32_t fMidiInLate; // dropped because of full ring or delivered too late
 
-        void clear()
-        {
-            mutex.lock();
-            data.clear();
-            dataPending.clear();
-            mutex.unlock();
-        }
-
-        void splice()
-        {
-            dataPending.spliceAppend(data, true);
-        }
-    };
-
-    RtMidiEvents fMidiInEvents;
-    //RtMidiEvents fMidiOutEvents;
+    // in seconds, only differences matter
+    static double getMonotonicTime()
+    {
+#if defined(CARLA_OS_WIN) || defined(CARLA_OS_MAC)
+        timeval now;
+        gettimeofday(&now, nullptr);
+        return double(now.tv_sec) + double(now.tv_usec) * 0.000001;
+#else
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return double(now.tv_sec) + double(now.tv_nsec) * 0.000000001;
+#endif
+    }
 
     #define handlePtr ((CarlaEngineRtAudio*)userData)
 
@@ -1314,9 +1478,10 @@ private:
         return 0;
     }
 
-    static void carla_rtmidi_callback(double timeStamp, std::vector<unsigned char>* message, void* userData)
+    static void carla_rtmidi_callback(double, std::vector<unsigned char>* message, void* userData)
     {
-        handlePtr->handleMidiCallback(timeStamp, message);
+        RtMidiInRing* const ring((RtMidiInRing*)userData);
+        ring->engine->handleMidiCallback(ring, message);
     }
 
     #undef handlePtr
@@ -20,22 +20,74 @@
 #include "CarlaEngine.hpp"
 #include "CarlaPlugin.hpp"
 
+#include <cerrno>
+
+#ifdef CARLA_OS_WIN
+# include <sys/time.h>
+#else
+# include <time.h>
+#endif
+
 CARLA_BACKEND_START_NAMESPACE
 
+// -----------------------------------------------------------------------
+// current time, in the clock used by sem_timedwait()
+
+static void getCurrentTime(timespec& ts)
+{
+#ifdef CARLA_OS_WIN
+    timeval now;
+    gettimeofday(&now, nullptr);
+    ts.tv_sec  = now.tv_sec;
+    ts.tv_nsec = now.tv_usec * 1000;
+#else
+    clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+}
+
+static void addTimeMs(timespec& ts, const unsigned int ms)
+{
+    ts.tv_sec  += ms / 1000;
+    ts.tv_nsec += long(ms % 1000) * 1000000;
+
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec  += 1;
+        ts.tv_nsec -= 1000000000;
+    }
+}
+
+static bool isTimeBefore(const timespec& a, const timespec& b)
+{
+    return (a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec));
+}
+
 // -----------------------------------------------------------------------
 
 CarlaEngineThread::CarlaEngineThread(CarlaEngine* const engine)
     : kEngine(engine),
-      fStopNow(true)
+      fStopNow(true),
+      fSemOk(false),
+      fPending(0)
 {
     carla_debug("CarlaEngineThread::CarlaEngineThread(%p)", engine);
     CARLA_ASSERT(engine != nullptr);
+
+#ifndef CARLA_OS_MAC
+    fSemOk = (sem_init(&fSem, 0, 0) == 0);
+#endif
+
+    if (! fSemOk)
+        carla_stderr("CarlaEngineThread::CarlaEngineThread() - failed to create semaphore, will poll instead");
 }
 
 CarlaEngineThread::~CarlaEngineThread()
 {
     carla_debug("CarlaEngineThread::~CarlaEngineThread()");
     CARLA_ASSERT(fStopNow);
+
+    if (fSemOk)
+        sem_destroy(&fSem);
 }
 
 // -----------------------------------------------------------------------
@@ -58,12 +110,22 @@ void CarlaEngineThread::stopNow()
 
     fStopNow = true;
 
+    if (fSemOk)
+        sem_post(&fSem);
+
     const CarlaMutex::ScopedLocker sl(fMutex);
 
     if (isRunning() && ! wait(500))
         terminate();
 }
 
+void CarlaEngineThread::wakeUp()
+{
+    // only post once until the thread picks it up
+    if (fSemOk && __sync_bool_compare_and_swap(&fPending, 0, 1))
+        sem_post(&fSem);
+}
+
 // -----------------------------------------------------------------------
 
 void CarlaEngineThread::run()
@@ -71,12 +133,48 @@ void CarlaEngineThread::run()
     carla_debug("CarlaEngineThread::run()");
     CARLA_ASSERT(kEngine->isRunning());
 
-    bool oscRegisted, usesSingleThread;
-    unsigned int i, count;
-    float value;
+    bool oscRegisted, oscWasRegisted = false, usesSingleThread, updateMeters;
+    unsigned int i, count, meterLatency;
+    timespec now, nextMeters;
+
+    // peaks last sent to the OSC control client, per plugin
+    const unsigned int maxPlugins(kEngine->maxPluginNumber());
+    float (*oscPeaks)[4] = new float[maxPlugins][4];
+    carla_zeroMem(oscPeaks, sizeof(float)*4*maxPlugins);
+
+    getCurrentTime(nextMeters);
 
     while (kEngine->isRunning() && ! fStopNow)
     {
+        meterLatency = kEngine->getOptions().meterLatency;
+
+        // Sleep until the next meter update, or until the audio thread has post-poned events for us
+#ifndef CARLA_OS_MAC
+        if (fSemOk)
+        {
+            while (sem_timedwait(&fSem, &nextMeters) != 0 && errno == EINTR) {}
+        }
+        else
+#endif
+        {
+            carla_msleep(meterLatency);
+        }
+
+        if (fStopNow)
+            break;
+
+        fPending = 0;
+        __sync_synchronize();
+
+        getCurrentTime(now);
+        updateMeters = ! (fSemOk && isTimeBefore(now, nextMeters));
+
+        if (updateMeters)
+        {
+            nextMeters = now;
+            addTimeMs(nextMeters, meterLatency);
+        }
+
         const CarlaMutex::ScopedLocker sl(fMutex);
 
 #ifdef BUILD_BRIDGE
@@ -85,6 +183,16 @@ void CarlaEngineThread::run()
         oscRegisted = kEngine->isOscControlRegistered();
 #endif
 
+        // resend everything to new OSC clients
+        const bool oscForce(oscRegisted && ! oscWasRegisted);
+        oscWasRegisted = oscRegisted;
+
+#ifndef BUILD_BRIDGE
+        // send this cycle's parameter values and peaks together
+        if (oscRegisted)
+            kEngine->osc_send_control_begin_bundle();
+#endif
+
         for (i=0, count = kEngine->currentPluginCount(); i < count; ++i)
         {
             CarlaPlugin* const plugin = kEngine->getPluginUnchecked(i);
@@ -99,49 +207,46 @@ void CarlaEngineThread::run()
             // -------------------------------------------------------
             // Process postponed events
 
-            if (oscRegisted || ! usesSingleThread)
-            {
-                if (! usesSingleThread)
-                    plugin->postRtEventsRun();
-
-                // ---------------------------------------------------
-                // Update parameter outputs
+            if (! usesSingleThread)
+                plugin->postRtEventsRun();
 
-                for (uint32_t j=0; j < plugin->parameterCount(); ++j)
-                {
-                    if (! plugin->parameterIsOutput(j))
-                        continue;
-
-                    value = plugin->getParameterValue(j);
+            if (! (updateMeters && (oscRegisted || ! usesSingleThread)))
+                continue;
 
-                    // Update UI
-                    if (! usesSingleThread)
-                        plugin->uiParameterChange(j, value);
+            // -------------------------------------------------------
+            // Update parameter outputs, only the ones that changed
 
-                    // Update OSC engine client
-                    if (oscRegisted)
-                    {
-#ifdef BUILD_BRIDGE
-                        kEngine->osc_send_bridge_set_parameter_value(j, value);
-#else
-                        kEngine->osc_send_control_set_parameter_value(i, j, value);
-#endif
-                    }
-                }
+            plugin->outputParametersRun(! usesSingleThread, oscRegisted, oscForce);
 
 #ifndef BUILD_BRIDGE
-                // ---------------------------------------------------
-                // Update OSC control client peaks
+            // -------------------------------------------------------
+            // Update OSC control client peaks
 
-                if (oscRegisted)
+            if (oscRegisted && i < maxPlugins)
+            {
+                const float peaks[4] = {
+                    kEngine->getInputPeak(i, 1),
+                    kEngine->getInputPeak(i, 2),
+                    kEngine->getOutputPeak(i, 1),
+                    kEngine->getOutputPeak(i, 2)
+                };
+
+                if (oscForce || std::memcmp(peaks, oscPeaks[i], sizeof(float)*4) != 0)
+                {
+                    std::memcpy(oscPeaks[i], peaks, sizeof(float)*4);
                     kEngine->osc_send_control_set_peaks(i);
-#endif
+                }
             }
+#endif
         }
 
-        kEngine->idleOsc();
-        carla_msleep(oscRegisted ? 30 : 50);
+#ifndef BUILD_BRIDGE
+        if (oscRegisted)
+            kEngine->osc_send_control_end_bundle();
+#endif
     }
+
+    delete[] oscPeaks;
 }
 
 CARLA_BACKEND_END_NAMESPACE
@@ -23,6 +23,8 @@
 
 #include <QtCore/QThread>
 
+#include <semaphore.h>
+
 CARLA_BACKEND_START_NAMESPACE
 
 #if 0
@@ -38,6 +40,15 @@ public:
     void startNow();
     void stopNow();
 
+    // wake up the thread to handle post-poned events, real-time safe
+    void wakeUp();
+
+    // held while plugins are being handled
+    CarlaMutex& getMutex()
+    {
+        return fMutex;
+    }
+
     // ----------------------------------------------
 
 protected:
@@ -51,6 +62,10 @@ private:
     CarlaMutex fMutex;
     bool       fStopNow;
 
+    sem_t fSem;
+    bool  fSemOk;
+    volatile int fPending;
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineThread)
 };
 
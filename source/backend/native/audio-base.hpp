@@ -18,63 +18,52 @@
 #ifndef __AUDIO_BASE_HPP__
 #define __AUDIO_BASE_HPP__
 
-#include "CarlaMutex.hpp"
+#include "audio-cache.hpp"
 
 #include <QtCore/QThread>
 
-extern "C" {
-#include "audio_decoder/ad.h"
-}
+// -----------------------------------------------------------------------
+// A fixed-size block of decoded stereo audio.
+// startFrame is in transport frames, so a looped file keeps counting up.
 
-typedef struct adinfo ADInfo;
-
-struct AudioFilePool {
+struct AudioFileBlock {
     float*   buffer[2];
-    uint32_t startFrame;
-    uint32_t size;
+    uint64_t startFrame;
+    uint32_t seekId;
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
-    AudioFilePool()
+    AudioFileBlock()
         : buffer{nullptr},
           startFrame(0),
-          size(0) {}
+          seekId(0) {}
 #else
-    AudioFilePool()
+    AudioFileBlock()
         : startFrame(0),
-          size(0)
+          seekId(0)
     {
         buffer[0] = buffer[1] = nullptr;
     }
 #endif
 
-    ~AudioFilePool()
+    ~AudioFileBlock()
     {
         CARLA_ASSERT(buffer[0] == nullptr);
         CARLA_ASSERT(buffer[1] == nullptr);
-        CARLA_ASSERT(startFrame == 0);
-        CARLA_ASSERT(size == 0);
     }
 
-    void create(const uint32_t sampleRate)
+    void create(const uint32_t frames)
     {
         CARLA_ASSERT(buffer[0] == nullptr);
         CARLA_ASSERT(buffer[1] == nullptr);
-        CARLA_ASSERT(startFrame == 0);
-        CARLA_ASSERT(size == 0);
-
-        size = sampleRate * 2;
-
-        buffer[0] = new float[size];
-        buffer[1] = new float[size];
 
-        reset();
+        buffer[0] = new float[frames];
+        buffer[1] = new float[frames];
     }
 
     void destroy()
     {
         CARLA_ASSERT(buffer[0] != nullptr);
         CARLA_ASSERT(buffer[1] != nullptr);
-        CARLA_ASSERT(size != 0);
 
         if (buffer[0] != nullptr)
         {
@@ -87,51 +76,39 @@ struct AudioFilePool {
             delete[] buffer[1];
             buffer[1] = nullptr;
         }
-
-        startFrame = 0;
-        size = 0;
     }
 
-    void reset()
-    {
-        CARLA_ASSERT(size != 0);
-
-        startFrame = 0;
-        carla_zeroFloat(buffer[0], size);
-        carla_zeroFloat(buffer[1], size);
-    }
+    CARLA_DECLARE_NON_COPYABLE(AudioFileBlock)
 };
 
-class AbstractAudioPlayer
-{
-public:
-    virtual ~AbstractAudioPlayer() {}
-    virtual uint32_t getLastFrame() const = 0;
-};
+// -----------------------------------------------------------------------
+// Streams a file through a ring of decoded blocks.
+// The reader thread is the only producer and keeps the ring filled ahead of the playhead,
+// the audio thread is the only consumer and reads the blocks in place, nothing is copied
+// between the two. Seeks are requested by the audio thread and tagged with an id,
+// so blocks decoded for an old position are simply dropped.
 
 class AudioFileThread : public QThread
 {
 public:
-    AudioFileThread(AbstractAudioPlayer* const player, const double sampleRate)
+    static const uint32_t kBlockFrames = 8192;
+    static const uint32_t kBlockCount  = 16; // must be a power of 2
+
+    AudioFileThread()
         : QThread(nullptr),
-          kPlayer(player),
-          fNeedsRead(false),
           fQuitNow(true),
-          fFilePtr(nullptr)
+          fLoopMode(false),
+          fCache(AudioFileCache::getInstance()),
+          fEntry(nullptr),
+          fWritePos(0),
+          fReadPos(0),
+          fSeekId(0),
+          fSeekFrame(0),
+          fServedSeekId(0),
+          fNextFrame(0)
     {
-        CARLA_ASSERT(kPlayer != nullptr);
-
-        static bool adInitiated = false;
-
-        if (! adInitiated)
-        {
-            ad_init();
-            adInitiated = true;
-        }
-
-        ad_clear_nfo(&fFileNfo);
-
-        fPool.create(sampleRate);
+        for (uint32_t i=0; i < kBlockCount; ++i)
+            fBlocks[i].create(kBlockFrames);
     }
 
     ~AudioFileThread() override
@@ -139,39 +116,38 @@ public:
         CARLA_ASSERT(fQuitNow);
         CARLA_ASSERT(! isRunning());
 
-        if (fFilePtr != nullptr)
-            ad_close(fFilePtr);
+        if (fEntry != nullptr)
+            fCache.release(fEntry);
 
-        fPool.destroy();
+        for (uint32_t i=0; i < kBlockCount; ++i)
+            fBlocks[i].destroy();
     }
 
     void startNow()
     {
-        fNeedsRead = true;
         fQuitNow = false;
         start(IdlePriority);
     }
 
     void stopNow()
     {
-        fNeedsRead = false;
         fQuitNow = true;
 
         if (isRunning() && ! wait(1000))
             terminate();
 
-        const CarlaMutex::ScopedLocker sl(fMutex);
-        fPool.reset();
+        // nothing else touches the ring now
+        fWritePos = fReadPos = 0;
     }
 
-    uint32_t getMaxFrame() const
+    uint64_t getMaxFrame() const
     {
-        return fFileNfo.frames > 0 ? fFileNfo.frames : 0;
+        return fEntry != nullptr ? fEntry->frames : 0;
     }
 
-    void setNeedsRead()
+    void setLoopMode(const bool loopMode)
     {
-        fNeedsRead = true;
+        fLoopMode = loopMode;
     }
 
     bool loadFilename(const char* const filename)
@@ -179,211 +155,202 @@ public:
         CARLA_ASSERT(! isRunning());
         CARLA_ASSERT(filename != nullptr);
 
-        fPool.startFrame = 0;
-
         // clear old data
-        if (fFilePtr != nullptr)
+        fDecoder.close();
+
+        if (fEntry != nullptr)
         {
-            ad_close(fFilePtr);
-            fFilePtr = nullptr;
+            fCache.release(fEntry);
+            fEntry = nullptr;
         }
 
-        ad_clear_nfo(&fFileNfo);
+        // open new, shared with other instances using the same file
+        fEntry = fCache.acquire(filename);
 
-        // open new
-        fFilePtr = ad_open(filename, &fFileNfo);
-
-        if (fFilePtr == nullptr)
+        if (fEntry == nullptr)
             return false;
 
-        ad_dump_nfo(99, &fFileNfo);
+        // prefetch the start of the file, instant if it was cached already
+        fWritePos = fReadPos = 0;
+        fSeekFrame = fNextFrame = 0;
+        fServedSeekId = fSeekId;
 
-        if (fFileNfo.frames == 0)
-            carla_stderr("L: filename \"%s\" has 0 frames", filename);
+        while (fWritePos < kBlockCount)
+            readBlock();
 
-        if ((fFileNfo.channels == 1 || fFileNfo.channels == 2) && fFileNfo.frames > 0)
-        {
-            // valid
-            readPoll();
-            return true;
-        }
-        else
-        {
-            // invalid
-            ad_clear_nfo(&fFileNfo);
-            ad_close(fFilePtr);
-            fFilePtr = nullptr;
-            return false;
-        }
+        return true;
     }
 
-    void tryPutData(AudioFilePool& pool)
-    {
-        CARLA_ASSERT(pool.size == fPool.size);
+    // -------------------------------------------------------------------
+    // audio thread side
 
-        if (pool.size != fPool.size)
-            return;
-        if (! fMutex.tryLock())
-            return;
+    // Fill the outputs starting at transport 'frame'.
+    // Frames not decoded yet are silent; a seek is requested if the reader is elsewhere.
+    void getData(float* const out1, float* const out2, const uint64_t frame, const uint32_t frames)
+    {
+        uint32_t done = 0;
 
-        //if (pool.startFrame != fPool.startFrame || pool.buffer[0] != fPool.buffer[0] || pool.buffer[1] != fPool.buffer[1])
+        while (done < frames)
         {
-            pool.startFrame = fPool.startFrame;
-            carla_copyFloat(pool.buffer[0], fPool.buffer[0], fPool.size);
-            carla_copyFloat(pool.buffer[1], fPool.buffer[1], fPool.size);
+            const AudioFileBlock* const block(locate(frame+done));
+
+            if (block == nullptr)
+                break;
+
+            const uint32_t offset(static_cast<uint32_t>(frame + done - block->startFrame));
+            const uint32_t count(std::min(kBlockFrames - offset, frames - done));
+
+            carla_copyFloat(out1 + done, block->buffer[0] + offset, count);
+            carla_copyFloat(out2 + done, block->buffer[1] + offset, count);
+            done += count;
+
+            if (offset + count == kBlockFrames)
+                releaseBlock();
         }
 
-        fMutex.unlock();
+        if (done < frames)
+        {
+            carla_zeroFloat(out1 + done, frames - done);
+            carla_zeroFloat(out2 + done, frames - done);
+        }
     }
 
-    void readPoll()
+    // Make sure 'frame' is (or will soon be) in the ring, used while the transport is stopped.
+    void prefetch(const uint64_t frame)
     {
-        if (fFileNfo.frames <= 0 || fFilePtr == nullptr)
-        {
-            carla_stderr("R: no song loaded");
-            fNeedsRead = false;
-            return;
-        }
+        locate(frame);
+    }
 
-        int64_t lastFrame = kPlayer->getLastFrame();
-        int64_t readFrame = lastFrame;
-        int64_t maxFrame  = fFileNfo.frames;
+    // Drop everything and start decoding at 'frame'. Safe from any thread.
+    void seek(const uint64_t frame)
+    {
+        fSeekFrame = frame;
+        __sync_synchronize();
+        __sync_add_and_fetch(&fSeekId, 1);
+    }
 
-        if (lastFrame >= maxFrame)
+protected:
+    void run() override
+    {
+        while (! fQuitNow)
         {
-#if 0
-            if (false)
-            //if (handlePtr->loopMode)
+            const uint32_t seekId(fSeekId);
+
+            if (seekId != fServedSeekId)
             {
-                carla_stderr("R: DEBUG read loop, lastFrame:%i, maxFrame:%i", lastFrame, maxFrame);
-
-                if (maxFrame >= static_cast<int64_t>(fPool.size))
-                {
-                    readFrame %= maxFrame;
-                }
-                else
-                {
-                    readFrame  = 0;
-                    lastFrame -= lastFrame % maxFrame;
-                }
+                __sync_synchronize();
+                fNextFrame    = fSeekFrame;
+                fServedSeekId = seekId;
             }
+
+            if (fWritePos - fReadPos < kBlockCount && (fLoopMode || fNextFrame < getMaxFrame()))
+                readBlock();
             else
-#endif
-            {
-                carla_stderr("R: transport out of bounds");
-                fNeedsRead = false;
-                return;
-            }
+                carla_msleep(5);
         }
+    }
 
-        // temp data buffer
-        const size_t tmpSize = fPool.size * fFileNfo.channels;
+private:
+    volatile bool fQuitNow;
+    volatile bool fLoopMode;
 
-        float tmpData[tmpSize];
-        carla_zeroFloat(tmpData, tmpSize);
+    AudioFileCache&         fCache;
+    AudioFileCache::Entry*  fEntry;
+    AudioFileCache::Decoder fDecoder;
 
-        {
-            carla_stderr("R: poll data - reading at %li:%02li", readFrame/44100/60, (readFrame/44100) % 60);
+    AudioFileBlock fBlocks[kBlockCount];
 
-            ad_seek(fFilePtr, readFrame);
-            ssize_t i, j, rv = ad_read(fFilePtr, tmpData, tmpSize);
-            i = j = 0;
+    // ring positions, write is owned by the reader and read by the audio thread
+    volatile uint32_t fWritePos;
+    volatile uint32_t fReadPos;
 
-            // lock, and put data asap
-            const CarlaMutex::ScopedLocker sl(fMutex);
+    // seek requests, from the audio thread to the reader
+    volatile uint32_t fSeekId;
+    volatile uint64_t fSeekFrame;
 
-            for (; i < fPool.size && j < rv; ++j)
-            {
-                if (fFileNfo.channels == 1)
-                {
-                    fPool.buffer[0][i] = tmpData[j];
-                    fPool.buffer[1][i] = tmpData[j];
-                    i++;
-                }
-                else
-                {
-                    if (j % 2 == 0)
-                    {
-                        fPool.buffer[0][i] = tmpData[j];
-                    }
-                    else
-                    {
-                        fPool.buffer[1][i] = tmpData[j];
-                        i++;
-                    }
-                }
-            }
+    // reader state, read-only for the audio thread
+    volatile uint32_t fServedSeekId;
+    volatile uint64_t fNextFrame;
 
-#if 0
-            if (false)
-            //if (handlePtr->loopMode && i < fPool.size)
-            {
-                while (i < fPool.size)
-                {
-                    for (j=0; i < fPool.size && j < rv; ++j)
-                    {
-                        if (fFileNfo.channels == 1)
-                        {
-                            fPool.buffer[0][i] = tmpData[j];
-                            fPool.buffer[1][i] = tmpData[j];
-                            i++;
-                        }
-                        else
-                        {
-                            if (j % 2 == 0)
-                            {
-                                fPool.buffer[0][i] = tmpData[j];
-                            }
-                            else
-                            {
-                                fPool.buffer[1][i] = tmpData[j];
-                                i++;
-                            }
-                        }
-                    }
-                }
-            }
-            else
-#endif
+    // Returns the block holding 'frame', dropping stale and already played blocks on the way.
+    const AudioFileBlock* locate(const uint64_t frame)
+    {
+        const uint32_t seekId(fSeekId);
+
+        for (; fReadPos != fWritePos;)
+        {
+            __sync_synchronize();
+            const AudioFileBlock& block(fBlocks[fReadPos & (kBlockCount-1)]);
+
+            if (block.seekId != seekId || frame >= block.startFrame + kBlockFrames)
             {
-                for (; i < fPool.size; ++i)
-                {
-                    fPool.buffer[0][i] = 0.0f;
-                    fPool.buffer[1][i] = 0.0f;
-                }
+                releaseBlock();
+                continue;
             }
 
-            fPool.startFrame = lastFrame;
+            if (frame >= block.startFrame)
+                return &block;
+
+            // playhead went back
+            break;
         }
 
-        fNeedsRead = false;
+        // wait if the reader is already on its way to this frame, seek otherwise
+        if (fServedSeekId == seekId && (frame < fNextFrame || frame >= fNextFrame + kBlockFrames))
+            seek(frame);
+
+        return nullptr;
     }
 
-protected:
-    void run() override
+    void releaseBlock()
     {
-        while (! fQuitNow)
+        __sync_synchronize();
+        fReadPos = fReadPos + 1;
+    }
+
+    // -------------------------------------------------------------------
+    // reader side
+
+    void readBlock()
+    {
+        AudioFileBlock& block(fBlocks[fWritePos & (kBlockCount-1)]);
+
+        const uint64_t maxFrame(getMaxFrame());
+
+        block.seekId     = fServedSeekId;
+        block.startFrame = fNextFrame;
+
+        uint64_t fileFrame = fLoopMode ? fNextFrame % maxFrame : fNextFrame;
+        uint32_t filled    = 0;
+
+        while (filled < kBlockFrames && fileFrame < maxFrame)
         {
-            const uint32_t lastFrame(kPlayer->getLastFrame());
+            const uint32_t readFrames(fCache.read(fEntry, fDecoder, fileFrame, block.buffer[0] + filled, block.buffer[1] + filled, kBlockFrames - filled));
 
-            if (fNeedsRead || lastFrame < fPool.startFrame || (lastFrame - fPool.startFrame >= fPool.size*3/4 && lastFrame < fFileNfo.frames))
-                readPoll();
-            else
-                carla_msleep(50);
+            if (readFrames == 0)
+                break;
+
+            filled    += readFrames;
+            fileFrame += readFrames;
+
+            // wrap around within the same block, so loops are seamless
+            if (fLoopMode && fileFrame >= maxFrame)
+                fileFrame = 0;
         }
-    }
 
-private:
-    AbstractAudioPlayer* const kPlayer;
+        if (filled < kBlockFrames)
+        {
+            carla_zeroFloat(block.buffer[0] + filled, kBlockFrames - filled);
+            carla_zeroFloat(block.buffer[1] + filled, kBlockFrames - filled);
+        }
 
-    bool fNeedsRead;
-    bool fQuitNow;
+        fNextFrame += kBlockFrames;
 
-    void*  fFilePtr;
-    ADInfo fFileNfo;
+        __sync_synchronize();
+        fWritePos = fWritePos + 1;
+    }
 
-    AudioFilePool fPool;
-    CarlaMutex    fMutex;
+    CARLA_DECLARE_NON_COPYABLE(AudioFileThread)
 };
 
 #endif // __AUDIO_BASE_HPP__
@@ -0,0 +1,830 @@
+/*
+ * Carla Native Plugins
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __AUDIO_CACHE_HPP__
+#define __AUDIO_CACHE_HPP__
+
+#include "CarlaMutex.hpp"
+#include "RtList.hpp"
+
+// from rtmempool/list.h, clashes with AudioFileThread::prefetch()
+#undef prefetch
+
+#include <sys/stat.h>
+
+#ifndef CARLA_OS_WIN
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+extern "C" {
+#include "audio_decoder/ad.h"
+}
+
+typedef struct adinfo ADInfo;
+
+// -----------------------------------------------------------------------
+// Process-wide cache of decoded audio files, shared by all audiofile instances.
+// Short files are decoded once into memory, uncompressed WAV/AIFF files are read
+// straight from a read-only mapping, and anything else is decoded on demand into pages.
+// Pages and unused files are evicted least-recently-used first when over the memory budget.
+// The budget is 256 MiB, CARLA_AUDIOFILE_CACHE_SIZE (in MiB) overrides it.
+
+class AudioFileCache
+{
+public:
+    static const uint32_t kPageFrames       = 65536;
+    static const uint64_t kPreloadMaxFrames = 48000*30;
+
+    enum EntryType {
+        kEntryPreloaded,
+        kEntryMapped,
+        kEntryPaged
+    };
+
+    struct Page {
+        float*   buffer[2];
+        uint64_t lastUse;
+
+        Page()
+            : lastUse(0)
+        {
+            buffer[0] = new float[kPageFrames];
+            buffer[1] = new float[kPageFrames];
+        }
+
+        ~Page()
+        {
+            delete[] buffer[0];
+            delete[] buffer[1];
+        }
+
+        CARLA_DECLARE_NON_COPYABLE(Page)
+    };
+
+    struct Entry {
+        const char* filename;
+        off_t       fileSize;
+        time_t      fileTime;
+
+        EntryType type;
+        uint32_t  channels;
+        uint64_t  frames;
+        int       refCount;
+        uint64_t  lastUse;
+
+        // kEntryPreloaded
+        float* buffer[2];
+
+        // kEntryMapped
+        void*          mapData;
+        size_t         mapSize;
+        const uint8_t* samples;
+        uint32_t       sampleBytes;
+        bool           sampleFloat;
+        bool           bigEndian;
+
+        // kEntryPaged, guarded by the cache mutex
+        Page**   pages;
+        uint32_t pageCount;
+
+        Entry(const char* const filename_)
+            : filename(carla_strdup(filename_)),
+              fileSize(0),
+              fileTime(0),
+              type(kEntryPreloaded),
+              channels(0),
+              frames(0),
+              refCount(1),
+              lastUse(0),
+              mapData(nullptr),
+              mapSize(0),
+              samples(nullptr),
+              sampleBytes(0),
+              sampleFloat(false),
+              bigEndian(false),
+              pages(nullptr),
+              pageCount(0)
+        {
+            buffer[0] = buffer[1] = nullptr;
+        }
+
+        ~Entry()
+        {
+            delete[] filename;
+
+            if (buffer[0] != nullptr)
+                delete[] buffer[0];
+            if (buffer[1] != nullptr)
+                delete[] buffer[1];
+
+#ifndef CARLA_OS_WIN
+            if (mapData != nullptr)
+                munmap(mapData, mapSize);
+#endif
+
+            if (pages != nullptr)
+            {
+                for (uint32_t i=0; i < pageCount; ++i)
+                {
+                    if (pages[i] != nullptr)
+                        delete pages[i];
+                }
+
+                delete[] pages;
+            }
+        }
+
+        CARLA_DECLARE_NON_COPYABLE(Entry)
+    };
+
+    // Decoder state owned by each reader, only opened for paged entries.
+    struct Decoder {
+        void*    filePtr;
+        uint64_t filePos;
+        float*   buffer;
+
+        Decoder()
+            : filePtr(nullptr),
+              filePos(0),
+              buffer(nullptr) {}
+
+        ~Decoder()
+        {
+            close();
+
+            if (buffer != nullptr)
+            {
+                delete[] buffer;
+                buffer = nullptr;
+            }
+        }
+
+        void close()
+        {
+            if (filePtr != nullptr)
+            {
+                ad_close(filePtr);
+                filePtr = nullptr;
+            }
+        }
+
+        CARLA_DECLARE_NON_COPYABLE(Decoder)
+    };
+
+    static AudioFileCache& getInstance()
+    {
+        static AudioFileCache cache;
+        return cache;
+    }
+
+    // -------------------------------------------------------------------
+
+    Entry* acquire(const char* const filename)
+    {
+        CARLA_ASSERT(filename != nullptr);
+
+        struct stat st;
+
+        if (filename == nullptr || ::stat(filename, &st) != 0)
+            return nullptr;
+
+        {
+            const CarlaMutex::ScopedLocker sl(fMutex);
+
+            if (Entry* const entry = findEntry(filename, st))
+                return entry;
+        }
+
+        // not cached, open it without holding the lock
+        Entry* const entry(new Entry(filename));
+        entry->fileSize = st.st_size;
+        entry->fileTime = st.st_mtime;
+
+        if (! (mapFile(entry) || decodeFile(entry)))
+        {
+            delete entry;
+            return nullptr;
+        }
+
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        // another instance might have loaded the same file meanwhile, keep only one
+        if (Entry* const oldEntry = findEntry(filename, st))
+        {
+            delete entry;
+            return oldEntry;
+        }
+
+        entry->lastUse = ++fUseCounter;
+        fEntries.append(entry);
+        fUsedBytes += getEntrySize(entry);
+        trim();
+
+        return entry;
+    }
+
+    void release(Entry* const entry)
+    {
+        CARLA_ASSERT(entry != nullptr);
+        CARLA_ASSERT(entry->refCount > 0);
+
+        if (entry == nullptr)
+            return;
+
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        if (--entry->refCount > 0)
+            return;
+
+        // mappings cost nothing to reopen, decoded data stays around for the next load
+        if (entry->type == kEntryMapped)
+            removeEntry(entry);
+        else
+            trim();
+    }
+
+    // Reads up to 'frames' from 'frame' onwards, returns the number of frames read.
+    // Called from the reader threads, never from the audio thread.
+    uint32_t read(Entry* const entry, Decoder& decoder, const uint64_t frame, float* const out1, float* const out2, const uint32_t frames)
+    {
+        CARLA_ASSERT(entry != nullptr);
+
+        if (entry == nullptr || frame >= entry->frames || frames == 0)
+            return 0;
+
+        uint32_t count(static_cast<uint32_t>(std::min<uint64_t>(frames, entry->frames - frame)));
+
+        switch (entry->type)
+        {
+        case kEntryPreloaded:
+            carla_copyFloat(out1, entry->buffer[0] + frame, count);
+            carla_copyFloat(out2, entry->buffer[1] + frame, count);
+            return count;
+
+        case kEntryMapped:
+            convertSamples(entry, frame, out1, out2, count);
+            return count;
+
+        case kEntryPaged:
+            break;
+        }
+
+        const uint32_t pageIndex(static_cast<uint32_t>(frame / kPageFrames));
+        const uint32_t pageOffset(static_cast<uint32_t>(frame % kPageFrames));
+
+        count = std::min(count, kPageFrames - pageOffset);
+
+        if (copyFromPage(entry, pageIndex, pageOffset, out1, out2, count))
+            return count;
+
+        // page miss, decode it outside the lock
+        Page* const page(decodePage(entry, decoder, pageIndex));
+
+        if (page == nullptr)
+            return 0;
+
+        {
+            const CarlaMutex::ScopedLocker sl(fMutex);
+
+            if (entry->pages[pageIndex] == nullptr)
+            {
+                entry->pages[pageIndex] = page;
+                fUsedBytes += sizeof(float)*kPageFrames*2;
+            }
+            else
+            {
+                // another reader got here first
+                delete page;
+            }
+        }
+
+        if (! copyFromPage(entry, pageIndex, pageOffset, out1, out2, count))
+            return 0;
+
+        const CarlaMutex::ScopedLocker sl(fMutex);
+        trim();
+
+        return count;
+    }
+
+private:
+    CarlaMutex       fMutex;
+    NonRtList<Entry*> fEntries;
+    uint64_t         fUseCounter;
+    size_t           fUsedBytes;
+    size_t           fBudget;
+
+    AudioFileCache()
+        : fUseCounter(0),
+          fUsedBytes(0),
+          fBudget(256*1024*1024)
+    {
+        ad_init();
+
+        if (const char* const sizeStr = getenv("CARLA_AUDIOFILE_CACHE_SIZE"))
+        {
+            const int size(std::atoi(sizeStr));
+
+            if (size > 0)
+                fBudget = static_cast<size_t>(size)*1024*1024;
+        }
+    }
+
+    ~AudioFileCache()
+    {
+        for (NonRtList<Entry*>::Itenerator it = fEntries.begin(); it.valid(); it.next())
+            delete *it;
+
+        fEntries.clear();
+    }
+
+    // -------------------------------------------------------------------
+
+    static size_t getEntrySize(const Entry* const entry)
+    {
+        switch (entry->type)
+        {
+        case kEntryPreloaded:
+            return sizeof(float)*entry->frames*2;
+        case kEntryMapped:
+            return 0;
+        case kEntryPaged:
+            break;
+        }
+
+        size_t size = 0;
+
+        for (uint32_t i=0; i < entry->pageCount; ++i)
+        {
+            if (entry->pages[i] != nullptr)
+                size += sizeof(float)*kPageFrames*2;
+        }
+
+        return size;
+    }
+
+    // Returns a referenced entry if 'filename' is cached and unchanged on disk, must be locked.
+    Entry* findEntry(const char* const filename, const struct stat& st)
+    {
+        for (NonRtList<Entry*>::Itenerator it = fEntries.begin(); it.valid(); it.next())
+        {
+            Entry* const entry(*it);
+
+            if (std::strcmp(entry->filename, filename) != 0)
+                continue;
+
+            if (entry->fileSize != st.st_size || entry->fileTime != st.st_mtime)
+            {
+                // file changed on disk
+                if (entry->refCount == 0)
+                {
+                    fUsedBytes -= getEntrySize(entry);
+                    fEntries.remove(it);
+                    delete entry;
+                }
+                continue;
+            }
+
+            ++entry->refCount;
+            entry->lastUse = ++fUseCounter;
+            carla_debug("AudioFileCache::findEntry(\"%s\") - cache hit", filename);
+            return entry;
+        }
+
+        return nullptr;
+    }
+
+    void removeEntry(Entry* const entry)
+    {
+        fUsedBytes -= getEntrySize(entry);
+        fEntries.removeOne(entry);
+        delete entry;
+    }
+
+    // Evict least recently used pages and unused files until under budget, must be locked.
+    void trim()
+    {
+        while (fUsedBytes > fBudget)
+        {
+            Entry*   oldestEntry = nullptr;
+            uint32_t oldestPage  = 0;
+            uint64_t oldestUse   = UINT64_MAX;
+
+            for (NonRtList<Entry*>::Itenerator it = fEntries.begin(); it.valid(); it.next())
+            {
+                Entry* const entry(*it);
+
+                if (entry->type == kEntryPaged)
+                {
+                    for (uint32_t i=0; i < entry->pageCount; ++i)
+                    {
+                        if (entry->pages[i] != nullptr && entry->pages[i]->lastUse < oldestUse)
+                        {
+                            oldestEntry = entry;
+                            oldestPage  = i;
+                            oldestUse   = entry->pages[i]->lastUse;
+                        }
+                    }
+                }
+                else if (entry->type == kEntryPreloaded && entry->refCount == 0 && entry->lastUse < oldestUse)
+                {
+                    oldestEntry = entry;
+                    oldestUse   = entry->lastUse;
+                }
+            }
+
+            if (oldestEntry == nullptr)
+                break;
+
+            if (oldestEntry->type == kEntryPaged)
+            {
+                delete oldestEntry->pages[oldestPage];
+                oldestEntry->pages[oldestPage] = nullptr;
+                fUsedBytes -= sizeof(float)*kPageFrames*2;
+            }
+            else
+            {
+                removeEntry(oldestEntry);
+            }
+        }
+
+        // drop unused paged files that have nothing left in memory
+        for (NonRtList<Entry*>::Itenerator it = fEntries.begin(); it.valid(); it.next())
+        {
+            Entry* const entry(*it);
+
+            if (entry->type == kEntryPaged && entry->refCount == 0 && getEntrySize(entry) == 0)
+            {
+                fEntries.remove(it);
+                delete entry;
+            }
+        }
+    }
+
+    bool copyFromPage(Entry* const entry, const uint32_t pageIndex, const uint32_t pageOffset, float* const out1, float* const out2, const uint32_t frames)
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        Page* const page(entry->pages[pageIndex]);
+
+        if (page == nullptr)
+            return false;
+
+        page->lastUse = ++fUseCounter;
+        carla_copyFloat(out1, page->buffer[0] + pageOffset, frames);
+        carla_copyFloat(out2, page->buffer[1] + pageOffset, frames);
+        return true;
+    }
+
+    // -------------------------------------------------------------------
+    // decoding
+
+    // Reads up to 'frames' from the decoder's current position into split buffers.
+    static uint64_t decodeFrames(void* const filePtr, const uint32_t channels, float* const tmpBuffer, const uint32_t tmpFrames,
+                                 float* const out1, float* const out2, const uint64_t frames)
+    {
+        uint64_t done = 0;
+
+        while (done < frames)
+        {
+            const uint32_t toRead(static_cast<uint32_t>(std::min<uint64_t>(tmpFrames, frames - done)));
+            const ssize_t  rv(ad_read(filePtr, tmpBuffer, toRead*channels));
+            const uint32_t readFrames(rv > 0 ? static_cast<uint32_t>(rv)/channels : 0);
+
+            if (readFrames == 0)
+                break;
+
+            if (channels == 1)
+            {
+                carla_copyFloat(out1 + done, tmpBuffer, readFrames);
+                carla_copyFloat(out2 + done, tmpBuffer, readFrames);
+            }
+            else
+            {
+                float* const bufs[2] = { out1 + done, out2 + done };
+                carla_deinterleaveFloat(bufs, tmpBuffer, 2, readFrames);
+            }
+
+            done += readFrames;
+        }
+
+        return done;
+    }
+
+    // Opens a file through the decoder, small files are decoded right away.
+    bool decodeFile(Entry* const entry)
+    {
+        ADInfo nfo;
+        ad_clear_nfo(&nfo);
+
+        void* const filePtr(ad_open(entry->filename, &nfo));
+
+        if (filePtr == nullptr)
+            return false;
+
+        ad_dump_nfo(99, &nfo);
+
+        if (nfo.frames <= 0 || (nfo.channels != 1 && nfo.channels != 2))
+        {
+            carla_stderr("AudioFileCache: \"%s\" has %i channels and %li frames, cannot use it", entry->filename, nfo.channels, (long)nfo.frames);
+            ad_close(filePtr);
+            return false;
+        }
+
+        entry->channels = nfo.channels;
+        entry->frames   = nfo.frames;
+
+        if (entry->frames <= kPreloadMaxFrames && sizeof(float)*entry->frames*2 <= fBudget/4)
+        {
+            entry->type      = kEntryPreloaded;
+            entry->buffer[0] = new float[entry->frames];
+            entry->buffer[1] = new float[entry->frames];
+
+            float* const tmpBuffer(new float[kPageFrames*2]);
+            const uint64_t done(decodeFrames(filePtr, entry->channels, tmpBuffer, kPageFrames, entry->buffer[0], entry->buffer[1], entry->frames));
+            delete[] tmpBuffer;
+
+            if (done < entry->frames)
+            {
+                carla_zeroFloat(entry->buffer[0] + done, entry->frames - done);
+                carla_zeroFloat(entry->buffer[1] + done, entry->frames - done);
+            }
+        }
+        else
+        {
+            entry->type      = kEntryPaged;
+            entry->pageCount = static_cast<uint32_t>((entry->frames + kPageFrames - 1) / kPageFrames);
+            entry->pages     = new Page*[entry->pageCount];
+
+            for (uint32_t i=0; i < entry->pageCount; ++i)
+                entry->pages[i] = nullptr;
+        }
+
+        ad_close(filePtr);
+        return true;
+    }
+
+    Page* decodePage(Entry* const entry, Decoder& decoder, const uint32_t pageIndex)
+    {
+        if (decoder.filePtr == nullptr)
+        {
+            ADInfo nfo;
+            ad_clear_nfo(&nfo);
+
+            decoder.filePtr = ad_open(entry->filename, &nfo);
+            decoder.filePos = 0;
+
+            if (decoder.filePtr == nullptr)
+                return nullptr;
+        }
+
+        if (decoder.buffer == nullptr)
+            decoder.buffer = new float[kPageFrames*2];
+
+        const uint64_t startFrame(static_cast<uint64_t>(pageIndex)*kPageFrames);
+
+        if (decoder.filePos != startFrame)
+            ad_seek(decoder.filePtr, startFrame);
+
+        Page* const page(new Page());
+        const uint64_t done(decodeFrames(decoder.filePtr, entry->channels, decoder.buffer, kPageFrames, page->buffer[0], page->buffer[1], kPageFrames));
+
+        if (done == 0)
+        {
+            // position unknown now
+            decoder.filePos = entry->frames+1;
+            delete page;
+            return nullptr;
+        }
+
+        if (done < kPageFrames)
+        {
+            carla_zeroFloat(page->buffer[0] + done, kPageFrames - done);
+            carla_zeroFloat(page->buffer[1] + done, kPageFrames - done);
+        }
+
+        decoder.filePos = startFrame + done;
+        return page;
+    }
+
+    // -------------------------------------------------------------------
+    // uncompressed files
+
+    static uint32_t readLE(const uint8_t* const data, const uint32_t bytes)
+    {
+        uint32_t value = 0;
+
+        for (uint32_t i=0; i < bytes; ++i)
+            value |= static_cast<uint32_t>(data[i]) << (8*i);
+
+        return value;
+    }
+
+    static uint32_t readBE(const uint8_t* const data, const uint32_t bytes)
+    {
+        uint32_t value = 0;
+
+        for (uint32_t i=0; i < bytes; ++i)
+            value = (value << 8) | data[i];
+
+        return value;
+    }
+
+    // Maps WAV and AIFF files with 16, 24 or 32-bit PCM or 32-bit float samples.
+    bool mapFile(Entry* const entry)
+    {
+#ifdef CARLA_OS_WIN
+        // unused
+        (void)entry;
+        return false;
+#else
+        if (entry->fileSize < 44)
+            return false;
+
+        const int fd(::open(entry->filename, O_RDONLY));
+
+        if (fd < 0)
+            return false;
+
+        const size_t mapSize(static_cast<size_t>(entry->fileSize));
+        void* const mapData(mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0));
+        ::close(fd);
+
+        if (mapData == MAP_FAILED)
+            return false;
+
+        const uint8_t* const data((const uint8_t*)mapData);
+
+        entry->mapData = mapData;
+        entry->mapSize = mapSize;
+
+        bool ok;
+
+        if (std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data+8, "WAVE", 4) == 0)
+            ok = parseWave(entry, data, mapSize);
+        else if (std::memcmp(data, "FORM", 4) == 0 && std::memcmp(data+8, "AIFF", 4) == 0)
+            ok = parseAiff(entry, data, mapSize);
+        else
+            ok = false;
+
+        if (! ok || entry->frames == 0 || (entry->channels != 1 && entry->channels != 2))
+        {
+            munmap(mapData, mapSize);
+            entry->mapData = nullptr;
+            entry->mapSize = 0;
+            entry->samples = nullptr;
+            entry->frames  = 0;
+            return false;
+        }
+
+        entry->type = kEntryMapped;
+        madvise(mapData, mapSize, MADV_SEQUENTIAL);
+        carla_debug("AudioFileCache: mapped \"%s\", %u channels, %u bytes per sample", entry->filename, entry->channels, entry->sampleBytes);
+        return true;
+#endif
+    }
+
+    static bool parseWave(Entry* const entry, const uint8_t* const data, const size_t size)
+    {
+        bool hasFormat = false;
+
+        for (size_t pos = 12; pos + 8 <= size;)
+        {
+            const uint8_t* const chunk(data + pos);
+            size_t chunkSize(readLE(chunk+4, 4));
+
+            // streamed files may have a bogus size, the data chunk can be cut short
+            if (pos + 8 + chunkSize > size)
+            {
+                if (std::memcmp(chunk, "data", 4) != 0)
+                    return false;
+
+                chunkSize = size - pos - 8;
+            }
+
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+            {
+                uint32_t format(readLE(chunk+8, 2));
+
+                // WAVE_FORMAT_EXTENSIBLE, the real format is at the start of the sub-format GUID
+                if (format == 0xFFFE && chunkSize >= 40)
+                    format = readLE(chunk+32, 2);
+
+                entry->channels    = readLE(chunk+10, 2);
+                entry->sampleBytes = readLE(chunk+22, 2)/8;
+                entry->sampleFloat = (format == 3);
+
+                if (format != 1 && format != 3)
+                    return false;
+                if (entry->sampleFloat ? entry->sampleBytes != 4 : (entry->sampleBytes < 2 || entry->sampleBytes > 4))
+                    return false;
+                if (readLE(chunk+20, 2) != entry->channels*entry->sampleBytes)
+                    return false;
+
+                hasFormat = true;
+            }
+            else if (std::memcmp(chunk, "data", 4) == 0 && hasFormat && entry->channels > 0)
+            {
+                entry->samples = chunk + 8;
+                entry->frames  = chunkSize / (entry->channels*entry->sampleBytes);
+                return true;
+            }
+
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+
+        return false;
+    }
+
+    static bool parseAiff(Entry* const entry, const uint8_t* const data, const size_t size)
+    {
+        bool hasFormat = false;
+
+        entry->bigEndian = true;
+
+        for (size_t pos = 12; pos + 8 <= size;)
+        {
+            const uint8_t* const chunk(data + pos);
+            const size_t chunkSize(readBE(chunk+4, 4));
+
+            if (pos + 8 + chunkSize > size)
+                return false;
+
+            if (std::memcmp(chunk, "COMM", 4) == 0 && chunkSize >= 18)
+            {
+                entry->channels    = readBE(chunk+8, 2);
+                entry->frames      = readBE(chunk+10, 4);
+                entry->sampleBytes = (readBE(chunk+14, 2)+7)/8;
+
+                if (entry->sampleBytes < 2 || entry->sampleBytes > 4)
+                    return false;
+
+                hasFormat = true;
+            }
+            else if (std::memcmp(chunk, "SSND", 4) == 0 && hasFormat && chunkSize >= 8)
+            {
+                const size_t offset(readBE(chunk+8, 4));
+                const size_t dataSize(chunkSize - 8 - std::min<size_t>(offset, chunkSize - 8));
+
+                entry->samples = chunk + 16 + offset;
+                entry->frames  = std::min<uint64_t>(entry->frames, dataSize / (entry->channels*entry->sampleBytes));
+                return (entry->channels > 0);
+            }
+
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+
+        return false;
+    }
+
+    static float convertSample(const Entry* const entry, const uint8_t* const data)
+    {
+        const uint32_t bytes(entry->sampleBytes);
+
+        // left-align the sample so all integer sizes share one scale
+        const uint32_t value((entry->bigEndian ? readBE(data, bytes) : readLE(data, bytes)) << (32 - 8*bytes));
+
+        if (entry->sampleFloat)
+        {
+            float fvalue;
+            std::memcpy(&fvalue, &value, sizeof(float));
+            return fvalue;
+        }
+
+        return static_cast<float>(static_cast<int32_t>(value)) / 2147483648.0f;
+    }
+
+    static void convertSamples(const Entry* const entry, const uint64_t frame, float* const out1, float* const out2, const uint32_t frames)
+    {
+        const uint32_t frameBytes(entry->channels*entry->sampleBytes);
+        const uint8_t* data(entry->samples + frame*frameBytes);
+
+        for (uint32_t i=0; i < frames; ++i, data += frameBytes)
+        {
+            out1[i] = convertSample(entry, data);
+            out2[i] = (entry->channels == 2) ? convertSample(entry, data + entry->sampleBytes) : out1[i];
+        }
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(AudioFileCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // __AUDIO_CACHE_HPP__
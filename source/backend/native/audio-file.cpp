@@ -22,40 +22,29 @@
 
 #define PROGRAM_COUNT 16
 
-class AudioFilePlugin : public PluginDescriptorClass,
-                        public AbstractAudioPlayer
+class AudioFilePlugin : public PluginDescriptorClass
 {
 public:
     AudioFilePlugin(const HostDescriptor* const host)
         : PluginDescriptorClass(host),
-          AbstractAudioPlayer(),
           fLoopMode(false),
           fDoProcess(false),
-          fLastFrame(0),
+          fNextFrame(0),
           fMaxFrame(0),
-          fThread(this, getSampleRate())
-    {
-        fPool.create(getSampleRate());
-    }
+          fThread() {}
 
     ~AudioFilePlugin() override
     {
-        fPool.destroy();
         fThread.stopNow();
     }
 
-    uint32_t getLastFrame() const override
-    {
-        return fLastFrame;
-    }
-
 protected:
     // -------------------------------------------------------------------
     // Plugin parameter calls
 
     uint32_t getParameterCount() override
     {
-        return 0; // TODO - loopMode
+        return 1;
     }
 
     const Parameter* getParameterInfo(const uint32_t index) override
@@ -68,7 +57,7 @@ protected:
         param.name  = "Loop Mode";
         param.unit  = nullptr;
         param.hints = static_cast<ParameterHints>(PARAMETER_IS_ENABLED|PARAMETER_IS_BOOLEAN);
-        param.ranges.def = 1.0f;
+        param.ranges.def = 0.0f;
         param.ranges.min = 0.0f;
         param.ranges.max = 1.0f;
         param.ranges.step = 1.0f;
@@ -102,7 +91,10 @@ protected:
             return;
 
         fLoopMode = b;
-        fThread.setNeedsRead();
+        fThread.setLoopMode(b);
+
+        // blocks past the end of the file are now wrong
+        fThread.seek(fNextFrame);
     }
 
     void setCustomData(const char* const key, const char* const value) override
@@ -126,64 +118,41 @@ protected:
         if (! fDoProcess)
         {
             //carla_stderr("P: no process");
-            fLastFrame = timePos->frame;
+            fNextFrame = timePos->frame;
             carla_zeroFloat(out1, frames);
             carla_zeroFloat(out2, frames);
             return;
         }
 
-        // not playing
+        // not playing, have the data ready for when it starts
         if (! timePos->playing)
         {
             //carla_stderr("P: not playing");
-            fLastFrame = timePos->frame;
+            if (timePos->frame != fNextFrame)
+            {
+                fNextFrame = timePos->frame;
 
-            if (timePos->frame == 0 && fLastFrame > 0)
-                fThread.setNeedsRead();
+                if (fLoopMode || fNextFrame < fMaxFrame)
+                    fThread.prefetch(fNextFrame);
+            }
 
             carla_zeroFloat(out1, frames);
             carla_zeroFloat(out2, frames);
             return;
         }
 
-        fThread.tryPutData(fPool);
-
         // out of reach
-        if (timePos->frame + frames < fPool.startFrame || timePos->frame >= fMaxFrame) /*&& ! loopMode)*/
+        if (timePos->frame >= fMaxFrame && ! fLoopMode)
         {
             //carla_stderr("P: out of reach");
-            fLastFrame = timePos->frame;
-
-            if (timePos->frame + frames < fPool.startFrame)
-                fThread.setNeedsRead();
-
+            fNextFrame = timePos->frame + frames;
             carla_zeroFloat(out1, frames);
             carla_zeroFloat(out2, frames);
             return;
         }
 
-        int64_t poolFrame = (int64_t)timePos->frame - fPool.startFrame;
-        int64_t poolSize  = fPool.size;
-
-        for (uint32_t i=0; i < frames; ++i, ++poolFrame)
-        {
-            if (poolFrame >= 0 && poolFrame < poolSize)
-            {
-                out1[i] = fPool.buffer[0][poolFrame];
-                out2[i] = fPool.buffer[1][poolFrame];
-
-                // reset
-                fPool.buffer[0][poolFrame] = 0.0f;
-                fPool.buffer[1][poolFrame] = 0.0f;
-            }
-            else
-            {
-                out1[i] = 0.0f;
-                out2[i] = 0.0f;
-            }
-        }
-
-        fLastFrame = timePos->frame;
+        fThread.getData(out1, out2, timePos->frame, frames);
+        fNextFrame = timePos->frame + frames;
     }
 
     // -------------------------------------------------------------------
@@ -204,10 +173,9 @@ private:
     bool fLoopMode;
     bool fDoProcess;
 
-    uint32_t fLastFrame;
-    uint32_t fMaxFrame;
+    uint64_t fNextFrame;
+    uint64_t fMaxFrame;
 
-    AudioFilePool   fPool;
     AudioFileThread fThread;
 
     void loadFilename(const char* const filename)
@@ -215,6 +183,7 @@ private:
         CARLA_ASSERT(filename != nullptr);
         carla_debug("AudioFilePlugin::loadFilename(\"%s\")", filename);
 
+        fDoProcess = false;
         fThread.stopNow();
 
         if (filename == nullptr || *filename == '\0')
@@ -250,7 +219,7 @@ static const PluginDescriptor audiofileDesc = {
     /* audioOuts */ 2,
     /* midiIns   */ 0,
     /* midiOuts  */ 0,
-    /* paramIns  */ 0, // TODO - loopMode
+    /* paramIns  */ 1,
     /* paramOuts */ 0,
     /* name      */ "Audio File",
     /* label     */ "audiofile",
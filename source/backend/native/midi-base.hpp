@@ -52,43 +52,97 @@ public:
     virtual void writeMidiEvent(const uint32_t timePosFrame, const RawMidiEvent* const event) = 0;
 };
 
+// -----------------------------------------------------------------------
+// A time-sorted, read-only array of events, as seen by the audio thread.
+
+struct RawMidiEventArray {
+    RawMidiEvent* events;
+    uint32_t      count;
+
+    RawMidiEventArray(const uint32_t count_)
+        : events(count_ > 0 ? new RawMidiEvent[count_] : nullptr),
+          count(count_) {}
+
+    ~RawMidiEventArray()
+    {
+        if (events != nullptr)
+            delete[] events;
+    }
+
+    // index of the first event at or after 'time'
+    uint32_t find(const uint32_t time) const
+    {
+        uint32_t low = 0, high = count;
+
+        while (low < high)
+        {
+            const uint32_t mid((low + high) / 2);
+
+            if (events[mid].time < time)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        return low;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(RawMidiEventArray)
+};
+
+// -----------------------------------------------------------------------
+// Events are added off the audio thread into an edit buffer, and only become
+// audible after commit(), which sorts them into a new array and hands it over
+// to play() with an atomic pointer swap. play() keeps a cursor into the array,
+// so each cycle costs only the events it outputs, plus a binary search on seek.
+
 class MidiPattern
 {
 public:
     MidiPattern(AbstractMidiPlayer* const player)
         : kPlayer(player),
-          fStartTime(0),
-          fDuration(0)
+          fEditEvents(nullptr),
+          fEditCount(0),
+          fEditSize(0),
+          fActive(nullptr),
+          fPending(nullptr),
+          fRetired(nullptr),
+          fCursor(0),
+          fNextFrame(0)
     {
         CARLA_ASSERT(kPlayer != nullptr);
     }
 
     ~MidiPattern()
     {
-        fData.clear();
+        if (fEditEvents != nullptr)
+            delete[] fEditEvents;
+
+        if (fActive != nullptr)
+            delete fActive;
+        if (fPending != nullptr)
+            delete fPending;
+        if (fRetired != nullptr)
+            delete fRetired;
     }
 
     void addControl(const uint32_t time, const uint8_t channel, const uint8_t control, const uint8_t value)
     {
-        RawMidiEvent* ctrlEvent(new RawMidiEvent());
-        ctrlEvent->data[0] = MIDI_STATUS_CONTROL_CHANGE | (channel & 0x0F);
-        ctrlEvent->data[1] = control;
-        ctrlEvent->data[2] = value;
-        ctrlEvent->size    = 3;
-        ctrlEvent->time    = time;
-
-        append(ctrlEvent);
+        RawMidiEvent& ctrlEvent(append());
+        ctrlEvent.data[0] = MIDI_STATUS_CONTROL_CHANGE | (channel & 0x0F);
+        ctrlEvent.data[1] = control;
+        ctrlEvent.data[2] = value;
+        ctrlEvent.size    = 3;
+        ctrlEvent.time    = time;
     }
 
     void addChannelPressure(const uint32_t time, const uint8_t channel, const uint8_t pressure)
     {
-        RawMidiEvent* pressureEvent(new RawMidiEvent());
-        pressureEvent->data[0] = MIDI_STATUS_AFTERTOUCH | (channel & 0x0F);
-        pressureEvent->data[1] = pressure;
-        pressureEvent->size    = 2;
-        pressureEvent->time    = time;
-
-        append(pressureEvent);
+        RawMidiEvent& pressureEvent(append());
+        pressureEvent.data[0] = MIDI_STATUS_AFTERTOUCH | (channel & 0x0F);
+        pressureEvent.data[1] = pressure;
+        pressureEvent.size    = 2;
+        pressureEvent.time    = time;
     }
 
     void addNote(const uint32_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity, const uint32_t duration)
@@ -99,141 +153,172 @@ public:
 
     void addNoteOn(const uint32_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity)
     {
-        RawMidiEvent* noteOnEvent(new RawMidiEvent());
-        noteOnEvent->data[0] = MIDI_STATUS_NOTE_ON | (channel & 0x0F);
-        noteOnEvent->data[1] = pitch;
-        noteOnEvent->data[2] = velocity;
-        noteOnEvent->size    = 3;
-        noteOnEvent->time    = time;
-
-        append(noteOnEvent);
+        RawMidiEvent& noteOnEvent(append());
+        noteOnEvent.data[0] = MIDI_STATUS_NOTE_ON | (channel & 0x0F);
+        noteOnEvent.data[1] = pitch;
+        noteOnEvent.data[2] = velocity;
+        noteOnEvent.size    = 3;
+        noteOnEvent.time    = time;
     }
 
     void addNoteOff(const uint32_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity = 0)
     {
-        RawMidiEvent* noteOffEvent(new RawMidiEvent());
-        noteOffEvent->data[0] = MIDI_STATUS_NOTE_OFF | (channel & 0x0F);
-        noteOffEvent->data[1] = pitch;
-        noteOffEvent->data[2] = velocity;
-        noteOffEvent->size    = 3;
-        noteOffEvent->time    = time;
-
-        append(noteOffEvent);
+        RawMidiEvent& noteOffEvent(append());
+        noteOffEvent.data[0] = MIDI_STATUS_NOTE_OFF | (channel & 0x0F);
+        noteOffEvent.data[1] = pitch;
+        noteOffEvent.data[2] = velocity;
+        noteOffEvent.size    = 3;
+        noteOffEvent.time    = time;
     }
 
     void addNoteAftertouch(const uint32_t time, const uint8_t channel, const uint8_t pitch, const uint8_t pressure)
     {
-        RawMidiEvent* noteAfterEvent(new RawMidiEvent());
-        noteAfterEvent->data[0] = MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & 0x0F);
-        noteAfterEvent->data[1] = pitch;
-        noteAfterEvent->data[2] = pressure;
-        noteAfterEvent->size    = 3;
-        noteAfterEvent->time    = time;
-
-        append(noteAfterEvent);
+        RawMidiEvent& noteAfterEvent(append());
+        noteAfterEvent.data[0] = MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & 0x0F);
+        noteAfterEvent.data[1] = pitch;
+        noteAfterEvent.data[2] = pressure;
+        noteAfterEvent.size    = 3;
+        noteAfterEvent.time    = time;
     }
 
     void addProgram(const uint32_t time, const uint8_t channel, const uint8_t bank, const uint8_t program)
     {
-        RawMidiEvent* bankEvent(new RawMidiEvent());
-        bankEvent->data[0] = MIDI_STATUS_CONTROL_CHANGE | (channel & 0x0F);
-        bankEvent->data[1] = MIDI_CONTROL_BANK_SELECT;
-        bankEvent->data[2] = bank;
-        bankEvent->size    = 3;
-        bankEvent->time    = time;
-
-        RawMidiEvent* programEvent(new RawMidiEvent());
-        programEvent->data[0] = MIDI_STATUS_PROGRAM_CHANGE | (channel & 0x0F);
-        programEvent->data[1] = program;
-        programEvent->size    = 2;
-        programEvent->time    = time;
-
-        append(bankEvent);
-        append(programEvent);
+        RawMidiEvent& bankEvent(append());
+        bankEvent.data[0] = MIDI_STATUS_CONTROL_CHANGE | (channel & 0x0F);
+        bankEvent.data[1] = MIDI_CONTROL_BANK_SELECT;
+        bankEvent.data[2] = bank;
+        bankEvent.size    = 3;
+        bankEvent.time    = time;
+
+        RawMidiEvent& programEvent(append());
+        programEvent.data[0] = MIDI_STATUS_PROGRAM_CHANGE | (channel & 0x0F);
+        programEvent.data[1] = program;
+        programEvent.size    = 2;
+        programEvent.time    = time;
     }
 
     void addPitchbend(const uint32_t time, const uint8_t channel, const uint8_t lsb, const uint8_t msb)
     {
-        RawMidiEvent* pressureEvent(new RawMidiEvent());
-        pressureEvent->data[0] = MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & 0x0F);
-        pressureEvent->data[1] = lsb;
-        pressureEvent->data[2] = msb;
-        pressureEvent->size    = 3;
-        pressureEvent->time    = time;
-
-        append(pressureEvent);
+        RawMidiEvent& pressureEvent(append());
+        pressureEvent.data[0] = MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & 0x0F);
+        pressureEvent.data[1] = lsb;
+        pressureEvent.data[2] = msb;
+        pressureEvent.size    = 3;
+        pressureEvent.time    = time;
     }
 
     void addRaw(const uint32_t time, const uint8_t* data, const uint8_t size)
     {
-        RawMidiEvent* rawEvent(new RawMidiEvent());
-        rawEvent->size    = size;
-        rawEvent->time    = time;
+        CARLA_ASSERT(size <= MAX_EVENT_DATA_SIZE);
 
-        carla_copy<uint8_t>(rawEvent->data, data, size);
+        if (size > MAX_EVENT_DATA_SIZE)
+            return;
+
+        RawMidiEvent& rawEvent(append());
+        rawEvent.size = size;
+        rawEvent.time = time;
 
-        append(rawEvent);
+        carla_copy<uint8_t>(rawEvent.data, data, size);
     }
 
-    void play(uint32_t timePosFrame, uint32_t frames)
+    // Clear the edit buffer, the events being played stay until the next commit().
+    void clear()
     {
-        if (! fMutex.tryLock())
-            return;
+        fEditCount = 0;
+    }
 
-        for (NonRtList<const RawMidiEvent*>::Itenerator it = fData.begin(); it.valid(); it.next())
-        {
-            const RawMidiEvent* const rawMidiEvent(*it);
+    // Publish the edit buffer to the audio thread, never blocks play().
+    void commit()
+    {
+        // free the array play() let go of last time
+        if (RawMidiEventArray* const retired = __sync_lock_test_and_set(&fRetired, (RawMidiEventArray*)nullptr))
+            delete retired;
 
-            if (timePosFrame > rawMidiEvent->time)
-                continue;
-            if (timePosFrame + frames <= rawMidiEvent->time)
-                continue;
+        RawMidiEventArray* const data(new RawMidiEventArray(fEditCount));
 
-            kPlayer->writeMidiEvent(timePosFrame, rawMidiEvent);
+        if (fEditCount > 0)
+        {
+            carla_copy<RawMidiEvent>(data->events, fEditEvents, fEditCount);
+            std::stable_sort(data->events, data->events + fEditCount, compareEvents);
         }
 
-        fMutex.unlock();
+        __sync_synchronize();
+
+        // not picked up by play() yet, safe to delete
+        if (RawMidiEventArray* const oldPending = __sync_lock_test_and_set(&fPending, data))
+            delete oldPending;
     }
 
-    void clear()
+    void play(const uint32_t timePosFrame, const uint32_t frames)
     {
-        const CarlaMutex::ScopedLocker sl(fMutex);
-        fData.clear();
+        if (fPending != nullptr && fRetired == nullptr)
+        {
+            if (RawMidiEventArray* const data = __sync_lock_test_and_set(&fPending, (RawMidiEventArray*)nullptr))
+            {
+                fRetired = fActive;
+                fActive  = data;
+                fCursor  = data->find(timePosFrame);
+            }
+        }
+
+        if (fActive == nullptr)
+            return;
+
+        // transport moved, relocate
+        if (timePosFrame != fNextFrame)
+            fCursor = fActive->find(timePosFrame);
+
+        const uint32_t endFrame(timePosFrame + frames);
+
+        for (; fCursor < fActive->count && fActive->events[fCursor].time < endFrame; ++fCursor)
+            kPlayer->writeMidiEvent(timePosFrame, &fActive->events[fCursor]);
+
+        fNextFrame = endFrame;
     }
 
 private:
     AbstractMidiPlayer* const kPlayer;
 
-    uint32_t fStartTime; // unused
-    uint32_t fDuration;  // unused
+    // edit side, not used by the audio thread
+    RawMidiEvent* fEditEvents;
+    uint32_t      fEditCount;
+    uint32_t      fEditSize;
 
-    CarlaMutex fMutex;
-    NonRtList<const RawMidiEvent*> fData;
+    // owned by play(), pending and retired are the handover points
+    RawMidiEventArray* fActive;
+    RawMidiEventArray* volatile fPending;
+    RawMidiEventArray* volatile fRetired;
+    uint32_t fCursor;
+    uint32_t fNextFrame;
 
-    void append(const RawMidiEvent* const event)
+    static bool compareEvents(const RawMidiEvent& a, const RawMidiEvent& b)
     {
-        if (fData.isEmpty())
-        {
-            const CarlaMutex::ScopedLocker sl(fMutex);
-            fData.append(event);
-            return;
-        }
+        return a.time < b.time;
+    }
 
-        for (NonRtList<const RawMidiEvent*>::Itenerator it = fData.begin(); it.valid(); it.next())
+    RawMidiEvent& append()
+    {
+        if (fEditCount == fEditSize)
         {
-            const RawMidiEvent* const oldEvent(*it);
+            const uint32_t newSize(fEditSize > 0 ? fEditSize*2 : MIN_PREALLOCATED_EVENT_COUNT);
+            RawMidiEvent* const newEvents(new RawMidiEvent[newSize]);
 
-            if (event->time >= oldEvent->time)
-                continue;
+            if (fEditEvents != nullptr)
+            {
+                carla_copy<RawMidiEvent>(newEvents, fEditEvents, fEditCount);
+                delete[] fEditEvents;
+            }
 
-            const CarlaMutex::ScopedLocker sl(fMutex);
-            fData.insertAt(event, it);
-            return;
+            fEditEvents = newEvents;
+            fEditSize   = newSize;
         }
 
-        const CarlaMutex::ScopedLocker sl(fMutex);
-        fData.append(event);
+        RawMidiEvent& event(fEditEvents[fEditCount++]);
+        event = RawMidiEvent();
+        return event;
     }
+
+    CARLA_DECLARE_NON_COPYABLE(MidiPattern)
 };
 
 #endif // __MIDI_BASE_HPP__
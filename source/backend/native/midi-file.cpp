@@ -210,6 +210,8 @@ private:
 
             smf_delete(smf);
         }
+
+        fMidiOut.commit();
     }
 
     PluginDescriptorClassEND(MidiFilePlugin)
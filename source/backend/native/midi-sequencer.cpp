@@ -118,6 +118,8 @@ public:
         fMidiOut.addNote(2304*m, 0, 64, 90, 650*m);
         fMidiOut.addNote(3072*m, 0, 62, 90, 325*m);
         fMidiOut.addNote(3456*m, 0, 62, 90, 325*m);
+
+        fMidiOut.commit();
     }
 
     ~MidiSequencerPlugin() override
@@ -21,8 +21,8 @@
 
 #include "CarlaNative.hpp"
 #include "CarlaMIDI.h"
+#include "CarlaMutex.hpp"
 #include "CarlaString.hpp"
-#include "RtList.hpp"
 
 #include <QtCore/QThread>
 
@@ -51,9 +51,13 @@
 #endif
 
 #include <ctime>
+#include <fstream>
 
 #include <set>
 #include <string>
+#include <vector>
+
+#include <sys/stat.h>
 
 // Dummy variables and functions for linking purposes
 const char* instance_name = nullptr;
@@ -95,6 +99,430 @@ void set_module_parameters(Fl_Widget* o)
 }
 #endif
 
+// -----------------------------------------------------------------------
+// Index of all banks and programs, shared by all plugin instances.
+// Scanning every bank directory can take seconds, so the index is loaded from a cache file and
+// then checked against the bank directories (by their mtime) in a background thread.
+// Without a cache the first instance waits for the full scan, hosts only read the program list once.
+// Programs are numbered as in zyn itself, bank 0 is the default instrument and bank N is banks[N-1].
+
+#define ZYN_BANK_INDEX_VERSION "CarlaZynBankIndex 1"
+
+class ZynBankIndex : public QThread
+{
+public:
+    ZynBankIndex()
+        : fHasCache(false),
+          fScanning(false),
+          fQuit(false) {}
+
+    ~ZynBankIndex() override
+    {
+        CARLA_ASSERT(! fScanning);
+
+        clear();
+    }
+
+    // Called by the first plugin instance, the config must be valid by now
+    void init()
+    {
+        if (fScanning)
+            return;
+
+        fMutex.lock();
+
+        if (fPrograms.size() == 0)
+        {
+            fPrograms.push_back(new ProgramInfo(0, 0, "default"));
+            fHasCache = readCache();
+        }
+
+        const bool hasCache(fHasCache);
+
+        fMutex.unlock();
+
+        fQuit     = false;
+        fScanning = true;
+        start(hasCache ? QThread::LowPriority : QThread::InheritPriority);
+
+        if (! hasCache)
+            wait();
+    }
+
+    // Called when the last plugin instance is gone
+    void stop()
+    {
+        fQuit = true;
+        wait();
+    }
+
+    uint32_t getProgramCount()
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        return fPrograms.size();
+    }
+
+    bool getProgramInfo(const uint32_t index, MidiProgram& midiProgram)
+    {
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        if (index >= fPrograms.size())
+            return false;
+
+        const ProgramInfo* const pInfo(fPrograms[index]);
+
+        midiProgram.bank    = pInfo->bank;
+        midiProgram.program = pInfo->prog;
+        midiProgram.name    = pInfo->name;
+        return true;
+    }
+
+    // Get the directory of a bank (starting at 1), waits if the bank has not been found yet
+    bool getBankDir(const uint32_t bank, std::string& dir)
+    {
+        CARLA_ASSERT(bank > 0);
+
+        if (bank == 0)
+            return false;
+
+        fMutex.lock();
+
+        while (bank > fBanks.size() && fScanning)
+        {
+            fMutex.unlock();
+            carla_msleep(20);
+            fMutex.lock();
+        }
+
+        const bool found(bank <= fBanks.size());
+
+        if (found)
+            dir = fBanks[bank-1].dir;
+
+        fMutex.unlock();
+
+        return found;
+    }
+
+protected:
+    void run() override
+    {
+        const std::vector<DirInfo> roots(getRootDirs());
+
+        fMutex.lock();
+        const bool hadCache(fHasCache);
+        const bool sameRoots(hadCache && roots == fRoots);
+        const std::vector<DirInfo> cachedBanks(fBanks);
+        fMutex.unlock();
+
+        Bank zynBank;
+        std::vector<DirInfo> banks;
+        std::vector<ProgramInfo*> programs;
+        bool changed = ! sameRoots;
+
+        // the bank list only changes when a root directory does
+        if (sameRoots)
+        {
+            banks = cachedBanks;
+        }
+        else
+        {
+            zynBank.rescanforbanks();
+
+            for (size_t i=0, size=zynBank.banks.size(); i < size; ++i)
+            {
+                if (! zynBank.banks[i].dir.empty())
+                    banks.push_back(DirInfo(zynBank.banks[i].dir, zynBank.banks[i].name));
+            }
+        }
+
+        for (uint32_t i=0, size=banks.size(); i < size && ! fQuit; ++i)
+        {
+            DirInfo& bankInfo(banks[i]);
+            const long mtime(getDirTime(bankInfo.dir));
+            std::vector<ProgramInfo*> bankPrograms;
+
+            if (sameRoots && mtime == bankInfo.mtime)
+            {
+                const CarlaMutex::ScopedLocker sl(fMutex);
+
+                for (size_t j=1, count=fPrograms.size(); j < count; ++j)
+                {
+                    if (fPrograms[j]->bank == i+1)
+                        bankPrograms.push_back(new ProgramInfo(i+1, fPrograms[j]->prog, fPrograms[j]->name));
+                }
+            }
+            else
+            {
+                // use zyn's own bank loading, so slots match what Bank::loadfromslot() sees
+                bankInfo.mtime = mtime;
+                changed = true;
+
+                zynBank.loadbank(bankInfo.dir);
+
+                for (uint32_t instrument = 0; instrument < BANK_SIZE; ++instrument)
+                {
+                    const std::string insName(zynBank.getname(instrument));
+
+                    if (insName.empty() || insName[0] == '\0' || insName[0] == ' ')
+                        continue;
+
+                    bankPrograms.push_back(new ProgramInfo(i+1, instrument, insName.c_str()));
+                }
+            }
+
+            if (hadCache)
+            {
+                programs.insert(programs.end(), bankPrograms.begin(), bankPrograms.end());
+            }
+            else
+            {
+                // nothing cached, init() is waiting for us to fill the index
+                const CarlaMutex::ScopedLocker sl(fMutex);
+
+                fBanks.push_back(bankInfo);
+                fPrograms.insert(fPrograms.end(), bankPrograms.begin(), bankPrograms.end());
+            }
+        }
+
+        if (fQuit)
+        {
+            for (size_t i=0, size=programs.size(); i < size; ++i)
+                delete programs[i];
+
+            // no instances left, start from the cache again next time
+            const CarlaMutex::ScopedLocker sl(fMutex);
+            clear();
+            fHasCache = false;
+            fScanning = false;
+            return;
+        }
+
+        fMutex.lock();
+
+        if (hadCache && changed)
+        {
+            // names might still be in use by the host, keep old programs until the end
+            fRetiredPrograms.insert(fRetiredPrograms.end(), fPrograms.begin()+1, fPrograms.end());
+            fPrograms.resize(1);
+            fPrograms.insert(fPrograms.end(), programs.begin(), programs.end());
+            fBanks = banks;
+        }
+        else
+        {
+            for (size_t i=0, size=programs.size(); i < size; ++i)
+                delete programs[i];
+        }
+
+        fRoots    = roots;
+        fHasCache = true;
+
+        if (changed)
+            writeCache();
+
+        fScanning = false;
+        fMutex.unlock();
+
+        carla_debug("ZynBankIndex - %i banks, %i programs%s", int(fBanks.size()), int(fPrograms.size()), changed ? "" : " (cached)");
+    }
+
+private:
+    struct ProgramInfo {
+        uint32_t bank;
+        uint32_t prog;
+        const char* name;
+
+        ProgramInfo(uint32_t bank_, uint32_t prog_, const char* name_)
+          : bank(bank_),
+            prog(prog_),
+            name(carla_strdup(name_)) {}
+
+        ~ProgramInfo()
+        {
+            if (name != nullptr)
+            {
+                delete[] name;
+                name = nullptr;
+            }
+        }
+
+        ProgramInfo() = delete;
+        ProgramInfo(ProgramInfo&) = delete;
+        ProgramInfo(const ProgramInfo&) = delete;
+    };
+
+    // a bank or root directory
+    struct DirInfo {
+        std::string dir;
+        std::string name;
+        long mtime;
+
+        DirInfo(const std::string& dir_, const std::string& name_, const long mtime_ = 0)
+            : dir(dir_),
+              name(name_),
+              mtime(mtime_) {}
+
+        bool operator==(const DirInfo& info) const
+        {
+            return (dir == info.dir && mtime == info.mtime);
+        }
+    };
+
+    CarlaMutex fMutex;
+    std::vector<DirInfo> fRoots;
+    std::vector<DirInfo> fBanks;
+    std::vector<ProgramInfo*> fPrograms;
+    std::vector<ProgramInfo*> fRetiredPrograms;
+
+    bool fHasCache;
+    volatile bool fScanning;
+    volatile bool fQuit;
+
+    void clear()
+    {
+        for (size_t i=0, size=fPrograms.size(); i < size; ++i)
+            delete fPrograms[i];
+        for (size_t i=0, size=fRetiredPrograms.size(); i < size; ++i)
+            delete fRetiredPrograms[i];
+
+        fPrograms.clear();
+        fRetiredPrograms.clear();
+        fBanks.clear();
+        fRoots.clear();
+    }
+
+    static long getDirTime(const std::string& dir)
+    {
+        struct stat st;
+
+        if (stat(dir.c_str(), &st) != 0)
+            return 0;
+
+        return st.st_mtime;
+    }
+
+    static std::vector<DirInfo> getRootDirs()
+    {
+        std::vector<DirInfo> roots;
+
+        for (int i=0; i < MAX_BANK_ROOT_DIRS; ++i)
+        {
+            const std::string& dir(config.cfg.bankRootDirList[i]);
+
+            if (! dir.empty())
+                roots.push_back(DirInfo(dir, "", getDirTime(dir)));
+        }
+
+        return roots;
+    }
+
+    static std::string getCacheDir()
+    {
+        const char* const home(std::getenv("HOME"));
+
+        if (home == nullptr || home[0] == '\0')
+            return std::string();
+
+        return std::string(home) + "/.config/falkTX";
+    }
+
+    // Cache format, one entry per line and tab separated:
+    //  R mtime dir         (root directory)
+    //  B mtime dir name    (bank)
+    //  P bank prog name    (program)
+    bool readCache()
+    {
+        const std::string cacheDir(getCacheDir());
+
+        if (cacheDir.empty())
+            return false;
+
+        std::ifstream file((cacheDir + "/zynaddsubfx_banks.cache").c_str());
+        std::string line;
+
+        if (! (std::getline(file, line) && line == ZYN_BANK_INDEX_VERSION))
+            return false;
+
+        while (std::getline(file, line))
+        {
+            if (line.size() < 3 || line[1] != '\t')
+                continue;
+
+            const size_t sep1(line.find('\t', 2));
+
+            if (sep1 == std::string::npos)
+                continue;
+
+            const long   value(std::atol(line.c_str()+2));
+            const size_t sep2(line.find('\t', sep1+1));
+            const std::string field(line.substr(sep1+1, sep2 == std::string::npos ? std::string::npos : sep2-sep1-1));
+            const std::string name(sep2 == std::string::npos ? std::string() : line.substr(sep2+1));
+
+            switch (line[0])
+            {
+            case 'R':
+                fRoots.push_back(DirInfo(field, "", value));
+                break;
+            case 'B':
+                fBanks.push_back(DirInfo(field, name, value));
+                break;
+            case 'P':
+                if (value > 0 && static_cast<size_t>(value) <= fBanks.size())
+                    fPrograms.push_back(new ProgramInfo(value, std::atoi(field.c_str()), name.c_str()));
+                break;
+            }
+        }
+
+        carla_debug("ZynBankIndex::readCache() - %i banks, %i programs", int(fBanks.size()), int(fPrograms.size()));
+        return true;
+    }
+
+    // Must be called with the mutex locked
+    void writeCache()
+    {
+        const std::string cacheDir(getCacheDir());
+
+        if (cacheDir.empty())
+            return;
+
+        ::mkdir((cacheDir.substr(0, cacheDir.rfind('/'))).c_str(), 0755);
+        ::mkdir(cacheDir.c_str(), 0755);
+
+        // write to a temporary file first, so other hosts never read a partial cache
+        const std::string filename(cacheDir + "/zynaddsubfx_banks.cache");
+        const std::string tmpFilename(filename + ".tmp");
+
+        {
+            std::ofstream file(tmpFilename.c_str());
+
+            if (! file)
+                return;
+
+            file << ZYN_BANK_INDEX_VERSION << "\n";
+
+            for (size_t i=0, size=fRoots.size(); i < size; ++i)
+                file << "R\t" << fRoots[i].mtime << "\t" << fRoots[i].dir << "\n";
+
+            for (size_t i=0, size=fBanks.size(); i < size; ++i)
+                file << "B\t" << fBanks[i].mtime << "\t" << fBanks[i].dir << "\t" << fBanks[i].name << "\n";
+
+            for (size_t i=1, size=fPrograms.size(); i < size; ++i)
+                file << "P\t" << fPrograms[i]->bank << "\t" << fPrograms[i]->prog << "\t" << fPrograms[i]->name << "\n";
+
+            if (! file.good())
+                return;
+        }
+
+        if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+            carla_stderr("ZynBankIndex::writeCache() - failed to save bank cache");
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(ZynBankIndex)
+};
+
+static ZynBankIndex sBankIndex;
+
 class ZynAddSubFxPlugin : public PluginDescriptorClass
 {
 public:
@@ -110,7 +538,6 @@ public:
           fThread(kMaster, host)
     {
         fThread.start();
-        maybeInitPrograms(kMaster);
 
         for (int i = 0; i < NUM_MIDI_PARTS; ++i)
             kMaster->partonoff(i, 1);
@@ -188,22 +615,17 @@ protected:
 
     uint32_t getMidiProgramCount() override
     {
-        return sPrograms.count();
+        return sBankIndex.getProgramCount();
     }
 
     const MidiProgram* getMidiProgramInfo(const uint32_t index) override
     {
         CARLA_ASSERT(index < getMidiProgramCount());
 
-        if (index >= sPrograms.count())
-            return nullptr;
-
-        const ProgramInfo* const pInfo(sPrograms.getAt(index));
-
         static MidiProgram midiProgram;
-        midiProgram.bank    = pInfo->bank;
-        midiProgram.program = pInfo->prog;
-        midiProgram.name    = pInfo->name;
+
+        if (! sBankIndex.getProgramInfo(index, midiProgram))
+            return nullptr;
 
         return &midiProgram;
     }
@@ -227,8 +649,6 @@ protected:
 
     void setMidiProgram(const uint8_t channel, const uint32_t bank, const uint32_t program) override
     {
-        if (bank >= kMaster->bank.banks.size())
-            return;
         if (program >= BANK_SIZE)
             return;
 
@@ -366,30 +786,6 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    struct ProgramInfo {
-        uint32_t bank;
-        uint32_t prog;
-        const char* name;
-
-        ProgramInfo(uint32_t bank_, uint32_t prog_, const char* name_)
-          : bank(bank_),
-            prog(prog_),
-            name(carla_strdup(name_)) {}
-
-        ~ProgramInfo()
-        {
-            if (name != nullptr)
-            {
-                delete[] name;
-                name = nullptr;
-            }
-        }
-
-        ProgramInfo() = delete;
-        ProgramInfo(ProgramInfo&) = delete;
-        ProgramInfo(const ProgramInfo&) = delete;
-    };
-
     class ZynThread : public QThread
     {
     public:
@@ -537,26 +933,23 @@ private:
                 if (fChangeProgram)
                 {
                     fChangeProgram = false;
-                    loadProgram(kMaster, fNextChannel, fNextBank, fNextProgram);
+
+                    // load into a new part here, the audio thread swaps it in without stopping the others
+                    if (Part* const part = createProgramPart(kMaster, fNextChannel, fNextBank, fNextProgram))
+                        kMaster->swapPart(fNextChannel, part);
+
                     fNextChannel = 0;
                     fNextBank    = 0;
                     fNextProgram = 0;
 
-#ifdef WANT_ZYNADDSUBFX_UI
-                    if (fUi != nullptr)
-                    {
-                        Fl::lock();
-                        fUi->refresh_master_ui();
-                        Fl::unlock();
-                    }
-#endif
-
                     carla_msleep(15);
                 }
                 else
                 {
                     carla_msleep(30);
                 }
+
+                freeSwappedParts();
             }
 
 #ifdef WANT_ZYNADDSUBFX_UI
@@ -571,6 +964,38 @@ private:
 #endif
         }
 
+        // Parts replaced by the audio thread (whenever it takes them, even much later if bypassed).
+        // The UI still points to the old parts until refreshed, so only free the ones retired before that.
+        void freeSwappedParts()
+        {
+            bool swapped[NUM_MIDI_PARTS];
+            bool anySwapped = false;
+
+            for (int i=0; i < NUM_MIDI_PARTS; ++i)
+            {
+                swapped[i] = kMaster->isPartSwapped(i);
+                anySwapped = anySwapped || swapped[i];
+            }
+
+            if (! anySwapped)
+                return;
+
+#ifdef WANT_ZYNADDSUBFX_UI
+            if (fUi != nullptr)
+            {
+                Fl::lock();
+                fUi->refresh_master_ui();
+                Fl::unlock();
+            }
+#endif
+
+            for (int i=0; i < NUM_MIDI_PARTS; ++i)
+            {
+                if (swapped[i])
+                    kMaster->freeSwappedPart(i);
+            }
+        }
+
 #ifdef WANT_ZYNADDSUBFX_UI
         void handlePartCounterCallback(Fl_Widget* widget)
         {
@@ -607,42 +1032,52 @@ private:
     ZynThread fThread;
 
     static int sInstanceCount;
-    static NonRtList<ProgramInfo*> sPrograms;
 
-    static void maybeInitPrograms(Master* const master)
+    // Creates a fully loaded part for a program, keeping the current part settings (channel, volume, etc).
+    // This can take a long time (PADsynth), but the master is not locked.
+    // The master's bank is left alone, the UI might be using it.
+    static Part* createProgramPart(Master* const master, const uint8_t channel, const uint32_t bank, const uint32_t program)
     {
-        static bool doSearch = true;
-
-        if (! doSearch)
-            return;
-        doSearch = false;
-
-        sPrograms.append(new ProgramInfo(0, 0, "default"));
-
-        pthread_mutex_lock(&master->mutex);
+        Part* const part(new Part(&master->microtonal, master->fft, &master->mutex));
+        part->defaults();
 
-        // refresh banks
-        master->bank.rescanforbanks();
-
-        for (uint32_t i=0, size = master->bank.banks.size(); i < size; ++i)
+        if (bank > 0)
         {
-            if (master->bank.banks[i].dir.empty())
-                continue;
-
-            master->bank.loadbank(master->bank.banks[i].dir);
+            std::string bankdir;
 
-            for (unsigned int instrument = 0; instrument < BANK_SIZE; ++instrument)
+            if (! sBankIndex.getBankDir(bank, bankdir))
             {
-                const std::string insName(master->bank.getname(instrument));
-
-                if (insName.empty() || insName[0] == '\0' || insName[0] == ' ')
-                    continue;
-
-                sPrograms.append(new ProgramInfo(i+1, instrument, insName.c_str()));
+                delete part;
+                return nullptr;
             }
+
+            Bank zynBank;
+            zynBank.loadbank(bankdir);
+            zynBank.loadfromslot(program, part);
         }
 
-        pthread_mutex_unlock(&master->mutex);
+        const Part* const oldPart(master->part[channel]);
+
+        part->Penabled    = 1;
+        part->setPvolume(oldPart->Pvolume);
+        part->setPpanning(oldPart->Ppanning);
+        part->Pminkey     = oldPart->Pminkey;
+        part->Pmaxkey     = oldPart->Pmaxkey;
+        part->Pkeyshift   = oldPart->Pkeyshift;
+        part->Prcvchn     = oldPart->Prcvchn;
+        part->Pvelsns     = oldPart->Pvelsns;
+        part->Pveloffs    = oldPart->Pveloffs;
+        part->Pnoteon     = oldPart->Pnoteon;
+        part->Ppolymode   = oldPart->Ppolymode;
+        part->Plegatomode = oldPart->Plegatomode;
+        part->Pkeylimit   = oldPart->Pkeylimit;
+        part->ctl         = oldPart->ctl;
+        part->oldvolumel  = oldPart->oldvolumel;
+        part->oldvolumer  = oldPart->oldvolumer;
+
+        part->applyparameters(false);
+
+        return part;
     }
 
     static void loadProgram(Master* const master, const uint8_t channel, const uint32_t bank, const uint32_t program)
@@ -660,9 +1095,9 @@ private:
             return;
         }
 
-        const std::string& bankdir(master->bank.banks[bank-1].dir);
+        std::string bankdir;
 
-        if (! bankdir.empty())
+        if (sBankIndex.getBankDir(bank, bankdir))
         {
             pthread_mutex_lock(&master->mutex);
 
@@ -695,6 +1130,9 @@ public:
             config.cfg.SampleRate      = synth->samplerate;
             config.cfg.GzipCompression = 0;
 
+            // render parts in parallel, keeping some cores for the rest of the host
+            config.cfg.PartThreads = std::max(0, std::min(QThread::idealThreadCount()-1, 3));
+
             sprng(std::time(nullptr));
             denormalkillbuf = new float[synth->buffersize];
             for (int i=0; i < synth->buffersize; ++i)
@@ -702,6 +1140,8 @@ public:
 
             Master::getInstance();
 
+            sBankIndex.init();
+
 #ifdef WANT_ZYNADDSUBFX_UI
             if (gPixmapPath.isEmpty())
             {
@@ -724,6 +1164,8 @@ public:
             CARLA_ASSERT(synth != nullptr);
             CARLA_ASSERT(denormalkillbuf != nullptr);
 
+            sBankIndex.stop();
+
             Master::deleteInstance();
 
             delete[] denormalkillbuf;
@@ -734,30 +1176,11 @@ public:
         }
     }
 
-    static void _clearPrograms()
-    {
-        for (auto it = sPrograms.begin(); it.valid(); it.next())
-        {
-            ProgramInfo* const programInfo(*it);
-            delete programInfo;
-        }
-
-        sPrograms.clear();
-    }
-
 private:
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ZynAddSubFxPlugin)
 };
 
 int ZynAddSubFxPlugin::sInstanceCount = 0;
-NonRtList<ZynAddSubFxPlugin::ProgramInfo*> ZynAddSubFxPlugin::sPrograms;
-
-static const struct ProgramsDestructor {
-    ProgramsDestructor() {}
-    ~ProgramsDestructor() {
-        ZynAddSubFxPlugin::_clearPrograms();
-    }
-} _programsDestructor;
 
 // -----------------------------------------------------------------------
 
@@ -58,6 +58,7 @@ void Config::init()
     cfg.GzipCompression = 3;
 
     cfg.Interpolation = 0;
+    cfg.PartThreads   = 0;
     cfg.CheckPADsynth = 1;
     cfg.IgnoreProgramChange = 0;
 
@@ -181,6 +182,11 @@ void Config::readConfig(const char *filename)
                                            0,
                                            1);
 
+        cfg.PartThreads = xmlcfg.getpar("part_threads",
+                                        cfg.PartThreads,
+                                        0,
+                                        15);
+
         cfg.CheckPADsynth = xmlcfg.getpar("check_pad_synth",
                                           cfg.CheckPADsynth,
                                           0,
@@ -281,6 +287,7 @@ void Config::saveConfig(const char *filename)
         }
 
     xmlcfg->addpar("interpolation", cfg.Interpolation);
+    xmlcfg->addpar("part_threads", cfg.PartThreads);
 
     //linux stuff
     xmlcfg->addparstr("linux_oss_wave_out_dev", cfg.LinuxOSSWaveOutDev);
@@ -43,6 +43,7 @@ class Config
             int   DumpNotesToFile, DumpAppend;
             int   GzipCompression;
             int   Interpolation;
+            int   PartThreads; //extra threads rendering parts, 0 to disable
             std::string DumpFile;
             std::string bankRootDirList[MAX_BANK_ROOT_DIRS], currentBankDir;
             std::string presetsDirList[MAX_BANK_ROOT_DIRS];
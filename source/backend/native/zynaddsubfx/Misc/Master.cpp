@@ -24,6 +24,7 @@
 #include "Master.h"
 
 #include "Part.h"
+#include "Util.h"
 
 #include "../Params/LFOParams.h"
 #include "../Effects/EffectMgr.h"
@@ -40,6 +41,10 @@
 
 using namespace std;
 
+//Below this many samples per cycle parts are always rendered serially,
+//waking the workers would cost more than it saves
+#define PARALLEL_MIN_BUFFERSIZE 128
+
 vuData::vuData(void)
     :outpeakl(0.0f), outpeakr(0.0f), maxoutpeakl(0.0f), maxoutpeakr(0.0f),
       rmspeakl(0.0f), rmspeakr(0.0f), clipped(0)
@@ -65,8 +70,12 @@ Master::Master()
         fakepeakpart[npart]  = 0;
     }
 
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         part[npart] = new Part(&microtonal, fft, &mutex);
+        pendingpart[npart] = NULL;
+        fadingpart[npart]  = NULL;
+        retiredpart[npart] = NULL;
+    }
 
     //Insertion Effects init
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
@@ -76,6 +85,25 @@ Master::Master()
     for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx)
         sysefx[nefx] = new EffectMgr(0, &mutex);
 
+    //Part rendering workers
+    njobs       = 0;
+    nextjob     = 0;
+    nworkers    = 0;
+    workers     = NULL;
+    workquit    = false;
+    workersched = false;
+
+    const int nthreads = limit(config.cfg.PartThreads, 0, NUM_MIDI_PARTS - 1);
+    if(nthreads > 0 && sem_init(&workstart, 0, 0) == 0) {
+        if(sem_init(&workdone, 0, 0) == 0) {
+            workers = new pthread_t[nthreads];
+            for(; nworkers < nthreads; ++nworkers)
+                if(pthread_create(&workers[nworkers], NULL, renderThread, this) != 0)
+                    break;
+        }
+        else
+            sem_destroy(&workstart);
+    }
 
     defaults();
 }
@@ -334,59 +362,28 @@ void Master::AudioOut(float *outl, float *outr)
     memset(outl, 0, synth->bufferbytes);
     memset(outr, 0, synth->bufferbytes);
 
-    //Compute part samples and store them part[npart]->partoutl,partoutr
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
-        if(part[npart]->Penabled != 0 && !pthread_mutex_trylock(&part[npart]->load_mutex)) {
-            part[npart]->ComputePartSmps();
-            pthread_mutex_unlock(&part[npart]->load_mutex);
-        }
-    }
-
-    //Insertion effects
-    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
-        if(Pinsparts[nefx] >= 0) {
-            int efxpart = Pinsparts[nefx];
-            if(part[efxpart]->Penabled)
-                insefx[nefx]->out(part[efxpart]->partoutl,
-                                  part[efxpart]->partoutr);
+    //Take in the parts loaded by swapPart(), the old ones fade out below
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        if(pendingpart[npart] != NULL && retiredpart[npart] == NULL) {
+            Part *newpart = __sync_lock_test_and_set(&pendingpart[npart], (Part *)NULL);
+            if(newpart != NULL) {
+                fadingpart[npart] = part[npart];
+                part[npart] = newpart;
+            }
         }
 
+    //Compute the enabled parts with their insertion effects and volumes,
+    //they only touch their own data so this can run in parallel
+    njobs = 0;
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+        if(part[npart]->Penabled != 0 || fadingpart[npart] != NULL)
+            renderjobs[njobs++] = npart;
 
-    //Apply the part volumes and pannings (after insertion effects)
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
-        if(part[npart]->Penabled == 0)
-            continue;
-
-        Stereo<float> newvol(part[npart]->volume),
-        oldvol(part[npart]->oldvolumel,
-               part[npart]->oldvolumer);
-
-        float pan = part[npart]->panning;
-        if(pan < 0.5f)
-            newvol.l *= pan * 2.0f;
-        else
-            newvol.r *= (1.0f - pan) * 2.0f;
-
-        //the volume or the panning has changed and needs interpolation
-        if(ABOVE_AMPLITUDE_THRESHOLD(oldvol.l, newvol.l)
-           || ABOVE_AMPLITUDE_THRESHOLD(oldvol.r, newvol.r)) {
-            for(int i = 0; i < synth->buffersize; ++i) {
-                Stereo<float> vol(INTERPOLATE_AMPLITUDE(oldvol.l, newvol.l,
-                                                        i, synth->buffersize),
-                                  INTERPOLATE_AMPLITUDE(oldvol.r, newvol.r,
-                                                        i, synth->buffersize));
-                part[npart]->partoutl[i] *= vol.l;
-                part[npart]->partoutr[i] *= vol.r;
-            }
-            part[npart]->oldvolumel = newvol.l;
-            part[npart]->oldvolumer = newvol.r;
-        }
-        else
-            for(int i = 0; i < synth->buffersize; ++i) { //the volume did not changed
-                part[npart]->partoutl[i] *= newvol.l;
-                part[npart]->partoutr[i] *= newvol.r;
-            }
-    }
+    if(nworkers > 0 && njobs > 1 && synth->buffersize >= PARALLEL_MIN_BUFFERSIZE)
+        renderParts();
+    else
+        for(int job = 0; job < njobs; ++job)
+            renderPart(renderjobs[job]);
 
 
     //System effects
@@ -520,13 +517,183 @@ void Master::GetAudioOutSamples(size_t nsamples,
     }
 }
 
+/*
+ * Compute one part, store the samples in part[npart]->partoutl,partoutr
+ * and apply its insertion effects, volume and panning
+ */
+void Master::renderPart(int npart)
+{
+    Part *p = part[npart];
+
+    //each part has its own random generator, so the result
+    //does not depend on which thread renders it
+    prng_t *oldprng = prng_current;
+    prng_current = &p->prngstate;
+
+    if(!pthread_mutex_trylock(&p->load_mutex)) {
+        p->ComputePartSmps();
+        pthread_mutex_unlock(&p->load_mutex);
+    }
+
+    //A part replaced by swapPart() keeps playing for one more block, fading out
+    if(fadingpart[npart] != NULL) {
+        Part *old = fadingpart[npart];
+        prng_current = &old->prngstate;
+
+        if(!pthread_mutex_trylock(&old->load_mutex)) {
+            old->ComputePartSmps();
+            pthread_mutex_unlock(&old->load_mutex);
+
+            for(int i = 0; i < synth->buffersize; ++i) {
+                const float fade = 1.0f - (float)i / synth->buffersize;
+                p->partoutl[i] += old->partoutl[i] * fade;
+                p->partoutr[i] += old->partoutr[i] * fade;
+            }
+        }
+
+        prng_current = &p->prngstate;
+        fadingpart[npart]  = NULL;
+        retiredpart[npart] = old;
+    }
+
+    //Insertion effects, in order
+    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
+        if(Pinsparts[nefx] == npart)
+            insefx[nefx]->out(p->partoutl, p->partoutr);
+
+    prng_current = oldprng;
+
+    //Apply the part volume and panning (after insertion effects)
+    Stereo<float> newvol(p->volume),
+    oldvol(p->oldvolumel,
+           p->oldvolumer);
+
+    float pan = p->panning;
+    if(pan < 0.5f)
+        newvol.l *= pan * 2.0f;
+    else
+        newvol.r *= (1.0f - pan) * 2.0f;
+
+    //the volume or the panning has changed and needs interpolation
+    if(ABOVE_AMPLITUDE_THRESHOLD(oldvol.l, newvol.l)
+       || ABOVE_AMPLITUDE_THRESHOLD(oldvol.r, newvol.r)) {
+        for(int i = 0; i < synth->buffersize; ++i) {
+            Stereo<float> vol(INTERPOLATE_AMPLITUDE(oldvol.l, newvol.l,
+                                                    i, synth->buffersize),
+                              INTERPOLATE_AMPLITUDE(oldvol.r, newvol.r,
+                                                    i, synth->buffersize));
+            p->partoutl[i] *= vol.l;
+            p->partoutr[i] *= vol.r;
+        }
+        p->oldvolumel = newvol.l;
+        p->oldvolumer = newvol.r;
+    }
+    else
+        for(int i = 0; i < synth->buffersize; ++i) { //the volume did not changed
+            p->partoutl[i] *= newvol.l;
+            p->partoutr[i] *= newvol.r;
+        }
+}
+
+/*
+ * Render all queued parts using the workers and the calling thread,
+ * returns once every part is done
+ */
+void Master::renderParts()
+{
+    const int nwake = min(nworkers, njobs - 1);
+
+    //run the workers with the same scheduling as the audio thread,
+    //otherwise they would hold it back
+    if(!workersched) {
+        int policy;
+        sched_param param;
+        if(pthread_getschedparam(pthread_self(), &policy, &param) == 0)
+            for(int i = 0; i < nworkers; ++i)
+                pthread_setschedparam(workers[i], policy, &param);
+        workersched = true;
+    }
+
+    nextjob = 0;
+    __sync_synchronize();
+
+    for(int i = 0; i < nwake; ++i)
+        sem_post(&workstart);
+
+    int job;
+    while((job = __sync_fetch_and_add(&nextjob, 1)) < njobs)
+        renderPart(renderjobs[job]);
+
+    for(int i = 0; i < nwake; ++i)
+        sem_wait(&workdone);
+}
+
+void *Master::renderThread(void *arg)
+{
+    Master *master = (Master *)arg;
+
+    while(true) {
+        sem_wait(&master->workstart);
+        if(master->workquit)
+            break;
+
+        int job;
+        while((job = __sync_fetch_and_add(&master->nextjob, 1)) < master->njobs)
+            master->renderPart(master->renderjobs[job]);
+
+        sem_post(&master->workdone);
+    }
+
+    return NULL;
+}
+
+void Master::swapPart(int npart, Part *newpart)
+{
+    if((npart < 0) || (npart >= NUM_MIDI_PARTS) || (newpart == NULL))
+        return;
+
+    //a previous part that was never taken in can go right away
+    Part *oldpending = __sync_lock_test_and_set(&pendingpart[npart], newpart);
+    if(oldpending != NULL)
+        delete oldpending;
+}
+
+bool Master::isPartSwapped(int npart) const
+{
+    return retiredpart[npart] != NULL;
+}
+
+void Master::freeSwappedPart(int npart)
+{
+    Part *old = __sync_lock_test_and_set(&retiredpart[npart], (Part *)NULL);
+    if(old != NULL)
+        delete old;
+}
+
 Master::~Master()
 {
+    if(nworkers > 0) {
+        workquit = true;
+        for(int i = 0; i < nworkers; ++i)
+            sem_post(&workstart);
+        for(int i = 0; i < nworkers; ++i)
+            pthread_join(workers[i], NULL);
+    }
+    if(workers != NULL) {
+        delete []workers;
+        sem_destroy(&workstart);
+        sem_destroy(&workdone);
+    }
+
     delete []bufl;
     delete []bufr;
 
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         delete part[npart];
+        delete pendingpart[npart];
+        delete fadingpart[npart];
+        delete retiredpart[npart];
+    }
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
         delete insefx[nefx];
     for(int nefx = 0; nefx < NUM_SYS_EFX; ++nefx)
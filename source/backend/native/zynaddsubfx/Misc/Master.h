@@ -24,6 +24,8 @@
 #ifndef MASTER_H
 #define MASTER_H
 #include "../globals.h"
+#include <pthread.h>
+#include <semaphore.h>
 #include "Microtonal.h"
 
 #include "Bank.h"
@@ -114,6 +116,17 @@ class Master
 
         void partonoff(int npart, int what);
 
+        /**Replace a part with an already loaded one at the next block,
+         * the old part fades out during that block. Used for program changes
+         * while running, so the other parts keep playing.
+         * Must not be called from the audio thread.*/
+        void swapPart(int npart, class Part *newpart);
+        /**Whether the audio thread replaced this part, and the old one waits to be freed.
+         * No new part is taken in for it until then.*/
+        bool isPartSwapped(int npart) const;
+        /**Delete the part replaced by swapPart(), outside the audio thread*/
+        void freeSwappedPart(int npart);
+
         /**parts \todo see if this can be made to be dynamic*/
         class Part * part[NUM_MIDI_PARTS];
 
@@ -177,6 +190,26 @@ class Master
         float *bufr;
         off_t  off;
         size_t smps;
+
+        //part rendering, optionally spread over config.cfg.PartThreads workers
+        void renderPart(int npart);
+        void renderParts();
+        static void *renderThread(void *arg);
+
+        //part swapping, pending -> fading (for one block) -> retired -> deleted
+        class Part *volatile pendingpart[NUM_MIDI_PARTS];
+        class Part          *fadingpart[NUM_MIDI_PARTS];
+        class Part *volatile retiredpart[NUM_MIDI_PARTS];
+
+        int          renderjobs[NUM_MIDI_PARTS];
+        int          njobs;
+        volatile int nextjob;
+
+        int           nworkers;
+        pthread_t    *workers;
+        sem_t         workstart, workdone;
+        volatile bool workquit;
+        bool          workersched; //workers follow the audio thread scheduling
 };
 
 #endif
@@ -42,6 +42,7 @@ Part::Part(Microtonal *microtonal_, FFTwrapper *fft_, pthread_mutex_t *mutex_)
     fft      = fft_;
     mutex    = mutex_;
     pthread_mutex_init(&load_mutex, NULL);
+    prngstate = prng();
     partoutl = new float [synth->buffersize];
     partoutr = new float [synth->buffersize];
 
@@ -154,6 +154,8 @@ class Part
         pthread_mutex_t *mutex;
         pthread_mutex_t load_mutex;
 
+        uint32_t prngstate; //random generator state used while rendering this part
+
         int lastnote;
 
     private:
@@ -34,9 +34,11 @@
 #include <errno.h>
 #include <string.h>
 #include <sched.h>
+#include <pthread.h>
 
 
 prng_t prng_state = 0x1234;
+__thread prng_t *prng_current = &prng_state;
 
 Config config;
 float *denormalkillbuf;
@@ -160,28 +162,37 @@ typedef pool_t::iterator        pool_itr_t;
 
 pool_t pool;
 
+//parts may be rendered from several threads at once
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 float *getTmpBuffer()
 {
+    pthread_mutex_lock(&pool_mutex);
     for(pool_itr_t itr = pool.begin(); itr != pool.end(); ++itr)
         if(itr->free) { //Use Pool
             itr->free = false;
+            pthread_mutex_unlock(&pool_mutex);
             return itr->dat;
         }
     pool_entry p; //Extend Pool
     p.free = false;
     p.dat  = new float[synth->buffersize];
     pool.push_back(p);
+    pthread_mutex_unlock(&pool_mutex);
 
     return p.dat;
 }
 
 void returnTmpBuffer(float *buf)
 {
+    pthread_mutex_lock(&pool_mutex);
     for(pool_itr_t itr = pool.begin(); itr != pool.end(); ++itr)
         if(itr->dat == buf) { //Return to Pool
             itr->free = true;
+            pthread_mutex_unlock(&pool_mutex);
             return;
         }
+    pthread_mutex_unlock(&pool_mutex);
     fprintf(stderr,
             "ERROR: invalid buffer returned %s %d\n",
             __FILE__,
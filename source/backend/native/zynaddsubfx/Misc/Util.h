@@ -92,6 +92,10 @@ T limit(T val, T min, T max)
 typedef uint32_t prng_t;
 extern prng_t prng_state;
 
+//State used by the calling thread, points to prng_state unless a part
+//is being rendered (each part has its own, see Master::AudioOut)
+extern __thread prng_t *prng_current;
+
 // Portable Pseudo-Random Number Generator
 inline prng_t prng_r(prng_t &p)
 {
@@ -100,7 +104,7 @@ inline prng_t prng_r(prng_t &p)
 
 inline prng_t prng(void)
 {
-    return prng_r(prng_state) & 0x7fffffff;
+    return prng_r(*prng_current) & 0x7fffffff;
 }
 
 inline void sprng(prng_t p)
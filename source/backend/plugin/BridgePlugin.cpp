@@ -30,6 +30,7 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QProcess>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 
@@ -103,6 +104,284 @@ shm_t shm_mkstemp(char* const fileBase)
     }
 }
 
+// -------------------------------------------------------------------------------------------------------------------
+// Bridge Process
+
+class BridgeProcess;
+
+static CarlaMutex gBridgeProcessMutex;
+static NonRtList<BridgeProcess*> gBridgeProcesses;
+
+/*
+ * A running bridge binary and the control shm it was started with.
+ * Each plugin inside it owns one of the control slots; plugins of the same engine and binary
+ * share a process when OPTION_SHARE_PLUGIN_BRIDGES is set, otherwise each one starts its own.
+ */
+class BridgeProcess : public QThread
+{
+public:
+    BridgeProcess(CarlaEngine* const engine, const char* const binary)
+        : kEngine(engine),
+          kBinary(binary),
+          fProcess(nullptr),
+          fShmData(nullptr),
+          fMemberCount(0)
+    {
+        carla_debug("BridgeProcess::BridgeProcess(%p, \"%s\")", engine, binary);
+
+        carla_shm_init(fShm);
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+            fMembers[i] = nullptr;
+    }
+
+    ~BridgeProcess() override
+    {
+        carla_debug("BridgeProcess::~BridgeProcess()");
+        CARLA_ASSERT(fMemberCount == 0);
+
+        if (fProcess != nullptr)
+        {
+            delete fProcess;
+            fProcess = nullptr;
+        }
+
+        if (fShmData != nullptr)
+        {
+            carla_shm_unmap(fShm, fShmData, sizeof(BridgeShmControl));
+            fShmData = nullptr;
+        }
+
+        if (carla_is_shm_valid(fShm))
+            carla_shm_close(fShm);
+    }
+
+    // -------------------------------------------------------------------
+
+    /*
+     * Find a process the plugin can join, or create a new one that the plugin must start.
+     * Returns the process and the plugin's slot in it, or null if the control shm could not be created.
+     */
+    static BridgeProcess* join(CarlaEngine* const engine, CarlaPlugin* const plugin, const char* const binary, unsigned int& slot)
+    {
+        const CarlaMutex::ScopedLocker sl(gBridgeProcessMutex);
+
+        if (engine->getOptions().sharePluginBridges)
+        {
+            for (NonRtList<BridgeProcess*>::Itenerator it = gBridgeProcesses.begin(); it.valid(); it.next())
+            {
+                BridgeProcess* const process(*it);
+
+                if (process->kEngine != engine || process->kBinary != binary || ! process->isRunning())
+                    continue;
+
+                for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+                {
+                    if (process->fMembers[i] != nullptr)
+                        continue;
+
+                    // drop replies a timed-out previous owner never took
+                    while (sem_trywait(&process->fShmData->plugins[i].runClient) == 0) {}
+
+                    process->fMembers[i] = plugin;
+                    ++process->fMemberCount;
+                    slot = i;
+                    return process;
+                }
+            }
+        }
+
+        BridgeProcess* const process(new BridgeProcess(engine, binary));
+
+        if (! process->initShm())
+        {
+            delete process;
+            return nullptr;
+        }
+
+        process->fMembers[0] = plugin;
+        process->fMemberCount = 1;
+        gBridgeProcesses.append(process);
+        slot = 0;
+        return process;
+    }
+
+    /*
+     * Give back the plugin's slot.
+     * Returns true if it was the last plugin, the caller must then stop the process and delete it.
+     */
+    bool leave(const unsigned int slot)
+    {
+        CARLA_ASSERT(slot < BRIDGE_SHM_PLUGIN_COUNT);
+
+        const CarlaMutex::ScopedLocker sl(gBridgeProcessMutex);
+
+        CARLA_ASSERT(fMembers[slot] != nullptr);
+
+        fMembers[slot] = nullptr;
+
+        if (--fMemberCount != 0)
+            return false;
+
+        gBridgeProcesses.removeOne(this);
+        return true;
+    }
+
+    // another plugin already running in this process, used to reach the bridge over OSC
+    CarlaPlugin* getOtherMember(const unsigned int slot) const
+    {
+        const CarlaMutex::ScopedLocker sl(gBridgeProcessMutex);
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+        {
+            if (i != slot && fMembers[i] != nullptr)
+                return fMembers[i];
+        }
+
+        return nullptr;
+    }
+
+    // -------------------------------------------------------------------
+
+    BridgeShmSlot* getSlot(const unsigned int slot) const
+    {
+        CARLA_ASSERT(slot < BRIDGE_SHM_PLUGIN_COUNT);
+
+        return &fShmData->plugins[slot];
+    }
+
+    // 0 until the bridge attaches to the shared memory
+    int getBridgeVersion() const
+    {
+        return fShmData->bridgeVersion;
+    }
+
+    const char* getShmId() const
+    {
+        return &fShmFilename[fShmFilename.length()-6];
+    }
+
+    void postServer()
+    {
+        sem_post(&fShmData->runServer);
+    }
+
+    void start(const QStringList& arguments)
+    {
+        fArguments = arguments;
+        QThread::start();
+    }
+
+protected:
+    void run() override
+    {
+        carla_debug("BridgeProcess::run()");
+
+        if (fProcess == nullptr)
+        {
+            fProcess = new QProcess(nullptr);
+            fProcess->setProcessChannelMode(QProcess::ForwardedChannels);
+        }
+
+        fProcess->start((const char*)kBinary, fArguments);
+        fProcess->waitForStarted();
+        fProcess->waitForFinished(-1);
+
+        if (fProcess->exitCode() == 0 && fProcess->exitStatus() != QProcess::CrashExit)
+            return;
+
+        carla_stderr("BridgeProcess::run() - bridge crashed");
+
+        // the callbacks may remove plugins, which takes the mutex again
+        unsigned int ids[BRIDGE_SHM_PLUGIN_COUNT];
+        CarlaString names[BRIDGE_SHM_PLUGIN_COUNT];
+        unsigned int count = 0;
+
+        {
+            const CarlaMutex::ScopedLocker sl(gBridgeProcessMutex);
+
+            for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+            {
+                if (fMembers[i] == nullptr)
+                    continue;
+
+                ids[count]   = fMembers[i]->id();
+                names[count] = fMembers[i]->name();
+                ++count;
+            }
+        }
+
+        for (unsigned int i=0; i < count; ++i)
+        {
+            CarlaString errorString("Plugin '" + names[i] + "' has crashed!\n"
+                                    "Saving now will lose its current settings.\n"
+                                    "Please remove this plugin, and not rely on it from this point.");
+            kEngine->callback(CALLBACK_ERROR, ids[i], 0, 0, 0.0f, (const char*)errorString);
+        }
+    }
+
+private:
+    CarlaEngine* const kEngine;
+    const CarlaString  kBinary;
+
+    QProcess*   fProcess;
+    QStringList fArguments;
+
+    CarlaString fShmFilename;
+    BridgeShmControl* fShmData;
+    shm_t fShm;
+
+    CarlaPlugin* fMembers[BRIDGE_SHM_PLUGIN_COUNT];
+    unsigned int fMemberCount;
+
+    bool initShm()
+    {
+        char tmpFileBase[60];
+
+        std::sprintf(tmpFileBase, "/carla-bridge_shc_XXXXXX");
+
+        fShm = shm_mkstemp(tmpFileBase);
+
+        if (! carla_is_shm_valid(fShm))
+        {
+            carla_stdout("Failed to open or create shared memory file #2");
+            return false;
+        }
+
+        fShmFilename = tmpFileBase;
+
+        if (! carla_shm_map<BridgeShmControl>(fShm, fShmData))
+        {
+            carla_stdout("Failed to mmap shared memory file");
+            return false;
+        }
+
+        CARLA_ASSERT(fShmData != nullptr);
+
+        std::memset(fShmData, 0, sizeof(BridgeShmControl));
+        fShmData->version = BRIDGE_SHM_PROTOCOL_VERSION;
+
+        if (sem_init(&fShmData->runServer, 1, 0) != 0)
+        {
+            carla_stdout("Failed to initialize shared memory semaphore #1");
+            return false;
+        }
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+        {
+            if (sem_init(&fShmData->plugins[i].runClient, 1, 0) != 0)
+            {
+                carla_stdout("Failed to initialize shared memory semaphore #2");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BridgeProcess)
+};
+
 // -------------------------------------------------------------------------------------------------------------------
 
 struct BridgeParamInfo {
@@ -126,12 +405,16 @@ public:
           fInitiated(false),
           fInitError(false),
           fSaved(false),
+          fAsyncProcess(false),
+          fProcessPending(false),
+          fEventCount(0),
+          fProcess(nullptr),
+          fSlot(0),
+          fShmSlot(nullptr),
           fParams(nullptr)
     {
         carla_debug("BridgePlugin::BridgePlugin(%p, %i, %s, %s)", engine, id, BinaryType2Str(btype), PluginType2Str(ptype));
 
-        kData->osc.thread.setMode(CarlaPluginThread::PLUGIN_THREAD_BRIDGE);
-
         fHints |= PLUGIN_IS_BRIDGE;
     }
 
@@ -151,27 +434,8 @@ public:
             kData->active = false;
         }
 
-        if (kData->osc.thread.isRunning())
-        {
-            rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeQuit);
-            rdwr_commitWrite(&fShmControl.data->ringBuffer);
-            waitForServer();
-        }
-
-        if (kData->osc.data.target != nullptr)
-        {
-            osc_send_hide(&kData->osc.data);
-            osc_send_quit(&kData->osc.data);
-        }
-
-        kData->osc.data.free();
-
-        // Wait a bit first, then force kill
-        if (kData->osc.thread.isRunning() && ! kData->osc.thread.wait(kData->engine->getOptions().oscUiTimeout))
-        {
-            carla_stderr("Failed to properly stop Plugin Bridge thread");
-            kData->osc.thread.terminate();
-        }
+        if (fProcess != nullptr)
+            leaveProcess();
 
         cleanup();
         clearBuffers();
@@ -336,13 +600,13 @@ public:
         if (doLock)
             kData->singleMutex.lock();
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetParameter);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, parameterId);
-        rdwr_writeFloat(&fShmControl.data->ringBuffer, value);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetParameter);
+        rdwr_writeInt(&fShmSlot->ringBuffer, parameterId);
+        rdwr_writeFloat(&fShmSlot->ringBuffer, value);
 
         if (doLock)
         {
-            rdwr_commitWrite(&fShmControl.data->ringBuffer);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
             kData->singleMutex.unlock();
         }
 
@@ -363,12 +627,12 @@ public:
         if (doLock)
             kData->singleMutex.lock();
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetProgram);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, index);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetProgram);
+        rdwr_writeInt(&fShmSlot->ringBuffer, index);
 
         if (doLock)
         {
-            rdwr_commitWrite(&fShmControl.data->ringBuffer);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
             kData->singleMutex.unlock();
         }
 
@@ -389,12 +653,12 @@ public:
         if (doLock)
             kData->singleMutex.lock();
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetMidiProgram);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, index);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetMidiProgram);
+        rdwr_writeInt(&fShmSlot->ringBuffer, index);
 
         if (doLock)
         {
-            rdwr_commitWrite(&fShmControl.data->ringBuffer);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
             kData->singleMutex.unlock();
         }
 
@@ -460,9 +724,15 @@ public:
 
     void idleGui() override
     {
-        if (! kData->osc.thread.isRunning())
+        if (fProcess == nullptr || ! fProcess->isRunning())
             carla_stderr2("TESTING: Bridge has closed!");
 
+        if (fShmSlot != nullptr)
+        {
+            if (const uint32_t overflows = rdwr_takeOverflows(&fShmSlot->eventRing))
+                carla_stderr2("BridgePlugin::idleGui() - %u events were dropped, the bridge could not keep up", overflows);
+        }
+
         CarlaPlugin::idleGui();
     }
 
@@ -585,6 +855,8 @@ public:
             kData->event.portOut = (CarlaEngineEventPort*)kData->client->addPort(kEnginePortTypeEvent, portName, false);
         }
 
+        fAsyncProcess = kData->engine->getOptions().asyncPluginBridges;
+
         bufferSizeChanged(kData->engine->getBufferSize());
         reloadPrograms(true);
 
@@ -597,20 +869,20 @@ public:
     void activate() override
     {
         // already locked before
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetParameter);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, PARAMETER_ACTIVE);
-        rdwr_writeFloat(&fShmControl.data->ringBuffer, 1.0f);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetParameter);
+        rdwr_writeInt(&fShmSlot->ringBuffer, PARAMETER_ACTIVE);
+        rdwr_writeFloat(&fShmSlot->ringBuffer, 1.0f);
+        rdwr_commitWrite(&fShmSlot->ringBuffer);
         waitForServer();
     }
 
     void deactivate() override
     {
         // already locked before
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetParameter);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, PARAMETER_ACTIVE);
-        rdwr_writeFloat(&fShmControl.data->ringBuffer, 0.0f);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetParameter);
+        rdwr_writeInt(&fShmSlot->ringBuffer, PARAMETER_ACTIVE);
+        rdwr_writeFloat(&fShmSlot->ringBuffer, 0.0f);
+        rdwr_commitWrite(&fShmSlot->ringBuffer);
         waitForServer();
     }
 
@@ -637,6 +909,12 @@ public:
         {
             // TODO
 
+            if (kData->latency > 0)
+            {
+                for (i=0; i < kData->audioIn.count; ++i)
+                    carla_zeroFloat(kData->latencyBuffers[i], kData->latency);
+            }
+
             kData->needsReset = false;
         }
 
@@ -656,18 +934,12 @@ public:
 
                     CARLA_ASSERT(note.channel >= 0 && note.channel < MAX_MIDI_CHANNELS);
 
-                    char data1, data2, data3;
-                    data1  = (note.velo > 0) ? MIDI_STATUS_NOTE_ON : MIDI_STATUS_NOTE_OFF;
-                    data1 += note.channel;
-                    data2  = note.note;
-                    data3  = note.velo;
-
-                    rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeMidiEvent);
-                    rdwr_writeLong(&fShmControl.data->ringBuffer, 0);
-                    rdwr_writeInt(&fShmControl.data->ringBuffer, 3);
-                    rdwr_writeChar(&fShmControl.data->ringBuffer, data1);
-                    rdwr_writeChar(&fShmControl.data->ringBuffer, data2);
-                    rdwr_writeChar(&fShmControl.data->ringBuffer, data3);
+                    uint8_t data[3];
+                    data[0] = (note.velo > 0) ? MIDI_STATUS_NOTE_ON : MIDI_STATUS_NOTE_OFF;
+                    data[1] = note.note;
+                    data[2] = note.velo;
+
+                    writeMidiEvent(0, note.channel, 3, data);
                 }
 
                 kData->extNotes.mutex.unlock();
@@ -754,17 +1026,10 @@ public:
                         }
 
                         // Control plugin parameters
-                        for (k=0; k < kData->param.count; ++k)
-                        {
-                            if (kData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (kData->param.data[k].midiCC != ctrlEvent.param)
-                                continue;
-                            if (kData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((kData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                        const PluginMidiCCMap::Table& ccTable(kData->param.midiCCMap.getTableRT());
 
+                        for (k = ccTable.getFirst(event.channel, ctrlEvent.param); k < kData->param.count; k = ccTable.next[k])
+                        {
                             float value;
 
                             if (kData->param.data[k].hints & PARAMETER_IS_BOOLEAN)
@@ -785,12 +1050,12 @@ public:
 
                         if ((fOptions & PLUGIN_OPTION_SEND_CONTROL_CHANGES) != 0 && ctrlEvent.param <= 0x5F)
                         {
-                            rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeMidiEvent);
-                            rdwr_writeLong(&fShmControl.data->ringBuffer, event.time);
-                            rdwr_writeInt(&fShmControl.data->ringBuffer, 3);
-                            rdwr_writeChar(&fShmControl.data->ringBuffer, MIDI_STATUS_CONTROL_CHANGE + event.channel);
-                            rdwr_writeChar(&fShmControl.data->ringBuffer, ctrlEvent.param);
-                            rdwr_writeChar(&fShmControl.data->ringBuffer, ctrlEvent.value*127.0f);
+                            uint8_t data[3];
+                            data[0] = MIDI_STATUS_CONTROL_CHANGE;
+                            data[1] = ctrlEvent.param;
+                            data[2] = ctrlEvent.value*127.0f;
+
+                            writeMidiEvent(event.time, event.channel, 3, data);
                         }
 
                         break;
@@ -868,18 +1133,13 @@ public:
                     if (status == MIDI_STATUS_NOTE_ON && midiEvent.data[2] == 0)
                         status -= 0x10;
 
-                    char data[4];
-                    data[0] = status + channel;
+                    uint8_t data[4];
+                    data[0] = status;
                     data[1] = midiEvent.data[1];
                     data[2] = midiEvent.data[2];
                     data[3] = midiEvent.data[3];
 
-                    rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeMidiEvent);
-                    rdwr_writeLong(&fShmControl.data->ringBuffer, event.time);
-                    rdwr_writeInt(&fShmControl.data->ringBuffer, midiEvent.size);
-
-                    for (uint8_t j=0; j < midiEvent.size && j < 4; ++j)
-                        rdwr_writeChar(&fShmControl.data->ringBuffer, data[j]);
+                    writeMidiEvent(event.time, channel, midiEvent.size, data);
 
                     if (status == MIDI_STATUS_NOTE_ON)
                         postponeRtEvent(kPluginPostRtEventNoteOn, channel, midiEvent.data[1], midiEvent.data[2]);
@@ -891,8 +1151,6 @@ public:
                 }
             }
 
-            kData->postRtEvents.trySplice();
-
         } // End of Event Input
 
         processSingle(inBuffer, outBuffer, frames);
@@ -918,7 +1176,7 @@ public:
                 return false;
         }
 
-        uint32_t i, k;
+        uint32_t i;
 
         // --------------------------------------------------------------------------------------------------------
         // Try lock, silence otherwise
@@ -935,90 +1193,72 @@ public:
             return false;
         }
 
-        // --------------------------------------------------------------------------------------------------------
-        // Reset audio buffers
-
-        for (i=0; i < fInfo.aIns; ++i)
-            carla_copyFloat(fShmAudioPool.data + (i * frames), inBuffer[i], frames);
+        if (fAsyncProcess)
+        {
+            // ----------------------------------------------------------------------------------------------------
+            // Collect the previous block, the bridge has been processing it while we were away
 
-        // --------------------------------------------------------------------------------------------------------
-        // Run plugin
+            if (fProcessPending && waitForReply())
+            {
+                for (i=0; i < fInfo.aOuts; ++i)
+                    carla_copyFloat(outBuffer[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+            }
+            else
+            {
+                for (i=0; i < kData->audioOut.count; ++i)
+                    carla_zeroFloat(outBuffer[i], frames);
+            }
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeProcess);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+            fProcessPending = false;
 
-        if (! waitForServer())
-        {
-            kData->singleMutex.unlock();
-            return true;
-        }
+            // ----------------------------------------------------------------------------------------------------
+            // Start this block, without waiting for it
 
-        for (i=0; i < fInfo.aOuts; ++i)
-            carla_copyFloat(outBuffer[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+            for (i=0; i < fInfo.aIns; ++i)
+                carla_copyFloat(fShmAudioPool.data + (i * frames), inBuffer[i], frames);
 
-        // --------------------------------------------------------------------------------------------------------
-        // Post-processing (dry/wet, volume and balance)
+            rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeProcess);
+            rdwr_writeInt(&fShmSlot->ringBuffer, fEventCount);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
+            fEventCount = 0;
 
+            if (kData->active)
+            {
+                rdwr_addRequest(fShmSlot);
+                fProcess->postServer();
+                fProcessPending = true;
+            }
+        }
+        else
         {
-            const bool doVolume  = (fHints & PLUGIN_CAN_VOLUME) != 0 && kData->postProc.volume != 1.0f;
-            const bool doDryWet  = (fHints & PLUGIN_CAN_DRYWET) != 0 && kData->postProc.dryWet != 1.0f;
-            const bool doBalance = (fHints & PLUGIN_CAN_BALANCE) != 0 && (kData->postProc.balanceLeft != -1.0f || kData->postProc.balanceRight != 1.0f);
+            // ----------------------------------------------------------------------------------------------------
+            // Reset audio buffers
 
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            for (i=0; i < fInfo.aIns; ++i)
+                carla_copyFloat(fShmAudioPool.data + (i * frames), inBuffer[i], frames);
 
-            for (i=0; i < kData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (k=0; k < frames; ++k)
-                    {
-                        bufValue        = inBuffer[(kData->audioIn.count == 1) ? 0 : i][k];
-                        outBuffer[i][k] = (outBuffer[i][k] * kData->postProc.dryWet) + (bufValue * (1.0f - kData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
+            // ----------------------------------------------------------------------------------------------------
+            // Run plugin
 
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < kData->audioOut.count);
-                        carla_copyFloat(oldBufLeft, outBuffer[i], frames);
-                    }
+            rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeProcess);
+            rdwr_writeInt(&fShmSlot->ringBuffer, fEventCount);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
+            fEventCount = 0;
 
-                    float balRangeL = (kData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (kData->postProc.balanceRight + 1.0f)/2.0f;
+            if (! waitForServer())
+            {
+                kData->singleMutex.unlock();
+                return true;
+            }
 
-                    for (k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            outBuffer[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            outBuffer[i][k] += outBuffer[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            outBuffer[i][k]  = outBuffer[i][k] * balRangeR;
-                            outBuffer[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
-                    }
-                }
+            for (i=0; i < fInfo.aOuts; ++i)
+                carla_copyFloat(outBuffer[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+        }
 
-                // Volume
-                if (doVolume)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k] *= kData->postProc.volume;
-                }
-            }
+        // --------------------------------------------------------------------------------------------------------
+        // Post-processing (dry/wet, volume and balance)
 
-        } // End of Post-processing
+        processPostProc(inBuffer, outBuffer, outBuffer, frames, 0, 0);
 
         // --------------------------------------------------------------------------------------------------------
 
@@ -1030,17 +1270,26 @@ public:
     {
         resizeAudioPool(newBufferSize);
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetBufferSize);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, newBufferSize);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetBufferSize);
+        rdwr_writeInt(&fShmSlot->ringBuffer, newBufferSize);
+        rdwr_commitWrite(&fShmSlot->ringBuffer);
 
+        // the async mode returns each block one cycle late, the dry signal is delayed to match
+        const uint32_t latency(fAsyncProcess ? newBufferSize : 0);
+
+        if (kData->latency != latency)
+        {
+            kData->latency = latency;
+            kData->client->setLatency(latency);
+            kData->recreateLatencyBuffers();
+        }
     }
 
     void sampleRateChanged(const double newSampleRate) override
     {
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetSampleRate);
-        rdwr_writeFloat(&fShmControl.data->ringBuffer, newSampleRate);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetSampleRate);
+        rdwr_writeFloat(&fShmSlot->ringBuffer, newSampleRate);
+        rdwr_commitWrite(&fShmSlot->ringBuffer);
     }
 
     // -------------------------------------------------------------------
@@ -1264,6 +1513,7 @@ public:
                 kData->param.data[index].hints   = hints;
                 kData->param.data[index].midiChannel = channel;
                 kData->param.data[index].midiCC  = cc;
+                kData->param.rebuildMidiCCMap();
             }
 
             break;
@@ -1578,89 +1828,110 @@ public:
         }
 
         // ---------------------------------------------------------------
-        // SHM Control
-        {
-            char tmpFileBase[60];
-
-            std::sprintf(tmpFileBase, "/carla-bridge_shc_XXXXXX");
+        // SHM Control, from the bridge process this plugin runs in
 
-            fShmControl.shm = shm_mkstemp(tmpFileBase);
+        fProcess = BridgeProcess::join(kData->engine, this, bridgeBinary, fSlot);
 
-            if (! carla_is_shm_valid(fShmControl.shm))
-            {
-                //_cleanup();
-                carla_stdout("Failed to open or create shared memory file #2");
-                return false;
-            }
-
-            fShmControl.filename = tmpFileBase;
+        if (fProcess == nullptr)
+            return false;
 
-            if (! carla_shm_map<BridgeShmControl>(fShmControl.shm, fShmControl.data))
-            {
-                //_cleanup();
-                carla_stdout("Failed to mmap shared memory file");
-                return false;
-            }
+        fShmSlot = fProcess->getSlot(fSlot);
 
-            CARLA_ASSERT(fShmControl.data != nullptr);
+        // a shared process is already running, a new one is started below
+        const bool isNewProcess(! fProcess->isRunning());
 
-            std::memset(fShmControl.data, 0, sizeof(BridgeShmControl));
-            std::strcpy(fShmControl.data->ringBuffer.buf, "This thing is actually working!!!!");
+        if (isNewProcess)
+        {
+            // initial values
+            rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetBufferSize);
+            rdwr_writeInt(&fShmSlot->ringBuffer, kData->engine->getBufferSize());
 
-            if (sem_init(&fShmControl.data->runServer, 1, 0) != 0)
-            {
-                //_cleanup();
-                carla_stdout("Failed to initialize shared memory semaphore #1");
-                return false;
-            }
+            rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetSampleRate);
+            rdwr_writeFloat(&fShmSlot->ringBuffer, kData->engine->getSampleRate());
 
-            if (sem_init(&fShmControl.data->runClient, 1, 0) != 0)
-            {
-                //_cleanup();
-                carla_stdout("Failed to initialize shared memory semaphore #2");
-                return false;
-            }
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
         }
 
-        // initial values
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetBufferSize);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, kData->engine->getBufferSize());
-
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetSampleRate);
-        rdwr_writeFloat(&fShmControl.data->ringBuffer, kData->engine->getSampleRate());
-
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
-
         // register plugin now so we can receive OSC (and wait for it)
         fHints |= PLUGIN_IS_BRIDGE;
         registerEnginePlugin(kData->engine, fId, this);
 
         // init OSC
         {
-            char shmIdStr[12+1] = { 0 };
-            std::strncpy(shmIdStr, &fShmAudioPool.filename[fShmAudioPool.filename.length()-6], 6);
-            std::strncat(shmIdStr, &fShmControl.filename[fShmControl.filename.length()-6], 6);
+            const QString oscUrl(QString("%1/%2").arg(kData->engine->getOscServerPathTCP()).arg(fId));
+            const char* const audioShmId(&fShmAudioPool.filename[fShmAudioPool.filename.length()-6]);
+            const char* const nameArg((name != nullptr) ? (const char*)fName : "(none)");
+
+            if (isNewProcess)
+            {
+                char shmIdStr[12+1] = { 0 };
+                std::strncpy(shmIdStr, audioShmId, 6);
+                std::strncat(shmIdStr, fProcess->getShmId(), 6);
+
+                QStringList arguments;
+                /* osc-url  */ arguments << oscUrl;
+                /* stype    */ arguments << getPluginTypeAsString(fPluginType);
+                /* filename */ arguments << filename;
+                /* name     */ arguments << nameArg;
+                /* label    */ arguments << label;
+                /* SHM ids  */ arguments << shmIdStr;
+
+                fProcess->start(arguments);
+            }
+            else if (BridgePlugin* const member = (BridgePlugin*)fProcess->getOtherMember(fSlot))
+            {
+                // ask the running bridge to load this plugin into our slot
+                const CarlaOscData& oscData(member->kData->osc.data);
 
-            kData->osc.thread.setOscData(bridgeBinary, label, getPluginTypeAsString(fPluginType), shmIdStr);
-            kData->osc.thread.start();
+                if (oscData.target != nullptr)
+                {
+                    char targetPath[std::strlen(oscData.path)+12];
+                    std::strcpy(targetPath, oscData.path);
+                    std::strcat(targetPath, "/plugin_add");
+                    lo_send(oscData.target, targetPath, "issssss", static_cast<int32_t>(fSlot), getPluginTypeAsString(fPluginType),
+                            filename, nameArg, label, oscUrl.toUtf8().constData(), audioShmId);
+                }
+            }
         }
 
         for (int i=0; i < 200; ++i)
         {
-            if (fInitiated || ! kData->osc.thread.isRunning())
+            if (fInitiated || ! fProcess->isRunning())
                 break;
             carla_msleep(50);
         }
 
+        // the bridge quits right away on a mismatch, say why instead of reporting a crash
+        if (! fInitError)
+        {
+            const int bridgeVersion(fProcess->getBridgeVersion());
+
+            if (bridgeVersion != 0 && bridgeVersion != BRIDGE_SHM_PROTOCOL_VERSION)
+            {
+                carla_stderr("BridgePlugin::init() - bridge uses protocol version %i, host uses %i", bridgeVersion, BRIDGE_SHM_PROTOCOL_VERSION);
+                kData->engine->setLastError("Plugin-bridge uses an incompatible protocol version, please rebuild or update it");
+                fInitError = true;
+            }
+        }
+
         if (fInitError || ! fInitiated)
         {
             // unregister so it gets handled properly
             registerEnginePlugin(kData->engine, fId, nullptr);
 
-            kData->osc.thread.quit();
+            if (fProcess->leave(fSlot))
+            {
+                if (fProcess->isRunning())
+                {
+                    fProcess->terminate();
+                    fProcess->wait();
+                }
+
+                delete fProcess;
+            }
 
-            if (kData->osc.thread.isRunning())
-                kData->osc.thread.terminate();
+            fProcess = nullptr;
+            fShmSlot = nullptr;
 
             if (! fInitError)
                 kData->engine->setLastError("Timeout while waiting for a response from plugin-bridge\n(or the plugin crashed on initialization?)");
@@ -1690,6 +1961,12 @@ private:
     bool fInitError;
     bool fSaved;
 
+    bool fAsyncProcess;
+    bool fProcessPending;
+
+    // events written to the event ring since the last process call
+    uint32_t fEventCount;
+
     CarlaString fBridgeBinary;
 
     struct BridgeAudioPool {
@@ -1706,18 +1983,9 @@ private:
         }
     } fShmAudioPool;
 
-    struct BridgeControl {
-        CarlaString filename;
-        BridgeShmControl* data;
-        shm_t shm;
-
-        BridgeControl()
-            : data(nullptr)
-        {
-            carla_shm_init(shm);
-        }
-
-    } fShmControl;
+    BridgeProcess* fProcess;
+    unsigned int   fSlot;
+    BridgeShmSlot* fShmSlot;
 
     struct Info {
         uint32_t aIns, aOuts;
@@ -1746,9 +2014,6 @@ private:
         if (fShmAudioPool.filename.isNotEmpty())
             fShmAudioPool.filename.clear();
 
-        if (fShmControl.filename.isNotEmpty())
-            fShmControl.filename.clear();
-
         if (fShmAudioPool.data != nullptr)
         {
             carla_shm_unmap(fShmAudioPool.shm, fShmAudioPool.data, fShmAudioPool.size);
@@ -1757,17 +2022,47 @@ private:
 
         fShmAudioPool.size = 0;
 
-        if (fShmControl.data != nullptr)
+        if (carla_is_shm_valid(fShmAudioPool.shm))
+            carla_shm_close(fShmAudioPool.shm);
+    }
+
+    void leaveProcess()
+    {
+        const bool isLast(fProcess->leave(fSlot));
+
+        if (fProcess->isRunning())
         {
-            carla_shm_unmap(fShmControl.shm, fShmControl.data, sizeof(BridgeShmControl));
-            fShmControl.data = nullptr;
+            // unless this was its last plugin, the bridge keeps running for the others
+            rdwr_writeOpcode(&fShmSlot->ringBuffer, isLast ? kPluginBridgeOpcodeQuit : kPluginBridgeOpcodeRemovePlugin);
+            rdwr_commitWrite(&fShmSlot->ringBuffer);
+            waitForServer();
         }
 
-        if (carla_is_shm_valid(fShmAudioPool.shm))
-            carla_shm_close(fShmAudioPool.shm);
+        if (kData->osc.data.target != nullptr)
+        {
+            osc_send_hide(&kData->osc.data);
 
-        if (carla_is_shm_valid(fShmControl.shm))
-            carla_shm_close(fShmControl.shm);
+            if (isLast)
+                osc_send_quit(&kData->osc.data);
+        }
+
+        kData->osc.data.free();
+
+        if (isLast)
+        {
+            // Wait a bit first, then force kill
+            if (fProcess->isRunning() && ! fProcess->wait(kData->engine->getOptions().oscUiTimeout))
+            {
+                carla_stderr("Failed to properly stop Plugin Bridge thread");
+                fProcess->terminate();
+                fProcess->wait();
+            }
+
+            delete fProcess;
+        }
+
+        fProcess = nullptr;
+        fShmSlot = nullptr;
     }
 
     void resizeAudioPool(uint32_t bufferSize)
@@ -1782,18 +2077,47 @@ private:
 
         fShmAudioPool.data = (float*)carla_shm_map(fShmAudioPool.shm, fShmAudioPool.size);
 
-        rdwr_writeOpcode(&fShmControl.data->ringBuffer, kPluginBridgeOpcodeSetAudioPool);
-        rdwr_writeInt(&fShmControl.data->ringBuffer, fShmAudioPool.size);
-        rdwr_commitWrite(&fShmControl.data->ringBuffer);
+        rdwr_writeOpcode(&fShmSlot->ringBuffer, kPluginBridgeOpcodeSetAudioPool);
+        rdwr_writeInt(&fShmSlot->ringBuffer, fShmAudioPool.size);
+        rdwr_commitWrite(&fShmSlot->ringBuffer);
 
         waitForServer();
     }
 
+    void writeMidiEvent(const uint32_t time, const uint8_t channel, const uint8_t size, const uint8_t* const data)
+    {
+        EngineEvent event;
+        event.type      = kEngineEventTypeMidi;
+        event.time      = time;
+        event.channel   = channel;
+        event.midi.port = 0;
+        event.midi.size = (size <= 4) ? size : 4;
+
+        for (uint8_t i=0; i < 4; ++i)
+            event.midi.data[i] = (i < event.midi.size) ? data[i] : 0;
+
+        if (rdwr_writeEvent(&fShmSlot->eventRing, event))
+            ++fEventCount;
+    }
+
     bool waitForServer()
     {
-        sem_post(&fShmControl.data->runServer);
+        // a process call may still be running in async mode, its reply must be taken first
+        if (fProcessPending)
+        {
+            fProcessPending = false;
+            waitForReply();
+        }
 
-        if (! jackbridge_sem_timedwait(&fShmControl.data->runClient, 5))
+        rdwr_addRequest(fShmSlot);
+        fProcess->postServer();
+
+        return waitForReply();
+    }
+
+    bool waitForReply()
+    {
+        if (! jackbridge_sem_timedwait(&fShmSlot->runClient, 5))
         {
             carla_stderr("waitForServer() timeout");
             kData->active = false; // TODO
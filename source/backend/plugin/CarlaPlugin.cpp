@@ -279,6 +279,16 @@ CarlaEngineAudioPort* CarlaPluginGetAudioOutPort(CarlaPlugin* const plugin, cons
     return CarlaPluginProtectedData::getAudioOutPort(plugin, index);
 }
 
+CarlaEngineEventPort* CarlaPluginGetEventInPort(CarlaPlugin* const plugin)
+{
+    return CarlaPluginProtectedData::getEventInPort(plugin);
+}
+
+CarlaEngineEventPort* CarlaPluginGetEventOutPort(CarlaPlugin* const plugin)
+{
+    return CarlaPluginProtectedData::getEventOutPort(plugin);
+}
+
 // -------------------------------------------------------------------
 // Constructor and destructor
 
@@ -1320,6 +1330,7 @@ void CarlaPlugin::setParameterMidiChannel(const uint32_t parameterId, uint8_t ch
         channel = MAX_MIDI_CHANNELS;
 
     kData->param.data[parameterId].midiChannel = channel;
+    kData->param.rebuildMidiCCMap();
 
 #ifndef BUILD_BRIDGE
     if (sendOsc)
@@ -1349,6 +1360,7 @@ void CarlaPlugin::setParameterMidiCC(const uint32_t parameterId, int16_t cc, con
         cc = -1;
 
     kData->param.data[parameterId].midiCC = cc;
+    kData->param.rebuildMidiCCMap();
 
 #ifndef BUILD_BRIDGE
     if (sendOsc)
@@ -1696,7 +1708,7 @@ void CarlaPlugin::registerToOscClient()
         getCopyright(bufCopyright);
 
 #ifdef BUILD_BRIDGE
-        kData->engine->osc_send_bridge_plugin_info(category(), fHints, bufName, bufLabel, bufMaker, bufCopyright, uniqueId());
+        kData->engine->osc_send_bridge_plugin_info(fId, category(), fHints, bufName, bufLabel, bufMaker, bufCopyright, uniqueId());
 #else
         kData->engine->osc_send_control_set_plugin_data(fId, type(), category(), fHints, bufName, bufLabel, bufMaker, bufCopyright, uniqueId());
 #endif
@@ -1708,9 +1720,9 @@ void CarlaPlugin::registerToOscClient()
         getParameterCountInfo(&cIns, &cOuts, &cTotals);
 
 #ifdef BUILD_BRIDGE
-        kData->engine->osc_send_bridge_audio_count(audioInCount(), audioOutCount(), audioInCount() + audioOutCount());
-        kData->engine->osc_send_bridge_midi_count(midiInCount(), midiOutCount(), midiInCount() + midiOutCount());
-        kData->engine->osc_send_bridge_parameter_count(cIns, cOuts, cTotals);
+        kData->engine->osc_send_bridge_audio_count(fId, audioInCount(), audioOutCount(), audioInCount() + audioOutCount());
+        kData->engine->osc_send_bridge_midi_count(fId, midiInCount(), midiOutCount(), midiInCount() + midiOutCount());
+        kData->engine->osc_send_bridge_parameter_count(fId, cIns, cOuts, cTotals);
 #else
         kData->engine->osc_send_control_set_plugin_ports(fId, audioInCount(), audioOutCount(), midiInCount(), midiOutCount(), cIns, cOuts, cTotals);
 #endif
@@ -1733,10 +1745,10 @@ void CarlaPlugin::registerToOscClient()
             const ParameterRanges& paramRanges(kData->param.ranges[i]);
 
 #ifdef BUILD_BRIDGE
-            kData->engine->osc_send_bridge_parameter_info(i, bufName, bufUnit);
-            kData->engine->osc_send_bridge_parameter_data(i, paramData.type, paramData.rindex, paramData.hints, paramData.midiChannel, paramData.midiCC);
-            kData->engine->osc_send_bridge_parameter_ranges(i, paramRanges.def, paramRanges.min, paramRanges.max, paramRanges.step, paramRanges.stepSmall, paramRanges.stepLarge);
-            kData->engine->osc_send_bridge_set_parameter_value(i, getParameterValue(i));
+            kData->engine->osc_send_bridge_parameter_info(fId, i, bufName, bufUnit);
+            kData->engine->osc_send_bridge_parameter_data(fId, i, paramData.type, paramData.rindex, paramData.hints, paramData.midiChannel, paramData.midiCC);
+            kData->engine->osc_send_bridge_parameter_ranges(fId, i, paramRanges.def, paramRanges.min, paramRanges.max, paramRanges.step, paramRanges.stepSmall, paramRanges.stepLarge);
+            kData->engine->osc_send_bridge_set_parameter_value(fId, i, getParameterValue(i));
 #else
             kData->engine->osc_send_control_set_parameter_data(fId, i, paramData.type, paramData.hints, bufName, bufUnit, getParameterValue(i));
             kData->engine->osc_send_control_set_parameter_ranges(fId, i, paramRanges.min, paramRanges.max, paramRanges.def, paramRanges.step, paramRanges.stepSmall, paramRanges.stepLarge);
@@ -1750,12 +1762,12 @@ void CarlaPlugin::registerToOscClient()
     if (kData->prog.count > 0)
     {
 #ifdef BUILD_BRIDGE
-        kData->engine->osc_send_bridge_program_count(kData->prog.count);
+        kData->engine->osc_send_bridge_program_count(fId, kData->prog.count);
 
         for (uint32_t i=0; i < kData->prog.count; ++i)
-            kData->engine->osc_send_bridge_program_info(i, kData->prog.names[i]);
+            kData->engine->osc_send_bridge_program_info(fId, i, kData->prog.names[i]);
 
-        kData->engine->osc_send_bridge_set_program(kData->prog.current);
+        kData->engine->osc_send_bridge_set_program(fId, kData->prog.current);
 #else
         kData->engine->osc_send_control_set_program_count(fId, kData->prog.count);
 
@@ -1770,16 +1782,16 @@ void CarlaPlugin::registerToOscClient()
     if (kData->midiprog.count > 0)
     {
 #ifdef BUILD_BRIDGE
-        kData->engine->osc_send_bridge_midi_program_count(kData->midiprog.count);
+        kData->engine->osc_send_bridge_midi_program_count(fId, kData->midiprog.count);
 
         for (uint32_t i=0; i < kData->midiprog.count; ++i)
         {
             const MidiProgramData& mpData(kData->midiprog.data[i]);
 
-            kData->engine->osc_send_bridge_midi_program_info(i, mpData.bank, mpData.program, mpData.name);
+            kData->engine->osc_send_bridge_midi_program_info(fId, i, mpData.bank, mpData.program, mpData.name);
         }
 
-        kData->engine->osc_send_bridge_set_midi_program(kData->midiprog.current);
+        kData->engine->osc_send_bridge_set_midi_program(fId, kData->midiprog.current);
 #else
         kData->engine->osc_send_control_set_midi_program_count(fId, kData->midiprog.count);
 
@@ -1960,6 +1972,8 @@ void CarlaPlugin::sendMidiAllNotesOffToCallback()
         postEvent.value2 = i;
         kData->postRtEvents.appendRT(postEvent);
     }
+
+    kData->engine->signalPostRtEvents();
 }
 
 // -------------------------------------------------------------------
@@ -1974,16 +1988,19 @@ void CarlaPlugin::postponeRtEvent(const PluginPostRtEventType type, const int32_
     event.value3 = value3;
 
     kData->postRtEvents.appendRT(event);
+    kData->engine->signalPostRtEvents();
 }
 
 void CarlaPlugin::postRtEventsRun()
 {
-    const CarlaMutex::ScopedLocker sl(kData->postRtEvents.mutex);
+    if (const uint32_t lost = kData->postRtEvents.data.takeOverflows())
+        carla_stderr2("CarlaPlugin::postRtEventsRun() - %u events lost, queue was full", lost);
 
-    while (! kData->postRtEvents.data.isEmpty())
-    {
-        const PluginPostRtEvent& event(kData->postRtEvents.data.getFirst(true));
+    // only handle what is queued now, so a busy audio thread cannot keep us here forever
+    PluginPostRtEvent event;
 
+    for (uint32_t count = kData->postRtEvents.data.count(); count > 0 && kData->postRtEvents.data.get(event); --count)
+    {
         switch (event.type)
         {
         case kPluginPostRtEventNull:
@@ -2112,6 +2129,45 @@ void CarlaPlugin::postRtEventsRun()
     }
 }
 
+void CarlaPlugin::outputParametersRun(const bool sendToUi, const bool sendToOsc, bool sendAll)
+{
+    if (kData->param.sentOutputs == nullptr)
+        return;
+
+    if (! kData->param.sentOutputsValid)
+    {
+        kData->param.sentOutputsValid = true;
+        sendAll = true;
+    }
+
+    for (uint32_t i=0; i < kData->param.count; ++i)
+    {
+        if (kData->param.data[i].type != PARAMETER_OUTPUT)
+            continue;
+
+        const float value(getParameterValue(i));
+
+        if (value == kData->param.sentOutputs[i] && ! sendAll)
+            continue;
+
+        kData->param.sentOutputs[i] = value;
+
+        // Update UI
+        if (sendToUi)
+            uiParameterChange(i, value);
+
+        // Update OSC engine client
+        if (sendToOsc)
+        {
+#ifdef BUILD_BRIDGE
+            kData->engine->osc_send_bridge_set_parameter_value(fId, static_cast<int32_t>(i), value);
+#else
+            kData->engine->osc_send_control_set_parameter_value(fId, static_cast<int32_t>(i), value);
+#endif
+        }
+    }
+}
+
 // -------------------------------------------------------------------
 // Post-poned UI Stuff
 
@@ -2167,6 +2223,148 @@ void CarlaPlugin::uiNoteOff(const uint8_t channel, const uint8_t note)
     (void)note;
 }
 
+// -------------------------------------------------------------------
+// Post-processing
+
+#ifndef BUILD_BRIDGE
+void CarlaPlugin::processPostProc(float** const dryBuffer, float** const wetBuffer, float** const outBuffer, const uint32_t frames, const uint32_t inOffset, const uint32_t outOffset)
+{
+    CARLA_ASSERT(wetBuffer != nullptr);
+    CARLA_ASSERT(outBuffer != nullptr);
+
+    if (frames == 0 || kData->audioOut.count == 0)
+        return;
+
+    CarlaPluginProtectedData::PostProc& postProc(kData->postProc);
+
+    const bool canDryWet(dryBuffer != nullptr && kData->audioIn.count > 0 && (fHints & PLUGIN_CAN_DRYWET) != 0);
+
+    // targets for this call, neutral values for what the plugin can't do
+    const float dryWet   = canDryWet ? postProc.dryWet : 1.0f;
+    const float volume   = (fHints & PLUGIN_CAN_VOLUME)  ? postProc.volume       : 1.0f;
+    const float balLeft  = (fHints & PLUGIN_CAN_BALANCE) ? postProc.balanceLeft  : -1.0f;
+    const float balRight = (fHints & PLUGIN_CAN_BALANCE) ? postProc.balanceRight : 1.0f;
+
+    // start values, from the last call
+    const float dryWet0   = canDryWet ? postProc.lastDryWet : 1.0f;
+    const float volume0   = (fHints & PLUGIN_CAN_VOLUME)  ? postProc.lastVolume       : 1.0f;
+    const float balLeft0  = (fHints & PLUGIN_CAN_BALANCE) ? postProc.lastBalanceLeft  : -1.0f;
+    const float balRight0 = (fHints & PLUGIN_CAN_BALANCE) ? postProc.lastBalanceRight : 1.0f;
+
+    postProc.lastDryWet       = dryWet;
+    postProc.lastVolume       = volume;
+    postProc.lastBalanceLeft  = balLeft;
+    postProc.lastBalanceRight = balRight;
+
+    const bool doDryWet  = (dryWet != 1.0f || dryWet0 != 1.0f);
+    const bool doBalance = (balLeft != -1.0f || balRight != 1.0f || balLeft0 != -1.0f || balRight0 != 1.0f);
+    const bool doRamp    = (dryWet != dryWet0 || volume != volume0 || balLeft != balLeft0 || balRight != balRight0);
+
+    const uint32_t latency(kData->latencyBuffers != nullptr ? kData->latency : 0);
+
+    if (! (doDryWet || doBalance || doRamp))
+    {
+        // Volume only, or just a buffer copy
+        for (uint32_t i=0; i < kData->audioOut.count; ++i)
+        {
+            float* const out(outBuffer[i]+outOffset);
+
+            if (out != wetBuffer[i]+inOffset)
+                carla_copyFloat(out, wetBuffer[i]+inOffset, frames);
+            if (volume != 1.0f)
+                carla_multiplyFloat(out, volume, frames);
+        }
+    }
+    else
+    {
+        // per-sample gain steps, so the last sample gets the target values
+        const float invFrames(1.0f/float(frames));
+        const float dryWetStep((dryWet - dryWet0) * invFrames);
+        const float volumeStep((volume - volume0) * invFrames);
+
+        // balance as left/right ranges, 0.0 is full left and 1.0 full right
+        const float balRangeL0((balLeft0  + 1.0f)/2.0f);
+        const float balRangeR0((balRight0 + 1.0f)/2.0f);
+        const float balRangeLStep(((balLeft  + 1.0f)/2.0f - balRangeL0) * invFrames);
+        const float balRangeRStep(((balRight + 1.0f)/2.0f - balRangeR0) * invFrames);
+
+        for (uint32_t i=0; i < kData->audioOut.count; ++i)
+        {
+            const bool isPair(doBalance && i % 2 == 0 && i+1 < kData->audioOut.count);
+
+            const float* const wetL(wetBuffer[i]+inOffset);
+            const float* const wetR(isPair ? wetBuffer[i+1]+inOffset : nullptr);
+            float* const outL(outBuffer[i]+outOffset);
+            float* const outR(isPair ? outBuffer[i+1]+outOffset : nullptr);
+
+            const uint32_t dryL(kData->audioIn.count == 1 ? 0 : i);
+            const uint32_t dryR(kData->audioIn.count == 1 ? 0 : i+1);
+
+            float left, right, dry, gain, dryWetNow, balRangeL, balRangeR;
+
+            for (uint32_t k=0; k < frames; ++k)
+            {
+                gain = volume0 + volumeStep * float(k+1);
+
+                left  = wetL[k];
+                right = isPair ? wetR[k] : 0.0f;
+
+                // Dry/Wet, with the dry signal delayed by the plugin latency
+                if (doDryWet)
+                {
+                    dryWetNow = dryWet0 + dryWetStep * float(k+1);
+
+                    dry   = (k < latency) ? kData->latencyBuffers[dryL][k] : dryBuffer[dryL][inOffset+k-latency];
+                    left  = left * dryWetNow + dry * (1.0f - dryWetNow);
+
+                    if (isPair)
+                    {
+                        dry   = (k < latency) ? kData->latencyBuffers[dryR][k] : dryBuffer[dryR][inOffset+k-latency];
+                        right = right * dryWetNow + dry * (1.0f - dryWetNow);
+                    }
+                }
+
+                // Balance and Volume
+                if (isPair)
+                {
+                    balRangeL = balRangeL0 + balRangeLStep * float(k+1);
+                    balRangeR = balRangeR0 + balRangeRStep * float(k+1);
+
+                    outL[k] = (left * (1.0f - balRangeL) + right * (1.0f - balRangeR)) * gain;
+                    outR[k] = (right * balRangeR + left * balRangeL) * gain;
+                }
+                else
+                {
+                    outL[k] = left * gain;
+                }
+            }
+
+            if (isPair)
+                ++i;
+        }
+    }
+
+    // Latency, save the last input values for the next call
+    if (latency > 0 && dryBuffer != nullptr)
+    {
+        for (uint32_t i=0; i < kData->audioIn.count; ++i)
+        {
+            float* const latBuf(kData->latencyBuffers[i]);
+
+            if (frames >= latency)
+            {
+                carla_copyFloat(latBuf, dryBuffer[i]+inOffset+frames-latency, latency);
+            }
+            else
+            {
+                std::memmove(latBuf, latBuf+frames, sizeof(float)*(latency-frames));
+                carla_copyFloat(latBuf+latency-frames, dryBuffer[i]+inOffset, frames);
+            }
+        }
+    }
+}
+#endif
+
 // -------------------------------------------------------------------
 // Scoped Disabler
 
@@ -2208,6 +2406,8 @@ CarlaPlugin::ScopedDisabler::~ScopedDisabler()
     if (kPlugin->kData->client == nullptr)
         return;
 
+    kPlugin->kData->param.rebuildMidiCCMap();
+
     kPlugin->fEnabled = true;
     kPlugin->kData->client->activate();
     kPlugin->kData->masterMutex.unlock();
@@ -28,6 +28,7 @@
 #include "CarlaMIDI.h"
 
 #include "RtList.hpp"
+#include "RtQueue.hpp"
 
 #define CARLA_PROCESS_CONTINUE_CHECK if (! fEnabled) { kData->engine->callback(CALLBACK_DEBUG, fId, 0, 0, 0.0f, "Processing while plugin is disabled!!"); return; }
 
@@ -163,21 +164,152 @@ struct PluginEventData {
 
 // -----------------------------------------------------------------------
 
+struct PluginMidiCCMap {
+    static const uint32_t kNone = 0xFFFFFFFF;
+
+    // automable input parameters for each MIDI channel and CC, as linked lists
+    struct Table {
+        uint32_t  first[MAX_MIDI_CHANNELS][MAX_MIDI_VALUE];
+        uint32_t* next;
+
+        uint32_t getFirst(const uint8_t channel, const uint16_t cc) const
+        {
+            if (channel >= MAX_MIDI_CHANNELS || cc >= MAX_MIDI_VALUE)
+                return kNone;
+            return first[channel][cc];
+        }
+    };
+
+    // the audio thread reads from one table while the other is rebuilt
+    Table tables[2];
+    volatile int state; // bit 0: active table, bit 1: the other table is ready
+    CarlaMutex mutex;   // serializes rebuilds
+
+    PluginMidiCCMap()
+        : state(0)
+    {
+        tables[0].next = nullptr;
+        tables[1].next = nullptr;
+        reset();
+    }
+
+    ~PluginMidiCCMap()
+    {
+        CARLA_ASSERT(tables[0].next == nullptr);
+        CARLA_ASSERT(tables[1].next == nullptr);
+    }
+
+    // plugin must not be processing for these 2
+    void createNew(const uint32_t count)
+    {
+        CARLA_ASSERT(tables[0].next == nullptr);
+        CARLA_ASSERT(tables[1].next == nullptr);
+
+        tables[0].next = new uint32_t[count];
+        tables[1].next = new uint32_t[count];
+        reset();
+    }
+
+    void clear()
+    {
+        for (int i=0; i < 2; ++i)
+        {
+            if (tables[i].next != nullptr)
+            {
+                delete[] tables[i].next;
+                tables[i].next = nullptr;
+            }
+        }
+
+        reset();
+    }
+
+    // called from the audio thread, picks up the last rebuilt table if needed
+    const Table& getTableRT()
+    {
+        int curState = state;
+
+        if ((curState & 0x2) != 0 && __sync_bool_compare_and_swap(&state, curState, (curState & 0x1) ^ 0x1))
+            curState ^= 0x1;
+
+        return tables[curState & 0x1];
+    }
+
+    // not called from the audio thread; a rebuild never touches the table currently in use
+    void rebuild(const ParameterData* const data, const uint32_t count)
+    {
+        if (tables[0].next == nullptr || tables[1].next == nullptr)
+            return;
+
+        const CarlaMutex::ScopedLocker sl(mutex);
+
+        // take back a previously rebuilt table the audio thread did not pick up yet
+        int curState;
+
+        do {
+            curState = state;
+        } while (! __sync_bool_compare_and_swap(&state, curState, curState & 0x1));
+
+        Table& table(tables[(curState & 0x1) ^ 0x1]);
+        std::memset(table.first, 0xFF, sizeof(table.first));
+
+        // reverse order, so lists end up sorted by parameter index
+        for (uint32_t i=count; i-- > 0;)
+        {
+            const ParameterData& paramData(data[i]);
+
+            if (paramData.type != PARAMETER_INPUT)
+                continue;
+            if ((paramData.hints & PARAMETER_IS_AUTOMABLE) == 0)
+                continue;
+            if (paramData.midiChannel >= MAX_MIDI_CHANNELS || paramData.midiCC < 0 || paramData.midiCC >= MAX_MIDI_VALUE)
+                continue;
+
+            uint32_t& first(table.first[paramData.midiChannel][paramData.midiCC]);
+            table.next[i] = first;
+            first = i;
+        }
+
+        __sync_synchronize();
+        state = (curState & 0x1) | 0x2;
+    }
+
+private:
+    void reset()
+    {
+        std::memset(tables[0].first, 0xFF, sizeof(tables[0].first));
+        std::memset(tables[1].first, 0xFF, sizeof(tables[1].first));
+        state = 0;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(PluginMidiCCMap)
+};
+
+// -----------------------------------------------------------------------
+
 struct PluginParameterData {
     uint32_t count;
     ParameterData* data;
     ParameterRanges* ranges;
+    PluginMidiCCMap midiCCMap;
+
+    // output values last sent by the engine thread
+    float* sentOutputs;
+    bool   sentOutputsValid;
 
     PluginParameterData()
         : count(0),
           data(nullptr),
-          ranges(nullptr) {}
+          ranges(nullptr),
+          sentOutputs(nullptr),
+          sentOutputsValid(false) {}
 
     ~PluginParameterData()
     {
         CARLA_ASSERT_INT(count == 0, count);
         CARLA_ASSERT(data == nullptr);
         CARLA_ASSERT(ranges == nullptr);
+        CARLA_ASSERT(sentOutputs == nullptr);
     }
 
     void createNew(const uint32_t newCount)
@@ -192,6 +324,9 @@ struct PluginParameterData {
 
         data   = new ParameterData[newCount];
         ranges = new ParameterRanges[newCount];
+        sentOutputs = new float[newCount];
+        sentOutputsValid = false;
+        midiCCMap.createNew(newCount);
         count  = newCount;
     }
 
@@ -209,9 +344,23 @@ struct PluginParameterData {
             ranges = nullptr;
         }
 
+        if (sentOutputs != nullptr)
+        {
+            delete[] sentOutputs;
+            sentOutputs = nullptr;
+        }
+
+        sentOutputsValid = false;
+        midiCCMap.clear();
         count = 0;
     }
 
+    // must be called after changing MIDI-learn data (channel, CC, type or hints)
+    void rebuildMidiCCMap()
+    {
+        midiCCMap.rebuild(data, count);
+    }
+
     float fixValue(const uint32_t parameterId, const float& value)
     {
         CARLA_ASSERT_INT2(parameterId < count, parameterId, count);
@@ -359,8 +508,6 @@ struct PluginPostRtEvent {
           value1(-1),
           value2(-1),
           value3(0.0f) {}
-
-    CARLA_DECLARE_NON_COPY_STRUCT(PluginPostRtEvent)
 };
 
 // -----------------------------------------------------------------------
@@ -441,15 +588,10 @@ struct CarlaPluginProtectedData {
     } extNotes;
 
     struct PostRtEvents {
-        CarlaMutex mutex;
-        RtList<PluginPostRtEvent>::Pool dataPool;
-        RtList<PluginPostRtEvent> data;
-        RtList<PluginPostRtEvent> dataPendingRT;
+        // written by the audio thread (and any other), read by the engine thread only
+        RtQueue<PluginPostRtEvent, 512> data;
 
-        PostRtEvents()
-            : dataPool(128, 128),
-              data(dataPool),
-              dataPendingRT(dataPool) {}
+        PostRtEvents() {}
 
         ~PostRtEvents()
         {
@@ -458,24 +600,12 @@ struct CarlaPluginProtectedData {
 
         void appendRT(const PluginPostRtEvent& event)
         {
-            dataPendingRT.append(event);
-        }
-
-        void trySplice()
-        {
-            if (mutex.tryLock())
-            {
-                dataPendingRT.spliceAppend(data, true);
-                mutex.unlock();
-            }
+            data.put(event);
         }
 
         void clear()
         {
-            mutex.lock();
             data.clear();
-            dataPendingRT.clear();
-            mutex.unlock();
         }
 
         CARLA_DECLARE_NON_COPY_STRUCT(PostRtEvents)
@@ -489,12 +619,22 @@ struct CarlaPluginProtectedData {
         float balanceRight;
         float panning;
 
+        // values used in the last processed cycle, to ramp from
+        float lastDryWet;
+        float lastVolume;
+        float lastBalanceLeft;
+        float lastBalanceRight;
+
         PostProc()
             : dryWet(1.0f),
               volume(1.0f),
               balanceLeft(-1.0f),
               balanceRight(1.0f),
-              panning(0.0f) {}
+              panning(0.0f),
+              lastDryWet(1.0f),
+              lastVolume(1.0f),
+              lastBalanceLeft(-1.0f),
+              lastBalanceRight(1.0f) {}
 
         CARLA_DECLARE_NON_COPY_STRUCT(PostProc)
     } postProc;
@@ -711,6 +851,16 @@ struct CarlaPluginProtectedData {
         return plugin->kData->audioOut.ports[index].port;
     }
 
+    static CarlaEngineEventPort* getEventInPort(CarlaPlugin* const plugin)
+    {
+        return plugin->kData->event.portIn;
+    }
+
+    static CarlaEngineEventPort* getEventOutPort(CarlaPlugin* const plugin)
+    {
+        return plugin->kData->event.portOut;
+    }
+
     static bool canRunInRack(CarlaPlugin* const plugin)
     {
         return (plugin->kData->extraHints & PLUGIN_HINT_CAN_RUN_RACK);
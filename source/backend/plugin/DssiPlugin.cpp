@@ -1179,17 +1179,10 @@ public:
 #endif
 
                         // Control plugin parameters
-                        for (k=0; k < kData->param.count; ++k)
-                        {
-                            if (kData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (kData->param.data[k].midiCC != ctrlEvent.param)
-                                continue;
-                            if (kData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((kData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                        const PluginMidiCCMap::Table& ccTable(kData->param.midiCCMap.getTableRT());
 
+                        for (k = ccTable.getFirst(event.channel, ctrlEvent.param); k < kData->param.count; k = ccTable.next[k])
+                        {
                             float value;
 
                             if (kData->param.data[k].hints & PARAMETER_IS_BOOLEAN)
@@ -1383,8 +1376,6 @@ public:
                 }
             }
 
-            kData->postRtEvents.trySplice();
-
             if (frames > timeOffset)
                 processSingle(inBuffer, outBuffer, frames - timeOffset, timeOffset, midiEventCount);
 
@@ -1507,78 +1498,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doDryWet  = (fHints & PLUGIN_CAN_DRYWET) != 0 && kData->postProc.dryWet != 1.0f;
-            const bool doBalance = (fHints & PLUGIN_CAN_BALANCE) != 0 && (kData->postProc.balanceLeft != -1.0f || kData->postProc.balanceRight != 1.0f);
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (i=0; i < kData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (k=0; k < frames; ++k)
-                    {
-                        // TODO
-                        //if (k < kData->latency && kData->latency < frames)
-                        //    bufValue = (kData->audioIn.count == 1) ? kData->latencyBuffers[0][k] : kData->latencyBuffers[i][k];
-                        //else
-                        //    bufValue = (kData->audioIn.count == 1) ? inBuffer[0][k-m_latency] : inBuffer[i][k-m_latency];
-
-                        bufValue = fAudioInBuffers[(kData->audioIn.count == 1) ? 0 : i][k];
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * kData->postProc.dryWet) + (bufValue * (1.0f - kData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < kData->audioOut.count);
-                        carla_copyFloat(oldBufLeft, fAudioOutBuffers[i], frames);
-                    }
-
-                    float balRangeL = (kData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (kData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] = fAudioOutBuffers[i][k] * kData->postProc.volume;
-                }
-            }
-
-#if 0
-            // Latency, save values for next callback, TODO
-            if (kData->latency > 0 && kData->latency < frames)
-            {
-                for (i=0; i < kData->audioIn.count; ++i)
-                    carla_copyFloat(kData->latencyBuffers[i], inBuffer[i] + (frames - kData->latency), kData->latency);
-            }
-#endif
-        } // End of Post-processing
+        processPostProc(fAudioInBuffers, fAudioOutBuffers, outBuffer, frames, 0, timeOffset);
 #else
         for (i=0; i < kData->audioOut.count; ++i)
         {
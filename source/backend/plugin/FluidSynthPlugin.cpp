@@ -1173,17 +1173,10 @@ public:
 #endif
 
                         // Control plugin parameters
-                        for (k=0; k < kData->param.count; ++k)
-                        {
-                            if (kData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (kData->param.data[k].midiCC != ctrlEvent.param)
-                                continue;
-                            if (kData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((kData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                        const PluginMidiCCMap::Table& ccTable(kData->param.midiCCMap.getTableRT());
 
+                        for (k = ccTable.getFirst(event.channel, ctrlEvent.param); k < kData->param.count; k = ccTable.next[k])
+                        {
                             float value;
 
                             if (kData->param.data[k].hints & PARAMETER_IS_BOOLEAN)
@@ -1330,8 +1323,6 @@ public:
                 }
             }
 
-            kData->postRtEvents.trySplice();
-
             if (frames > timeOffset)
                 processSingle(outBuffer, frames - timeOffset, timeOffset);
 
@@ -1403,55 +1394,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (volume and balance)
 
-        {
-            // note - balance not possible with kUses16Outs, so we can safely skip fAudioOutBuffers
-            const bool doVolume  = (fHints & PLUGIN_CAN_VOLUME) > 0 && kData->postProc.volume != 1.0f;
-            const bool doBalance = (fHints & PLUGIN_CAN_BALANCE) > 0 && (kData->postProc.balanceLeft != -1.0f || kData->postProc.balanceRight != 1.0f);
-
-            float oldBufLeft[doBalance ? frames : 1];
-
-            for (i=0; i < kData->audioOut.count; ++i)
-            {
-                // Balance
-                if (doBalance)
-                {
-                    if (i % 2 == 0)
-                        carla_copyFloat(oldBufLeft, outBuffer[i]+timeOffset, frames);
-
-                    float balRangeL = (kData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (kData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (k=0; k < frames; ++k)
-                    {
-                        if (i % 2 == 0)
-                        {
-                            // left
-                            outBuffer[i][k+timeOffset]  = oldBufLeft[k]                * (1.0f - balRangeL);
-                            outBuffer[i][k+timeOffset] += outBuffer[i+1][k+timeOffset] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            outBuffer[i][k+timeOffset]  = outBuffer[i][k+timeOffset] * balRangeR;
-                            outBuffer[i][k+timeOffset] += oldBufLeft[k]              * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume
-                if (kUses16Outs)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] = fAudio16Buffers[i][k] * kData->postProc.volume;
-                }
-                else if (doVolume)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= kData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
+        processPostProc(nullptr, kUses16Outs ? fAudio16Buffers : outBuffer, outBuffer, frames, kUses16Outs ? 0 : timeOffset, timeOffset);
 #else
         if (kUses16Outs)
         {
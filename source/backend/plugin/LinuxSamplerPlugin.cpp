@@ -676,17 +676,10 @@ public:
 #endif
 
                         // Control plugin parameters
-                        for (k=0; k < kData->param.count; ++k)
-                        {
-                            if (kData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (kData->param.data[k].midiCC != ctrlEvent.param)
-                                continue;
-                            if (kData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((kData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                        const PluginMidiCCMap::Table& ccTable(kData->param.midiCCMap.getTableRT());
 
+                        for (k = ccTable.getFirst(event.channel, ctrlEvent.param); k < kData->param.count; k = ccTable.next[k])
+                        {
                             double value;
 
                             if (kData->param.data[k].hints & PARAMETER_IS_BOOLEAN)
@@ -788,8 +781,6 @@ public:
                 }
             }
 
-            kData->postRtEvents.trySplice();
-
             if (frames > timeOffset)
                 processSingle(outBuffer, frames - timeOffset, timeOffset);
 
@@ -838,49 +829,7 @@ public:
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doVolume  = (fHints & PLUGIN_CAN_VOLUME) > 0 && kData->postProc.volume != 1.0f;
-            const bool doBalance = (fHints & PLUGIN_CAN_BALANCE) > 0 && (kData->postProc.balanceLeft != -1.0f || kData->postProc.balanceRight != 1.0f);
-
-            float oldBufLeft[doBalance ? frames : 1];
-
-            for (i=0; i < kData->audioOut.count; ++i)
-            {
-                // Balance
-                if (doBalance)
-                {
-                    if (i % 2 == 0)
-                        carla_copyFloat(oldBufLeft, outBuffer[i], frames);
-
-                    float balRangeL = (kData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (kData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (k=0; k < frames; ++k)
-                    {
-                        if (i % 2 == 0)
-                        {
-                            // left
-                            outBuffer[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            outBuffer[i][k] += outBuffer[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            outBuffer[i][k]  = outBuffer[i][k] * balRangeR;
-                            outBuffer[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume
-                if (doVolume)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= kData->postProc.volume;
-                }
-            }
-
-        } // End of Post-processing
+        processPostProc(nullptr, outBuffer, outBuffer, frames, timeOffset, timeOffset);
 #endif
 
         // --------------------------------------------------------------------------------------------------------
@@ -22,10 +22,16 @@
 #include "CarlaPluginGui.hpp"
 #include "CarlaLv2Utils.hpp"
 #include "Lv2AtomQueue.hpp"
+#include "Lv2RdfCache.hpp"
+#include "Lv2UridMap.hpp"
+#include "RtRingBuffer.hpp"
 
 #include "../engine/CarlaEngineOsc.hpp"
 
 #include <QtCore/QDir>
+#include <QtCore/QThread>
+
+#include <semaphore.h>
 
 extern "C" {
 #include "rtmempool/rtmempool-lv2.h"
@@ -64,47 +70,11 @@ const unsigned int CARLA_EVENT_TYPE_MESSAGE = 0x10; // unused
 const unsigned int CARLA_EVENT_TYPE_MIDI    = 0x20;
 const unsigned int CARLA_EVENT_TYPE_TIME    = 0x40;
 
-// LV2 URI Map Ids
-const uint32_t CARLA_URI_MAP_ID_NULL                   =  0;
-const uint32_t CARLA_URI_MAP_ID_ATOM_BLANK             =  1;
-const uint32_t CARLA_URI_MAP_ID_ATOM_BOOL              =  2;
-const uint32_t CARLA_URI_MAP_ID_ATOM_CHUNK             =  3;
-const uint32_t CARLA_URI_MAP_ID_ATOM_DOUBLE            =  4;
-const uint32_t CARLA_URI_MAP_ID_ATOM_FLOAT             =  5;
-const uint32_t CARLA_URI_MAP_ID_ATOM_INT               =  6;
-const uint32_t CARLA_URI_MAP_ID_ATOM_LITERAL           =  7;
-const uint32_t CARLA_URI_MAP_ID_ATOM_LONG              =  8;
-const uint32_t CARLA_URI_MAP_ID_ATOM_PATH              =  9;
-const uint32_t CARLA_URI_MAP_ID_ATOM_PROPERTY          = 10;
-const uint32_t CARLA_URI_MAP_ID_ATOM_RESOURCE          = 11;
-const uint32_t CARLA_URI_MAP_ID_ATOM_SEQUENCE          = 12;
-const uint32_t CARLA_URI_MAP_ID_ATOM_STRING            = 13;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TUPLE             = 14;
-const uint32_t CARLA_URI_MAP_ID_ATOM_URI               = 15;
-const uint32_t CARLA_URI_MAP_ID_ATOM_URID              = 16;
-const uint32_t CARLA_URI_MAP_ID_ATOM_VECTOR            = 17;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM     = 18;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT    = 19;
-const uint32_t CARLA_URI_MAP_ID_BUF_MAX_LENGTH         = 20;
-const uint32_t CARLA_URI_MAP_ID_BUF_MIN_LENGTH         = 21;
-const uint32_t CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE      = 22;
-const uint32_t CARLA_URI_MAP_ID_LOG_ERROR              = 23;
-const uint32_t CARLA_URI_MAP_ID_LOG_NOTE               = 24;
-const uint32_t CARLA_URI_MAP_ID_LOG_TRACE              = 25;
-const uint32_t CARLA_URI_MAP_ID_LOG_WARNING            = 26;
-const uint32_t CARLA_URI_MAP_ID_TIME_POSITION          = 27; // base type
-const uint32_t CARLA_URI_MAP_ID_TIME_BAR               = 28; // values
-const uint32_t CARLA_URI_MAP_ID_TIME_BAR_BEAT          = 29;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEAT              = 30;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEAT_UNIT         = 31;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR     = 32;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE  = 33;
-const uint32_t CARLA_URI_MAP_ID_TIME_FRAME             = 34;
-const uint32_t CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND = 35;
-const uint32_t CARLA_URI_MAP_ID_TIME_SPEED             = 36;
-const uint32_t CARLA_URI_MAP_ID_MIDI_EVENT             = 37;
-const uint32_t CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE      = 38;
-const uint32_t CARLA_URI_MAP_ID_COUNT                  = 39;
+// URID map shared by all plugins and UIs
+static Lv2UridMap gLv2UridMap(kFixedURIs, CARLA_URI_MAP_ID_COUNT);
+
+// Plugin descriptors from previous runs, lilv only loads the world on a cache miss
+static Lv2RdfCache gLv2RdfCache;
 
 // LV2 Feature Ids
 const uint32_t kFeatureIdBufSizeBounded   =  0;
@@ -350,6 +320,153 @@ struct Lv2PluginOptions {
     CARLA_DECLARE_NON_COPY_STRUCT_WITH_LEAK_DETECTOR(Lv2PluginOptions)
 };
 
+// -----------------------------------------------------
+// Worker thread for the LV2 worker extension.
+// Work scheduled during run() is passed to this thread through a lock-free ring,
+// its responses come back the same way and are given to the plugin at the end of the next process().
+
+class Lv2Worker : public QThread
+{
+public:
+    Lv2Worker()
+        : fHandle(nullptr),
+          fWorker(nullptr),
+          fStopNow(true),
+          fSemOk(false)
+    {
+#ifndef CARLA_OS_MAC
+        fSemOk = (sem_init(&fSem, 0, 0) == 0);
+#endif
+    }
+
+    ~Lv2Worker() override
+    {
+        CARLA_ASSERT(fStopNow);
+
+        if (fSemOk)
+            sem_destroy(&fSem);
+    }
+
+    void startNow(LV2_Handle const handle, const LV2_Worker_Interface* const worker)
+    {
+        CARLA_ASSERT(handle != nullptr);
+        CARLA_ASSERT(worker != nullptr && worker->work != nullptr);
+        CARLA_ASSERT(fStopNow);
+
+        fHandle  = handle;
+        fWorker  = worker;
+        fStopNow = false;
+        start();
+    }
+
+    void stopNow()
+    {
+        if (fStopNow)
+            return;
+
+        fStopNow = true;
+
+        if (fSemOk)
+            sem_post(&fSem);
+
+        wait();
+
+        fRequests.clear();
+        fResponses.clear();
+    }
+
+    // called by the plugin during run(), real-time safe unless offline
+    LV2_Worker_Status schedule(const uint32_t size, const void* const data, const bool offline)
+    {
+        if (fStopNow)
+            return LV2_WORKER_ERR_UNKNOWN;
+
+        if (offline)
+        {
+            // no reason to wait for the worker thread, but work() calls must never overlap
+            const CarlaMutex::ScopedLocker sl(fWorkMutex);
+
+            return fWorker->work(fHandle, carla_lv2_worker_respond, this, size, data);
+        }
+
+        if (! fRequests.writeMessage(data, size))
+            return LV2_WORKER_ERR_NO_SPACE;
+
+        if (fSemOk)
+            sem_post(&fSem);
+
+        return LV2_WORKER_SUCCESS;
+    }
+
+    // called by the audio thread after run(), before end_run()
+    void deliverResponses()
+    {
+        uint32_t size;
+
+        while (fResponses.readMessage(fRtData, kRingSize, size))
+        {
+            if (fWorker->work_response != nullptr)
+                fWorker->work_response(fHandle, size, fRtData);
+        }
+    }
+
+protected:
+    void run() override
+    {
+        uint32_t size;
+
+        while (! fStopNow)
+        {
+            if (fSemOk)
+                sem_wait(&fSem);
+            else
+                carla_msleep(5);
+
+            while (! fStopNow && fRequests.readMessage(fData, kRingSize, size))
+            {
+                const CarlaMutex::ScopedLocker sl(fWorkMutex);
+
+                fWorker->work(fHandle, carla_lv2_worker_respond, this, size, fData);
+            }
+        }
+    }
+
+private:
+    static const uint32_t kRingSize = 16384;
+
+    LV2_Handle fHandle;
+    const LV2_Worker_Interface* fWorker;
+
+    RtRingBuffer<kRingSize> fRequests;
+    RtRingBuffer<kRingSize> fResponses;
+
+    // messages are copied here before being passed to the plugin, aligned as if malloc'ed
+    double fData[kRingSize/sizeof(double)];
+    double fRtData[kRingSize/sizeof(double)];
+
+    CarlaMutex fWorkMutex;
+    volatile bool fStopNow;
+
+    sem_t fSem;
+    bool  fSemOk;
+
+    static LV2_Worker_Status carla_lv2_worker_respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+    {
+        CARLA_ASSERT(handle != nullptr);
+        carla_debug("carla_lv2_worker_respond(%p, %i, %p)", handle, size, data);
+
+        if (handle == nullptr)
+            return LV2_WORKER_ERR_UNKNOWN;
+
+        if (! ((Lv2Worker*)handle)->fResponses.writeMessage(data, size))
+            return LV2_WORKER_ERR_NO_SPACE;
+
+        return LV2_WORKER_SUCCESS;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(Lv2Worker)
+};
+
 // -----------------------------------------------------
 
 class Lv2Plugin : public CarlaPlugin,
@@ -377,9 +494,6 @@ public:
 
         kData->osc.thread.setMode(CarlaPluginThread::PLUGIN_THREAD_LV2_GUI);
 
-        for (uint32_t i=0; i < CARLA_URI_MAP_ID_COUNT; ++i)
-            fCustomURIDs.append(nullptr);
-
         fAtomForge.Blank    = CARLA_URI_MAP_ID_ATOM_BLANK;
         fAtomForge.Bool     = CARLA_URI_MAP_ID_ATOM_BOOL;
         fAtomForge.Chunk    = CARLA_URI_MAP_ID_ATOM_CHUNK;
@@ -457,6 +571,8 @@ public:
             kData->active = false;
         }
 
+        fWorker.stopNow();
+
         if (fDescriptor != nullptr)
         {
             if (fDescriptor->cleanup != nullptr)
@@ -517,19 +633,6 @@ public:
             }
         }
 
-        for (NonRtList<const char*>::Itenerator it = fCustomURIDs.begin(); it.valid(); it.next())
-        {
-            const char*& uri(*it);
-
-            if (uri != nullptr)
-            {
-                delete[] uri;
-                uri = nullptr;
-            }
-        }
-
-        fCustomURIDs.clear();
-
         clearBuffers();
     }
 
@@ -1089,6 +1192,7 @@ public:
             {
                 kData->osc.data.free();
                 kData->osc.thread.start();
+                fUi.uridCount = CARLA_URI_MAP_ID_COUNT;
             }
             else
             {
@@ -1246,6 +1350,13 @@ public:
         //if (fUi.type == PLUGIN_UI_NULL)
         //    return CarlaPlugin::idleGui();
 
+        // the OSC UI has its own URID map, send it all URIDs mapped since last time (by any plugin)
+        if (fUi.type == PLUGIN_UI_OSC && kData->osc.data.target != nullptr)
+        {
+            for (const uint32_t count = gLv2UridMap.getCount(); fUi.uridCount < count; ++fUi.uridCount)
+                osc_send_lv2_urid_map(&kData->osc.data, fUi.uridCount, gLv2UridMap.unmap(fUi.uridCount));
+        }
+
         if (! fAtomQueueOut.isEmpty())
         {
             Lv2AtomQueue tmpQueue;
@@ -1395,6 +1506,16 @@ public:
 
             if (kData->extraHints & PLUGIN_HAS_EXTENSION_WORKER)
                 fExt.worker = (const LV2_Worker_Interface*)fDescriptor->extension_data(LV2_WORKER__interface);
+
+            if (fExt.worker != nullptr && fExt.worker->work == nullptr)
+                fExt.worker = nullptr;
+        }
+
+        if (fExt.worker != nullptr)
+        {
+            // the plugin handle never changes, the thread keeps running after the first reload
+            if (! fWorker.isRunning())
+                fWorker.startNow(fHandle, fExt.worker);
         }
 
         if ((fOptions & PLUGIN_OPTION_FORCE_STEREO) != 0 && (aIns == 1 || aOuts == 1) && fExt.state == nullptr && fExt.worker == nullptr)
@@ -2545,8 +2666,6 @@ public:
                 CARLA_ASSERT(atom->size < 256);
             }
 
-            kData->postRtEvents.trySplice();
-
             std::memcpy(&fLastTimeInfo, &timeInfo, sizeof(EngineTimeInfo));
 
             CARLA_PROCESS_CONTINUE_CHECK;
@@ -2756,17 +2875,10 @@ public:
 #endif
 
                         // Control plugin parameters
-                        for (k=0; k < kData->param.count; ++k)
-                        {
-                            if (kData->param.data[k].midiChannel != event.channel)
-                                continue;
-                            if (kData->param.data[k].midiCC != ctrlEvent.param)
-                                continue;
-                            if (kData->param.data[k].type != PARAMETER_INPUT)
-                                continue;
-                            if ((kData->param.data[k].hints & PARAMETER_IS_AUTOMABLE) == 0)
-                                continue;
+                        const PluginMidiCCMap::Table& ccTable(kData->param.midiCCMap.getTableRT());
 
+                        for (k = ccTable.getFirst(event.channel, ctrlEvent.param); k < kData->param.count; k = ccTable.next[k])
+                        {
                             float value;
 
                             if (kData->param.data[k].hints & PARAMETER_IS_BOOLEAN)
@@ -2921,8 +3033,6 @@ public:
                 }
             }
 
-            kData->postRtEvents.trySplice();
-
             if (frames > timeOffset)
                 processSingle(inBuffer, outBuffer, frames - timeOffset, timeOffset);
 
@@ -3041,18 +3151,21 @@ public:
 
         CARLA_PROCESS_CONTINUE_CHECK;
 
-#if 0
         // --------------------------------------------------------------------------------------------------------
         // Final work
 
-        if (fExt.worker != nullptr && fExt.worker->end_run != nullptr)
+        if (fExt.worker != nullptr)
         {
-            fExt.worker->end_run(fHandle);
+            fWorker.deliverResponses();
 
-            if (fHandle2 != nullptr)
-                fExt.worker->end_run(fHandle2);
+            if (fExt.worker->end_run != nullptr)
+            {
+                fExt.worker->end_run(fHandle);
+
+                if (fHandle2 != nullptr)
+                    fExt.worker->end_run(fHandle2);
+            }
         }
-#endif
 
         fFirstActive = false;
 
@@ -3133,84 +3246,11 @@ public:
             }
         }
 
-        kData->postRtEvents.trySplice();
-
 #ifndef BUILD_BRIDGE
         // --------------------------------------------------------------------------------------------------------
         // Post-processing (dry/wet, volume and balance)
 
-        {
-            const bool doDryWet  = (fHints & PLUGIN_CAN_DRYWET) != 0 && kData->postProc.dryWet != 1.0f;
-            const bool doBalance = (fHints & PLUGIN_CAN_BALANCE) != 0 && (kData->postProc.balanceLeft != -1.0f || kData->postProc.balanceRight != 1.0f);
-
-            bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
-
-            for (i=0; i < kData->audioOut.count; ++i)
-            {
-                // Dry/Wet
-                if (doDryWet)
-                {
-                    for (k=0; k < frames; ++k)
-                    {
-                        // TODO
-                        //if (k < kData->latency && kData->latency < frames)
-                        //    bufValue = (kData->audioIn.count == 1) ? kData->latencyBuffers[0][k] : kData->latencyBuffers[i][k];
-                        //else
-                        //    bufValue = (kData->audioIn.count == 1) ? inBuffer[0][k-m_latency] : inBuffer[i][k-m_latency];
-
-                        bufValue = fAudioInBuffers[(kData->audioIn.count == 1) ? 0 : i][k];
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * kData->postProc.dryWet) + (bufValue * (1.0f - kData->postProc.dryWet));
-                    }
-                }
-
-                // Balance
-                if (doBalance)
-                {
-                    isPair = (i % 2 == 0);
-
-                    if (isPair)
-                    {
-                        CARLA_ASSERT(i+1 < kData->audioOut.count);
-                        carla_copyFloat(oldBufLeft, fAudioOutBuffers[i], frames);
-                    }
-
-                    float balRangeL = (kData->postProc.balanceLeft  + 1.0f)/2.0f;
-                    float balRangeR = (kData->postProc.balanceRight + 1.0f)/2.0f;
-
-                    for (k=0; k < frames; ++k)
-                    {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
-                    }
-                }
-
-                // Volume (and buffer copy)
-                {
-                    for (k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] = fAudioOutBuffers[i][k] * kData->postProc.volume;
-                }
-            }
-
-# if 0
-            // Latency, save values for next callback, TODO
-            if (kData->latency > 0 && kData->latency < frames)
-            {
-                for (i=0; i < kData->audioIn.count; ++i)
-                    carla_copyFloat(kData->latencyBuffers[i], inBuffer[i] + (frames - kData->latency), kData->latency);
-            }
-# endif
-        } // End of Post-processing
+        processPostProc(fAudioInBuffers, fAudioOutBuffers, outBuffer, frames, 0, timeOffset);
 #else
         for (i=0; i < kData->audioOut.count; ++i)
         {
@@ -3528,47 +3568,6 @@ protected:
 
     // -------------------------------------------------------------------
 
-    LV2_URID getCustomURID(const char* const uri)
-    {
-        CARLA_ASSERT(uri != nullptr);
-        carla_debug("Lv2Plugin::getCustomURID(\"%s\")", uri);
-
-        if (uri == nullptr)
-            return CARLA_URI_MAP_ID_NULL;
-
-        for (size_t i=0; i < fCustomURIDs.count(); ++i)
-        {
-            const char*& thisUri(fCustomURIDs.getAt(i));
-            if (thisUri != nullptr && std::strcmp(thisUri, uri) == 0)
-                return i;
-        }
-
-        fCustomURIDs.append(carla_strdup(uri));
-
-        const LV2_URID urid(fCustomURIDs.count()-1);
-
-        if (fUi.type == PLUGIN_UI_OSC && kData->osc.data.target != nullptr)
-            osc_send_lv2_urid_map(&kData->osc.data, urid, uri);
-
-        return urid;
-    }
-
-    const char* getCustomURIString(const LV2_URID urid)
-    {
-        CARLA_ASSERT(urid != CARLA_URI_MAP_ID_NULL);
-        CARLA_ASSERT_INT2(urid < fCustomURIDs.count(), urid, fCustomURIDs.count());
-        carla_debug("Lv2Plugin::getCustomURIString(%i)", urid);
-
-        if (urid == CARLA_URI_MAP_ID_NULL)
-            return nullptr;
-        if (urid < fCustomURIDs.count())
-            return fCustomURIDs.getAt(urid);
-
-        return nullptr;
-    }
-
-    // -------------------------------------------------------------------
-
     void handleProgramChanged(const int32_t index)
     {
         CARLA_ASSERT_INT(index >= -1, index);
@@ -3745,37 +3744,16 @@ protected:
 
     LV2_Worker_Status handleWorkerSchedule(const uint32_t size, const void* const data)
     {
-        carla_stdout("Lv2Plugin::handleWorkerSchedule(%i, %p)", size, data);
+        carla_debug("Lv2Plugin::handleWorkerSchedule(%i, %p)", size, data);
 
-        if (fExt.worker == nullptr || fExt.worker->work == nullptr)
+        if (fExt.worker == nullptr)
         {
             carla_stderr("Lv2Plugin::handleWorkerSchedule(%i, %p) - plugin has no worker", size, data);
             return LV2_WORKER_ERR_UNKNOWN;
         }
 
-        //if (kData->engine->isOffline())
-        fExt.worker->work(fHandle, carla_lv2_worker_respond, this, size, data);
-        //else
-        //    postponeEvent(PluginPostEventCustom, size, 0, 0.0, data);
-
-        return LV2_WORKER_SUCCESS;
-    }
-
-    LV2_Worker_Status handleWorkerRespond(const uint32_t size, const void* const data)
-    {
-        carla_stdout("Lv2Plugin::handleWorkerRespond(%i, %p)", size, data);
-
-#if 0
-        LV2_Atom_Worker workerAtom;
-        workerAtom.atom.type = CARLA_URI_MAP_ID_ATOM_WORKER;
-        workerAtom.atom.size = sizeof(LV2_Atom_Worker_Body);
-        workerAtom.body.size = size;
-        workerAtom.body.data = data;
-
-        atomQueueIn.put(0, (const LV2_Atom*)&workerAtom);
-#endif
-
-        return LV2_WORKER_SUCCESS;
+        // offline the work is done right away, its responses are still delivered at the end of process()
+        return fWorker.schedule(size, data, kData->engine->isOffline());
     }
 
     // -------------------------------------------------------------------
@@ -4048,11 +4026,17 @@ public:
         }
 
         // ---------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+        // get plugin from lv2_rdf (cache or lilv)
+
+        fRdfDescriptor = gLv2RdfCache.get(uri);
 
-        gLv2World.init();
+        if (fRdfDescriptor == nullptr)
+        {
+            gLv2World.initFor(uri);
 
-        fRdfDescriptor = lv2_rdf_new(uri);
+            fRdfDescriptor = lv2_rdf_new(uri);
+            gLv2RdfCache.put(fRdfDescriptor);
+        }
 
         if (fRdfDescriptor == nullptr)
         {
@@ -4717,18 +4701,14 @@ public:
         fAtomQueueIn.put(portIndex, atom);
     }
 
-    void handleUridMap(const LV2_URID urid, const char* const uri)
+    void handleUridMapRequest(const char* const uri)
     {
-        CARLA_ASSERT(urid != CARLA_URI_MAP_ID_NULL);
         CARLA_ASSERT(uri != nullptr);
-        carla_debug("Lv2Plugin::handleUridMap(%i, \"%s\")", urid, uri);
+        carla_debug("Lv2Plugin::handleUridMapRequest(\"%s\")", uri);
 
-        CARLA_SAFE_ASSERT_INT2(urid == fCustomURIDs.count(), urid, fCustomURIDs.count());
-
-        if (urid != fCustomURIDs.count())
-            return;
-
-        fCustomURIDs.append(carla_strdup(uri));
+        // the UI waits for this URID, idleGui() sends it together with the ones it does not have yet
+        if (uri != nullptr)
+            gLv2UridMap.map(uri);
     }
 
     // -------------------------------------------------------------------
@@ -4748,11 +4728,12 @@ private:
     Lv2AtomQueue   fAtomQueueOut;
     LV2_Atom_Forge fAtomForge;
 
+    Lv2Worker fWorker;
+
     Lv2PluginEventData fEventsIn;
     Lv2PluginEventData fEventsOut;
     Lv2PluginOptions   fLv2Options;
 
-    NonRtList<const char*> fCustomURIDs;
 
     bool fFirstActive; // first process() call after activate()
     EngineTimeInfo fLastTimeInfo;
@@ -4780,13 +4761,15 @@ private:
         LV2UI_Widget widget;
         const LV2UI_Descriptor* descriptor;
         const LV2_RDF_UI*       rdfDescriptor;
+        uint32_t uridCount; // URIDs already sent to the OSC UI
 
         UI()
             : type(PLUGIN_UI_NULL),
               handle(nullptr),
               widget(nullptr),
               descriptor(nullptr),
-              rdfDescriptor(nullptr) {}
+              rdfDescriptor(nullptr),
+              uridCount(CARLA_URI_MAP_ID_COUNT) {}
 
         ~UI()
         {
@@ -4990,101 +4973,9 @@ private:
         CARLA_ASSERT(handle != nullptr);
         CARLA_ASSERT(uri != nullptr);
         carla_debug("carla_lv2_urid_map(%p, \"%s\")", handle, uri);
+        (void)handle;
 
-        if (uri == nullptr)
-            return CARLA_URI_MAP_ID_NULL;
-
-        // Atom types
-        if (std::strcmp(uri, LV2_ATOM__Blank) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BLANK;
-        if (std::strcmp(uri, LV2_ATOM__Bool) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BOOL;
-        if (std::strcmp(uri, LV2_ATOM__Chunk) == 0)
-            return CARLA_URI_MAP_ID_ATOM_CHUNK;
-        if (std::strcmp(uri, LV2_ATOM__Double) == 0)
-            return CARLA_URI_MAP_ID_ATOM_DOUBLE;
-        if (std::strcmp(uri, LV2_ATOM__Float) == 0)
-            return CARLA_URI_MAP_ID_ATOM_FLOAT;
-        if (std::strcmp(uri, LV2_ATOM__Int) == 0)
-            return CARLA_URI_MAP_ID_ATOM_INT;
-        if (std::strcmp(uri, LV2_ATOM__Literal) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LITERAL;
-        if (std::strcmp(uri, LV2_ATOM__Long) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LONG;
-        if (std::strcmp(uri, LV2_ATOM__Path) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PATH;
-        if (std::strcmp(uri, LV2_ATOM__Property) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PROPERTY;
-        if (std::strcmp(uri, LV2_ATOM__Resource) == 0)
-            return CARLA_URI_MAP_ID_ATOM_RESOURCE;
-        if (std::strcmp(uri, LV2_ATOM__Sequence) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SEQUENCE;
-        if (std::strcmp(uri, LV2_ATOM__String) == 0)
-            return CARLA_URI_MAP_ID_ATOM_STRING;
-        if (std::strcmp(uri, LV2_ATOM__Tuple) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TUPLE;
-        if (std::strcmp(uri, LV2_ATOM__URI) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URI;
-        if (std::strcmp(uri, LV2_ATOM__URID) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URID;
-        if (std::strcmp(uri, LV2_ATOM__Vector) == 0)
-            return CARLA_URI_MAP_ID_ATOM_VECTOR;
-        if (std::strcmp(uri, LV2_ATOM__atomTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM;
-        if (std::strcmp(uri, LV2_ATOM__eventTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT;
-
-        // BufSize types
-        if (std::strcmp(uri, LV2_BUF_SIZE__maxBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MAX_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__minBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MIN_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__sequenceSize) == 0)
-            return CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE;
-
-        // Log types
-        if (std::strcmp(uri, LV2_LOG__Error) == 0)
-            return CARLA_URI_MAP_ID_LOG_ERROR;
-        if (std::strcmp(uri, LV2_LOG__Note) == 0)
-            return CARLA_URI_MAP_ID_LOG_NOTE;
-        if (std::strcmp(uri, LV2_LOG__Trace) == 0)
-            return CARLA_URI_MAP_ID_LOG_TRACE;
-        if (std::strcmp(uri, LV2_LOG__Warning) == 0)
-            return CARLA_URI_MAP_ID_LOG_WARNING;
-
-        // Time types
-        if (std::strcmp(uri, LV2_TIME__Position) == 0)
-            return CARLA_URI_MAP_ID_TIME_POSITION;
-        if (std::strcmp(uri, LV2_TIME__bar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR;
-        if (std::strcmp(uri, LV2_TIME__barBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beatUnit) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT_UNIT;
-        if (std::strcmp(uri, LV2_TIME__beatsPerBar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR;
-        if (std::strcmp(uri, LV2_TIME__beatsPerMinute) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE;
-        if (std::strcmp(uri, LV2_TIME__frame) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAME;
-        if (std::strcmp(uri, LV2_TIME__framesPerSecond) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND;
-        if (std::strcmp(uri, LV2_TIME__speed) == 0)
-            return CARLA_URI_MAP_ID_TIME_SPEED;
-
-        // Others
-        if (std::strcmp(uri, LV2_MIDI__MidiEvent) == 0)
-            return CARLA_URI_MAP_ID_MIDI_EVENT;
-        if (std::strcmp(uri, LV2_PARAMETERS__sampleRate) == 0)
-            return CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE;
-
-        if (handle == nullptr)
-            return CARLA_URI_MAP_ID_NULL;
-
-        // Custom types
-        return ((Lv2Plugin*)handle)->getCustomURID(uri);
+        return gLv2UridMap.map(uri);
     }
 
     static const char* carla_lv2_urid_unmap(LV2_URID_Map_Handle handle, LV2_URID urid)
@@ -5092,101 +4983,9 @@ private:
         carla_debug("carla_lv2_urid_unmap(%p, %i)", handle, urid);
         CARLA_ASSERT(handle != nullptr);
         CARLA_ASSERT(urid > CARLA_URI_MAP_ID_NULL);
+        (void)handle;
 
-        if (urid == CARLA_URI_MAP_ID_NULL)
-            return nullptr;
-
-        // Atom types
-        if (urid == CARLA_URI_MAP_ID_ATOM_BLANK)
-            return LV2_ATOM__Blank;
-        if (urid == CARLA_URI_MAP_ID_ATOM_BOOL)
-            return LV2_ATOM__Bool;
-        if (urid == CARLA_URI_MAP_ID_ATOM_CHUNK)
-            return LV2_ATOM__Chunk;
-        if (urid == CARLA_URI_MAP_ID_ATOM_DOUBLE)
-            return LV2_ATOM__Double;
-        if (urid == CARLA_URI_MAP_ID_ATOM_FLOAT)
-            return LV2_ATOM__Float;
-        if (urid == CARLA_URI_MAP_ID_ATOM_INT)
-            return LV2_ATOM__Int;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LITERAL)
-            return LV2_ATOM__Literal;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LONG)
-            return LV2_ATOM__Long;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PATH)
-            return LV2_ATOM__Path;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PROPERTY)
-            return LV2_ATOM__Property;
-        if (urid == CARLA_URI_MAP_ID_ATOM_RESOURCE)
-            return LV2_ATOM__Resource;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SEQUENCE)
-            return LV2_ATOM__Sequence;
-        if (urid == CARLA_URI_MAP_ID_ATOM_STRING)
-            return LV2_ATOM__String;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TUPLE)
-            return LV2_ATOM__Tuple;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URI)
-            return LV2_ATOM__URI;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URID)
-            return LV2_ATOM__URID;
-        if (urid == CARLA_URI_MAP_ID_ATOM_VECTOR)
-            return LV2_ATOM__Vector;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM)
-            return LV2_ATOM__atomTransfer;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT)
-            return LV2_ATOM__eventTransfer;
-
-        // BufSize types
-        if (urid == CARLA_URI_MAP_ID_BUF_MAX_LENGTH)
-            return LV2_BUF_SIZE__maxBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_MIN_LENGTH)
-            return LV2_BUF_SIZE__minBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE)
-            return LV2_BUF_SIZE__sequenceSize;
-
-        // Log types
-        if (urid == CARLA_URI_MAP_ID_LOG_ERROR)
-            return LV2_LOG__Error;
-        if (urid == CARLA_URI_MAP_ID_LOG_NOTE)
-            return LV2_LOG__Note;
-        if (urid == CARLA_URI_MAP_ID_LOG_TRACE)
-            return LV2_LOG__Trace;
-        if (urid == CARLA_URI_MAP_ID_LOG_WARNING)
-            return LV2_LOG__Warning;
-
-        // Time types
-        if (urid == CARLA_URI_MAP_ID_TIME_POSITION)
-            return LV2_TIME__Position;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR)
-            return LV2_TIME__bar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR_BEAT)
-            return LV2_TIME__barBeat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT)
-            return LV2_TIME__beat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT_UNIT)
-            return LV2_TIME__beatUnit;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR)
-            return LV2_TIME__beatsPerBar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE)
-            return LV2_TIME__beatsPerMinute;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAME)
-            return LV2_TIME__frame;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND)
-            return LV2_TIME__framesPerSecond;
-        if (urid == CARLA_URI_MAP_ID_TIME_SPEED)
-            return LV2_TIME__speed;
-
-        // Others
-        if (urid == CARLA_URI_MAP_ID_MIDI_EVENT)
-            return LV2_MIDI__MidiEvent;
-        if (urid == CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE)
-            return LV2_PARAMETERS__sampleRate;
-
-        if (handle == nullptr)
-            return nullptr;
-
-        // Custom types
-        return ((Lv2Plugin*)handle)->getCustomURIString(urid);
+        return gLv2UridMap.unmap(urid);
     }
 
     // -------------------------------------------------------------------
@@ -5203,17 +5002,6 @@ private:
         return ((Lv2Plugin*)handle)->handleWorkerSchedule(size, data);
     }
 
-    static LV2_Worker_Status carla_lv2_worker_respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
-    {
-        CARLA_ASSERT(handle != nullptr);
-        carla_debug("carla_lv2_worker_respond(%p, %i, %p)", handle, size, data);
-
-        if (handle == nullptr)
-            return LV2_WORKER_ERR_UNKNOWN;
-
-        return ((Lv2Plugin*)handle)->handleWorkerRespond(size, data);
-    }
-
     // -------------------------------------------------------------------
     // UI Port-Map Feature
 
@@ -5320,10 +5108,11 @@ int CarlaEngineOsc::handleMsgLv2UridMap(CARLA_ENGINE_OSC_HANDLE_ARGS2)
     const int32_t urid    = argv[0]->i;
     const char* const uri = (const char*)&argv[1]->s;
 
-    if (urid <= 0)
-        return 0;
+    // the UI never maps new URIDs by itself, it asks for them with a null URID
+    if (urid != 0)
+        return 1;
 
-    lv2PluginPtr->handleUridMap(urid, uri);
+    lv2PluginPtr->handleUridMapRequest(uri);
     return 0;
 }
 
@@ -525,12 +525,15 @@ bool carla_engine_init(const char* driverName, const char* clientName)
 # endif
     standalone.engine->setOption(CarlaBackend::OPTION_FORCE_STEREO,               standalone.options.forceStereo ? 1 : 0,             nullptr);
     standalone.engine->setOption(CarlaBackend::OPTION_PREFER_PLUGIN_BRIDGES,      standalone.options.preferPluginBridges ? 1 : 0,     nullptr);
+    standalone.engine->setOption(CarlaBackend::OPTION_ASYNC_PLUGIN_BRIDGES,       standalone.options.asyncPluginBridges ? 1 : 0,      nullptr);
+    standalone.engine->setOption(CarlaBackend::OPTION_SHARE_PLUGIN_BRIDGES,       standalone.options.sharePluginBridges ? 1 : 0,      nullptr);
     standalone.engine->setOption(CarlaBackend::OPTION_PREFER_UI_BRIDGES,          standalone.options.preferUiBridges ? 1 : 0,         nullptr);
 # ifdef WANT_DSSI
     standalone.engine->setOption(CarlaBackend::OPTION_USE_DSSI_VST_CHUNKS,        standalone.options.useDssiVstChunks ? 1 : 0,        nullptr);
 # endif
     standalone.engine->setOption(CarlaBackend::OPTION_MAX_PARAMETERS,             static_cast<int>(standalone.options.maxParameters), nullptr);
     standalone.engine->setOption(CarlaBackend::OPTION_OSC_UI_TIMEOUT,             static_cast<int>(standalone.options.oscUiTimeout),  nullptr);
+    standalone.engine->setOption(CarlaBackend::OPTION_METER_LATENCY,              static_cast<int>(standalone.options.meterLatency),  nullptr);
     standalone.engine->setOption(CarlaBackend::OPTION_JACK_AUTOCONNECT,           standalone.options.jackAutoConnect ? 1 : 0,         nullptr);
     standalone.engine->setOption(CarlaBackend::OPTION_JACK_TIMEMASTER,            standalone.options.jackTimeMaster  ? 1 : 0,         nullptr);
 # ifdef WANT_RTAUDIO
@@ -680,6 +683,14 @@ void carla_set_engine_option(CarlaOptionsType option, int value, const char* val
         standalone.options.preferPluginBridges = (value != 0);
         break;
 
+    case CarlaBackend::OPTION_ASYNC_PLUGIN_BRIDGES:
+        standalone.options.asyncPluginBridges = (value != 0);
+        break;
+
+    case CarlaBackend::OPTION_SHARE_PLUGIN_BRIDGES:
+        standalone.options.sharePluginBridges = (value != 0);
+        break;
+
     case CarlaBackend::OPTION_PREFER_UI_BRIDGES:
         standalone.options.preferUiBridges = (value != 0);
         break;
@@ -704,6 +715,13 @@ void carla_set_engine_option(CarlaOptionsType option, int value, const char* val
         standalone.options.oscUiTimeout = static_cast<unsigned int>(value);
         break;
 
+    case CarlaBackend::OPTION_METER_LATENCY:
+        if (value <= 0)
+            return carla_stderr2("carla_set_engine_option(OPTION_METER_LATENCY, %i, \"%s\") - invalid value", value, valueStr);
+
+        standalone.options.meterLatency = static_cast<unsigned int>(value);
+        break;
+
     case CarlaBackend::OPTION_JACK_AUTOCONNECT:
         standalone.options.jackAutoConnect = (value != 0);
         break;
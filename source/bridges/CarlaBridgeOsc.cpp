@@ -193,6 +193,8 @@ int CarlaBridgeOsc::handleMessage(const char* const path, const int argc, const
 
 #ifdef BUILD_BRIDGE_PLUGIN
     // Plugin methods
+    if (std::strcmp(method, "plugin_add") == 0)
+        return handleMsgPluginAdd(argc, argv, types);
     if (std::strcmp(method, "plugin_save_now") == 0)
         return handleMsgPluginSaveNow();
     if (std::strcmp(method, "plugin_set_parameter_midi_channel") == 0)
@@ -114,6 +114,7 @@ private:
 #endif
 
 #ifdef BUILD_BRIDGE_PLUGIN
+    int handleMsgPluginAdd(CARLA_BRIDGE_OSC_HANDLE_ARGS);
     int handleMsgPluginSaveNow();
     int handleMsgPluginSetParameterMidiChannel(CARLA_BRIDGE_OSC_HANDLE_ARGS);
     int handleMsgPluginSetParameterMidiCC(CARLA_BRIDGE_OSC_HANDLE_ARGS);
@@ -111,125 +111,117 @@ CARLA_BRIDGE_START_NAMESPACE
 
 // -------------------------------------------------------------------------
 
-class CarlaPluginClient : public CarlaBridgeClient,
-                          public QObject
+class CarlaPluginClientPool;
+
+// One plugin running in this bridge, with its own OSC link to its plugin on the host side.
+class CarlaPluginClient : public CarlaBridgeClient
 {
 public:
-    CarlaPluginClient(const bool useBridge, const char* const driverName, const char* audioBaseName, const char* controlBaseName)
+    CarlaPluginClient(CarlaPluginClientPool* const pool, CarlaBackend::CarlaEngine* const engine, const unsigned int slot)
         : CarlaBridgeClient(nullptr),
-          QObject(nullptr),
-          fEngine(nullptr),
-          fPlugin(nullptr),
-          fTimerId(0)
+          kPool(pool),
+          kEngine(engine),
+          kSlot(slot),
+          fPlugin(nullptr)
     {
-        CARLA_ASSERT(driverName != nullptr);
-        carla_debug("CarlaPluginClient::CarlaPluginClient(%s, \"%s\", %s, %s)", bool2str(useBridge), driverName, audioBaseName, controlBaseName);
-
-        if (useBridge)
-            carla_engine_init_bridge(audioBaseName, controlBaseName, driverName);
-        else
-            carla_engine_init("JACK", driverName);
-
-        carla_set_engine_callback(callback, this);
+        CARLA_ASSERT(pool != nullptr);
+        CARLA_ASSERT(engine != nullptr);
+        carla_debug("CarlaPluginClient::CarlaPluginClient(%p, %p, %i)", pool, engine, slot);
     }
 
     ~CarlaPluginClient()
     {
-        CARLA_ASSERT(fTimerId == 0);
         carla_debug("CarlaPluginClient::~CarlaPluginClient()");
-
-        carla_set_engine_about_to_close();
-        carla_engine_close();
     }
 
-    void oscInit(const char* const url)
+    CarlaPluginClientPool* getPool() const
     {
-        CarlaBridgeClient::oscInit(url);
+        return kPool;
+    }
 
-        fEngine = carla_get_standalone_engine();
-        fEngine->setOscBridgeData(fOscData);
+    CarlaBackend::CarlaPlugin* getPlugin() const
+    {
+        return fPlugin;
     }
 
-    void ready(const bool doSaveLoad)
+    bool loadPlugin(const char* const audioBaseName, const CarlaBackend::PluginType itype, const char* const filename, const char* const name, const char* const label)
     {
-        CARLA_ASSERT(fTimerId == 0);
+        carla_debug("CarlaPluginClient::loadPlugin(\"%s\", %s, \"%s\", \"%s\", \"%s\")", audioBaseName, CarlaBackend::PluginType2Str(itype), filename, name, label);
+        CARLA_ASSERT(fPlugin == nullptr);
 
-        fEngine = carla_get_standalone_engine();
-        fPlugin = fEngine->getPlugin(0);
+        const unsigned int id(kEngine->currentPluginCount());
 
-        if (doSaveLoad)
-        {
-            fProjFileName  = fPlugin->name();
-            fProjFileName += ".carxs";
+        // the plugin registers to the host while being added
+        if (isOscControlRegistered())
+            kEngine->setOscBridgeData(id, fOscData);
 
-            fPlugin->loadStateFromFile(fProjFileName);
-        }
+        const void* extraStuff = nullptr;
 
-        fTimerId = startTimer(50);
-    }
+        if (itype == CarlaBackend::PLUGIN_DSSI)
+            extraStuff = CarlaBackend::findDSSIGUI(filename, label);
 
-    void idle()
-    {
-        if (fEngine != nullptr)
-            fEngine->idle();
+        const bool added(carla_add_plugin(CarlaBackend::BINARY_NATIVE, itype, filename, name, label, extraStuff));
 
-        CarlaBridgeClient::oscIdle();
+        if (extraStuff != nullptr && itype == CarlaBackend::PLUGIN_DSSI)
+            delete[] (const char*)extraStuff;
 
-        if (gSaveNow)
+        if (! added)
         {
-            gSaveNow = false;
-
-            CARLA_ASSERT(fPlugin != nullptr);
-
-            if (fPlugin != nullptr && fProjFileName.isNotEmpty())
-                fPlugin->saveStateToFile(fProjFileName);
+            kEngine->setOscBridgeData(id, nullptr);
+            return false;
         }
 
-        if (gCloseNow)
-        {
-            gCloseNow = false;
+        fPlugin = kEngine->getPlugin(id);
 
-            if (fTimerId != 0)
-            {
-                killTimer(fTimerId);
-                fTimerId = 0;
-            }
-
-            if (QApplication* const app = qApp)
-            {
-                if (! app->closingDown())
-                    app->quit();
-            }
+        if (audioBaseName != nullptr && ! kEngine->attachBridgePlugin(kSlot, audioBaseName, id))
+        {
+            carla_remove_plugin(id);
+            fPlugin = nullptr;
+            return false;
         }
+
+        return true;
     }
 
-    void exec()
+    void removePlugin()
     {
-        while (! gCloseNow)
-        {
-            idle();
-            carla_msleep(50);
-        }
+        carla_debug("CarlaPluginClient::removePlugin()");
+
+        if (fPlugin == nullptr)
+            return;
+
+        carla_remove_plugin(fPlugin->id());
+        fPlugin = nullptr;
     }
 
     // ---------------------------------------------------------------------
     // plugin management
 
+    void showGui(const bool yesNo)
+    {
+        carla_debug("CarlaPluginClient::showGui(%s)", bool2str(yesNo));
+        CARLA_ASSERT(fPlugin != nullptr);
+
+        if (fPlugin != nullptr)
+            carla_show_gui(fPlugin->id(), yesNo);
+    }
+
     void saveNow()
     {
         carla_debug("CarlaPluginClient::saveNow()");
-        CARLA_ASSERT(fEngine != nullptr);
         CARLA_ASSERT(fPlugin != nullptr);
 
-        if (fPlugin == nullptr || fEngine == nullptr)
+        if (fPlugin == nullptr)
             return;
 
+        const unsigned int id(fPlugin->id());
+
         fPlugin->prepareForSave();
 
         for (uint32_t i=0; i < fPlugin->customDataCount(); ++i)
         {
             const CarlaBackend::CustomData& cdata(fPlugin->customData(i));
-            fEngine->osc_send_bridge_set_custom_data(cdata.type, cdata.key, cdata.value);
+            kEngine->osc_send_bridge_set_custom_data(id, cdata.type, cdata.key, cdata.value);
         }
 
         if (fPlugin->options() & CarlaBackend::PLUGIN_OPTION_USE_CHUNKS)
@@ -255,12 +247,12 @@ public:
                     QByteArray chunk((const char*)data, dataSize);
                     file.write(chunk);
                     file.close();
-                    fEngine->osc_send_bridge_set_chunk_data(filePath.toUtf8().constData());
+                    kEngine->osc_send_bridge_set_chunk_data(id, filePath.toUtf8().constData());
                 }
             }
         }
 
-        fEngine->osc_send_bridge_configure(CARLA_BRIDGE_MSG_SAVED, "");
+        kEngine->osc_send_bridge_configure(id, CARLA_BRIDGE_MSG_SAVED, "");
     }
 
     void setCustomData(const char* const type, const char* const key, const char* const value)
@@ -315,7 +307,9 @@ public:
             fPlugin->setParameterValueByRealIndex(rindex, value, true, true, false);
     }
 
-protected:
+    // ---------------------------------------------------------------------
+    // callbacks
+
     void handleCallback(const CarlaBackend::CallbackType action, const int value1, const int value2, const float value3, const char* const valueStr)
     {
         CARLA_BACKEND_USE_NAMESPACE;
@@ -335,10 +329,10 @@ protected:
                 if (value1 != 1)
                     gCloseNow = true;
             }
-            else
+            else if (fPlugin != nullptr)
             {
                 // show-gui button
-                fEngine->osc_send_bridge_configure(CARLA_BRIDGE_MSG_HIDE_GUI, "");
+                kEngine->osc_send_bridge_configure(fPlugin->id(), CARLA_BRIDGE_MSG_HIDE_GUI, "");
             }
             break;
         default:
@@ -352,12 +346,195 @@ protected:
     }
 
 private:
-    CarlaBackend::CarlaEngine* fEngine;
+    CarlaPluginClientPool* const kPool;
+    CarlaBackend::CarlaEngine* const kEngine;
+    const unsigned int kSlot;
+
     CarlaBackend::CarlaPlugin* fPlugin;
+};
+
+// -------------------------------------------------------------------------
+
+// The bridge engine and the plugin clients running in it, one per shared memory slot.
+class CarlaPluginClientPool : public QObject
+{
+public:
+    CarlaPluginClientPool(const bool useBridge, const char* const driverName, const char* const audioBaseName, const char* const controlBaseName)
+        : QObject(nullptr),
+          kUseBridge(useBridge),
+          fEngine(nullptr),
+          fTimerId(0)
+    {
+        CARLA_ASSERT(driverName != nullptr);
+        carla_debug("CarlaPluginClientPool::CarlaPluginClientPool(%s, \"%s\", %s, %s)", bool2str(useBridge), driverName, audioBaseName, controlBaseName);
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+            fClients[i] = nullptr;
+
+        if (useBridge)
+            carla_engine_init_bridge(audioBaseName, controlBaseName, driverName);
+        else
+            carla_engine_init("JACK", driverName);
+
+        carla_set_engine_callback(callback, this);
+
+        fEngine = carla_get_standalone_engine();
+    }
+
+    ~CarlaPluginClientPool()
+    {
+        CARLA_ASSERT(fTimerId == 0);
+        carla_debug("CarlaPluginClientPool::~CarlaPluginClientPool()");
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+        {
+            if (fClients[i] != nullptr)
+                removeClient(i);
+        }
+
+        carla_set_engine_about_to_close();
+        carla_engine_close();
+    }
+
+    /*
+     * Load a plugin into a slot, reporting to the host-side plugin at oscUrl (if not null).
+     * On failure the error is sent to that plugin and null is returned.
+     */
+    CarlaPluginClient* addClient(const unsigned int slot, const char* const oscUrl, const char* const audioBaseName, const CarlaBackend::PluginType itype,
+                                 const char* const filename, const char* const name, const char* const label)
+    {
+        carla_debug("CarlaPluginClientPool::addClient(%i, \"%s\", \"%s\", %s, \"%s\", \"%s\", \"%s\")", slot, oscUrl, audioBaseName, CarlaBackend::PluginType2Str(itype), filename, name, label);
+        CARLA_ASSERT(slot < BRIDGE_SHM_PLUGIN_COUNT);
+
+        if (slot >= BRIDGE_SHM_PLUGIN_COUNT || fEngine == nullptr)
+            return nullptr;
+
+        // the host may reuse a slot before our idle has cleaned it
+        removeDetached(slot);
+
+        CarlaPluginClient* const client(new CarlaPluginClient(this, fEngine, slot));
+
+        if (oscUrl != nullptr)
+            client->oscInit(oscUrl);
+
+        if (fClients[slot] != nullptr)
+            fEngine->setLastError("Bridge slot is already in use");
+        else if (client->loadPlugin(kUseBridge ? audioBaseName : nullptr, itype, filename, name, label))
+        {
+            fClients[slot] = client;
+
+            if (oscUrl != nullptr)
+            {
+                client->sendOscUpdate();
+                client->sendOscBridgeUpdate();
+            }
+
+            return client;
+        }
+
+        const char* const lastError = carla_get_last_error();
+        carla_stderr("Plugin failed to load, error was:\n%s", lastError);
+
+        if (oscUrl != nullptr)
+        {
+            client->sendOscBridgeError(lastError);
+            client->oscClose();
+        }
+
+        delete client;
+        return nullptr;
+    }
+
+    void ready(const bool doSaveLoad)
+    {
+        CARLA_ASSERT(fTimerId == 0);
+
+        if (doSaveLoad && fClients[0] != nullptr)
+        {
+            CarlaBackend::CarlaPlugin* const plugin(fClients[0]->getPlugin());
+
+            fProjFileName  = plugin->name();
+            fProjFileName += ".carxs";
+
+            plugin->loadStateFromFile(fProjFileName);
+        }
+
+        fTimerId = startTimer(50);
+    }
+
+    void idle()
+    {
+        if (fEngine != nullptr)
+            fEngine->idle();
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+            removeDetached(i);
+
+        // may add new clients
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+        {
+            if (fClients[i] != nullptr)
+                fClients[i]->oscIdle();
+        }
+
+        if (gSaveNow)
+        {
+            gSaveNow = false;
+
+            if (fClients[0] != nullptr && fProjFileName.isNotEmpty())
+                fClients[0]->getPlugin()->saveStateToFile(fProjFileName);
+        }
+
+        if (gCloseNow)
+        {
+            gCloseNow = false;
+
+            if (fTimerId != 0)
+            {
+                killTimer(fTimerId);
+                fTimerId = 0;
+            }
+
+            if (QApplication* const app = qApp)
+            {
+                if (! app->closingDown())
+                    app->quit();
+            }
+        }
+    }
+
+private:
+    const bool kUseBridge;
+
+    CarlaBackend::CarlaEngine* fEngine;
+    CarlaPluginClient* fClients[BRIDGE_SHM_PLUGIN_COUNT];
 
     CarlaString fProjFileName;
     int fTimerId;
 
+    void removeClient(const unsigned int slot)
+    {
+        CarlaPluginClient* const client(fClients[slot]);
+        fClients[slot] = nullptr;
+
+        client->removePlugin();
+
+        if (client->isOscControlRegistered())
+            client->oscClose();
+
+        delete client;
+    }
+
+    // the host took a plugin out of its slot, it can be removed now
+    void removeDetached(const unsigned int slot)
+    {
+        if (! kUseBridge || fEngine == nullptr)
+            return;
+
+        if (fEngine->takeDetachedBridgePlugin(slot) != nullptr && fClients[slot] != nullptr)
+            removeClient(slot);
+    }
+
     void timerEvent(QTimerEvent* const event)
     {
         if (event->timerId() == fTimerId)
@@ -368,10 +545,15 @@ private:
 
     static void callback(void* ptr, CarlaBackend::CallbackType action, unsigned int pluginId, int value1, int value2, float value3, const char* valueStr)
     {
-        return ((CarlaPluginClient*)ptr)->handleCallback(action, value1, value2, value3, valueStr);
+        CarlaPluginClientPool* const pool((CarlaPluginClientPool*)ptr);
+
+        for (unsigned int i=0; i < BRIDGE_SHM_PLUGIN_COUNT; ++i)
+        {
+            CarlaPluginClient* const client(pool->fClients[i]);
 
-        // unused
-        (void)pluginId;
+            if (client != nullptr && client->getPlugin() != nullptr && client->getPlugin()->id() == pluginId)
+                return client->handleCallback(action, value1, value2, value3, valueStr);
+        }
     }
 };
 
@@ -385,7 +567,8 @@ int CarlaBridgeOsc::handleMsgShow()
     if (kClient == nullptr)
         return 1;
 
-    carla_show_gui(0, true);
+    CarlaPluginClient* const plugClient = (CarlaPluginClient*)kClient;
+    plugClient->showGui(true);
 
     return 0;
 }
@@ -398,7 +581,8 @@ int CarlaBridgeOsc::handleMsgHide()
     if (kClient == nullptr)
         return 1;
 
-    carla_show_gui(0, false);
+    CarlaPluginClient* const plugClient = (CarlaPluginClient*)kClient;
+    plugClient->showGui(false);
 
     return 0;
 }
@@ -415,6 +599,50 @@ int CarlaBridgeOsc::handleMsgQuit()
 
 // -------------------------------------------------------------------------
 
+int CarlaBridgeOsc::handleMsgPluginAdd(CARLA_BRIDGE_OSC_HANDLE_ARGS)
+{
+    carla_debug("CarlaBridgeOsc::handleMsgPluginAdd()");
+    CARLA_ASSERT(kClient != nullptr);
+    CARLA_BRIDGE_OSC_CHECK_OSC_TYPES(7, "issssss");
+
+    if (kClient == nullptr)
+        return 1;
+
+    const int32_t     slot     = argv[0]->i;
+    const char* const stype    = (const char*)&argv[1]->s;
+    const char* const filename = (const char*)&argv[2]->s;
+    const char*       name     = (const char*)&argv[3]->s;
+    const char*       label    = (const char*)&argv[4]->s;
+    const char* const oscUrl   = (const char*)&argv[5]->s;
+    const char* const shmId    = (const char*)&argv[6]->s;
+
+    CARLA_SAFE_ASSERT_INT(slot >= 0 && slot < BRIDGE_SHM_PLUGIN_COUNT, slot);
+
+    if (slot < 0 || slot >= BRIDGE_SHM_PLUGIN_COUNT)
+        return 1;
+
+    const CarlaBackend::PluginType itype(CarlaBackend::getPluginTypeFromString(stype));
+
+    if (itype == CarlaBackend::PLUGIN_NONE)
+    {
+        carla_stderr("CarlaBridgeOsc::handleMsgPluginAdd() - invalid plugin type '%s'", stype);
+        return 1;
+    }
+
+    if (std::strcmp(name, "(none)") == 0)
+        name = nullptr;
+
+    if (std::strlen(label) == 0)
+        label = nullptr;
+
+    CarlaPluginClient* const plugClient = (CarlaPluginClient*)kClient;
+
+    if (plugClient->getPool()->addClient(static_cast<unsigned int>(slot), oscUrl, shmId, itype, filename, name, label) == nullptr)
+        return 1;
+
+    return 0;
+}
+
 int CarlaBridgeOsc::handleMsgPluginSaveNow()
 {
     carla_debug("CarlaBridgeOsc::handleMsgPluginSaveNow()");
@@ -547,32 +775,18 @@ int main(int argc, char* argv[])
     if (itype >= CarlaBackend::PLUGIN_GIG && itype <= CarlaBackend::PLUGIN_SFZ && label == nullptr)
         label = clientName;
 
-    // Init Plugin client
-    CarlaPluginClient client(useBridge, (const char*)clientName, bridgeBaseAudioName, bridgeBaseControlName);
-
-    // Init OSC
-    if (useOsc)
-        client.oscInit(oscUrl);
+    // Init engine
+    CarlaPluginClientPool pool(useBridge, (const char*)clientName, bridgeBaseAudioName, bridgeBaseControlName);
 
     // Listen for ctrl+c or sigint/sigterm events
     initSignalHandler();
 
-    const void* extraStuff = nullptr;
-
-    if (itype == CarlaBackend::PLUGIN_DSSI)
-        extraStuff = CarlaBackend::findDSSIGUI(filename, label);
-
-    // Init plugin
+    // Init plugin, the bridge host adds others later over OSC
     int ret;
 
-    if (carla_add_plugin(CarlaBackend::BINARY_NATIVE, itype, filename, name, label, extraStuff))
+    if (pool.addClient(0, useOsc ? oscUrl : nullptr, bridgeBaseAudioName, itype, filename, name, label) != nullptr)
     {
-        if (useOsc)
-        {
-            client.sendOscUpdate();
-            client.sendOscBridgeUpdate();
-        }
-        else
+        if (! useOsc)
         {
             carla_set_active(0, true);
 
@@ -583,29 +797,14 @@ int main(int argc, char* argv[])
             }
         }
 
-        client.ready(!useOsc);
+        pool.ready(!useOsc);
 
         ret = app.exec();
-
-        carla_remove_plugin(0);
     }
     else
     {
-        const char* const lastError = carla_get_last_error();
-        carla_stderr("Plugin failed to load, error was:\n%s", lastError);
-
-        if (useOsc)
-            client.sendOscBridgeError(lastError);
-
         ret = 1;
     }
 
-    if (extraStuff != nullptr && itype == CarlaBackend::PLUGIN_DSSI)
-        delete[] (const char*)extraStuff;
-
-    // Close OSC
-    if (useOsc)
-        client.oscClose();
-
     return ret;
 }
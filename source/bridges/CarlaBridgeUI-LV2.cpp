@@ -18,6 +18,8 @@
 #include "CarlaBridgeClient.hpp"
 #include "CarlaLv2Utils.hpp"
 #include "CarlaMIDI.h"
+#include "Lv2RdfCache.hpp"
+#include "Lv2UridMap.hpp"
 #include "RtList.hpp"
 
 #include <QtCore/QDir>
@@ -45,47 +47,11 @@ static double   gSampleRate = 44100.0;
 // static max values
 const unsigned int MAX_EVENT_BUFFER = 8192; // 0x2000
 
-// LV2 URI Map Ids
-const uint32_t CARLA_URI_MAP_ID_NULL                   =  0;
-const uint32_t CARLA_URI_MAP_ID_ATOM_BLANK             =  1;
-const uint32_t CARLA_URI_MAP_ID_ATOM_BOOL              =  2;
-const uint32_t CARLA_URI_MAP_ID_ATOM_CHUNK             =  3;
-const uint32_t CARLA_URI_MAP_ID_ATOM_DOUBLE            =  4;
-const uint32_t CARLA_URI_MAP_ID_ATOM_FLOAT             =  5;
-const uint32_t CARLA_URI_MAP_ID_ATOM_INT               =  6;
-const uint32_t CARLA_URI_MAP_ID_ATOM_LITERAL           =  7;
-const uint32_t CARLA_URI_MAP_ID_ATOM_LONG              =  8;
-const uint32_t CARLA_URI_MAP_ID_ATOM_PATH              =  9;
-const uint32_t CARLA_URI_MAP_ID_ATOM_PROPERTY          = 10;
-const uint32_t CARLA_URI_MAP_ID_ATOM_RESOURCE          = 11;
-const uint32_t CARLA_URI_MAP_ID_ATOM_SEQUENCE          = 12;
-const uint32_t CARLA_URI_MAP_ID_ATOM_STRING            = 13;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TUPLE             = 14;
-const uint32_t CARLA_URI_MAP_ID_ATOM_URI               = 15;
-const uint32_t CARLA_URI_MAP_ID_ATOM_URID              = 16;
-const uint32_t CARLA_URI_MAP_ID_ATOM_VECTOR            = 17;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM     = 18;
-const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT    = 19;
-const uint32_t CARLA_URI_MAP_ID_BUF_MAX_LENGTH         = 20;
-const uint32_t CARLA_URI_MAP_ID_BUF_MIN_LENGTH         = 21;
-const uint32_t CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE      = 22;
-const uint32_t CARLA_URI_MAP_ID_LOG_ERROR              = 23;
-const uint32_t CARLA_URI_MAP_ID_LOG_NOTE               = 24;
-const uint32_t CARLA_URI_MAP_ID_LOG_TRACE              = 25;
-const uint32_t CARLA_URI_MAP_ID_LOG_WARNING            = 26;
-const uint32_t CARLA_URI_MAP_ID_TIME_POSITION          = 27; // base type
-const uint32_t CARLA_URI_MAP_ID_TIME_BAR               = 28; // values
-const uint32_t CARLA_URI_MAP_ID_TIME_BAR_BEAT          = 29;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEAT              = 30;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEAT_UNIT         = 31;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR     = 32;
-const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE  = 33;
-const uint32_t CARLA_URI_MAP_ID_TIME_FRAME             = 34;
-const uint32_t CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND = 35;
-const uint32_t CARLA_URI_MAP_ID_TIME_SPEED             = 36;
-const uint32_t CARLA_URI_MAP_ID_MIDI_EVENT             = 37;
-const uint32_t CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE      = 38;
-const uint32_t CARLA_URI_MAP_ID_COUNT                  = 39;
+// URID map shared by all plugins and UIs
+static Lv2UridMap gLv2UridMap(kFixedURIs, CARLA_URI_MAP_ID_COUNT);
+
+// Plugin descriptors from previous runs, lilv only loads the world on a cache miss
+static Lv2RdfCache gLv2RdfCache;
 
 // LV2 Feature Ids
 const uint32_t kFeatureIdLogs             =  0;
@@ -197,9 +163,6 @@ public:
         carla_fill<LV2_Feature*>(fFeatures, kFeatureCount+1, nullptr);
 #endif
 
-        for (uint32_t i=0; i < CARLA_URI_MAP_ID_COUNT; ++i)
-            fCustomURIDs.append(nullptr);
-
         // ---------------------------------------------------------------
         // initialize options
 
@@ -329,19 +292,6 @@ public:
                 fFeatures[i] = nullptr;
             }
         }
-
-        for (NonRtList<const char*>::Itenerator it = fCustomURIDs.begin(); it.valid(); it.next())
-        {
-            const char*& uri(*it);
-
-            if (uri != nullptr)
-            {
-                delete[] uri;
-                uri = nullptr;
-            }
-        }
-
-        fCustomURIDs.clear();
     }
 
     // ---------------------------------------------------------------------
@@ -355,10 +305,16 @@ public:
         CarlaBridgeClient::uiInit(pluginURI, uiURI);
 
         // -----------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+        // get plugin from lv2_rdf (cache or lilv)
 
-        gLv2World.init();
-        fRdfDescriptor = lv2_rdf_new(pluginURI);
+        fRdfDescriptor = gLv2RdfCache.get(pluginURI);
+
+        if (fRdfDescriptor == nullptr)
+        {
+            gLv2World.initFor(pluginURI);
+            fRdfDescriptor = lv2_rdf_new(pluginURI);
+            gLv2RdfCache.put(fRdfDescriptor);
+        }
 
         if (fRdfDescriptor == nullptr)
             return false;
@@ -555,35 +511,26 @@ public:
         if (uri == nullptr)
             return CARLA_URI_MAP_ID_NULL;
 
-        for (size_t i=0; i < fCustomURIDs.count(); ++i)
-        {
-            const char*& thisUri(fCustomURIDs.getAt(i));
-            if (thisUri != nullptr && std::strcmp(thisUri, uri) == 0)
-                return i;
-        }
-
-        fCustomURIDs.append(carla_strdup(uri));
-
-        const LV2_URID urid(fCustomURIDs.count()-1);
+        // no host to follow
+        if (! isOscControlRegistered())
+            return gLv2UridMap.map(uri);
 
-        if (isOscControlRegistered())
-            sendOscLv2UridMap(urid, uri);
+        if (const LV2_URID urid = gLv2UridMap.lookup(uri))
+            return urid;
 
-        return urid;
-    }
+        // the host owns the map, ask it for a new URID and wait until it arrives together with the others
+        sendOscLv2UridMap(CARLA_URI_MAP_ID_NULL, uri);
 
-    const char* getCustomURIString(const LV2_URID urid)
-    {
-        CARLA_ASSERT(urid != CARLA_URI_MAP_ID_NULL);
-        CARLA_ASSERT_INT2(urid < fCustomURIDs.count(), urid, fCustomURIDs.count());
-        carla_debug("CarlaLv2Client::getCustomURIString(%i)", urid);
+        for (int i=0; i < 200 && oscIdle(); ++i)
+        {
+            if (const LV2_URID urid = gLv2UridMap.lookup(uri))
+                return urid;
 
-        if (urid == CARLA_URI_MAP_ID_NULL)
-            return nullptr;
-        if (urid < fCustomURIDs.count())
-            return fCustomURIDs.getAt(urid);
+            carla_msleep(10);
+        }
 
-        return nullptr;
+        carla_stderr("CarlaLv2Client::getCustomURID(\"%s\") - host did not reply in time", uri);
+        return CARLA_URI_MAP_ID_NULL;
     }
 
     // ---------------------------------------------------------------------
@@ -675,7 +622,9 @@ public:
         CARLA_ASSERT(uri != nullptr);
         carla_debug("CarlaLv2Client::handleUridMap(%i, \"%s\")", urid, uri);
 
-        // TODO
+        // the host sends all of its URIDs in order, ours must end up the same
+        if (! gLv2UridMap.insert(urid, uri))
+            carla_stderr("CarlaLv2Client::handleUridMap(%i, \"%s\") - URID does not match ours", urid, uri);
     }
 
 private:
@@ -689,7 +638,6 @@ private:
     Lv2PluginOptions          fOptions;
 
     bool fIsResizable;
-    NonRtList<const char*> fCustomURIDs;
 
     struct Extensions {
         const LV2_Options_Interface* options;
@@ -852,99 +800,9 @@ private:
         CARLA_ASSERT(uri != nullptr);
         carla_debug("CarlaLv2Client::carla_lv2_urid_map(%p, \"%s\")", handle, uri);
 
-        if (uri == nullptr)
-            return CARLA_URI_MAP_ID_NULL;
-
-        // Atom types
-        if (std::strcmp(uri, LV2_ATOM__Blank) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BLANK;
-        if (std::strcmp(uri, LV2_ATOM__Bool) == 0)
-            return CARLA_URI_MAP_ID_ATOM_BOOL;
-        if (std::strcmp(uri, LV2_ATOM__Chunk) == 0)
-            return CARLA_URI_MAP_ID_ATOM_CHUNK;
-        if (std::strcmp(uri, LV2_ATOM__Double) == 0)
-            return CARLA_URI_MAP_ID_ATOM_DOUBLE;
-        if (std::strcmp(uri, LV2_ATOM__Float) == 0)
-            return CARLA_URI_MAP_ID_ATOM_FLOAT;
-        if (std::strcmp(uri, LV2_ATOM__Int) == 0)
-            return CARLA_URI_MAP_ID_ATOM_INT;
-        if (std::strcmp(uri, LV2_ATOM__Literal) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LITERAL;
-        if (std::strcmp(uri, LV2_ATOM__Long) == 0)
-            return CARLA_URI_MAP_ID_ATOM_LONG;
-        if (std::strcmp(uri, LV2_ATOM__Path) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PATH;
-        if (std::strcmp(uri, LV2_ATOM__Property) == 0)
-            return CARLA_URI_MAP_ID_ATOM_PROPERTY;
-        if (std::strcmp(uri, LV2_ATOM__Resource) == 0)
-            return CARLA_URI_MAP_ID_ATOM_RESOURCE;
-        if (std::strcmp(uri, LV2_ATOM__Sequence) == 0)
-            return CARLA_URI_MAP_ID_ATOM_SEQUENCE;
-        if (std::strcmp(uri, LV2_ATOM__String) == 0)
-            return CARLA_URI_MAP_ID_ATOM_STRING;
-        if (std::strcmp(uri, LV2_ATOM__Tuple) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TUPLE;
-        if (std::strcmp(uri, LV2_ATOM__URI) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URI;
-        if (std::strcmp(uri, LV2_ATOM__URID) == 0)
-            return CARLA_URI_MAP_ID_ATOM_URID;
-        if (std::strcmp(uri, LV2_ATOM__Vector) == 0)
-            return CARLA_URI_MAP_ID_ATOM_VECTOR;
-        if (std::strcmp(uri, LV2_ATOM__atomTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM;
-        if (std::strcmp(uri, LV2_ATOM__eventTransfer) == 0)
-            return CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT;
-
-        // BufSize types
-        if (std::strcmp(uri, LV2_BUF_SIZE__maxBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MAX_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__minBlockLength) == 0)
-            return CARLA_URI_MAP_ID_BUF_MIN_LENGTH;
-        if (std::strcmp(uri, LV2_BUF_SIZE__sequenceSize) == 0)
-            return CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE;
-
-        // Log types
-        if (std::strcmp(uri, LV2_LOG__Error) == 0)
-            return CARLA_URI_MAP_ID_LOG_ERROR;
-        if (std::strcmp(uri, LV2_LOG__Note) == 0)
-            return CARLA_URI_MAP_ID_LOG_NOTE;
-        if (std::strcmp(uri, LV2_LOG__Trace) == 0)
-            return CARLA_URI_MAP_ID_LOG_TRACE;
-        if (std::strcmp(uri, LV2_LOG__Warning) == 0)
-            return CARLA_URI_MAP_ID_LOG_WARNING;
-
-        // Time types
-        if (std::strcmp(uri, LV2_TIME__Position) == 0)
-            return CARLA_URI_MAP_ID_TIME_POSITION;
-        if (std::strcmp(uri, LV2_TIME__bar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR;
-        if (std::strcmp(uri, LV2_TIME__barBeat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BAR_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beat) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT;
-        if (std::strcmp(uri, LV2_TIME__beatUnit) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEAT_UNIT;
-        if (std::strcmp(uri, LV2_TIME__beatsPerBar) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR;
-        if (std::strcmp(uri, LV2_TIME__beatsPerMinute) == 0)
-            return CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE;
-        if (std::strcmp(uri, LV2_TIME__frame) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAME;
-        if (std::strcmp(uri, LV2_TIME__framesPerSecond) == 0)
-            return CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND;
-        if (std::strcmp(uri, LV2_TIME__speed) == 0)
-            return CARLA_URI_MAP_ID_TIME_SPEED;
-
-        // Others
-        if (std::strcmp(uri, LV2_MIDI__MidiEvent) == 0)
-            return CARLA_URI_MAP_ID_MIDI_EVENT;
-        if (std::strcmp(uri, LV2_PARAMETERS__sampleRate) == 0)
-            return CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE;
-
         if (handle == nullptr)
-            return CARLA_URI_MAP_ID_NULL;
+            return gLv2UridMap.map(uri);
 
-        // Custom types
         return ((CarlaLv2Client*)handle)->getCustomURID(uri);
     }
 
@@ -953,101 +811,9 @@ private:
         carla_debug("CarlaLv2Client::carla_lv2_urid_unmap(%p, %i)", handle, urid);
         CARLA_ASSERT(handle != nullptr);
         CARLA_ASSERT(urid > CARLA_URI_MAP_ID_NULL);
+        (void)handle;
 
-        if (urid == CARLA_URI_MAP_ID_NULL)
-            return nullptr;
-
-        // Atom types
-        if (urid == CARLA_URI_MAP_ID_ATOM_BLANK)
-            return LV2_ATOM__Blank;
-        if (urid == CARLA_URI_MAP_ID_ATOM_BOOL)
-            return LV2_ATOM__Bool;
-        if (urid == CARLA_URI_MAP_ID_ATOM_CHUNK)
-            return LV2_ATOM__Chunk;
-        if (urid == CARLA_URI_MAP_ID_ATOM_DOUBLE)
-            return LV2_ATOM__Double;
-        if (urid == CARLA_URI_MAP_ID_ATOM_FLOAT)
-            return LV2_ATOM__Float;
-        if (urid == CARLA_URI_MAP_ID_ATOM_INT)
-            return LV2_ATOM__Int;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LITERAL)
-            return LV2_ATOM__Literal;
-        if (urid == CARLA_URI_MAP_ID_ATOM_LONG)
-            return LV2_ATOM__Long;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PATH)
-            return LV2_ATOM__Path;
-        if (urid == CARLA_URI_MAP_ID_ATOM_PROPERTY)
-            return LV2_ATOM__Property;
-        if (urid == CARLA_URI_MAP_ID_ATOM_RESOURCE)
-            return LV2_ATOM__Resource;
-        if (urid == CARLA_URI_MAP_ID_ATOM_SEQUENCE)
-            return LV2_ATOM__Sequence;
-        if (urid == CARLA_URI_MAP_ID_ATOM_STRING)
-            return LV2_ATOM__String;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TUPLE)
-            return LV2_ATOM__Tuple;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URI)
-            return LV2_ATOM__URI;
-        if (urid == CARLA_URI_MAP_ID_ATOM_URID)
-            return LV2_ATOM__URID;
-        if (urid == CARLA_URI_MAP_ID_ATOM_VECTOR)
-            return LV2_ATOM__Vector;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM)
-            return LV2_ATOM__atomTransfer;
-        if (urid == CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT)
-            return LV2_ATOM__eventTransfer;
-
-        // BufSize types
-        if (urid == CARLA_URI_MAP_ID_BUF_MAX_LENGTH)
-            return LV2_BUF_SIZE__maxBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_MIN_LENGTH)
-            return LV2_BUF_SIZE__minBlockLength;
-        if (urid == CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE)
-            return LV2_BUF_SIZE__sequenceSize;
-
-        // Log types
-        if (urid == CARLA_URI_MAP_ID_LOG_ERROR)
-            return LV2_LOG__Error;
-        if (urid == CARLA_URI_MAP_ID_LOG_NOTE)
-            return LV2_LOG__Note;
-        if (urid == CARLA_URI_MAP_ID_LOG_TRACE)
-            return LV2_LOG__Trace;
-        if (urid == CARLA_URI_MAP_ID_LOG_WARNING)
-            return LV2_LOG__Warning;
-
-        // Time types
-        if (urid == CARLA_URI_MAP_ID_TIME_POSITION)
-            return LV2_TIME__Position;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR)
-            return LV2_TIME__bar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BAR_BEAT)
-            return LV2_TIME__barBeat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT)
-            return LV2_TIME__beat;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEAT_UNIT)
-            return LV2_TIME__beatUnit;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR)
-            return LV2_TIME__beatsPerBar;
-        if (urid == CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE)
-            return LV2_TIME__beatsPerMinute;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAME)
-            return LV2_TIME__frame;
-        if (urid == CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND)
-            return LV2_TIME__framesPerSecond;
-        if (urid == CARLA_URI_MAP_ID_TIME_SPEED)
-            return LV2_TIME__speed;
-
-        // Others
-        if (urid == CARLA_URI_MAP_ID_MIDI_EVENT)
-            return LV2_MIDI__MidiEvent;
-        if (urid == CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE)
-            return LV2_PARAMETERS__sampleRate;
-
-        if (handle == nullptr)
-            return nullptr;
-
-        // Custom types
-        return ((CarlaLv2Client*)handle)->getCustomURIString(urid);
+        return gLv2UridMap.unmap(urid);
     }
 
     // -------------------------------------------------------------------
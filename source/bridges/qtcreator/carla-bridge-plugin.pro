@@ -162,7 +162,8 @@ HEADERS += \
     ../../utils/CarlaMutex.hpp \
     ../../utils/CarlaString.hpp \
     ../../utils/Lv2AtomQueue.hpp \
-    ../../utils/RtList.hpp
+    ../../utils/RtList.hpp \
+    ../../utils/RtQueue.hpp
 
 INCLUDEPATH = .. \
     ../../backend \
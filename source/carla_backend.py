@@ -227,6 +227,9 @@ OPTION_PATH_BRIDGE_LV2_X11     = 26
 OPTION_PATH_BRIDGE_VST_COCOA   = 27
 OPTION_PATH_BRIDGE_VST_HWND    = 28
 OPTION_PATH_BRIDGE_VST_X11     = 29
+OPTION_METER_LATENCY           = 30
+OPTION_ASYNC_PLUGIN_BRIDGES    = 31
+OPTION_SHARE_PLUGIN_BRIDGES    = 32
 
 # Callback Type
 CALLBACK_DEBUG          = 0
@@ -23,7 +23,11 @@ import os
 import json
 import sys
 from copy import deepcopy
-from subprocess import Popen, PIPE
+from hashlib import md5
+from multiprocessing import cpu_count
+from subprocess import Popen
+from tempfile import TemporaryFile
+from time import sleep, time
 from PyQt4.QtCore import pyqtSlot, qWarning, Qt, QByteArray, QSettings, QThread, QTimer, SIGNAL, SLOT
 from PyQt4.QtGui import QColor, QCursor, QDialog, QIcon, QInputDialog, QFileDialog, QFontMetrics, QFrame, QMenu
 from PyQt4.QtGui import QLineEdit, QMessageBox, QPainter, QPainterPath, QTableWidgetItem, QVBoxLayout, QWidget
@@ -664,9 +668,7 @@ PyPluginInfo = {
     'programs.total': 0
 }
 
-def runCarlaDiscovery(itype, stype, filename, tool, isWine=False):
-    fakeLabel = os.path.basename(filename).rsplit(".", 1)[0]
-    plugins = []
+def startCarlaDiscovery(stype, filename, tool, isWine=False):
     command = []
 
     if LINUX or MACOS:
@@ -679,14 +681,29 @@ def runCarlaDiscovery(itype, stype, filename, tool, isWine=False):
     command.append(stype)
     command.append(filename)
 
-    Ps = Popen(command, stdout=PIPE)
+    # output goes to a file, a full pipe would block the tool while we wait for others
+    output = TemporaryFile()
+
+    Ps = Popen(command, stdout=output)
+    Ps.carlaOutput = output
+
+    return Ps
+
+def finishCarlaDiscovery(itype, filename, Ps):
+    fakeLabel = os.path.basename(filename).rsplit(".", 1)[0]
+    plugins = []
 
     try:
-        Ps.wait()
-        output = Ps.stdout.read().decode("utf-8", errors="ignore").split("\n")
+        Ps.carlaOutput.seek(0)
+        output = Ps.carlaOutput.read().decode("utf-8", errors="ignore").split("\n")
     except:
         output = ""
 
+    Ps.carlaOutput.close()
+
+    if Ps.returncode is not None and Ps.returncode < 0:
+        print("carla-discovery::crash::%s crashed during discovery" % filename)
+
     pinfo = None
 
     for line in output:
@@ -759,6 +776,131 @@ def runCarlaDiscovery(itype, stype, filename, tool, isWine=False):
 
     return plugins
 
+def runCarlaDiscovery(itype, stype, filename, tool, isWine=False):
+    Ps = startCarlaDiscovery(stype, filename, tool, isWine)
+    Ps.wait()
+    return finishCarlaDiscovery(itype, filename, Ps)
+
+# ------------------------------------------------------------------------------------------------------------
+# Plugin Query cache, results are reused for as long as a binary (or LV2 bundle) stays the same
+
+DISCOVERY_CACHE_VERSION = 1
+DISCOVERY_TIMEOUT       = 60 # seconds, per binary
+
+def getDiscoveryStamp(filename):
+    if not os.path.isdir(filename):
+        stat = os.stat(filename)
+        return [stat.st_mtime, stat.st_size]
+
+    mtime = 0
+    size  = 0
+
+    for root, dirs, files in os.walk(filename):
+        for name in files:
+            stat   = os.stat(os.path.join(root, name))
+            mtime  = max(mtime, stat.st_mtime)
+            size  += stat.st_size
+
+    return [mtime, size]
+
+def getDiscoveryHash(filename):
+    if os.path.isdir(filename):
+        filenames = []
+        for root, dirs, files in os.walk(filename):
+            for name in files:
+                filenames.append(os.path.join(root, name))
+        filenames.sort()
+    else:
+        filenames = [filename]
+
+    fileHash = md5()
+
+    for name in filenames:
+        fileHash.update(name.encode("utf-8", errors="ignore"))
+
+        with open(name, "rb") as fd:
+            while True:
+                data = fd.read(65536)
+                if not data:
+                    break
+                fileHash.update(data)
+
+    return fileHash.hexdigest()
+
+class DiscoveryCache(object):
+    def __init__(self):
+        object.__init__(self)
+
+        self.fFilename = os.path.join(HOME, ".config", "falkTX", "carla_discovery.db")
+        self.fEntries  = {}
+        self.fChanged  = False
+
+        try:
+            fd   = open(self.fFilename, "r")
+            data = json.load(fd)
+            fd.close()
+        except:
+            data = None
+
+        if isinstance(data, dict) and data.get("version") == DISCOVERY_CACHE_VERSION and data.get("api") == PLUGIN_QUERY_API_VERSION:
+            self.fEntries = data.get("entries", {})
+
+    def lookup(self, tool, stype, filename):
+        entry = self.fEntries.get(self._key(tool, stype, filename))
+
+        if entry is None:
+            return None
+
+        try:
+            stamp = getDiscoveryStamp(filename)
+
+            if stamp == entry['stamp']:
+                return entry['plugins']
+
+            # touched but maybe not changed, only the content hash can tell
+            if stamp[1] == entry['stamp'][1] and getDiscoveryHash(filename) == entry['hash']:
+                entry['stamp'] = stamp
+                self.fChanged  = True
+                return entry['plugins']
+        except:
+            pass
+
+        return None
+
+    def store(self, tool, stype, filename, plugins):
+        try:
+            entry = {
+                'stamp': getDiscoveryStamp(filename),
+                'hash': getDiscoveryHash(filename),
+                'plugins': plugins
+            }
+        except:
+            return
+
+        self.fEntries[self._key(tool, stype, filename)] = entry
+        self.fChanged = True
+
+    def save(self):
+        if not self.fChanged:
+            return
+
+        data = {
+            'version': DISCOVERY_CACHE_VERSION,
+            'api': PLUGIN_QUERY_API_VERSION,
+            'entries': self.fEntries
+        }
+
+        try:
+            fd = open(self.fFilename, "w")
+            json.dump(data, fd)
+            fd.close()
+            self.fChanged = False
+        except:
+            print("Failed to save plugin discovery cache")
+
+    def _key(self, tool, stype, filename):
+        return "%s|%s|%s" % (tool, stype, filename)
+
 def checkPluginInternal(desc):
     plugins = []
 
@@ -2346,6 +2488,10 @@ class SearchPluginsThread(QThread):
 
         self.fToolNative = carla_discovery_native
 
+        self.fCache    = None
+        self.fJobCount = 1
+        self.fRunning  = []
+
         self.fCurCount = 0
         self.fCurPercentValue = 0
         self.fLastCheckValue  = 0
@@ -2371,6 +2517,12 @@ class SearchPluginsThread(QThread):
         apps += " carla-discovery-win32.exe"
         apps += " carla-discovery-win64.exe"
 
+        for job in self.fRunning[:]:
+            try:
+                job[1].kill()
+            except:
+                pass
+
         if LINUX:
             os.system("killall -KILL %s" % apps)
 
@@ -2398,6 +2550,13 @@ class SearchPluginsThread(QThread):
         pluginCount    = 0
         settingsDB     = QSettings("falkTX", "CarlaPlugins")
 
+        self.fCache = DiscoveryCache()
+
+        try:
+            self.fJobCount = max(1, cpu_count())
+        except:
+            self.fJobCount = 1
+
         if self.fCheckLADSPA: pluginCount += 1
         if self.fCheckDSSI:   pluginCount += 1
         if self.fCheckLV2:    pluginCount += 1
@@ -2563,6 +2722,7 @@ class SearchPluginsThread(QThread):
             settingsDB.setValue("Plugins/SFZ", self.fKitPlugins)
 
         settingsDB.sync()
+        self.fCache.save()
 
     def _checkLADSPA(self, OS, tool, isWine=False):
         ladspaBinaries = []
@@ -2576,16 +2736,7 @@ class SearchPluginsThread(QThread):
 
         ladspaBinaries.sort()
 
-        for i in range(len(ladspaBinaries)):
-            ladspa  = ladspaBinaries[i]
-            percent = ( float(i) / len(ladspaBinaries) ) * self.fCurPercentValue
-            self._pluginLook((self.fLastCheckValue + percent) * 0.9, ladspa)
-
-            plugins = checkPluginLADSPA(ladspa, tool, isWine)
-            if plugins:
-                self.fLadspaPlugins.append(plugins)
-                self.fSomethingChanged = True
-
+        self.fLadspaPlugins = self._checkBinaries(PLUGIN_LADSPA, "LADSPA", ladspaBinaries, tool, isWine, 0.9)
         self.fLastCheckValue += self.fCurPercentValue
 
     def _checkDSSI(self, OS, tool, isWine=False):
@@ -2600,16 +2751,7 @@ class SearchPluginsThread(QThread):
 
         dssiBinaries.sort()
 
-        for i in range(len(dssiBinaries)):
-            dssi    = dssiBinaries[i]
-            percent = ( float(i) / len(dssiBinaries) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, dssi)
-
-            plugins = checkPluginDSSI(dssi, tool, isWine)
-            if plugins:
-                self.fDssiPlugins.append(plugins)
-                self.fSomethingChanged = True
-
+        self.fDssiPlugins = self._checkBinaries(PLUGIN_DSSI, "DSSI", dssiBinaries, tool, isWine)
         self.fLastCheckValue += self.fCurPercentValue
 
     def _checkLV2(self, tool, isWine=False):
@@ -2626,16 +2768,7 @@ class SearchPluginsThread(QThread):
 
         lv2Bundles.sort()
 
-        for i in range(len(lv2Bundles)):
-            lv2     = lv2Bundles[i]
-            percent = ( float(i) / len(lv2Bundles) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, lv2)
-
-            plugins = checkPluginLV2(lv2, tool, isWine)
-            if plugins:
-                self.fLv2Plugins.append(plugins)
-                self.fSomethingChanged = True
-
+        self.fLv2Plugins = self._checkBinaries(PLUGIN_LV2, "LV2", lv2Bundles, tool, isWine)
         self.fLastCheckValue += self.fCurPercentValue
 
     def _checkVST(self, OS, tool, isWine=False):
@@ -2650,16 +2783,7 @@ class SearchPluginsThread(QThread):
 
         vstBinaries.sort()
 
-        for i in range(len(vstBinaries)):
-            vst     = vstBinaries[i]
-            percent = ( float(i) / len(vstBinaries) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, vst)
-
-            plugins = checkPluginVST(vst, tool, isWine)
-            if plugins:
-                self.fVstPlugins.append(plugins)
-                self.fSomethingChanged = True
-
+        self.fVstPlugins = self._checkBinaries(PLUGIN_VST, "VST", vstBinaries, tool, isWine)
         self.fLastCheckValue += self.fCurPercentValue
 
     def _checkKIT(self, kPATH, kType):
@@ -2674,25 +2798,68 @@ class SearchPluginsThread(QThread):
 
         kitFiles.sort()
 
-        for i in range(len(kitFiles)):
-            kit     = kitFiles[i]
-            percent = ( float(i) / len(kitFiles) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, kit)
-
-            if kType == "gig":
-                plugins = checkPluginGIG(kit, self.fToolNative)
-            elif kType == "sf2":
-                plugins = checkPluginSF2(kit, self.fToolNative)
-            elif kType == "sfz":
-                plugins = checkPluginSFZ(kit, self.fToolNative)
+        if kType == "gig":
+            self.fKitPlugins = self._checkBinaries(PLUGIN_GIG, "GIG", kitFiles, self.fToolNative)
+        elif kType == "sf2":
+            self.fKitPlugins = self._checkBinaries(PLUGIN_SF2, "SF2", kitFiles, self.fToolNative)
+        elif kType == "sfz":
+            self.fKitPlugins = self._checkBinaries(PLUGIN_SFZ, "SFZ", kitFiles, self.fToolNative)
+
+        self.fLastCheckValue += self.fCurPercentValue
+
+    def _checkBinaries(self, itype, stype, binaries, tool, isWine=False, percentScale=1.0):
+        # Runs up to 'fJobCount' discovery tools at once, binaries that didn't change since last time come from the cache.
+        # Results keep the order of 'binaries'.
+        results = [None] * len(binaries)
+        pending = []
+        done    = 0
+
+        for i in range(len(binaries)):
+            plugins = self.fCache.lookup(tool, stype, binaries[i])
+
+            if plugins is None:
+                pending.append(i)
             else:
-                plugins = None
+                results[i] = plugins
+                done += 1
+
+        while pending or self.fRunning:
+            while pending and len(self.fRunning) < self.fJobCount:
+                i = pending.pop(0)
+                percent = ( float(done) / len(binaries) ) * self.fCurPercentValue
+                self._pluginLook((self.fLastCheckValue + percent) * percentScale, binaries[i])
+                self.fRunning.append((i, startCarlaDiscovery(stype, binaries[i], tool, isWine), time()))
+
+            sleep(0.005)
 
+            for job in self.fRunning[:]:
+                i, Ps, startTime = job
+
+                if Ps.poll() is None:
+                    if time() - startTime < DISCOVERY_TIMEOUT:
+                        continue
+
+                    Ps.kill()
+                    Ps.wait()
+                    Ps.carlaOutput.close()
+                    print("carla-discovery::timeout::%s took too long, skipped" % binaries[i])
+                    results[i] = []
+
+                else:
+                    results[i] = finishCarlaDiscovery(itype, binaries[i], Ps)
+                    self.fCache.store(tool, stype, binaries[i], results[i])
+
+                self.fRunning.remove(job)
+                done += 1
+
+        pluginsList = []
+
+        for plugins in results:
             if plugins:
-                self.fKitPlugins.append(plugins)
+                pluginsList.append(plugins)
                 self.fSomethingChanged = True
 
-        self.fLastCheckValue += self.fCurPercentValue
+        return pluginsList
 
     def _pluginLook(self, percent, plugin):
         self.emit(SIGNAL("pluginLook(int, QString)"), percent, plugin)
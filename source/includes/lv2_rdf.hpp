@@ -516,6 +516,12 @@ struct LV2_RDF_UI {
         }
         if (Extensions != nullptr)
         {
+            for (uint32_t i=0; i < ExtensionCount; ++i)
+            {
+                if (Extensions[i] != nullptr)
+                    delete[] Extensions[i];
+            }
+
             delete[] Extensions;
             Extensions = nullptr;
         }
@@ -628,6 +634,12 @@ struct LV2_RDF_Descriptor {
         }
         if (Extensions != nullptr)
         {
+            for (uint32_t i=0; i < ExtensionCount; ++i)
+            {
+                if (Extensions[i] != nullptr)
+                    delete[] Extensions[i];
+            }
+
             delete[] Extensions;
             Extensions = nullptr;
         }
@@ -59,8 +59,17 @@ bool jackbridge_sem_post(void* sem)
     return (sem_post((sem_t*)sem) == 0);
 }
 
+// the other side usually answers within a few microseconds, so try a bit before going to sleep
+static const int kSemSpinCount = 2000;
+
 bool jackbridge_sem_timedwait(void* sem, int secs)
 {
+    for (int i=0; i < kSemSpinCount; ++i)
+    {
+        if (sem_trywait((sem_t*)sem) == 0)
+            return true;
+    }
+
 # ifdef CARLA_OS_MAC
         alarm(secs);
         return (sem_wait((sem_t*)sem) == 0);
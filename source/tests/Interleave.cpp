@@ -0,0 +1,110 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+// Micro-benchmark of (de)interleaving as done by the RtAudio engine
+
+#include "CarlaUtils.hpp"
+
+#include <chrono>
+
+const uint32_t kFrames      = 256;
+const uint32_t kIterations  = 20000;
+const uint32_t kMaxChannels = 32;
+
+// the old RtAudio engine loops, one division and one modulo per sample.
+// (the originals indexed the buffers by frame twice, fixed here so they stay in bounds)
+static void oldDeinterleave(float** const bufs, const float* const insPtr, const uint32_t channels, const uint32_t nframes)
+{
+    for (unsigned int i=0; i < nframes*channels; ++i)
+        bufs[i % channels][i/channels] = insPtr[i];
+}
+
+static void oldInterleave(float* const outsPtr, float** const bufs, const uint32_t channels, const uint32_t nframes)
+{
+    for (unsigned int i=0; i < nframes*channels; ++i)
+        outsPtr[i] = bufs[i % channels][i/channels];
+}
+
+static double now()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float   gInterleaved[kFrames*kMaxChannels];
+static float   gBuffers[kMaxChannels][kFrames];
+static float*  gBuffersPtr[kMaxChannels];
+static float   gSink = 0.0f;
+
+static void run(const char* const name, const CarlaFloatKernels* const kernels, const uint32_t channels)
+{
+    double start = now();
+
+    for (uint32_t i=0; i < kIterations; ++i)
+    {
+        if (kernels == nullptr)
+            oldDeinterleave(gBuffersPtr, gInterleaved, channels, kFrames);
+        else
+            kernels->deinterleave(gBuffersPtr, gInterleaved, channels, kFrames);
+
+        gSink += gBuffers[channels-1][i % kFrames];
+    }
+
+    const double deinterleaveTime((now() - start)/kIterations);
+
+    start = now();
+
+    for (uint32_t i=0; i < kIterations; ++i)
+    {
+        if (kernels == nullptr)
+            oldInterleave(gInterleaved, gBuffersPtr, channels, kFrames);
+        else
+            kernels->interleave(gInterleaved, gBuffersPtr, channels, kFrames);
+
+        gSink += gInterleaved[i % (kFrames*channels)];
+    }
+
+    const double interleaveTime((now() - start)/kIterations);
+
+    carla_stdout("%2i channels, %-6s: deinterleave %7.3f us, interleave %7.3f us", channels, name, deinterleaveTime, interleaveTime);
+}
+
+int main()
+{
+    for (uint32_t i=0; i < kFrames*kMaxChannels; ++i)
+        gInterleaved[i] = float(i % 1000)/1000.0f;
+
+    for (uint32_t i=0; i < kMaxChannels; ++i)
+        gBuffersPtr[i] = gBuffers[i];
+
+    static const uint32_t kChannelCounts[] = { 2, 4, 8, 16, 32, 6 };
+
+    for (size_t c=0; c < sizeof(kChannelCounts)/sizeof(uint32_t); ++c)
+    {
+        const uint32_t channels(kChannelCounts[c]);
+
+        run("old", nullptr, channels);
+        run("scalar", carla_getFloatKernels(CARLA_SIMD_NONE), channels);
+
+        if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_SSE2))
+            run("sse2", kernels, channels);
+
+        if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_NEON))
+            run("neon", kernels, channels);
+    }
+
+    return (gSink != 0.0f) ? 0 : 1;
+}
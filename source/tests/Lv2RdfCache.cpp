@@ -0,0 +1,272 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+// all checks below are asserts, keep them in release builds
+#undef NDEBUG
+
+#include "Lv2RdfCache.hpp"
+
+#include <fstream>
+#include <utime.h>
+
+static const char* const kURI = "http://example.org/plugins/test";
+
+static std::string gTmpDir;
+static std::string gLv2Dir;
+static std::string gBundle;
+static std::string gCacheFile;
+
+static void writeFile(const std::string& filename, const char* const contents)
+{
+    std::ofstream file(filename.c_str());
+    file << contents;
+}
+
+static void setTime(const std::string& filename, const time_t time)
+{
+    struct utimbuf times;
+    times.actime = times.modtime = time;
+    utime(filename.c_str(), &times);
+}
+
+static LV2_RDF_Descriptor* newDescriptor()
+{
+    LV2_RDF_Descriptor* const desc(new LV2_RDF_Descriptor());
+    desc->Type[0]  = LV2_PLUGIN_DELAY;
+    desc->Type[1]  = LV2_PLUGIN_CHORUS;
+    desc->URI      = carla_strdup(kURI);
+    desc->Name     = carla_strdup("Test Plugin");
+    desc->Author   = carla_strdup("falkTX");
+    desc->Binary   = carla_strdup((gBundle + "/test.so").c_str());
+    desc->Bundle   = carla_strdup((gBundle + "/").c_str());
+    desc->UniqueID = 123456;
+
+    desc->PortCount = 2;
+    desc->Ports = new LV2_RDF_Port[2];
+    desc->Ports[0].Types  = LV2_PORT_INPUT|LV2_PORT_AUDIO;
+    desc->Ports[0].Name   = carla_strdup("In");
+    desc->Ports[0].Symbol = carla_strdup("in");
+    desc->Ports[1].Types  = LV2_PORT_INPUT|LV2_PORT_CONTROL;
+    desc->Ports[1].Properties  = LV2_PORT_ENUMERATION;
+    desc->Ports[1].Designation = LV2_PORT_DESIGNATION_FREEWHEELING;
+    desc->Ports[1].Name   = carla_strdup("Mode");
+    desc->Ports[1].Symbol = carla_strdup("mode");
+    desc->Ports[1].MidiMap.Type   = LV2_PORT_MIDI_MAP_CC;
+    desc->Ports[1].MidiMap.Number = 7;
+    desc->Ports[1].Points.Hints   = LV2_PORT_POINT_DEFAULT|LV2_PORT_POINT_MINIMUM|LV2_PORT_POINT_MAXIMUM;
+    desc->Ports[1].Points.Default = 0.5f;
+    desc->Ports[1].Points.Minimum = -1.0f;
+    desc->Ports[1].Points.Maximum = 2.0f;
+    desc->Ports[1].Unit.Hints  = LV2_PORT_UNIT_SYMBOL|LV2_PORT_UNIT_UNIT;
+    desc->Ports[1].Unit.Symbol = carla_strdup("dB");
+    desc->Ports[1].Unit.Unit   = LV2_PORT_UNIT_DB;
+    desc->Ports[1].ScalePointCount = 2;
+    desc->Ports[1].ScalePoints = new LV2_RDF_PortScalePoint[2];
+    desc->Ports[1].ScalePoints[0].Label = carla_strdup("Off");
+    desc->Ports[1].ScalePoints[0].Value = 0.0f;
+    desc->Ports[1].ScalePoints[1].Label = carla_strdup("");
+    desc->Ports[1].ScalePoints[1].Value = 1.0f;
+
+    desc->PresetCount = 1;
+    desc->Presets = new LV2_RDF_Preset[1];
+    desc->Presets[0].URI   = carla_strdup("http://example.org/plugins/test#preset1");
+    desc->Presets[0].Label = carla_strdup("Preset 1");
+
+    desc->FeatureCount = 1;
+    desc->Features = new LV2_RDF_Feature[1];
+    desc->Features[0].Type = LV2_FEATURE_REQUIRED;
+    desc->Features[0].URI  = carla_strdup("http://lv2plug.in/ns/ext/urid#map");
+
+    desc->ExtensionCount = 1;
+    desc->Extensions = new LV2_URI[1];
+    desc->Extensions[0] = carla_strdup("http://lv2plug.in/ns/ext/state#interface");
+
+    desc->UICount = 1;
+    desc->UIs = new LV2_RDF_UI[1];
+    desc->UIs[0].Type   = LV2_UI_X11;
+    desc->UIs[0].URI    = carla_strdup("http://example.org/plugins/test#ui");
+    desc->UIs[0].Binary = carla_strdup((gBundle + "/test_ui.so").c_str());
+    desc->UIs[0].Bundle = carla_strdup((gBundle + "/").c_str());
+
+    return desc;
+}
+
+static inline bool sameString(const char* const s1, const char* const s2)
+{
+    if (s1 == nullptr || s2 == nullptr)
+        return (s1 == s2);
+    return (std::strcmp(s1, s2) == 0);
+}
+
+static void checkDescriptor(const LV2_RDF_Descriptor* const a, const LV2_RDF_Descriptor* const b)
+{
+    assert(a->Type[0] == b->Type[0] && a->Type[1] == b->Type[1]);
+    assert(sameString(a->URI, b->URI));
+    assert(sameString(a->Name, b->Name));
+    assert(sameString(a->Author, b->Author));
+    assert(sameString(a->License, b->License));
+    assert(sameString(a->Binary, b->Binary));
+    assert(sameString(a->Bundle, b->Bundle));
+    assert(a->UniqueID == b->UniqueID);
+
+    assert(a->PortCount == b->PortCount);
+
+    for (uint32_t i=0; i < a->PortCount; ++i)
+    {
+        const LV2_RDF_Port& pa(a->Ports[i]);
+
+        assert(pa.Types == b->Ports[i].Types && pa.Properties == b->Ports[i].Properties && pa.Designation == b->Ports[i].Designation);
+        assert(sameString(pa.Name, b->Ports[i].Name) && sameString(pa.Symbol, b->Ports[i].Symbol));
+        assert(pa.MidiMap.Type == b->Ports[i].MidiMap.Type && pa.MidiMap.Number == b->Ports[i].MidiMap.Number);
+        assert(pa.Points.Hints == b->Ports[i].Points.Hints && pa.Points.Default == b->Ports[i].Points.Default);
+        assert(pa.Points.Minimum == b->Ports[i].Points.Minimum && pa.Points.Maximum == b->Ports[i].Points.Maximum);
+        assert(pa.Unit.Hints == b->Ports[i].Unit.Hints && pa.Unit.Unit == b->Ports[i].Unit.Unit);
+        assert(sameString(pa.Unit.Name, b->Ports[i].Unit.Name) && sameString(pa.Unit.Symbol, b->Ports[i].Unit.Symbol));
+        assert(pa.ScalePointCount == b->Ports[i].ScalePointCount);
+
+        for (uint32_t j=0; j < pa.ScalePointCount; ++j)
+            assert(sameString(pa.ScalePoints[j].Label, b->Ports[i].ScalePoints[j].Label) && pa.ScalePoints[j].Value == b->Ports[i].ScalePoints[j].Value);
+    }
+
+    assert(a->PresetCount == b->PresetCount);
+
+    for (uint32_t i=0; i < a->PresetCount; ++i)
+        assert(sameString(a->Presets[i].URI, b->Presets[i].URI) && sameString(a->Presets[i].Label, b->Presets[i].Label));
+
+    assert(a->FeatureCount == b->FeatureCount);
+
+    for (uint32_t i=0; i < a->FeatureCount; ++i)
+        assert(a->Features[i].Type == b->Features[i].Type && sameString(a->Features[i].URI, b->Features[i].URI));
+
+    assert(a->ExtensionCount == b->ExtensionCount);
+
+    for (uint32_t i=0; i < a->ExtensionCount; ++i)
+        assert(sameString(a->Extensions[i], b->Extensions[i]));
+
+    assert(a->UICount == b->UICount);
+
+    for (uint32_t i=0; i < a->UICount; ++i)
+    {
+        assert(a->UIs[i].Type == b->UIs[i].Type);
+        assert(sameString(a->UIs[i].URI, b->UIs[i].URI));
+        assert(sameString(a->UIs[i].Binary, b->UIs[i].Binary));
+        assert(sameString(a->UIs[i].Bundle, b->UIs[i].Bundle));
+        assert(a->UIs[i].FeatureCount == b->UIs[i].FeatureCount);
+        assert(a->UIs[i].ExtensionCount == b->UIs[i].ExtensionCount);
+    }
+}
+
+int main()
+{
+    char tmpDir[] = "/tmp/carla-lv2rdfcache-XXXXXX";
+
+    if (mkdtemp(tmpDir) == nullptr)
+        return 1;
+
+    gTmpDir    = tmpDir;
+    gLv2Dir    = gTmpDir + "/lv2";
+    gBundle    = gLv2Dir + "/test.lv2";
+    gCacheFile = gTmpDir + "/lv2_rdf.cache";
+
+    setenv("LV2_PATH", gLv2Dir.c_str(), 1);
+
+    mkdir(gLv2Dir.c_str(), 0755);
+    mkdir(gBundle.c_str(), 0755);
+    writeFile(gBundle + "/manifest.ttl", "# manifest\n");
+    writeFile(gBundle + "/test.ttl", "# plugin\n");
+    setTime(gBundle + "/manifest.ttl", 1000000);
+    setTime(gBundle + "/test.ttl", 1000000);
+
+    const LV2_RDF_Descriptor* const desc(newDescriptor());
+
+    // store and read back, from the same object and from a new one (file)
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        assert(cache.get(kURI) == nullptr);
+
+        cache.put(desc);
+
+        const LV2_RDF_Descriptor* const cached(cache.get(kURI));
+        assert(cached != nullptr);
+        checkDescriptor(desc, cached);
+        delete cached;
+    }
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        assert(cache.get("http://example.org/plugins/other") == nullptr);
+
+        const LV2_RDF_Descriptor* const cached(cache.get(kURI));
+        assert(cached != nullptr);
+        checkDescriptor(desc, cached);
+        delete cached;
+    }
+
+    // changed .ttl in the bundle makes the entry stale
+    setTime(gBundle + "/test.ttl", 2000000);
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        assert(cache.get(kURI) == nullptr);
+
+        // storing again refreshes it
+        cache.put(desc);
+    }
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        const LV2_RDF_Descriptor* const cached(cache.get(kURI));
+        assert(cached != nullptr);
+        delete cached;
+    }
+
+    // a new bundle in LV2_PATH makes all entries stale (it could add presets)
+    setTime(gLv2Dir, 3000000);
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        assert(cache.get(kURI) == nullptr);
+    }
+
+    // truncated cache files are ignored
+    {
+        Lv2RdfCache cache(gCacheFile.c_str());
+        cache.put(desc);
+    }
+    {
+        std::ifstream in(gCacheFile.c_str(), std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        for (size_t size=0; size < data.size(); size += 7)
+        {
+            {
+                std::ofstream out(gCacheFile.c_str(), std::ios::binary|std::ios::trunc);
+                out.write(data.data(), static_cast<std::streamsize>(size));
+            }
+
+            Lv2RdfCache cache(gCacheFile.c_str());
+            assert(cache.get(kURI) == nullptr);
+        }
+    }
+
+    delete desc;
+
+    std::remove(gCacheFile.c_str());
+    std::remove((gBundle + "/manifest.ttl").c_str());
+    std::remove((gBundle + "/test.ttl").c_str());
+    rmdir(gBundle.c_str());
+    rmdir(gLv2Dir.c_str());
+    rmdir(gTmpDir.c_str());
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+#include "RtQueue.hpp"
+#include "Lv2UridMap.hpp"
+
+#include <pthread.h>
+#include <cstdio>
+
+const uint32_t kThreads = 4;
+const uint32_t kURIs    = 5000;
+
+static const char* const kFixedURIs[] = {
+    nullptr,
+    "urn:test:fixed1",
+    "urn:test:fixed2",
+    "urn:test:fixed3"
+};
+
+static Lv2UridMap gMap(kFixedURIs, 4);
+static LV2_URID   gUrids[kThreads][kURIs];
+
+static void getURI(char* const uri, const uint32_t i)
+{
+    std::snprintf(uri, 64, "http://example.org/uri#%u", i);
+}
+
+static void* mapperThread(void* arg)
+{
+    const uint32_t thread(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg)));
+    char uri[64];
+
+    // each thread starts at a different place
+    for (uint32_t i=0; i < kURIs; ++i)
+    {
+        const uint32_t index((i + thread*kURIs/kThreads) % kURIs);
+        getURI(uri, index);
+        gUrids[thread][index] = gMap.map(uri);
+    }
+
+    return nullptr;
+}
+
+// mapped in this order on a map holding only the fixed URIs
+static const struct {
+    const char* uri;
+    LV2_URID    urid;
+} kMapSteps[] = {
+    { "urn:test:fixed2", 2 },
+    { "urn:test:a",      4 },
+    { "urn:test:b",      5 },
+    { "urn:test:a",      4 }
+};
+
+// then inserted as if following another map, 'ok' is the expected result
+static const struct {
+    LV2_URID    urid;
+    const char* uri;
+    bool        ok;
+} kInsertSteps[] = {
+    {  4, "urn:test:a", true  }, // already there with the same URID
+    {  5, "urn:test:a", false }, // URI already has another URID
+    { 10, "urn:test:c", false }, // would leave a gap
+    {  6, "urn:test:c", true  }
+};
+
+int main()
+{
+    uint32_t errors = 0;
+
+    // fixed URIs
+    if (gMap.getCount() != 4 || gMap.unmap(0) != nullptr || gMap.unmap(4) != nullptr)
+    {
+        carla_stderr("Lv2UridMap: bad initial state, count is %u", gMap.getCount());
+        return 1;
+    }
+
+    const char* const fixed3(gMap.unmap(3));
+
+    if (fixed3 == nullptr || std::strcmp(fixed3, "urn:test:fixed3") != 0)
+    {
+        carla_stderr("Lv2UridMap: unmap(3) returned '%s'", fixed3);
+        return 1;
+    }
+
+    // simple usage
+    for (size_t i=0; i < sizeof(kMapSteps)/sizeof(kMapSteps[0]); ++i)
+    {
+        const LV2_URID urid(gMap.map(kMapSteps[i].uri));
+
+        if (urid != kMapSteps[i].urid)
+        {
+            carla_stderr("Lv2UridMap: '%s' mapped to %u, expected %u", kMapSteps[i].uri, urid, kMapSteps[i].urid);
+            ++errors;
+        }
+    }
+
+    // lookup() must not add anything
+    const uint32_t countBeforeLookup(gMap.getCount());
+    const LV2_URID lookupA(gMap.lookup("urn:test:a"));
+    const LV2_URID lookupNew(gMap.lookup("urn:test:not-mapped"));
+
+    if (lookupA != 4 || lookupNew != 0 || gMap.getCount() != countBeforeLookup)
+    {
+        carla_stderr("Lv2UridMap: lookup() returned %u and %u, count went from %u to %u", lookupA, lookupNew, countBeforeLookup, gMap.getCount());
+        ++errors;
+    }
+
+    // following another map
+    for (size_t i=0; i < sizeof(kInsertSteps)/sizeof(kInsertSteps[0]); ++i)
+    {
+        const bool ok(gMap.insert(kInsertSteps[i].urid, kInsertSteps[i].uri));
+
+        if (ok != kInsertSteps[i].ok)
+        {
+            carla_stderr("Lv2UridMap: insert(%u, '%s') returned %s", kInsertSteps[i].urid, kInsertSteps[i].uri, ok ? "true" : "false");
+            ++errors;
+        }
+    }
+
+    const LV2_URID uridC(gMap.map("urn:test:c"));
+
+    if (uridC != 6)
+    {
+        carla_stderr("Lv2UridMap: inserted URI mapped to %u, expected 6", uridC);
+        ++errors;
+    }
+
+    if (errors != 0)
+        return 1;
+
+    // many threads mapping the same URIs, all must get the same URIDs
+    pthread_t threads[kThreads];
+
+    for (uint32_t i=0; i < kThreads; ++i)
+        pthread_create(&threads[i], nullptr, mapperThread, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+
+    for (uint32_t i=0; i < kThreads; ++i)
+        pthread_join(threads[i], nullptr);
+
+    if (gMap.getCount() != 7 + kURIs)
+    {
+        carla_stderr("Lv2UridMap: %u URIDs after the threads, expected %u", gMap.getCount()-1, 6 + kURIs);
+        return 1;
+    }
+
+    char uri[64];
+
+    for (uint32_t i=0; i < kURIs; ++i)
+    {
+        getURI(uri, i);
+
+        bool agreed = true;
+
+        for (uint32_t j=1; j < kThreads; ++j)
+            agreed = agreed && (gUrids[j][i] == gUrids[0][i]);
+
+        const char* const unmapped(gMap.unmap(gUrids[0][i]));
+
+        if (! agreed || gUrids[0][i] < 7 || unmapped == nullptr || std::strcmp(unmapped, uri) != 0)
+        {
+            carla_stderr("Lv2UridMap: threads disagree on '%s'", uri);
+            ++errors;
+        }
+    }
+
+    if (errors != 0)
+        return 1;
+
+    carla_stdout("Lv2UridMap: %u URIDs", gMap.getCount()-1);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#include "CarlaUtils.hpp"
+
+// odd size, so all kernels go through their scalar tail too
+const size_t kTestSize = 1027;
+
+static float randomFloat()
+{
+    return float(std::rand())/float(RAND_MAX)*2.0f - 1.0f;
+}
+
+// prints the first differing sample, returns 1 if there is one
+static int compareBuffers(const CarlaFloatKernels* const kernels, const char* const what, const float* const expected, const float* const result, const size_t size)
+{
+    for (size_t i=0; i < size; ++i)
+    {
+        if (expected[i] != result[i])
+        {
+            carla_stderr("kernels type %i, %s: sample %u is %f, expected %f", kernels->type, what, uint(i), result[i], expected[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// returns the number of operations where 'kernels' do not match the scalar code
+static int testKernels(const CarlaFloatKernels* const scalar, const CarlaFloatKernels* const kernels)
+{
+    carla_stdout("testing kernels type %i", kernels->type);
+
+    int failures = 0;
+
+    float data[kTestSize];
+    float dataS[kTestSize];
+    float dataK[kTestSize];
+
+    for (size_t i=0; i < kTestSize; ++i)
+        data[i] = randomFloat();
+
+    // abs max, for all sizes up to 33 and for the full buffer
+    for (size_t i=0; i <= 34; ++i)
+    {
+        const size_t size((i == 34) ? kTestSize : i);
+        const float maxS(scalar->findAbsMax(data, size));
+        const float maxK(kernels->findAbsMax(data, size));
+
+        if (maxS != maxK)
+        {
+            carla_stderr("kernels type %i, findAbsMax: %f for size %u, expected %f", kernels->type, maxK, uint(size), maxS);
+            ++failures;
+        }
+    }
+
+    // abs max, highest value at the end and negative, aligned and not
+    data[kTestSize-1] = -2.0f;
+
+    const float maxAligned(kernels->findAbsMax(data, kTestSize));
+    const float maxUnaligned(kernels->findAbsMax(data+1, kTestSize-1));
+
+    if (maxAligned != 2.0f || maxUnaligned != 2.0f)
+    {
+        carla_stderr("kernels type %i, findAbsMax: missed the last sample (%f, %f)", kernels->type, maxAligned, maxUnaligned);
+        ++failures;
+    }
+
+    // add
+    for (size_t i=0; i < kTestSize; ++i)
+        dataS[i] = dataK[i] = randomFloat();
+
+    scalar->add(dataS, data, kTestSize);
+    kernels->add(dataK, data, kTestSize);
+    failures += compareBuffers(kernels, "add", dataS, dataK, kTestSize);
+
+    // add, unaligned
+    scalar->add(dataS+1, data+3, kTestSize-3);
+    kernels->add(dataK+1, data+3, kTestSize-3);
+    failures += compareBuffers(kernels, "unaligned add", dataS, dataK, kTestSize);
+
+    // multiply
+    scalar->multiply(dataS, 0.3f, kTestSize);
+    kernels->multiply(dataK, 0.3f, kTestSize);
+    failures += compareBuffers(kernels, "multiply", dataS, dataK, kTestSize);
+
+    // (de)interleave, common channel counts and a few odd ones
+    static const uint32_t kChannelCounts[] = { 1, 2, 3, 4, 5, 6, 8, 10, 16, 32 };
+
+    for (size_t c=0; c < sizeof(kChannelCounts)/sizeof(uint32_t); ++c)
+    {
+        const uint32_t channels(kChannelCounts[c]);
+        const size_t   frames(kTestSize/channels);
+
+        float  bufs[32][kTestSize];
+        float* bufsPtr[32];
+
+        for (uint32_t j=0; j < channels; ++j)
+        {
+            bufsPtr[j] = bufs[j];
+
+            for (size_t i=0; i < frames; ++i)
+                bufs[j][i] = randomFloat();
+        }
+
+        // the scalar result is checked against the source buffers directly
+        scalar->interleave(dataS, bufsPtr, channels, frames);
+        kernels->interleave(dataK, bufsPtr, channels, frames);
+
+        for (size_t i=0; i < frames*channels; ++i)
+        {
+            if (dataS[i] != bufs[i%channels][i/channels])
+            {
+                carla_stderr("scalar interleave: %u channels, sample %u is in the wrong place", channels, uint(i));
+                ++failures;
+                break;
+            }
+        }
+
+        failures += compareBuffers(kernels, "interleave", dataS, dataK, frames*channels);
+
+        for (uint32_t j=0; j < channels; ++j)
+            carla_zeroFloat(bufs[j], frames);
+
+        kernels->deinterleave(bufsPtr, dataK, channels, frames);
+
+        for (size_t i=0; i < frames*channels; ++i)
+        {
+            if (bufs[i%channels][i/channels] != dataS[i])
+            {
+                carla_stderr("kernels type %i, deinterleave: %u channels, sample %u is in the wrong place", kernels->type, channels, uint(i));
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    return failures;
+}
+
+int main()
+{
+    const CarlaFloatKernels* const scalar(carla_getFloatKernels(CARLA_SIMD_NONE));
+
+    if (scalar == nullptr)
+    {
+        carla_stderr("no scalar kernels");
+        return 1;
+    }
+
+    int failures = testKernels(scalar, scalar);
+
+    if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_SSE2))
+        failures += testKernels(scalar, kernels);
+
+    if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_AVX))
+        failures += testKernels(scalar, kernels);
+
+    if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_NEON))
+        failures += testKernels(scalar, kernels);
+
+    // public calls, using the best kernels; all values are exact in binary
+    {
+        float data1[500];
+        float data2[500];
+        carla_fill<float>(data1, 500, 0.25f);
+        carla_fill<float>(data2, 500, 0.5f);
+        data1[499] = -0.75f;
+
+        const float absMax(carla_findAbsMaxFloat(data1, 500));
+
+        if (absMax != 0.75f)
+        {
+            carla_stderr("carla_findAbsMaxFloat: %f, expected 0.75", absMax);
+            ++failures;
+        }
+
+        carla_addFloat(data2, data1, 500);
+        carla_multiplyFloat(data2, 2.0f, 500);
+
+        float expected[500];
+        carla_fill<float>(expected, 499, 1.5f);
+        expected[499] = -0.5f;
+
+        failures += compareBuffers(scalar, "public add and multiply", expected, data2, 500);
+    }
+
+    if (failures != 0)
+    {
+        carla_stderr("MathUtils: %i checks failed", failures);
+        return 1;
+    }
+
+    return 0;
+}
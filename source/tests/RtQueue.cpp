@@ -0,0 +1,183 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+#include "RtQueue.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+const uint32_t kProducers       = 4;
+const uint32_t kEventsPerThread = 20000;
+
+struct MyEvent {
+    uint32_t producer;
+    uint32_t index;
+
+    MyEvent()
+        : producer(0),
+          index(0) {}
+};
+
+static RtQueue<MyEvent, 256> gQueue;
+static volatile uint32_t gRunning = 0;
+
+static void* producerThread(void* arg)
+{
+    MyEvent event;
+    event.producer = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+
+    while (gRunning == 0)
+        sched_yield();
+
+    for (uint32_t i=0; i < kEventsPerThread;)
+    {
+        event.index = i;
+
+        // spin until there's room, we want every event to arrive for this test
+        if (gQueue.put(event))
+            ++i;
+        else
+            sched_yield();
+    }
+
+    return nullptr;
+}
+
+// put/get from one thread, then fill the queue past its size
+static bool testSingleThread()
+{
+    MyEvent event;
+
+    if (! gQueue.isEmpty() || gQueue.get(event))
+    {
+        carla_stderr("RtQueue: a new queue is not empty");
+        return false;
+    }
+
+    event.index = 1;
+    const bool put1(gQueue.put(event));
+    event.index = 2;
+    const bool put2(gQueue.put(event));
+
+    if (! (put1 && put2) || gQueue.count() != 2)
+    {
+        carla_stderr("RtQueue: put failed on an empty queue, count is %u", gQueue.count());
+        return false;
+    }
+
+    for (uint32_t i=1; i <= 2; ++i)
+    {
+        event.index = 0;
+
+        if (! gQueue.get(event) || event.index != i)
+        {
+            carla_stderr("RtQueue: got event %u, expected %u", event.index, i);
+            return false;
+        }
+    }
+
+    if (! gQueue.isEmpty())
+    {
+        carla_stderr("RtQueue: queue not empty after reading everything");
+        return false;
+    }
+
+    // overflow, the 2 extra events get dropped and counted once
+    uint32_t accepted = 0;
+
+    for (uint32_t i=0; i < 258; ++i)
+    {
+        if (gQueue.put(event))
+            ++accepted;
+    }
+
+    const uint32_t overflows(gQueue.takeOverflows());
+    const uint32_t overflowsAfterTake(gQueue.takeOverflows());
+
+    if (accepted != 256 || overflows != 2 || overflowsAfterTake != 0)
+    {
+        carla_stderr("RtQueue: %u of 258 events accepted, %u overflows then %u, expected 256, 2 and 0", accepted, overflows, overflowsAfterTake);
+        return false;
+    }
+
+    gQueue.clear();
+
+    if (! gQueue.isEmpty())
+    {
+        carla_stderr("RtQueue: queue not empty after clear()");
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (! testSingleThread())
+        return 1;
+
+    // many producers, single consumer; per-producer order must be kept
+    gQueue.takeOverflows();
+
+    MyEvent   event;
+    pthread_t threads[kProducers];
+    uint32_t  nextIndex[kProducers];
+    uint32_t  outOfOrder = 0;
+
+    for (uint32_t i=0; i < kProducers; ++i)
+    {
+        nextIndex[i] = 0;
+        pthread_create(&threads[i], nullptr, producerThread, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+    }
+
+    gRunning = 1;
+
+    for (uint32_t received=0; received < kProducers*kEventsPerThread;)
+    {
+        if (! gQueue.get(event))
+        {
+            sched_yield();
+            continue;
+        }
+
+        ++received;
+
+        if (event.producer >= kProducers)
+        {
+            ++outOfOrder;
+            continue;
+        }
+
+        // resync on the received index, so one bad event is only counted once
+        if (event.index != nextIndex[event.producer])
+            ++outOfOrder;
+
+        nextIndex[event.producer] = event.index + 1;
+    }
+
+    for (uint32_t i=0; i < kProducers; ++i)
+        pthread_join(threads[i], nullptr);
+
+    if (outOfOrder != 0 || ! gQueue.isEmpty())
+    {
+        carla_stderr("RtQueue: %u events out of order or corrupted, %u left in the queue", outOfOrder, gQueue.count());
+        return 1;
+    }
+
+    carla_stdout("RtQueue: %u events received, %u dropped while full", kProducers*kEventsPerThread, gQueue.takeOverflows());
+
+    return 0;
+}
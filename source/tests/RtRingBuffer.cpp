@@ -0,0 +1,177 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+#include "RtQueue.hpp"
+#include "RtRingBuffer.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+const uint32_t kMessages = 50000;
+
+static RtRingBuffer<1024> gRing;
+static volatile uint32_t gRunning = 0;
+
+// message 'i' has a size of 'i % 300' bytes, all set to 'i'
+static uint32_t getMessageSize(const uint32_t i)
+{
+    return i % 300;
+}
+
+static void* producerThread(void*)
+{
+    uint8_t data[300];
+
+    while (gRunning == 0)
+        sched_yield();
+
+    for (uint32_t i=0; i < kMessages;)
+    {
+        std::memset(data, static_cast<int>(i & 0xff), getMessageSize(i));
+
+        // spin until there's room, we want every message to arrive for this test
+        if (gRing.writeMessage(data, getMessageSize(i)))
+            ++i;
+        else
+            sched_yield();
+    }
+
+    return nullptr;
+}
+
+int main()
+{
+    uint8_t  data[1024];
+    uint32_t size = 0;
+
+    // simple usage
+    if (! gRing.isEmpty() || gRing.readMessage(data, sizeof(data), size))
+    {
+        carla_stderr("RtRingBuffer: a new ring is not empty");
+        return 1;
+    }
+
+    const bool wroteText(gRing.writeMessage("abc", 4));
+    const bool wroteEmpty(gRing.writeMessage(nullptr, 0));
+
+    if (! (wroteText && wroteEmpty))
+    {
+        carla_stderr("RtRingBuffer: write to an empty ring failed");
+        return 1;
+    }
+
+    size = 0;
+    const bool readText(gRing.readMessage(data, sizeof(data), size));
+
+    if (! readText || size != 4 || std::strcmp((const char*)data, "abc") != 0)
+    {
+        carla_stderr("RtRingBuffer: first message read as %u bytes", size);
+        return 1;
+    }
+
+    size = 1;
+    const bool readEmpty(gRing.readMessage(data, sizeof(data), size));
+
+    if (! readEmpty || size != 0 || ! gRing.isEmpty())
+    {
+        carla_stderr("RtRingBuffer: empty message read as %u bytes", size);
+        return 1;
+    }
+
+    // too big for the ring; the biggest message leaves no room for another
+    const uint32_t maxSize(gRing.getMaxMessageSize());
+    const bool wroteTooBig(gRing.writeMessage(data, 1024));
+    const bool wroteMax(gRing.writeMessage(data, maxSize));
+    const bool wroteExtra(gRing.writeMessage(data, 1));
+
+    if (wroteTooBig || ! wroteMax || wroteExtra)
+    {
+        carla_stderr("RtRingBuffer: size limits not respected (%i %i %i)", wroteTooBig, wroteMax, wroteExtra);
+        return 1;
+    }
+
+    // too big for the reader, which gets the size and loses the message
+    size = 0;
+    const bool readSmall(gRing.readMessage(data, 16, size));
+
+    if (readSmall || size != maxSize || ! gRing.isEmpty())
+    {
+        carla_stderr("RtRingBuffer: small reader got %u bytes, expected failure and %u", size, maxSize);
+        return 1;
+    }
+
+    // full; each 12 byte message takes 16 bytes with its header
+    uint32_t written = 0;
+
+    for (uint32_t i=0; i < 1024/16; ++i)
+    {
+        if (gRing.writeMessage(data, 12))
+            ++written;
+    }
+
+    if (written != 1024/16 || gRing.writeMessage(data, 0))
+    {
+        carla_stderr("RtRingBuffer: %u messages fit, expected exactly %u", written, 1024/16);
+        return 1;
+    }
+
+    gRing.clear();
+
+    if (! gRing.isEmpty())
+    {
+        carla_stderr("RtRingBuffer: ring not empty after clear()");
+        return 1;
+    }
+
+    // producer and consumer threads, messages wrap around the end of the ring
+    uint32_t badMessages = 0;
+
+    pthread_t thread;
+    pthread_create(&thread, nullptr, producerThread, nullptr);
+
+    gRunning = 1;
+
+    for (uint32_t i=0; i < kMessages;)
+    {
+        if (! gRing.readMessage(data, sizeof(data), size))
+        {
+            sched_yield();
+            continue;
+        }
+
+        bool good = (size == getMessageSize(i));
+
+        for (uint32_t j=0; good && j < size; ++j)
+            good = (data[j] == (i & 0xff));
+
+        if (! good)
+            ++badMessages;
+
+        ++i;
+    }
+
+    pthread_join(thread, nullptr);
+
+    if (badMessages != 0 || ! gRing.isEmpty())
+    {
+        carla_stderr("RtRingBuffer: %u of %u messages had the wrong size or contents", badMessages, kMessages);
+        return 1;
+    }
+
+    carla_stdout("RtRingBuffer: %u messages received", kMessages);
+
+    return 0;
+}
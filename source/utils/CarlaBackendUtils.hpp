@@ -270,6 +270,12 @@ const char* OptionsType2Str(const OptionsType& type)
     case OPTION_PATH_BRIDGE_VST_X11:
         return "OPTION_PATH_BRIDGE_VST_X11";
 #endif
+    case OPTION_METER_LATENCY:
+        return "OPTION_METER_LATENCY";
+    case OPTION_ASYNC_PLUGIN_BRIDGES:
+        return "OPTION_ASYNC_PLUGIN_BRIDGES";
+    case OPTION_SHARE_PLUGIN_BRIDGES:
+        return "OPTION_SHARE_PLUGIN_BRIDGES";
     }
 
     carla_stderr("CarlaBackend::OptionsType2Str(%i) - invalid type", type);
@@ -19,11 +19,14 @@
 #ifndef __CARLA_BRIDGE_UTILS_HPP__
 #define __CARLA_BRIDGE_UTILS_HPP__
 
-#include "CarlaUtils.hpp"
+#include "CarlaEngine.hpp"
 
 #include <semaphore.h>
 
+#define BRIDGE_SHM_PROTOCOL_VERSION 3
 #define BRIDGE_SHM_RING_BUFFER_SIZE 2048
+#define BRIDGE_SHM_EVENT_COUNT      512
+#define BRIDGE_SHM_PLUGIN_COUNT     16
 
 // ---------------------------------------------------------------------------------------------
 
@@ -58,9 +61,10 @@ enum PluginBridgeOpcode {
     kPluginBridgeOpcodeSetParameter   = 4, // int, float
     kPluginBridgeOpcodeSetProgram     = 5, // int
     kPluginBridgeOpcodeSetMidiProgram = 6, // int
-    kPluginBridgeOpcodeMidiEvent      = 7, // long, int, char[] (long = timeFrame, int = size max 4)
-    kPluginBridgeOpcodeProcess        = 8,
-    kPluginBridgeOpcodeQuit           = 9
+    // 7 was MidiEvent, events go through the event ring since protocol version 2
+    kPluginBridgeOpcodeProcess        = 8, // int (number of events in the event ring for this cycle)
+    kPluginBridgeOpcodeQuit           = 9,
+    kPluginBridgeOpcodeRemovePlugin   = 10 // the slot's plugin leaves the bridge, which keeps running for the others
 };
 
 const char* const CARLA_BRIDGE_MSG_HIDE_GUI   = "CarlaBridgeHideGUI";   //!< Plugin -> Host call, tells host GUI is now hidden
@@ -80,6 +84,26 @@ struct BridgeRingBuffer {
     char buf[BRIDGE_SHM_RING_BUFFER_SIZE];
 };
 
+// Single-writer (host), single-reader (bridge) ring of whole engine events.
+// Events that don't fit, on either side, are counted in 'overflows' for the host to report.
+struct BridgeEventRing {
+    uint32_t head, tail;
+    uint32_t overflows;
+    CarlaBackend::EngineEvent events[BRIDGE_SHM_EVENT_COUNT];
+};
+
+// One per plugin running in the bridge, written only by that plugin's BridgePlugin on the host side.
+// 'requests' counts the replies the host is waiting for, the bridge posts runClient once for each.
+struct BridgeShmSlot {
+    union {
+        sem_t runClient;
+        char _alignClient[128];
+    };
+    int requests;
+    BridgeRingBuffer ringBuffer;
+    BridgeEventRing eventRing;
+};
+
 struct BridgeShmControl {
     // 32 and 64-bit binaries align semaphores differently.
     // Let's make sure there's plenty of room for either one.
@@ -87,11 +111,10 @@ struct BridgeShmControl {
         sem_t runServer;
         char _alignServer[128];
     };
-    union {
-        sem_t runClient;
-        char _alignClient[128];
-    };
-    BridgeRingBuffer ringBuffer;
+    // Keep these 2 right after the semaphore, so any protocol version can read them.
+    int version;       // set by the host
+    int bridgeVersion; // set by the bridge once attached, even if it does not match 'version'
+    BridgeShmSlot plugins[BRIDGE_SHM_PLUGIN_COUNT];
 };
 
 // ---------------------------------------------------------------------------------------------
@@ -326,4 +349,66 @@ void rdwr_writeFloat(BridgeRingBuffer* const ringbuf, const float value)
 
 // ---------------------------------------------------------------------------------------------
 
+static inline
+bool rdwr_writeEvent(BridgeEventRing* const ring, const CarlaBackend::EngineEvent& event)
+{
+    const uint32_t head(ring->head);
+
+    if (head - ring->tail >= BRIDGE_SHM_EVENT_COUNT)
+    {
+        __sync_add_and_fetch(&ring->overflows, 1);
+        return false;
+    }
+
+    std::memcpy(&ring->events[head % BRIDGE_SHM_EVENT_COUNT], &event, sizeof(CarlaBackend::EngineEvent));
+    __sync_synchronize();
+    ring->head = head + 1;
+    return true;
+}
+
+static inline
+bool rdwr_readEvent(BridgeEventRing* const ring, CarlaBackend::EngineEvent& event)
+{
+    const uint32_t tail(ring->tail);
+
+    if (tail == ring->head)
+        return false;
+
+    __sync_synchronize();
+    std::memcpy(&event, &ring->events[tail % BRIDGE_SHM_EVENT_COUNT], sizeof(CarlaBackend::EngineEvent));
+    __sync_synchronize();
+    ring->tail = tail + 1;
+    return true;
+}
+
+static inline
+void rdwr_addOverflows(BridgeEventRing* const ring, const uint32_t count)
+{
+    __sync_add_and_fetch(&ring->overflows, count);
+}
+
+static inline
+uint32_t rdwr_takeOverflows(BridgeEventRing* const ring)
+{
+    return __sync_fetch_and_and(&ring->overflows, 0);
+}
+
+// ---------------------------------------------------------------------------------------------
+
+// host side, after committing everything the request needs to the slot's ring
+static inline
+void rdwr_addRequest(BridgeShmSlot* const slot)
+{
+    __sync_add_and_fetch(&slot->requests, 1);
+}
+
+// bridge side, before reading the slot's ring
+static inline
+int rdwr_takeRequests(BridgeShmSlot* const slot)
+{
+    return __sync_fetch_and_and(&slot->requests, 0);
+}
+
+// ---------------------------------------------------------------------------------------------
+
 #endif // __CARLA_BRIDGE_UTILS_HPP__
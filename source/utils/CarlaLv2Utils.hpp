@@ -59,10 +59,19 @@
 #include "lv2_rdf.hpp"
 
 #include "lilv/lilvmm.hpp"
+#include "serd/serd.h"
 #include "sratom/sratom.h"
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
 #include <QtCore/QMap>
 #include <QtCore/QStringList>
+#include <QtCore/QThread>
+
+#include <dirent.h>
 
 // -------------------------------------------------
 // Define namespaces and missing prefixes
@@ -103,6 +112,339 @@ struct LV2_Atom_MidiEvent {
     uint8_t data[4];
 };
 
+// -------------------------------------------------
+// URIDs mapped first by the host and UI bridges, so both agree on them from the start
+
+const uint32_t CARLA_URI_MAP_ID_NULL                   =  0;
+const uint32_t CARLA_URI_MAP_ID_ATOM_BLANK             =  1;
+const uint32_t CARLA_URI_MAP_ID_ATOM_BOOL              =  2;
+const uint32_t CARLA_URI_MAP_ID_ATOM_CHUNK             =  3;
+const uint32_t CARLA_URI_MAP_ID_ATOM_DOUBLE            =  4;
+const uint32_t CARLA_URI_MAP_ID_ATOM_FLOAT             =  5;
+const uint32_t CARLA_URI_MAP_ID_ATOM_INT               =  6;
+const uint32_t CARLA_URI_MAP_ID_ATOM_LITERAL           =  7;
+const uint32_t CARLA_URI_MAP_ID_ATOM_LONG              =  8;
+const uint32_t CARLA_URI_MAP_ID_ATOM_PATH              =  9;
+const uint32_t CARLA_URI_MAP_ID_ATOM_PROPERTY          = 10;
+const uint32_t CARLA_URI_MAP_ID_ATOM_RESOURCE          = 11;
+const uint32_t CARLA_URI_MAP_ID_ATOM_SEQUENCE          = 12;
+const uint32_t CARLA_URI_MAP_ID_ATOM_STRING            = 13;
+const uint32_t CARLA_URI_MAP_ID_ATOM_TUPLE             = 14;
+const uint32_t CARLA_URI_MAP_ID_ATOM_URI               = 15;
+const uint32_t CARLA_URI_MAP_ID_ATOM_URID              = 16;
+const uint32_t CARLA_URI_MAP_ID_ATOM_VECTOR            = 17;
+const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_ATOM     = 18;
+const uint32_t CARLA_URI_MAP_ID_ATOM_TRANSFER_EVENT    = 19;
+const uint32_t CARLA_URI_MAP_ID_BUF_MAX_LENGTH         = 20;
+const uint32_t CARLA_URI_MAP_ID_BUF_MIN_LENGTH         = 21;
+const uint32_t CARLA_URI_MAP_ID_BUF_SEQUENCE_SIZE      = 22;
+const uint32_t CARLA_URI_MAP_ID_LOG_ERROR              = 23;
+const uint32_t CARLA_URI_MAP_ID_LOG_NOTE               = 24;
+const uint32_t CARLA_URI_MAP_ID_LOG_TRACE              = 25;
+const uint32_t CARLA_URI_MAP_ID_LOG_WARNING            = 26;
+const uint32_t CARLA_URI_MAP_ID_TIME_POSITION          = 27; // base type
+const uint32_t CARLA_URI_MAP_ID_TIME_BAR               = 28; // values
+const uint32_t CARLA_URI_MAP_ID_TIME_BAR_BEAT          = 29;
+const uint32_t CARLA_URI_MAP_ID_TIME_BEAT              = 30;
+const uint32_t CARLA_URI_MAP_ID_TIME_BEAT_UNIT         = 31;
+const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_BAR     = 32;
+const uint32_t CARLA_URI_MAP_ID_TIME_BEATS_PER_MINUTE  = 33;
+const uint32_t CARLA_URI_MAP_ID_TIME_FRAME             = 34;
+const uint32_t CARLA_URI_MAP_ID_TIME_FRAMES_PER_SECOND = 35;
+const uint32_t CARLA_URI_MAP_ID_TIME_SPEED             = 36;
+const uint32_t CARLA_URI_MAP_ID_MIDI_EVENT             = 37;
+const uint32_t CARLA_URI_MAP_ID_PARAM_SAMPLE_RATE      = 38;
+const uint32_t CARLA_URI_MAP_ID_COUNT                  = 39;
+
+// URIs of the ids above, in the same order
+static const char* const kFixedURIs[CARLA_URI_MAP_ID_COUNT] = {
+    nullptr,
+    LV2_ATOM__Blank,
+    LV2_ATOM__Bool,
+    LV2_ATOM__Chunk,
+    LV2_ATOM__Double,
+    LV2_ATOM__Float,
+    LV2_ATOM__Int,
+    LV2_ATOM__Literal,
+    LV2_ATOM__Long,
+    LV2_ATOM__Path,
+    LV2_ATOM__Property,
+    LV2_ATOM__Resource,
+    LV2_ATOM__Sequence,
+    LV2_ATOM__String,
+    LV2_ATOM__Tuple,
+    LV2_ATOM__URI,
+    LV2_ATOM__URID,
+    LV2_ATOM__Vector,
+    LV2_ATOM__atomTransfer,
+    LV2_ATOM__eventTransfer,
+    LV2_BUF_SIZE__maxBlockLength,
+    LV2_BUF_SIZE__minBlockLength,
+    LV2_BUF_SIZE__sequenceSize,
+    LV2_LOG__Error,
+    LV2_LOG__Note,
+    LV2_LOG__Trace,
+    LV2_LOG__Warning,
+    LV2_TIME__Position,
+    LV2_TIME__bar,
+    LV2_TIME__barBeat,
+    LV2_TIME__beat,
+    LV2_TIME__beatUnit,
+    LV2_TIME__beatsPerBar,
+    LV2_TIME__beatsPerMinute,
+    LV2_TIME__frame,
+    LV2_TIME__framesPerSecond,
+    LV2_TIME__speed,
+    LV2_MIDI__MidiEvent,
+    LV2_PARAMETERS__sampleRate
+};
+
+// -------------------------------------------------
+// Index of the LV2_PATH bundles, made by reading only their manifest.ttl files.
+// Maps every URI used as subject in a manifest (plugins, UIs, presets) and every lv2:appliesTo object
+// (plugins that have presets elsewhere) to the bundles that mention it.
+// Manifests are parsed on several threads, each with its own serd reader.
+
+class Lv2ManifestIndex
+{
+public:
+    Lv2ManifestIndex()
+        : fBuilt(false) {}
+
+    // Bundle paths (ending in a single '/') that describe 'uri', empty if unknown
+    const std::vector<std::string>& getBundles(const LV2_URI uri)
+    {
+        static const std::vector<std::string> kNoBundles;
+
+        if (! fBuilt)
+            build();
+
+        std::map<std::string, std::vector<std::string> >::const_iterator it(fIndex.find(uri));
+
+        return (it != fIndex.end()) ? it->second : kNoBundles;
+    }
+
+private:
+    bool fBuilt;
+    std::map<std::string, std::vector<std::string> > fIndex;
+
+    // same default as lilv
+    static std::vector<std::string> getBundlePaths()
+    {
+        std::vector<std::string> bundles;
+
+        const char* lv2Path(std::getenv("LV2_PATH"));
+        const char* const home(std::getenv("HOME"));
+
+        if (lv2Path == nullptr)
+        {
+#if defined(CARLA_OS_MAC)
+            lv2Path = "~/Library/Audio/Plug-Ins/LV2:/Library/Audio/Plug-Ins/LV2";
+#elif defined(CARLA_OS_WIN)
+            // the default uses %APPDATA%, let lilv load everything instead
+            return bundles;
+#else
+            lv2Path = "~/.lv2:/usr/lib/lv2:/usr/local/lib/lv2";
+#endif
+        }
+
+#ifdef CARLA_OS_WIN
+        const char kPathSep(';');
+#else
+        const char kPathSep(':');
+#endif
+        const std::string paths(lv2Path);
+
+        for (size_t start=0, end; start < paths.size(); start = end+1)
+        {
+            end = paths.find(kPathSep, start);
+
+            if (end == std::string::npos)
+                end = paths.size();
+
+            std::string dir(paths.substr(start, end-start));
+
+            if (dir.empty())
+                continue;
+
+            if (dir[0] == '~' && home != nullptr)
+                dir.replace(0, 1, home);
+
+            DIR* const dirp(::opendir(dir.c_str()));
+
+            if (dirp == nullptr)
+                continue;
+
+            while (struct dirent* const entry = ::readdir(dirp))
+            {
+                if (entry->d_name[0] == '.')
+                    continue;
+
+                // joined like lilv's load_dir_entry(), so initFor() makes the same bundle URI as load_all()
+                const std::string bundle(dir + "/" + entry->d_name + "/");
+                const std::string manifest(bundle + "manifest.ttl");
+
+                if (FILE* const file = std::fopen(manifest.c_str(), "r"))
+                {
+                    std::fclose(file);
+                    bundles.push_back(bundle);
+                }
+            }
+
+            ::closedir(dirp);
+        }
+
+        return bundles;
+    }
+
+    // -------------------------------------------------
+
+    struct ManifestScan {
+        SerdEnv* env;
+        SerdNode appliesTo;
+        std::vector<std::string>* uris;
+    };
+
+    static SerdStatus scanBase(void* handle, const SerdNode* uri)
+    {
+        return serd_env_set_base_uri(((ManifestScan*)handle)->env, uri);
+    }
+
+    static SerdStatus scanPrefix(void* handle, const SerdNode* name, const SerdNode* uri)
+    {
+        return serd_env_set_prefix(((ManifestScan*)handle)->env, name, uri);
+    }
+
+    static void scanNode(ManifestScan* const scan, const SerdNode* const node)
+    {
+        if (node->type != SERD_URI && node->type != SERD_CURIE)
+            return;
+
+        SerdNode expanded(serd_env_expand_node(scan->env, node));
+
+        if (expanded.buf != nullptr)
+        {
+            const std::string uri((const char*)expanded.buf, expanded.n_bytes);
+
+            if (std::find(scan->uris->begin(), scan->uris->end(), uri) == scan->uris->end())
+                scan->uris->push_back(uri);
+        }
+
+        serd_node_free(&expanded);
+    }
+
+    static SerdStatus scanStatement(void* handle, SerdStatementFlags, const SerdNode*, const SerdNode* subject, const SerdNode* predicate,
+                                    const SerdNode* object, const SerdNode*, const SerdNode*)
+    {
+        ManifestScan* const scan((ManifestScan*)handle);
+
+        scanNode(scan, subject);
+
+        SerdNode expandedPredicate(serd_env_expand_node(scan->env, predicate));
+
+        if (serd_node_equals(&expandedPredicate, &scan->appliesTo))
+            scanNode(scan, object);
+
+        serd_node_free(&expandedPredicate);
+        return SERD_SUCCESS;
+    }
+
+    static SerdStatus scanError(void*, const SerdError*)
+    {
+        // lilv reports these when (and if) the bundle gets loaded
+        return SERD_SUCCESS;
+    }
+
+    // Returns all URIs of interest in a bundle's manifest
+    static std::vector<std::string> scanManifest(const std::string& bundle)
+    {
+        std::vector<std::string> uris;
+
+        const std::string manifestPath(bundle + "manifest.ttl");
+        SerdNode manifestURI(serd_node_new_file_uri((const uint8_t*)manifestPath.c_str(), nullptr, nullptr, false));
+
+        ManifestScan scan;
+        scan.env       = serd_env_new(&manifestURI);
+        scan.appliesTo = serd_node_from_string(SERD_URI, (const uint8_t*)LV2_CORE__appliesTo);
+        scan.uris      = &uris;
+
+        SerdReader* const reader(serd_reader_new(SERD_TURTLE, &scan, nullptr, scanBase, scanPrefix, scanStatement, nullptr));
+        serd_reader_set_error_sink(reader, scanError, nullptr);
+        serd_reader_read_file(reader, manifestURI.buf);
+        serd_reader_free(reader);
+
+        serd_env_free(scan.env);
+        serd_node_free(&manifestURI);
+
+        return uris;
+    }
+
+    // -------------------------------------------------
+
+    class ScanThread : public QThread
+    {
+    public:
+        ScanThread(const std::vector<std::string>& bundles, volatile int* const next)
+            : kBundles(bundles),
+              kNext(next) {}
+
+        // index of the bundle, and its URIs
+        std::vector<std::pair<size_t, std::vector<std::string> > > results;
+
+    protected:
+        void run() override
+        {
+            for (int i; (i = __sync_fetch_and_add(kNext, 1)) < static_cast<int>(kBundles.size());)
+                results.push_back(std::make_pair(size_t(i), scanManifest(kBundles[i])));
+        }
+
+    private:
+        const std::vector<std::string>& kBundles;
+        volatile int* const kNext;
+    };
+
+    void build()
+    {
+        fBuilt = true;
+
+        const std::vector<std::string> bundles(getBundlePaths());
+
+        if (bundles.empty())
+            return;
+
+        const int threadCount(carla_min<int>(QThread::idealThreadCount(), static_cast<int>(bundles.size()), 1));
+        volatile int next = 0;
+
+        std::vector<ScanThread*> threads;
+
+        for (int i=0; i < threadCount; ++i)
+        {
+            threads.push_back(new ScanThread(bundles, &next));
+            threads.back()->start();
+        }
+
+        for (int i=0; i < threadCount; ++i)
+        {
+            threads[i]->wait();
+
+            for (size_t j=0, size=threads[i]->results.size(); j < size; ++j)
+            {
+                const std::string& bundle(bundles[threads[i]->results[j].first]);
+                const std::vector<std::string>& uris(threads[i]->results[j].second);
+
+                for (size_t k=0, count=uris.size(); k < count; ++k)
+                    fIndex[uris[k]].push_back(bundle);
+            }
+
+            delete threads[i];
+        }
+
+        carla_debug("Lv2ManifestIndex::build() - %i bundles, %i URIs, %i threads", int(bundles.size()), int(fIndex.size()), threadCount);
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(Lv2ManifestIndex)
+};
+
 // -------------------------------------------------
 // Our LV2 World class
 
@@ -342,6 +684,7 @@ public:
         needInit = true;
     }
 
+    // Loads every bundle in LV2_PATH
     void init()
     {
         if (! needInit)
@@ -351,6 +694,36 @@ public:
         Lilv::World::load_all();
     }
 
+    // Loads only the bundles that describe 'uri' (plugin data, UIs and presets),
+    // or everything if the manifest index doesn't know about it
+    void initFor(const LV2_URI uri)
+    {
+        CARLA_ASSERT(uri != nullptr);
+
+        if (! needInit || uri == nullptr)
+            return;
+
+        const std::vector<std::string>& bundles(fManifestIndex.getBundles(uri));
+
+        if (bundles.empty())
+        {
+            carla_debug("Lv2WorldClass::initFor(\"%s\") - not in the manifest index, loading all bundles", uri);
+            return init();
+        }
+
+        for (size_t i=0, size=bundles.size(); i < size; ++i)
+        {
+            if (std::find(fLoadedBundles.begin(), fLoadedBundles.end(), bundles[i]) != fLoadedBundles.end())
+                continue;
+
+            fLoadedBundles.push_back(bundles[i]);
+
+            // unescaped, the same bundle URI as load_all() would use, so its statements are not duplicated later
+            Lilv::Node bundleNode(Lilv::World::new_uri(("file://" + bundles[i]).c_str()));
+            Lilv::World::load_bundle(bundleNode);
+        }
+    }
+
     const LilvPlugin* getPlugin(const LV2_URI uri)
     {
         CARLA_ASSERT(uri != nullptr);
@@ -382,6 +755,9 @@ public:
     {
         CARLA_ASSERT(uri != nullptr);
 
+        // plugins loaded from the RDF cache don't need the world until a state is requested
+        initFor(uri);
+
         LilvNode* const uriNode(Lilv::World::new_uri(uri));
 
         if (uriNode == nullptr)
@@ -405,6 +781,8 @@ public:
 
 private:
     bool needInit;
+    Lv2ManifestIndex fManifestIndex;
+    std::vector<std::string> fLoadedBundles;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Lv2WorldClass)
 };
@@ -1132,6 +1510,8 @@ const LV2_RDF_Descriptor* lv2_rdf_new(const LV2_URI uri, const bool fillPresets
 
                 if (const char* const extURI = lilvExtensionDataNode.as_uri())
                     *rdfExtension = carla_strdup(extURI);
+                else
+                    *rdfExtension = nullptr;
             }
         }
     }
@@ -1239,6 +1619,8 @@ const LV2_RDF_Descriptor* lv2_rdf_new(const LV2_URI uri, const bool fillPresets
 
                             if (const char* const extURI = lilvExtensionDataNode.as_uri())
                                 *rdfExtension = carla_strdup(extURI);
+                            else
+                                *rdfExtension = nullptr;
                         }
                     }
                 }
@@ -0,0 +1,753 @@
+/*
+ * Carla math utils
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __CARLA_MATH_UTILS_HPP__
+#define __CARLA_MATH_UTILS_HPP__
+
+#include "CarlaDefines.hpp"
+
+#include <cstddef>
+
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+# include <cstdint>
+#else
+# include <stdint.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && ! defined(CARLA_NO_SIMD)
+# define CARLA_SIMD_X86
+# include <immintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && ! defined(CARLA_NO_SIMD)
+# define CARLA_SIMD_NEON
+# include <arm_neon.h>
+#endif
+
+// -------------------------------------------------
+// float buffer kernels
+//
+// These run for every channel of every plugin on each audio cycle.
+// The best implementation for the running CPU is picked once, on first use.
+// Buffers do not need any special alignment.
+
+enum CarlaSimdType {
+    CARLA_SIMD_NONE = 0,
+    CARLA_SIMD_SSE2 = 1,
+    CARLA_SIMD_AVX  = 2,
+    CARLA_SIMD_NEON = 3
+};
+
+struct CarlaFloatKernels {
+    CarlaSimdType type;
+
+    // returns the highest absolute value in data
+    float (*findAbsMax)(const float* const data, const size_t size);
+
+    // dataDst += dataSrc
+    void (*add)(float* const dataDst, const float* const dataSrc, const size_t size);
+
+    // data *= gain
+    void (*multiply)(float* const data, const float gain, const size_t size);
+
+    // dataDst[frame*channels+channel] = dataSrc[channel][frame]
+    void (*interleave)(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames);
+
+    // dataDst[channel][frame] = dataSrc[frame*channels+channel]
+    void (*deinterleave)(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames);
+};
+
+// -------------------------------------------------
+// scalar versions, always available
+
+static inline
+float carla_findAbsMaxFloat_scalar(const float* const data, const size_t size)
+{
+    float maxValue = 0.0f;
+
+    for (size_t i=0; i < size; ++i)
+    {
+        const float value((data[i] < 0.0f) ? -data[i] : data[i]);
+
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    return maxValue;
+}
+
+static inline
+void carla_addFloat_scalar(float* const dataDst, const float* const dataSrc, const size_t size)
+{
+    for (size_t i=0; i < size; ++i)
+        dataDst[i] += dataSrc[i];
+}
+
+static inline
+void carla_multiplyFloat_scalar(float* const data, const float gain, const size_t size)
+{
+    for (size_t i=0; i < size; ++i)
+        data[i] *= gain;
+}
+
+// fixed channel count, lets the compiler unroll the inner loop
+template<uint32_t kChannels>
+static inline
+void carla_interleaveFloat_fixed(float* dataDst, float* const* const dataSrc, const size_t frames)
+{
+    for (size_t i=0; i < frames; ++i, dataDst += kChannels)
+    {
+        for (uint32_t j=0; j < kChannels; ++j)
+            dataDst[j] = dataSrc[j][i];
+    }
+}
+
+template<uint32_t kChannels>
+static inline
+void carla_deinterleaveFloat_fixed(float* const* const dataDst, const float* dataSrc, const size_t frames)
+{
+    for (size_t i=0; i < frames; ++i, dataSrc += kChannels)
+    {
+        for (uint32_t j=0; j < kChannels; ++j)
+            dataDst[j][i] = dataSrc[j];
+    }
+}
+
+static inline
+void carla_interleaveFloat_scalar(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    switch (channels)
+    {
+    case 1:
+        return carla_interleaveFloat_fixed<1>(dataDst, dataSrc, frames);
+    case 2:
+        return carla_interleaveFloat_fixed<2>(dataDst, dataSrc, frames);
+    case 4:
+        return carla_interleaveFloat_fixed<4>(dataDst, dataSrc, frames);
+    case 8:
+        return carla_interleaveFloat_fixed<8>(dataDst, dataSrc, frames);
+    case 16:
+        return carla_interleaveFloat_fixed<16>(dataDst, dataSrc, frames);
+    case 32:
+        return carla_interleaveFloat_fixed<32>(dataDst, dataSrc, frames);
+    }
+
+    for (size_t i=0, k=0; i < frames; ++i)
+    {
+        for (uint32_t j=0; j < channels; ++j)
+            dataDst[k++] = dataSrc[j][i];
+    }
+}
+
+static inline
+void carla_deinterleaveFloat_scalar(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    switch (channels)
+    {
+    case 1:
+        return carla_deinterleaveFloat_fixed<1>(dataDst, dataSrc, frames);
+    case 2:
+        return carla_deinterleaveFloat_fixed<2>(dataDst, dataSrc, frames);
+    case 4:
+        return carla_deinterleaveFloat_fixed<4>(dataDst, dataSrc, frames);
+    case 8:
+        return carla_deinterleaveFloat_fixed<8>(dataDst, dataSrc, frames);
+    case 16:
+        return carla_deinterleaveFloat_fixed<16>(dataDst, dataSrc, frames);
+    case 32:
+        return carla_deinterleaveFloat_fixed<32>(dataDst, dataSrc, frames);
+    }
+
+    for (size_t i=0, k=0; i < frames; ++i)
+    {
+        for (uint32_t j=0; j < channels; ++j)
+            dataDst[j][i] = dataSrc[k++];
+    }
+}
+
+static inline
+const CarlaFloatKernels* carla_getFloatKernels_scalar()
+{
+    static const CarlaFloatKernels kernels = {
+        CARLA_SIMD_NONE,
+        carla_findAbsMaxFloat_scalar,
+        carla_addFloat_scalar,
+        carla_multiplyFloat_scalar,
+        carla_interleaveFloat_scalar,
+        carla_deinterleaveFloat_scalar
+    };
+    return &kernels;
+}
+
+// -------------------------------------------------
+// x86 versions, enabled per function so the rest of the code does not need special flags
+
+#ifdef CARLA_SIMD_X86
+__attribute__((target("sse2")))
+static inline
+float carla_findAbsMaxFloat_sse2(const float* const data, const size_t size)
+{
+    const __m128 signMask(_mm_set1_ps(-0.0f));
+    __m128 maxValues(_mm_setzero_ps());
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        maxValues = _mm_max_ps(_mm_andnot_ps(signMask, _mm_loadu_ps(data+i)), maxValues);
+
+    // reduce 4 -> 1
+    maxValues = _mm_max_ps(maxValues, _mm_movehl_ps(maxValues, maxValues));
+    maxValues = _mm_max_ss(maxValues, _mm_shuffle_ps(maxValues, maxValues, 1));
+
+    float maxValue(_mm_cvtss_f32(maxValues));
+
+    for (; i < size; ++i)
+    {
+        const float value((data[i] < 0.0f) ? -data[i] : data[i]);
+
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    return maxValue;
+}
+
+__attribute__((target("sse2")))
+static inline
+void carla_addFloat_sse2(float* const dataDst, const float* const dataSrc, const size_t size)
+{
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        _mm_storeu_ps(dataDst+i, _mm_add_ps(_mm_loadu_ps(dataDst+i), _mm_loadu_ps(dataSrc+i)));
+
+    for (; i < size; ++i)
+        dataDst[i] += dataSrc[i];
+}
+
+__attribute__((target("sse2")))
+static inline
+void carla_multiplyFloat_sse2(float* const data, const float gain, const size_t size)
+{
+    const __m128 gains(_mm_set1_ps(gain));
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        _mm_storeu_ps(data+i, _mm_mul_ps(_mm_loadu_ps(data+i), gains));
+
+    for (; i < size; ++i)
+        data[i] *= gain;
+}
+
+// channels are done in blocks of 4 using a 4x4 transpose, the remaining ones one by one.
+// kChannels is 0 for a channel count only known at runtime.
+template<uint32_t kChannels>
+__attribute__((target("sse2")))
+static inline
+void carla_interleaveFloat_sse2_blocks(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    const uint32_t numChannels((kChannels != 0) ? kChannels : channels);
+    const uint32_t numBlocks(numChannels/4);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        float* const dst(dataDst + i*numChannels);
+
+        for (uint32_t b=0; b < numBlocks; ++b)
+        {
+            __m128 r0(_mm_loadu_ps(dataSrc[b*4+0]+i));
+            __m128 r1(_mm_loadu_ps(dataSrc[b*4+1]+i));
+            __m128 r2(_mm_loadu_ps(dataSrc[b*4+2]+i));
+            __m128 r3(_mm_loadu_ps(dataSrc[b*4+3]+i));
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_storeu_ps(dst + b*4,                 r0);
+            _mm_storeu_ps(dst + b*4 + numChannels,   r1);
+            _mm_storeu_ps(dst + b*4 + numChannels*2, r2);
+            _mm_storeu_ps(dst + b*4 + numChannels*3, r3);
+        }
+
+        for (uint32_t j=numBlocks*4; j < numChannels; ++j)
+        {
+            for (uint32_t k=0; k < 4; ++k)
+                dst[k*numChannels + j] = dataSrc[j][i+k];
+        }
+    }
+
+    for (; i < frames; ++i)
+    {
+        for (uint32_t j=0; j < numChannels; ++j)
+            dataDst[i*numChannels + j] = dataSrc[j][i];
+    }
+}
+
+template<uint32_t kChannels>
+__attribute__((target("sse2")))
+static inline
+void carla_deinterleaveFloat_sse2_blocks(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    const uint32_t numChannels((kChannels != 0) ? kChannels : channels);
+    const uint32_t numBlocks(numChannels/4);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        const float* const src(dataSrc + i*numChannels);
+
+        for (uint32_t b=0; b < numBlocks; ++b)
+        {
+            __m128 r0(_mm_loadu_ps(src + b*4));
+            __m128 r1(_mm_loadu_ps(src + b*4 + numChannels));
+            __m128 r2(_mm_loadu_ps(src + b*4 + numChannels*2));
+            __m128 r3(_mm_loadu_ps(src + b*4 + numChannels*3));
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_storeu_ps(dataDst[b*4+0]+i, r0);
+            _mm_storeu_ps(dataDst[b*4+1]+i, r1);
+            _mm_storeu_ps(dataDst[b*4+2]+i, r2);
+            _mm_storeu_ps(dataDst[b*4+3]+i, r3);
+        }
+
+        for (uint32_t j=numBlocks*4; j < numChannels; ++j)
+        {
+            for (uint32_t k=0; k < 4; ++k)
+                dataDst[j][i+k] = src[k*numChannels + j];
+        }
+    }
+
+    for (; i < frames; ++i)
+    {
+        for (uint32_t j=0; j < numChannels; ++j)
+            dataDst[j][i] = dataSrc[i*numChannels + j];
+    }
+}
+
+__attribute__((target("sse2")))
+static inline
+void carla_interleaveFloat_sse2(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    switch (channels)
+    {
+    case 2:
+        break;
+    case 4:
+        return carla_interleaveFloat_sse2_blocks<4>(dataDst, dataSrc, channels, frames);
+    case 8:
+        return carla_interleaveFloat_sse2_blocks<8>(dataDst, dataSrc, channels, frames);
+    case 16:
+        return carla_interleaveFloat_sse2_blocks<16>(dataDst, dataSrc, channels, frames);
+    case 32:
+        return carla_interleaveFloat_sse2_blocks<32>(dataDst, dataSrc, channels, frames);
+    default:
+        if (channels > 4)
+            return carla_interleaveFloat_sse2_blocks<0>(dataDst, dataSrc, channels, frames);
+        return carla_interleaveFloat_scalar(dataDst, dataSrc, channels, frames);
+    }
+
+    const float* const left(dataSrc[0]);
+    const float* const right(dataSrc[1]);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        const __m128 l(_mm_loadu_ps(left+i));
+        const __m128 r(_mm_loadu_ps(right+i));
+
+        _mm_storeu_ps(dataDst+i*2,   _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dataDst+i*2+4, _mm_unpackhi_ps(l, r));
+    }
+
+    for (; i < frames; ++i)
+    {
+        dataDst[i*2]   = left[i];
+        dataDst[i*2+1] = right[i];
+    }
+}
+
+__attribute__((target("sse2")))
+static inline
+void carla_deinterleaveFloat_sse2(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    switch (channels)
+    {
+    case 2:
+        break;
+    case 4:
+        return carla_deinterleaveFloat_sse2_blocks<4>(dataDst, dataSrc, channels, frames);
+    case 8:
+        return carla_deinterleaveFloat_sse2_blocks<8>(dataDst, dataSrc, channels, frames);
+    case 16:
+        return carla_deinterleaveFloat_sse2_blocks<16>(dataDst, dataSrc, channels, frames);
+    case 32:
+        return carla_deinterleaveFloat_sse2_blocks<32>(dataDst, dataSrc, channels, frames);
+    default:
+        if (channels > 4)
+            return carla_deinterleaveFloat_sse2_blocks<0>(dataDst, dataSrc, channels, frames);
+        return carla_deinterleaveFloat_scalar(dataDst, dataSrc, channels, frames);
+    }
+
+    float* const left(dataDst[0]);
+    float* const right(dataDst[1]);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        const __m128 a(_mm_loadu_ps(dataSrc+i*2));
+        const __m128 b(_mm_loadu_ps(dataSrc+i*2+4));
+
+        _mm_storeu_ps(left+i,  _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right+i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    for (; i < frames; ++i)
+    {
+        left[i]  = dataSrc[i*2];
+        right[i] = dataSrc[i*2+1];
+    }
+}
+
+__attribute__((target("avx")))
+static inline
+float carla_findAbsMaxFloat_avx(const float* const data, const size_t size)
+{
+    const __m256 signMask(_mm256_set1_ps(-0.0f));
+    __m256 maxValues(_mm256_setzero_ps());
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        maxValues = _mm256_max_ps(_mm256_andnot_ps(signMask, _mm256_loadu_ps(data+i)), maxValues);
+
+    // reduce 8 -> 1
+    __m128 maxValues4(_mm_max_ps(_mm256_castps256_ps128(maxValues), _mm256_extractf128_ps(maxValues, 1)));
+    maxValues4 = _mm_max_ps(maxValues4, _mm_movehl_ps(maxValues4, maxValues4));
+    maxValues4 = _mm_max_ss(maxValues4, _mm_shuffle_ps(maxValues4, maxValues4, 1));
+
+    float maxValue(_mm_cvtss_f32(maxValues4));
+
+    for (; i < size; ++i)
+    {
+        const float value((data[i] < 0.0f) ? -data[i] : data[i]);
+
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    return maxValue;
+}
+
+__attribute__((target("avx")))
+static inline
+void carla_addFloat_avx(float* const dataDst, const float* const dataSrc, const size_t size)
+{
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        _mm256_storeu_ps(dataDst+i, _mm256_add_ps(_mm256_loadu_ps(dataDst+i), _mm256_loadu_ps(dataSrc+i)));
+
+    for (; i < size; ++i)
+        dataDst[i] += dataSrc[i];
+}
+
+__attribute__((target("avx")))
+static inline
+void carla_multiplyFloat_avx(float* const data, const float gain, const size_t size)
+{
+    const __m256 gains(_mm256_set1_ps(gain));
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        _mm256_storeu_ps(data+i, _mm256_mul_ps(_mm256_loadu_ps(data+i), gains));
+
+    for (; i < size; ++i)
+        data[i] *= gain;
+}
+
+static inline
+const CarlaFloatKernels* carla_getFloatKernels_sse2()
+{
+    static const CarlaFloatKernels kernels = {
+        CARLA_SIMD_SSE2,
+        carla_findAbsMaxFloat_sse2,
+        carla_addFloat_sse2,
+        carla_multiplyFloat_sse2,
+        carla_interleaveFloat_sse2,
+        carla_deinterleaveFloat_sse2
+    };
+    return &kernels;
+}
+
+// (de)interleaving is bound by memory access, AVX lane crossing does not help there
+static inline
+const CarlaFloatKernels* carla_getFloatKernels_avx()
+{
+    static const CarlaFloatKernels kernels = {
+        CARLA_SIMD_AVX,
+        carla_findAbsMaxFloat_avx,
+        carla_addFloat_avx,
+        carla_multiplyFloat_avx,
+        carla_interleaveFloat_sse2,
+        carla_deinterleaveFloat_sse2
+    };
+    return &kernels;
+}
+#endif // CARLA_SIMD_X86
+
+// -------------------------------------------------
+// ARM NEON versions, only when the compiler targets NEON
+
+#ifdef CARLA_SIMD_NEON
+static inline
+float carla_findAbsMaxFloat_neon(const float* const data, const size_t size)
+{
+    float32x4_t maxValues(vdupq_n_f32(0.0f));
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        maxValues = vmaxq_f32(maxValues, vabsq_f32(vld1q_f32(data+i)));
+
+    // reduce 4 -> 1
+    float32x2_t maxValues2(vpmax_f32(vget_low_f32(maxValues), vget_high_f32(maxValues)));
+    maxValues2 = vpmax_f32(maxValues2, maxValues2);
+
+    float maxValue(vget_lane_f32(maxValues2, 0));
+
+    for (; i < size; ++i)
+    {
+        const float value((data[i] < 0.0f) ? -data[i] : data[i]);
+
+        if (value > maxValue)
+            maxValue = value;
+    }
+
+    return maxValue;
+}
+
+static inline
+void carla_addFloat_neon(float* const dataDst, const float* const dataSrc, const size_t size)
+{
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        vst1q_f32(dataDst+i, vaddq_f32(vld1q_f32(dataDst+i), vld1q_f32(dataSrc+i)));
+
+    for (; i < size; ++i)
+        dataDst[i] += dataSrc[i];
+}
+
+static inline
+void carla_multiplyFloat_neon(float* const data, const float gain, const size_t size)
+{
+    size_t i = 0;
+
+    for (; i+4 <= size; i += 4)
+        vst1q_f32(data+i, vmulq_n_f32(vld1q_f32(data+i), gain));
+
+    for (; i < size; ++i)
+        data[i] *= gain;
+}
+
+static inline
+void carla_interleaveFloat_neon(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    if (channels == 4)
+    {
+        size_t i = 0;
+
+        for (; i+4 <= frames; i += 4)
+        {
+            float32x4x4_t values;
+            values.val[0] = vld1q_f32(dataSrc[0]+i);
+            values.val[1] = vld1q_f32(dataSrc[1]+i);
+            values.val[2] = vld1q_f32(dataSrc[2]+i);
+            values.val[3] = vld1q_f32(dataSrc[3]+i);
+            vst4q_f32(dataDst+i*4, values);
+        }
+
+        for (; i < frames; ++i)
+        {
+            for (uint32_t j=0; j < 4; ++j)
+                dataDst[i*4+j] = dataSrc[j][i];
+        }
+        return;
+    }
+
+    if (channels != 2)
+        return carla_interleaveFloat_scalar(dataDst, dataSrc, channels, frames);
+
+    const float* const left(dataSrc[0]);
+    const float* const right(dataSrc[1]);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        float32x4x2_t values;
+        values.val[0] = vld1q_f32(left+i);
+        values.val[1] = vld1q_f32(right+i);
+        vst2q_f32(dataDst+i*2, values);
+    }
+
+    for (; i < frames; ++i)
+    {
+        dataDst[i*2]   = left[i];
+        dataDst[i*2+1] = right[i];
+    }
+}
+
+static inline
+void carla_deinterleaveFloat_neon(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    if (channels == 4)
+    {
+        size_t i = 0;
+
+        for (; i+4 <= frames; i += 4)
+        {
+            const float32x4x4_t values(vld4q_f32(dataSrc+i*4));
+            vst1q_f32(dataDst[0]+i, values.val[0]);
+            vst1q_f32(dataDst[1]+i, values.val[1]);
+            vst1q_f32(dataDst[2]+i, values.val[2]);
+            vst1q_f32(dataDst[3]+i, values.val[3]);
+        }
+
+        for (; i < frames; ++i)
+        {
+            for (uint32_t j=0; j < 4; ++j)
+                dataDst[j][i] = dataSrc[i*4+j];
+        }
+        return;
+    }
+
+    if (channels != 2)
+        return carla_deinterleaveFloat_scalar(dataDst, dataSrc, channels, frames);
+
+    float* const left(dataDst[0]);
+    float* const right(dataDst[1]);
+    size_t i = 0;
+
+    for (; i+4 <= frames; i += 4)
+    {
+        const float32x4x2_t values(vld2q_f32(dataSrc+i*2));
+        vst1q_f32(left+i,  values.val[0]);
+        vst1q_f32(right+i, values.val[1]);
+    }
+
+    for (; i < frames; ++i)
+    {
+        left[i]  = dataSrc[i*2];
+        right[i] = dataSrc[i*2+1];
+    }
+}
+
+static inline
+const CarlaFloatKernels* carla_getFloatKernels_neon()
+{
+    static const CarlaFloatKernels kernels = {
+        CARLA_SIMD_NEON,
+        carla_findAbsMaxFloat_neon,
+        carla_addFloat_neon,
+        carla_multiplyFloat_neon,
+        carla_interleaveFloat_neon,
+        carla_deinterleaveFloat_neon
+    };
+    return &kernels;
+}
+#endif // CARLA_SIMD_NEON
+
+// -------------------------------------------------
+// runtime dispatch
+
+/*
+ * Get the kernels of a specific type.
+ * Returns null if the type is not built in or not supported by the running CPU.
+ */
+static inline
+const CarlaFloatKernels* carla_getFloatKernels(const CarlaSimdType type)
+{
+    switch (type)
+    {
+    case CARLA_SIMD_NONE:
+        return carla_getFloatKernels_scalar();
+#ifdef CARLA_SIMD_X86
+    case CARLA_SIMD_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2") ? carla_getFloatKernels_sse2() : nullptr;
+    case CARLA_SIMD_AVX:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx") ? carla_getFloatKernels_avx() : nullptr;
+#endif
+#ifdef CARLA_SIMD_NEON
+    case CARLA_SIMD_NEON:
+        return carla_getFloatKernels_neon();
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+/*
+ * Get the best kernels for the running CPU.
+ */
+static inline
+const CarlaFloatKernels& carla_getFloatKernels()
+{
+    struct Detector {
+        static const CarlaFloatKernels* detect()
+        {
+            if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_AVX))
+                return kernels;
+            if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_SSE2))
+                return kernels;
+            if (const CarlaFloatKernels* const kernels = carla_getFloatKernels(CARLA_SIMD_NEON))
+                return kernels;
+            return carla_getFloatKernels_scalar();
+        }
+    };
+
+    static const CarlaFloatKernels* const kernels(Detector::detect());
+    return *kernels;
+}
+
+// -------------------------------------------------
+// public calls
+
+static inline
+float carla_findAbsMaxFloat(const float* const data, const size_t size)
+{
+    return carla_getFloatKernels().findAbsMax(data, size);
+}
+
+static inline
+void carla_multiplyFloat(float* const data, const float gain, const size_t size)
+{
+    carla_getFloatKernels().multiply(data, gain, size);
+}
+
+static inline
+void carla_interleaveFloat(float* const dataDst, float* const* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    carla_getFloatKernels().interleave(dataDst, dataSrc, channels, frames);
+}
+
+static inline
+void carla_deinterleaveFloat(float* const* const dataDst, const float* const dataSrc, const uint32_t channels, const size_t frames)
+{
+    carla_getFloatKernels().deinterleave(dataDst, dataSrc, channels, frames);
+}
+
+// -------------------------------------------------
+
+#endif // __CARLA_MATH_UTILS_HPP__
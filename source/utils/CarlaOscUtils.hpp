@@ -329,15 +329,15 @@ void osc_send_lv2_atom_transfer(const CarlaOscData* const oscData, const int32_t
     }
 }
 
+// a null 'urid' asks the host to map 'uri'
 static inline
 void osc_send_lv2_urid_map(const CarlaOscData* const oscData, const uint32_t urid, const char* const uri)
 {
     CARLA_ASSERT(oscData != nullptr && oscData->path != nullptr);
-    CARLA_ASSERT(urid > 0);
     CARLA_ASSERT(uri != nullptr);
     carla_debug("osc_send_lv2_urid_map(path:\"%s\", %i, \"%s\")", oscData->path, urid, uri);
 
-    if (oscData != nullptr && oscData->path != nullptr && oscData->target != nullptr && urid > 0 && uri != nullptr)
+    if (oscData != nullptr && oscData->path != nullptr && oscData->target != nullptr && uri != nullptr)
     {
         char targetPath[std::strlen(oscData->path)+14];
         std::strcpy(targetPath, oscData->path);
@@ -19,6 +19,7 @@
 #define __CARLA_UTILS_HPP__
 
 #include "CarlaDefines.hpp"
+#include "CarlaMathUtils.hpp"
 
 #include <cassert>
 #include <cstdarg>
@@ -344,7 +345,14 @@ void carla_addDouble(double* const dataDst, double* const dataSrc, const size_t
 static inline
 void carla_addFloat(float* const dataDst, float* const dataSrc, const size_t size)
 {
-    carla_add<float>(dataDst, dataSrc, size);
+    CARLA_ASSERT(dataDst != nullptr);
+    CARLA_ASSERT(dataSrc != nullptr);
+    CARLA_ASSERT(size != 0);
+
+    if (dataDst == nullptr || dataSrc == nullptr || size == 0)
+        return;
+
+    carla_getFloatKernels().add(dataDst, dataSrc, size);
 }
 
 static inline
@@ -376,7 +384,14 @@ void carla_zeroDouble(double* const data, const size_t size)
 static inline
 void carla_zeroFloat(float* const data, const size_t size)
 {
-    carla_fill<float>(data, size, 0.0f);
+    CARLA_ASSERT(data != nullptr);
+    CARLA_ASSERT(size != 0);
+
+    if (data == nullptr || size == 0)
+        return;
+
+    // all bits zero is 0.0f
+    std::memset(data, 0, size*sizeof(float));
 }
 
 #if defined(CARLA_OS_MAC) && ! defined(DISTRHO_OS_MAC)
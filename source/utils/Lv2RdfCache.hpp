@@ -0,0 +1,713 @@
+/*
+ * On-disk cache of LV2 RDF descriptors
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __LV2_RDF_CACHE_HPP__
+#define __LV2_RDF_CACHE_HPP__
+
+#include "CarlaJuceUtils.hpp"
+#include "CarlaUtils.hpp"
+
+#include "lv2_rdf.hpp"
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+// -----------------------------------------------------------------------
+// Serialized LV2_RDF_Descriptors, so hosts can skip lilv's load_all() when a plugin was seen before.
+// Each entry is keyed by plugin URI and stamped with its bundle's .ttl files and the LV2_PATH directories,
+// a changed bundle (or a newly installed one, which may add presets) makes the entry stale.
+// The file is written in host byte order, it is never meant to be shared between machines.
+
+#define LV2_RDF_CACHE_MAGIC   "CarlaLv2RdfCache"
+#define LV2_RDF_CACHE_VERSION 1
+
+class Lv2RdfCache
+{
+public:
+    // uses ~/.config/falkTX/lv2_rdf.cache when 'filename' is null
+    Lv2RdfCache(const char* const filename = nullptr)
+        : fFilename(filename != nullptr ? std::string(filename) : getDefaultFilename()),
+          fPathStamp(0),
+          fLoaded(false)
+    {
+    }
+
+    // Returns a new descriptor if 'uri' is cached and still valid, nullptr otherwise
+    const LV2_RDF_Descriptor* get(const LV2_URI uri)
+    {
+        CARLA_ASSERT(uri != nullptr);
+
+        if (uri == nullptr || fFilename.empty())
+            return nullptr;
+
+        load();
+
+        std::map<std::string, Entry>::const_iterator it(fEntries.find(uri));
+
+        if (it == fEntries.end())
+            return nullptr;
+
+        const Entry& entry(it->second);
+
+        if (entry.pathStamp != fPathStamp || entry.bundleStamp != getBundleStamp(entry.bundle.c_str()))
+        {
+            carla_debug("Lv2RdfCache::get(\"%s\") - entry is stale", uri);
+            return nullptr;
+        }
+
+        Reader reader(entry.data);
+        LV2_RDF_Descriptor* const rdfDescriptor(new LV2_RDF_Descriptor());
+
+        if (! reader.readDescriptor(rdfDescriptor))
+        {
+            carla_stderr("Lv2RdfCache::get(\"%s\") - invalid entry", uri);
+            delete rdfDescriptor;
+            return nullptr;
+        }
+
+        return rdfDescriptor;
+    }
+
+    // Stores a descriptor made by lv2_rdf_new() (with presets) and saves the cache file
+    void put(const LV2_RDF_Descriptor* const rdfDescriptor)
+    {
+        CARLA_ASSERT(rdfDescriptor != nullptr);
+
+        if (rdfDescriptor == nullptr || rdfDescriptor->URI == nullptr || rdfDescriptor->Bundle == nullptr || fFilename.empty())
+            return;
+
+        load();
+
+        const uint64_t bundleStamp(getBundleStamp(rdfDescriptor->Bundle));
+
+        if (bundleStamp == 0)
+            return;
+
+        Writer writer;
+        writer.writeDescriptor(rdfDescriptor);
+
+        Entry& entry(fEntries[rdfDescriptor->URI]);
+        entry.bundle      = rdfDescriptor->Bundle;
+        entry.bundleStamp = bundleStamp;
+        entry.pathStamp   = fPathStamp;
+        entry.data        = writer.data;
+
+        save();
+    }
+
+    // Combined modification times of all .ttl files in a bundle, 0 if the bundle can't be read.
+    // The directory time covers added and removed files.
+    static uint64_t getBundleStamp(const char* const bundle)
+    {
+        CARLA_ASSERT(bundle != nullptr);
+
+        struct stat st;
+
+        if (bundle == nullptr || ::stat(bundle, &st) != 0)
+            return 0;
+
+        DIR* const dir(::opendir(bundle));
+
+        if (dir == nullptr)
+            return 0;
+
+        std::string path(bundle);
+
+        if (path[path.size()-1] != '/')
+            path += '/';
+
+        uint64_t stamp(hashString(bundle) ^ uint64_t(st.st_mtime));
+
+        // readdir order is not stable, so the files are combined in an order-independent way
+        while (struct dirent* const entry = ::readdir(dir))
+        {
+            const size_t nameLen(std::strlen(entry->d_name));
+
+            if (nameLen < 5 || std::strcmp(entry->d_name + nameLen - 4, ".ttl") != 0)
+                continue;
+
+            if (::stat((path + entry->d_name).c_str(), &st) != 0)
+                continue;
+
+            stamp += hashString(entry->d_name) ^ (uint64_t(st.st_mtime) << 16) ^ uint64_t(st.st_size);
+        }
+
+        ::closedir(dir);
+
+        return (stamp != 0) ? stamp : 1;
+    }
+
+    // Combined modification times of the LV2_PATH directories, same defaults as lilv
+    static uint64_t getPathStamp()
+    {
+        const char* const envPath(std::getenv("LV2_PATH"));
+        const char* const home(std::getenv("HOME"));
+
+#ifdef CARLA_OS_MAC
+        const std::string lv2Path((envPath != nullptr) ? envPath : "~/Library/Audio/Plug-Ins/LV2:/Library/Audio/Plug-Ins/LV2");
+#else
+        const std::string lv2Path((envPath != nullptr) ? envPath : "~/.lv2:/usr/lib/lv2:/usr/local/lib/lv2");
+#endif
+
+        uint64_t stamp(hashString(lv2Path.c_str()));
+
+        for (size_t start=0, end; start < lv2Path.size(); start = end+1)
+        {
+            end = lv2Path.find(':', start);
+
+            if (end == std::string::npos)
+                end = lv2Path.size();
+
+            std::string dir(lv2Path.substr(start, end-start));
+
+            if (dir.size() > 0 && dir[0] == '~' && home != nullptr)
+                dir.replace(0, 1, home);
+
+            struct stat st;
+
+            if (::stat(dir.c_str(), &st) == 0)
+                stamp = stamp*31 + uint64_t(st.st_mtime);
+        }
+
+        return stamp;
+    }
+
+private:
+    struct Entry {
+        std::string bundle;
+        uint64_t    bundleStamp;
+        uint64_t    pathStamp;
+        std::string data;
+
+        Entry()
+            : bundleStamp(0),
+              pathStamp(0) {}
+    };
+
+    const std::string fFilename;
+    uint64_t fPathStamp;
+    bool     fLoaded;
+    std::map<std::string, Entry> fEntries;
+
+    // -------------------------------------------------------------------
+
+    static std::string getDefaultFilename()
+    {
+#ifdef CARLA_OS_WIN
+        return std::string();
+#else
+        const char* const home(std::getenv("HOME"));
+
+        if (home == nullptr || home[0] == '\0')
+            return std::string();
+
+        return std::string(home) + "/.config/falkTX/lv2_rdf.cache";
+#endif
+    }
+
+    // FNV-1a
+    static uint64_t hashString(const char* str)
+    {
+        uint64_t hash(14695981039346656037ULL);
+
+        for (; *str != '\0'; ++str)
+        {
+            hash ^= static_cast<uint8_t>(*str);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    // -------------------------------------------------------------------
+    // File format, after the magic string and version:
+    //  uint32 size, then 'size' bytes per entry: uri, bundle, bundle stamp, path stamp and descriptor
+
+    void load()
+    {
+        if (fLoaded)
+            return;
+
+        fLoaded    = true;
+        fPathStamp = getPathStamp();
+
+        FILE* const file(std::fopen(fFilename.c_str(), "rb"));
+
+        if (file == nullptr)
+            return;
+
+        std::string data;
+        char buf[8192];
+
+        for (size_t len; (len = std::fread(buf, 1, sizeof(buf), file)) > 0;)
+            data.append(buf, len);
+
+        std::fclose(file);
+
+        Reader reader(data);
+
+        if (! (reader.readMagic() && reader.readUInt32() == LV2_RDF_CACHE_VERSION))
+        {
+            carla_stderr("Lv2RdfCache::load() - ignoring old or invalid cache file");
+            return;
+        }
+
+        while (! reader.atEnd())
+        {
+            const uint32_t size(reader.readUInt32());
+            const std::string entryData(reader.readBlock(size));
+
+            if (! reader.ok)
+                break;
+
+            Reader entryReader(entryData);
+
+            const std::string uri(entryReader.readStdString());
+
+            Entry entry;
+            entry.bundle      = entryReader.readStdString();
+            entry.bundleStamp = entryReader.readUInt64();
+            entry.pathStamp   = entryReader.readUInt64();
+
+            if (! entryReader.ok)
+                continue;
+
+            entry.data = entryReader.readBlock(entryReader.remaining());
+            fEntries[uri] = entry;
+        }
+
+        carla_debug("Lv2RdfCache::load() - %i entries", int(fEntries.size()));
+    }
+
+    void save()
+    {
+        ::mkdir(fFilename.substr(0, fFilename.rfind('/')).c_str(), 0755);
+
+        // write to a temporary file first, so other hosts never read a partial cache
+        const std::string tmpFilename(fFilename + ".tmp");
+
+        Writer writer;
+        writer.writeMagic();
+        writer.writeUInt32(LV2_RDF_CACHE_VERSION);
+
+        for (std::map<std::string, Entry>::const_iterator it=fEntries.begin(), end=fEntries.end(); it != end; ++it)
+        {
+            Writer entryWriter;
+            entryWriter.writeString(it->first.c_str());
+            entryWriter.writeString(it->second.bundle.c_str());
+            entryWriter.writeUInt64(it->second.bundleStamp);
+            entryWriter.writeUInt64(it->second.pathStamp);
+            entryWriter.data += it->second.data;
+
+            writer.writeUInt32(static_cast<uint32_t>(entryWriter.data.size()));
+            writer.data += entryWriter.data;
+        }
+
+        FILE* const file(std::fopen(tmpFilename.c_str(), "wb"));
+
+        if (file == nullptr)
+            return;
+
+        const bool written(std::fwrite(writer.data.data(), 1, writer.data.size(), file) == writer.data.size());
+
+        if (std::fclose(file) != 0 || ! written || std::rename(tmpFilename.c_str(), fFilename.c_str()) != 0)
+        {
+            carla_stderr("Lv2RdfCache::save() - failed to save cache");
+            std::remove(tmpFilename.c_str());
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+    struct Writer {
+        std::string data;
+
+        void writeMagic()
+        {
+            data.append(LV2_RDF_CACHE_MAGIC, sizeof(LV2_RDF_CACHE_MAGIC));
+        }
+
+        void writeUInt32(const uint32_t value)
+        {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+        }
+
+        void writeUInt64(const uint64_t value)
+        {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(uint64_t));
+        }
+
+        void writeFloat(const float value)
+        {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(float));
+        }
+
+        // null strings are stored with a length of 0xFFFFFFFF
+        void writeString(const char* const str)
+        {
+            if (str == nullptr)
+                return writeUInt32(0xFFFFFFFF);
+
+            const size_t len(std::strlen(str));
+            writeUInt32(static_cast<uint32_t>(len));
+            data.append(str, len);
+        }
+
+        void writeFeatures(const uint32_t count, const LV2_RDF_Feature* const features)
+        {
+            writeUInt32(count);
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                writeUInt32(features[i].Type);
+                writeString(features[i].URI);
+            }
+        }
+
+        void writeExtensions(const uint32_t count, const LV2_URI* const extensions)
+        {
+            writeUInt32(count);
+
+            for (uint32_t i=0; i < count; ++i)
+                writeString(extensions[i]);
+        }
+
+        void writeDescriptor(const LV2_RDF_Descriptor* const rdfDescriptor)
+        {
+            writeUInt32(rdfDescriptor->Type[0]);
+            writeUInt32(rdfDescriptor->Type[1]);
+            writeString(rdfDescriptor->URI);
+            writeString(rdfDescriptor->Name);
+            writeString(rdfDescriptor->Author);
+            writeString(rdfDescriptor->License);
+            writeString(rdfDescriptor->Binary);
+            writeString(rdfDescriptor->Bundle);
+            writeUInt64(rdfDescriptor->UniqueID);
+
+            writeUInt32(rdfDescriptor->PortCount);
+
+            for (uint32_t i=0; i < rdfDescriptor->PortCount; ++i)
+            {
+                const LV2_RDF_Port& port(rdfDescriptor->Ports[i]);
+
+                writeUInt32(port.Types);
+                writeUInt32(port.Properties);
+                writeUInt32(port.Designation);
+                writeString(port.Name);
+                writeString(port.Symbol);
+
+                writeUInt32(port.MidiMap.Type);
+                writeUInt32(port.MidiMap.Number);
+
+                writeUInt32(port.Points.Hints);
+                writeFloat(port.Points.Default);
+                writeFloat(port.Points.Minimum);
+                writeFloat(port.Points.Maximum);
+
+                writeUInt32(port.Unit.Hints);
+                writeString(port.Unit.Name);
+                writeString(port.Unit.Render);
+                writeString(port.Unit.Symbol);
+                writeUInt32(port.Unit.Unit);
+
+                writeUInt32(port.ScalePointCount);
+
+                for (uint32_t j=0; j < port.ScalePointCount; ++j)
+                {
+                    writeString(port.ScalePoints[j].Label);
+                    writeFloat(port.ScalePoints[j].Value);
+                }
+            }
+
+            writeUInt32(rdfDescriptor->PresetCount);
+
+            for (uint32_t i=0; i < rdfDescriptor->PresetCount; ++i)
+            {
+                writeString(rdfDescriptor->Presets[i].URI);
+                writeString(rdfDescriptor->Presets[i].Label);
+            }
+
+            writeFeatures(rdfDescriptor->FeatureCount, rdfDescriptor->Features);
+            writeExtensions(rdfDescriptor->ExtensionCount, rdfDescriptor->Extensions);
+
+            writeUInt32(rdfDescriptor->UICount);
+
+            for (uint32_t i=0; i < rdfDescriptor->UICount; ++i)
+            {
+                const LV2_RDF_UI& ui(rdfDescriptor->UIs[i]);
+
+                writeUInt32(ui.Type);
+                writeString(ui.URI);
+                writeString(ui.Binary);
+                writeString(ui.Bundle);
+                writeFeatures(ui.FeatureCount, ui.Features);
+                writeExtensions(ui.ExtensionCount, ui.Extensions);
+            }
+        }
+    };
+
+    // Reads past the end return zeros and clear 'ok', so callers only check once at the end
+    struct Reader {
+        const std::string& data;
+        size_t pos;
+        bool   ok;
+
+        Reader(const std::string& d)
+            : data(d),
+              pos(0),
+              ok(true) {}
+
+        bool atEnd() const
+        {
+            return (pos >= data.size());
+        }
+
+        size_t remaining() const
+        {
+            return data.size() - pos;
+        }
+
+        bool take(void* const dest, const size_t size)
+        {
+            if (! ok || size > remaining())
+            {
+                ok = false;
+                std::memset(dest, 0, size);
+                return false;
+            }
+
+            std::memcpy(dest, data.data() + pos, size);
+            pos += size;
+            return true;
+        }
+
+        bool readMagic()
+        {
+            char magic[sizeof(LV2_RDF_CACHE_MAGIC)];
+            return take(magic, sizeof(magic)) && std::memcmp(magic, LV2_RDF_CACHE_MAGIC, sizeof(magic)) == 0;
+        }
+
+        uint32_t readUInt32()
+        {
+            uint32_t value;
+            take(&value, sizeof(uint32_t));
+            return value;
+        }
+
+        uint64_t readUInt64()
+        {
+            uint64_t value;
+            take(&value, sizeof(uint64_t));
+            return value;
+        }
+
+        float readFloat()
+        {
+            float value;
+            take(&value, sizeof(float));
+            return value;
+        }
+
+        std::string readBlock(const size_t size)
+        {
+            if (! ok || size > remaining())
+            {
+                ok = false;
+                return std::string();
+            }
+
+            pos += size;
+            return data.substr(pos-size, size);
+        }
+
+        std::string readStdString()
+        {
+            const uint32_t len(readUInt32());
+            return readBlock(len == 0xFFFFFFFF ? 0 : len);
+        }
+
+        // returns a new string for the descriptor structs, or nullptr
+        const char* readString()
+        {
+            const uint32_t len(readUInt32());
+
+            if (len == 0xFFFFFFFF || ! ok || len > remaining())
+            {
+                if (len != 0xFFFFFFFF)
+                    ok = false;
+                return nullptr;
+            }
+
+            char* const str(new char[len+1]);
+            std::memcpy(str, data.data() + pos, len);
+            str[len] = '\0';
+            pos += len;
+
+            return str;
+        }
+
+        // every array element takes at least 4 bytes, bogus counts fail here instead of allocating
+        uint32_t readCount()
+        {
+            const uint32_t count(readUInt32());
+
+            if (count > remaining()/4)
+            {
+                ok = false;
+                return 0;
+            }
+
+            return count;
+        }
+
+        void readFeatures(uint32_t& count, LV2_RDF_Feature*& features)
+        {
+            count = readCount();
+
+            if (count == 0)
+                return;
+
+            features = new LV2_RDF_Feature[count];
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                features[i].Type = readUInt32();
+                features[i].URI  = readString();
+            }
+        }
+
+        void readExtensions(uint32_t& count, LV2_URI*& extensions)
+        {
+            count = readCount();
+
+            if (count == 0)
+                return;
+
+            extensions = new LV2_URI[count];
+
+            for (uint32_t i=0; i < count; ++i)
+                extensions[i] = readString();
+        }
+
+        bool readDescriptor(LV2_RDF_Descriptor* const rdfDescriptor)
+        {
+            rdfDescriptor->Type[0]  = readUInt32();
+            rdfDescriptor->Type[1]  = readUInt32();
+            rdfDescriptor->URI      = readString();
+            rdfDescriptor->Name     = readString();
+            rdfDescriptor->Author   = readString();
+            rdfDescriptor->License  = readString();
+            rdfDescriptor->Binary   = readString();
+            rdfDescriptor->Bundle   = readString();
+            rdfDescriptor->UniqueID = static_cast<unsigned long>(readUInt64());
+
+            rdfDescriptor->PortCount = readCount();
+
+            if (rdfDescriptor->PortCount > 0)
+            {
+                rdfDescriptor->Ports = new LV2_RDF_Port[rdfDescriptor->PortCount];
+
+                for (uint32_t i=0; i < rdfDescriptor->PortCount; ++i)
+                {
+                    LV2_RDF_Port& port(rdfDescriptor->Ports[i]);
+
+                    port.Types       = readUInt32();
+                    port.Properties  = readUInt32();
+                    port.Designation = readUInt32();
+                    port.Name        = readString();
+                    port.Symbol      = readString();
+
+                    port.MidiMap.Type   = readUInt32();
+                    port.MidiMap.Number = readUInt32();
+
+                    port.Points.Hints   = readUInt32();
+                    port.Points.Default = readFloat();
+                    port.Points.Minimum = readFloat();
+                    port.Points.Maximum = readFloat();
+
+                    port.Unit.Hints  = readUInt32();
+                    port.Unit.Name   = readString();
+                    port.Unit.Render = readString();
+                    port.Unit.Symbol = readString();
+                    port.Unit.Unit   = readUInt32();
+
+                    port.ScalePointCount = readCount();
+
+                    if (port.ScalePointCount > 0)
+                    {
+                        port.ScalePoints = new LV2_RDF_PortScalePoint[port.ScalePointCount];
+
+                        for (uint32_t j=0; j < port.ScalePointCount; ++j)
+                        {
+                            port.ScalePoints[j].Label = readString();
+                            port.ScalePoints[j].Value = readFloat();
+                        }
+                    }
+                }
+            }
+
+            rdfDescriptor->PresetCount = readCount();
+
+            if (rdfDescriptor->PresetCount > 0)
+            {
+                rdfDescriptor->Presets = new LV2_RDF_Preset[rdfDescriptor->PresetCount];
+
+                for (uint32_t i=0; i < rdfDescriptor->PresetCount; ++i)
+                {
+                    rdfDescriptor->Presets[i].URI   = readString();
+                    rdfDescriptor->Presets[i].Label = readString();
+                }
+            }
+
+            readFeatures(rdfDescriptor->FeatureCount, rdfDescriptor->Features);
+            readExtensions(rdfDescriptor->ExtensionCount, rdfDescriptor->Extensions);
+
+            rdfDescriptor->UICount = readCount();
+
+            if (rdfDescriptor->UICount > 0)
+            {
+                rdfDescriptor->UIs = new LV2_RDF_UI[rdfDescriptor->UICount];
+
+                for (uint32_t i=0; i < rdfDescriptor->UICount; ++i)
+                {
+                    LV2_RDF_UI& ui(rdfDescriptor->UIs[i]);
+
+                    ui.Type   = readUInt32();
+                    ui.URI    = readString();
+                    ui.Binary = readString();
+                    ui.Bundle = readString();
+                    readFeatures(ui.FeatureCount, ui.Features);
+                    readExtensions(ui.ExtensionCount, ui.Extensions);
+                }
+            }
+
+            return ok && atEnd() && rdfDescriptor->URI != nullptr && rdfDescriptor->Binary != nullptr;
+        }
+
+        CARLA_DECLARE_NON_COPYABLE(Reader)
+    };
+
+    CARLA_DECLARE_NON_COPYABLE(Lv2RdfCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // __LV2_RDF_CACHE_HPP__
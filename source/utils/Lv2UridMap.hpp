@@ -0,0 +1,276 @@
+/*
+ * Process-wide LV2 URID map
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __LV2_URID_MAP_HPP__
+#define __LV2_URID_MAP_HPP__
+
+#include "CarlaMutex.hpp"
+#include "CarlaUtils.hpp"
+
+#include "lv2/urid.h"
+
+// -----------------------------------------------------------------------
+// URID map shared by everything in the process, so URIDs are the same for all plugins and UIs.
+// URIs are stored in an append-only table and never move or get freed until the map itself goes away,
+// so unmap() is lock-free and returns pointers that stay valid.
+// map() looks up a hash index without locking, only adding a new URI takes the mutex.
+
+class Lv2UridMap
+{
+public:
+    // 'fixedURIs' get the ids 1 to fixedCount-1, index 0 is ignored (URID 0 is never valid)
+    Lv2UridMap(const char* const* const fixedURIs, const uint32_t fixedCount)
+        : fCount(1),
+          fIndex(nullptr),
+          fRetiredIndexes(nullptr)
+    {
+        carla_zeroStruct<Entry*>(fChunks, kMaxChunks);
+
+        fIndex = newIndex(256);
+
+        for (uint32_t i=1; i < fixedCount; ++i)
+        {
+            const LV2_URID urid(map(fixedURIs[i]));
+            CARLA_ASSERT_INT2(urid == i, urid, i);
+            (void)urid;
+        }
+    }
+
+    ~Lv2UridMap()
+    {
+        for (uint32_t i=1; i < fCount; ++i)
+            delete[] getEntry(i).uri;
+
+        for (uint32_t i=0; i < kMaxChunks && fChunks[i] != nullptr; ++i)
+            delete[] fChunks[i];
+
+        deleteIndex(fIndex);
+
+        while (Index* const index = fRetiredIndexes)
+        {
+            fRetiredIndexes = index->next;
+            deleteIndex(index);
+        }
+    }
+
+    // number of used URIDs, plus 1 for the null URID
+    uint32_t getCount() const
+    {
+        return fCount;
+    }
+
+    LV2_URID map(const char* const uri)
+    {
+        CARLA_ASSERT(uri != nullptr);
+
+        if (uri == nullptr)
+            return 0;
+
+        const uint32_t hash(getHash(uri));
+
+        if (const LV2_URID urid = find(fIndex, uri, hash))
+            return urid;
+
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        // might have been added while waiting for the lock
+        if (const LV2_URID urid = find(fIndex, uri, hash))
+            return urid;
+
+        return append(uri, hash);
+    }
+
+    // like map(), but never adds 'uri', returns 0 if it has no URID yet
+    LV2_URID lookup(const char* const uri) const
+    {
+        CARLA_ASSERT(uri != nullptr);
+
+        if (uri == nullptr)
+            return 0;
+
+        return find(fIndex, uri, getHash(uri));
+    }
+
+    const char* unmap(const LV2_URID urid) const
+    {
+        if (urid == 0 || urid >= fCount)
+            return nullptr;
+
+        return getEntry(urid).uri;
+    }
+
+    // Used to follow another process' map (UI bridges), which must keep the same URIDs.
+    // Returns false if 'uri' already has another URID, or if 'urid' is not the next one to be used.
+    bool insert(const LV2_URID urid, const char* const uri)
+    {
+        CARLA_ASSERT(uri != nullptr);
+
+        if (urid == 0 || uri == nullptr)
+            return false;
+
+        const uint32_t hash(getHash(uri));
+        const CarlaMutex::ScopedLocker sl(fMutex);
+
+        if (const LV2_URID oldUrid = find(fIndex, uri, hash))
+            return (oldUrid == urid);
+
+        if (urid != fCount)
+            return false;
+
+        append(uri, hash);
+        return true;
+    }
+
+private:
+    static const uint32_t kChunkSize = 1024;
+    static const uint32_t kMaxChunks = 1024;
+
+    struct Entry {
+        const char* uri;
+        uint32_t hash;
+    };
+
+    // open addressing, 0 means an empty slot
+    struct Index {
+        volatile uint32_t* ids;
+        uint32_t mask;
+        Index* next;
+    };
+
+    Entry* fChunks[kMaxChunks];
+    volatile uint32_t fCount;
+
+    Index* volatile fIndex;
+    Index* fRetiredIndexes;
+
+    CarlaMutex fMutex;
+
+    const Entry& getEntry(const uint32_t urid) const
+    {
+        return fChunks[urid / kChunkSize][urid % kChunkSize];
+    }
+
+    // FNV-1a
+    static uint32_t getHash(const char* uri)
+    {
+        uint32_t hash = 2166136261U;
+
+        for (; *uri != '\0'; ++uri)
+        {
+            hash ^= static_cast<uint8_t>(*uri);
+            hash *= 16777619U;
+        }
+
+        return hash;
+    }
+
+    LV2_URID find(const Index* const index, const char* const uri, const uint32_t hash) const
+    {
+        for (uint32_t i = hash & index->mask;; i = (i+1) & index->mask)
+        {
+            const uint32_t urid(index->ids[i]);
+
+            if (urid == 0)
+                return 0;
+
+            const Entry& entry(getEntry(urid));
+
+            if (entry.hash == hash && std::strcmp(entry.uri, uri) == 0)
+                return urid;
+        }
+    }
+
+    static void insertInIndex(Index* const index, const uint32_t urid, const uint32_t hash)
+    {
+        uint32_t i = hash & index->mask;
+
+        while (index->ids[i] != 0)
+            i = (i+1) & index->mask;
+
+        index->ids[i] = urid;
+    }
+
+    static Index* newIndex(const uint32_t size)
+    {
+        Index* const index(new Index);
+        index->ids = new uint32_t[size];
+        index->mask  = size-1;
+        index->next  = nullptr;
+
+        carla_zeroMem((void*)index->ids, sizeof(uint32_t)*size);
+
+        return index;
+    }
+
+    static void deleteIndex(Index* const index)
+    {
+        delete[] index->ids;
+        delete index;
+    }
+
+    // must be called with the mutex locked
+    LV2_URID append(const char* const uri, const uint32_t hash)
+    {
+        const uint32_t urid(fCount);
+        const uint32_t chunk(urid / kChunkSize);
+
+        CARLA_ASSERT(chunk < kMaxChunks);
+
+        if (chunk >= kMaxChunks)
+            return 0;
+
+        if (fChunks[chunk] == nullptr)
+            fChunks[chunk] = new Entry[kChunkSize];
+
+        Entry& entry(fChunks[chunk][urid % kChunkSize]);
+        entry.uri  = carla_strdup(uri);
+        entry.hash = hash;
+
+        // the entry must be complete before anyone can see its urid
+        __sync_synchronize();
+        fCount = urid+1;
+
+        if ((urid+1)*2 > fIndex->mask+1)
+        {
+            // keep the index at most half full, old indexes might still be read so are only deleted at the end
+            Index* const index(newIndex((fIndex->mask+1)*2));
+
+            for (uint32_t i=1; i <= urid; ++i)
+                insertInIndex(index, i, getEntry(i).hash);
+
+            __sync_synchronize();
+
+            Index* const oldIndex(fIndex);
+            fIndex = index;
+
+            oldIndex->next  = fRetiredIndexes;
+            fRetiredIndexes = oldIndex;
+        }
+        else
+        {
+            insertInIndex(fIndex, urid, hash);
+        }
+
+        return urid;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(Lv2UridMap)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // __LV2_URID_MAP_HPP__
@@ -0,0 +1,156 @@
+/*
+ * Real-time safe, lock-free, bounded multi-producer queue
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __RT_QUEUE_HPP__
+#define __RT_QUEUE_HPP__
+
+#include "CarlaJuceUtils.hpp"
+
+// -----------------------------------------------------------------------
+// Bounded queue, based on Dmitry Vyukov's MPMC ring.
+// put() never blocks or allocates and is safe from any number of threads,
+// when the queue is full the value is dropped and counted as an overflow.
+// get() is meant for a single consumer thread.
+// kSize must be a power of 2; T must be copyable.
+
+template<typename T, uint32_t kSize>
+class RtQueue
+{
+public:
+    RtQueue()
+        : fWritePos(0),
+          fReadPos(0),
+          fOverflows(0)
+    {
+        CARLA_ASSERT(kSize >= 2 && (kSize & (kSize-1)) == 0);
+
+        for (uint32_t i=0; i < kSize; ++i)
+            fCells[i].sequence = i;
+    }
+
+    bool put(const T& value)
+    {
+        Cell* cell;
+        uint32_t pos = fWritePos;
+
+        for (;;)
+        {
+            cell = &fCells[pos & kMask];
+
+            const uint32_t sequence = cell->sequence;
+            __sync_synchronize();
+
+            const int32_t diff = static_cast<int32_t>(sequence - pos);
+
+            if (diff == 0)
+            {
+                if (__sync_bool_compare_and_swap(&fWritePos, pos, pos+1))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                __sync_add_and_fetch(&fOverflows, 1);
+                return false;
+            }
+
+            pos = fWritePos;
+        }
+
+        cell->value = value;
+        __sync_synchronize();
+        cell->sequence = pos+1;
+        return true;
+    }
+
+    bool get(T& value)
+    {
+        Cell* cell;
+        uint32_t pos = fReadPos;
+
+        for (;;)
+        {
+            cell = &fCells[pos & kMask];
+
+            const uint32_t sequence = cell->sequence;
+            __sync_synchronize();
+
+            const int32_t diff = static_cast<int32_t>(sequence - (pos+1));
+
+            if (diff == 0)
+            {
+                if (__sync_bool_compare_and_swap(&fReadPos, pos, pos+1))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+
+            pos = fReadPos;
+        }
+
+        value = cell->value;
+        __sync_synchronize();
+        cell->sequence = pos+kSize;
+        return true;
+    }
+
+    // number of values currently queued, only exact when no put() is in progress
+    uint32_t count() const
+    {
+        return fWritePos - fReadPos;
+    }
+
+    bool isEmpty() const
+    {
+        return (fWritePos == fReadPos);
+    }
+
+    // number of dropped values since the last call
+    uint32_t takeOverflows()
+    {
+        return __sync_fetch_and_and(&fOverflows, 0);
+    }
+
+    void clear()
+    {
+        T value;
+
+        while (get(value)) {}
+
+        fOverflows = 0;
+    }
+
+private:
+    static const uint32_t kMask = kSize-1;
+
+    struct Cell {
+        volatile uint32_t sequence;
+        T value;
+    };
+
+    Cell fCells[kSize];
+    volatile uint32_t fWritePos;
+    volatile uint32_t fReadPos;
+    volatile uint32_t fOverflows;
+
+    CARLA_DECLARE_NON_COPYABLE(RtQueue)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // __RT_QUEUE_HPP__
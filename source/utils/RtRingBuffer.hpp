@@ -0,0 +1,130 @@
+/*
+ * Real-time safe, lock-free ring buffer for variable sized messages
+ * Copyright (C) 2013 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the GPL.txt file
+ */
+
+#ifndef __RT_RING_BUFFER_HPP__
+#define __RT_RING_BUFFER_HPP__
+
+#include "CarlaJuceUtils.hpp"
+
+#include <cstring>
+
+// -----------------------------------------------------------------------
+// Single producer, single consumer ring of variable sized messages.
+// Each message is stored as its size followed by its data, wrapping around the end.
+// Neither side ever blocks or allocates, a message that doesn't fit is refused.
+// kSize must be a power of 2.
+
+template<uint32_t kSize>
+class RtRingBuffer
+{
+public:
+    RtRingBuffer()
+        : fWritePos(0),
+          fReadPos(0)
+    {
+        CARLA_ASSERT(kSize >= 8 && (kSize & (kSize-1)) == 0);
+    }
+
+    // biggest message that can ever fit
+    static uint32_t getMaxMessageSize()
+    {
+        return kSize - sizeof(uint32_t);
+    }
+
+    // producer side
+    bool writeMessage(const void* const data, const uint32_t size)
+    {
+        CARLA_ASSERT(data != nullptr || size == 0);
+
+        const uint32_t pos(fWritePos);
+
+        if (size > getMaxMessageSize() || sizeof(uint32_t) + size > kSize - (pos - fReadPos))
+            return false;
+
+        copyIn(pos, &size, sizeof(uint32_t));
+
+        if (size > 0)
+            copyIn(pos + sizeof(uint32_t), data, size);
+
+        __sync_synchronize();
+        fWritePos = pos + sizeof(uint32_t) + size;
+        return true;
+    }
+
+    // consumer side, 'data' must have room for 'maxSize' bytes.
+    // a message bigger than 'maxSize' is dropped, and 'size' set to its real size.
+    bool readMessage(void* const data, const uint32_t maxSize, uint32_t& size)
+    {
+        const uint32_t pos(fReadPos);
+
+        if (fWritePos == pos)
+            return false;
+
+        __sync_synchronize();
+
+        copyOut(pos, &size, sizeof(uint32_t));
+
+        if (size <= maxSize)
+            copyOut(pos + sizeof(uint32_t), data, size);
+
+        __sync_synchronize();
+        fReadPos = pos + sizeof(uint32_t) + size;
+        return (size <= maxSize);
+    }
+
+    bool isEmpty() const
+    {
+        return (fWritePos == fReadPos);
+    }
+
+    // consumer side
+    void clear()
+    {
+        fReadPos = fWritePos;
+    }
+
+private:
+    static const uint32_t kMask = kSize-1;
+
+    uint8_t fBuffer[kSize];
+    volatile uint32_t fWritePos;
+    volatile uint32_t fReadPos;
+
+    void copyIn(const uint32_t pos, const void* const data, const uint32_t size)
+    {
+        const uint32_t offset(pos & kMask);
+        const uint32_t first((size < kSize - offset) ? size : kSize - offset);
+
+        std::memcpy(fBuffer + offset, data, first);
+        std::memcpy(fBuffer, (const uint8_t*)data + first, size - first);
+    }
+
+    void copyOut(const uint32_t pos, void* const data, const uint32_t size) const
+    {
+        const uint32_t offset(pos & kMask);
+        const uint32_t first((size < kSize - offset) ? size : kSize - offset);
+
+        std::memcpy(data, fBuffer + offset, first);
+        std::memcpy((uint8_t*)data + first, fBuffer, size - first);
+    }
+
+    CARLA_DECLARE_NON_COPYABLE(RtRingBuffer)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // __RT_RING_BUFFER_HPP__